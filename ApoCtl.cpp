@@ -56,6 +56,10 @@ public:
 #include <string>
 #include <algorithm>
 
+#include "MyApoParams.h"
+#include "ApoShmCtl.h" // 共享内存控制面（与 APO 共用同一份布局）
+#include "ParamsWire.h" // 参数线格式（增量/批量）
+
 // ===== 你的 APO 属性集与 PID 定义（需与 APO 内一致）=====
 DEFINE_GUID(MYCOMPANY_APO_PROPSETID,
             0xd4d9a040, 0x8b5f, 0x4c0e, 0xaa, 0xd1, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff);
@@ -65,8 +69,9 @@ enum : ULONG
     PID_Gain = 1,
     PID_EQBand = 2,
     PID_Reverb = 3,
-    PID_Limiter = 4,
-    PID_ParamsBlob = 10
+    PID_Limiter = 4,     // 不再经 KS 发送：APO 收不到，limiter 命令改写共享内存里的 MyDspParams.limiter
+    PID_ParamsBlob = 10,
+    PID_ParamsWire = 11 // ParamsWire 线格式消息（变长）
 };
 
 struct EQBandParam
@@ -570,6 +575,215 @@ static HRESULT KsGet(IKsControl *ks, ULONG pid, T &out)
     return ks->KsProperty(&prop, sizeof(prop), (PVOID)&out, sizeof(T), &ret);
 }
 
+static bool HexToBytes(const std::wstring &hex, std::vector<BYTE> &out);
+
+// ---- 共享内存控制面：读回当前参数 → 改 → 编码成增量消息发布（APO 的控制线程几毫秒内取走，不走 IKsControl）----
+// 每个端点一块，对象名由端点 ID 拼成（ApoShmMakeName），端点按与其他命令相同的选择器挑
+static void ShmDefaults(MyDspParams &p)
+{
+    ZeroMemory(&p, sizeof(p));
+    p.gain = 1.0f;
+    for (int b = 0; b < MY_EQ_BANDS; ++b)
+    {
+        p.eq[b].freq = 1000.f;
+        p.eq[b].q = 1.0f;
+        p.eq[b].type = 0;
+    }
+    p.eq[0].freq = 100.f;  p.eq[0].q = 0.707f; p.eq[0].type = 1;
+    p.eq[2].freq = 8000.f; p.eq[2].q = 0.707f; p.eq[2].type = 2;
+    p.reverb.wet = 0.2f;
+    p.reverb.room = 0.7f;
+    p.reverb.damp = 0.3f;
+    p.reverb.pre_ms = 20.f;
+    p.limiterEnabled = 1;
+    p.limiter.threshold = 0.98f;
+    p.limiter.lookahead_ms = 1.5f;
+    p.limiter.release_ms = 50.f;
+}
+
+static int ShmCommand(int argc, wchar_t **argv, int argi, const wchar_t *endpointId)
+{
+    wchar_t name[APO_SHM_NAME_CCH];
+    if (!ApoShmMakeName(endpointId, name, _countof(name)))
+    {
+        wprintf(L"[!] 端点 ID 无效，拼不出共享内存名\n");
+        return 1;
+    }
+    HANDLE h = OpenFileMappingW(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, name);
+    if (!h)
+    {
+        wprintf(L"[!] 打开共享内存 %s 失败 (err=%u)；APO 还没加载？可先播放一段声音（--force-stream）\n", name, GetLastError());
+        return 1;
+    }
+    auto *blk = static_cast<ApoShmParamsBlock *>(MapViewOfFile(h, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, sizeof(ApoShmParamsBlock)));
+    if (!blk || !ApoShmValid(blk))
+    {
+        wprintf(L"[!] 共享内存布局不匹配（APO 与 ApoCtl 版本不一致？）\n");
+        if (blk)
+            UnmapViewOfFile(blk);
+        CloseHandle(h);
+        return 1;
+    }
+
+    MyDspParams p;
+    const bool hasState = ApoShmRead(blk, p);
+    if (!hasState)
+        ShmDefaults(p);
+    const MyDspParams before = p;
+
+    int rc = 0;
+    std::wstring sub = (argi < argc) ? argv[argi] : L"get";
+    if (sub == L"get")
+    {
+        wprintf(L"[OK] seq=%u gain=%f limiter=%d(thr=%f look=%fms rel=%fms tp=%d mode=%d) reverb=%d(wet=%f room=%f damp=%f pre=%fms)\n",
+                blk->seq.load(), p.gain, p.limiterEnabled, p.limiter.threshold, p.limiter.lookahead_ms,
+                p.limiter.release_ms, p.limiter.truePeak, p.limiter.mode, p.reverb.enabled,
+                p.reverb.wet, p.reverb.room, p.reverb.damp, p.reverb.pre_ms);
+        for (int b = 0; b < MY_EQ_BANDS; ++b)
+            if (p.eq[b].enabled)
+                wprintf(L"     eq[%d] type=%d f=%.1f q=%.3f g=%.2fdB\n", b, p.eq[b].type, p.eq[b].freq, p.eq[b].q, p.eq[b].gain_db);
+        UnmapViewOfFile(blk);
+        CloseHandle(h);
+        return 0;
+    }
+
+    // 一行里可以连写多条子命令（例：shm gain 0.8 eq 3 1000 1 -3 reverb 0.2），
+    // 全部改完后编码成一条增量消息发布，APO 在同一块开头一次生效
+    bool full = false;   // blob：整份发布
+    std::vector<BYTE> rawWire; // wire：直接发布给定的线格式消息
+    while (rc == 0 && argi < argc)
+    {
+        sub = argv[argi];
+        if (sub == L"gain" && argi + 1 < argc)
+        {
+            p.gain = (float)_wtof(argv[argi + 1]);
+            argi += 2;
+        }
+        else if (sub == L"limiter" && argi + 1 < argc)
+        {
+            p.limiterEnabled = _wtoi(argv[argi + 1]) ? 1 : 0;
+            argi += 2;
+            // 可选：阈值（线性）、前瞻 ms、释放 ms、真峰值 0/1，按顺序给出前几个即可
+            float *const fields[] = {&p.limiter.threshold, &p.limiter.lookahead_ms, &p.limiter.release_ms};
+            for (int i = 0; i < 3 && argi < argc && iswdigit(argv[argi][0]); ++i)
+                *fields[i] = (float)_wtof(argv[argi++]);
+            if (argi < argc && iswdigit(argv[argi][0]))
+                p.limiter.truePeak = _wtoi(argv[argi++]) ? 1 : 0;
+        }
+        else if (sub == L"softclip" && argi + 1 < argc)
+        {
+            p.limiter.mode = _wtoi(argv[argi + 1]) ? 1 : 0;
+            argi += 2;
+        }
+        else if (sub == L"eq" && argi + 4 < argc)
+        {
+            const int b = _wtoi(argv[argi + 1]);
+            if (b < 0 || b >= MY_EQ_BANDS)
+            {
+                rc = 1;
+                break;
+            }
+            p.eq[b].enabled = 1;
+            p.eq[b].freq = (float)_wtof(argv[argi + 2]);
+            p.eq[b].q = (float)_wtof(argv[argi + 3]);
+            p.eq[b].gain_db = (float)_wtof(argv[argi + 4]);
+            argi += 5;
+            // 可选的第 5 个参数是类型（0/1/2）；下一条子命令以字母开头，不会被误认
+            if (argi < argc && iswdigit(argv[argi][0]))
+                p.eq[b].type = _wtoi(argv[argi++]);
+        }
+        else if (sub == L"eqoff" && argi + 1 < argc)
+        {
+            const int b = _wtoi(argv[argi + 1]);
+            if (b < 0 || b >= MY_EQ_BANDS)
+            {
+                rc = 1;
+                break;
+            }
+            p.eq[b].enabled = 0;
+            argi += 2;
+        }
+        else if (sub == L"reverb" && argi + 1 < argc)
+        {
+            p.reverb.wet = (float)_wtof(argv[argi + 1]);
+            p.reverb.enabled = p.reverb.wet > 0.f ? 1 : 0;
+            argi += 2;
+            if (argi + 2 < argc && iswdigit(argv[argi][0]))
+            {
+                p.reverb.room = (float)_wtof(argv[argi]);
+                p.reverb.damp = (float)_wtof(argv[argi + 1]);
+                p.reverb.pre_ms = (float)_wtof(argv[argi + 2]);
+                argi += 3;
+            }
+        }
+        else if (sub == L"blob" && argi + 1 < argc)
+        {
+            // 整份 sizeof(MyDspParams) 字节，或不含 limiter 组的旧长度（limiter 组清零 = DSP 默认值）
+            std::vector<BYTE> bytes;
+            if (!HexToBytes(argv[argi + 1], bytes) ||
+                (bytes.size() != sizeof(MyDspParams) && bytes.size() != MY_DSP_PARAMS_BASE_BYTES))
+            {
+                wprintf(L"[!] shm blob 需要正好 %u 或 %u 字节的16进制串\n", (UINT)sizeof(MyDspParams),
+                        (UINT)MY_DSP_PARAMS_BASE_BYTES);
+                rc = 1;
+                break;
+            }
+            ZeroMemory(&p, sizeof(p));
+            memcpy(&p, bytes.data(), bytes.size());
+            full = true;
+            argi += 2;
+        }
+        else if (sub == L"wire" && argi + 1 < argc)
+        {
+            if (!HexToBytes(argv[argi + 1], rawWire) || rawWire.empty() || rawWire.size() > PARAMS_WIRE_MAX_BYTES)
+            {
+                wprintf(L"[!] shm wire 需要 1..%u 字节的16进制串\n", PARAMS_WIRE_MAX_BYTES);
+                rc = 1;
+                break;
+            }
+            argi += 2;
+        }
+        else
+            rc = 1;
+    }
+
+    if (rc == 0 && !rawWire.empty())
+    {
+        const ParamsWireResult r = ApoShmPublishWire(blk, rawWire.data(), (uint32_t)rawWire.size());
+        if (r == kWireOk)
+            wprintf(L"[OK] shm wire 已发布 (%u bytes, seq=%u)\n", (UINT)rawWire.size(), blk->seq.load());
+        else
+        {
+            wprintf(L"[!] shm wire 消息不合法 (err=%d)，未发布\n", (int)r);
+            rc = 1;
+        }
+    }
+    else if (rc == 0 && full)
+    {
+        ApoShmPublish(blk, p);
+        wprintf(L"[OK] shm blob 已发布 (seq=%u)\n", blk->seq.load());
+    }
+    else if (rc == 0)
+    {
+        // 控制端从没写过时共享内存里是全零：发整份（相对 nullptr 编码），否则只发改动
+        uint8_t msg[PARAMS_WIRE_MAX_BYTES];
+        const uint32_t n = ParamsWireEncodeDelta(hasState ? &before : nullptr, p, msg, sizeof(msg));
+        const ParamsWireResult r = n ? ApoShmPublishWire(blk, msg, n) : kWireTruncated;
+        if (r == kWireOk)
+            wprintf(L"[OK] shm 已发布 (%u bytes, seq=%u)\n", n, blk->seq.load());
+        else
+        {
+            wprintf(L"[!] shm 编码/发布失败 (err=%d)\n", (int)r);
+            rc = 1;
+        }
+    }
+    else
+        wprintf(L"[!] shm 命令/参数不完整\n");
+    UnmapViewOfFile(blk);
+    CloseHandle(h);
+    return rc;
+}
+
 static bool HexToBytes(const std::wstring &hex, std::vector<BYTE> &out)
 {
     if (hex.size() % 2)
@@ -682,9 +896,14 @@ int wmain(int argc, wchar_t **argv)
         wprintf(L"  ApoCtl.exe [选择器...] gain <linear>\n");
         wprintf(L"  ApoCtl.exe [选择器...] eq <bandIndex> <linear>\n");
         wprintf(L"  ApoCtl.exe [选择器...] reverb <mix0..1>\n");
-        wprintf(L"  ApoCtl.exe [选择器...] limiter <thresLinear>\n");
+        wprintf(L"  ApoCtl.exe [选择器...] limiter <thresLinear>   （开启限幅并设阈值，写选中端点的共享内存）\n");
         wprintf(L"  ApoCtl.exe [选择器...] blob <hex_no_spaces>\n");
         wprintf(L"  ApoCtl.exe [选择器...] get gain|reverb|limiter\n");
+        wprintf(L"  ApoCtl.exe [选择器...] wire <hex>   （ParamsWire 线格式消息）\n");
+        wprintf(L"  ApoCtl.exe [选择器...] shm get | gain <linear> | limiter <0|1> [thresLinear lookaheadMs releaseMs truePeak]\n");
+        wprintf(L"                 | softclip <0|1> | eq <band> <freq> <q> <gainDb> [type]\n");
+        wprintf(L"                 | eqoff <band> | reverb <wet> [room damp preMs] | blob <hex> | wire <hex>\n");
+        wprintf(L"                 （选中端点的共享内存，无需 IKsControl；多条子命令可连写，作为一个事务发布）\n");
         wprintf(L"  例：ApoCtl.exe --render --pnp \"USB\\VID_0A67&PID_30A2&MI_00\" gain 0.5\n");
         return 0; // 这里直接 return，避免 goto 跳过构造
     }
@@ -725,6 +944,33 @@ int wmain(int argc, wchar_t **argv)
                 ifPath.c_str(), hwid.empty() ? L"(n/a)" : hwid.c_str());
     }
 
+    // 共享内存控制面：只要端点 ID（拼共享内存名），不需要 IKsControl。
+    // limiter <thres> / get limiter 也走这里：等价于 shm limiter 1 <thres> / shm get
+    const bool isShm = _wcsicmp(argv[opt.argi], L"shm") == 0;
+    const bool isLimiter = _wcsicmp(argv[opt.argi], L"limiter") == 0 && opt.argi + 1 < argc;
+    const bool isGetLimiter = _wcsicmp(argv[opt.argi], L"get") == 0 && opt.argi + 1 < argc &&
+                              _wcsicmp(argv[opt.argi + 1], L"limiter") == 0;
+    if (isShm || isLimiter || isGetLimiter)
+    {
+        if (opt.forceStream && FAILED(hr = EnsureApoLoaded(dev, opt.forceMs)))
+            wprintf(L"[!] force-stream failed (0x%08X)\n", hr);
+        LPWSTR id = nullptr;
+        hr = dev->GetId(&id);
+        RETURN_IF_FAILED(hr, "Get endpoint id");
+        if (opt.verbose)
+            wprintf(L"[v] Endpoint id: %s\n", id);
+        wchar_t subLimiter[] = L"limiter", subOn[] = L"1", subGet[] = L"get";
+        wchar_t *limArgv[] = {subLimiter, subOn, isLimiter ? argv[opt.argi + 1] : subOn};
+        wchar_t *getArgv[] = {subGet};
+        const int rc = isShm       ? ShmCommand(argc, argv, opt.argi + 1, id)
+                       : isLimiter ? ShmCommand(3, limArgv, 0, id)
+                                   : ShmCommand(1, getArgv, 0, id);
+        CoTaskMemFree(id);
+        dev->Release();
+        CoUninitialize();
+        return rc;
+    }
+
     // 取 IKsControl（多路径）
     if (opt.forceStream)
     {
@@ -758,13 +1004,6 @@ int wmain(int argc, wchar_t **argv)
             hr = KsSet(ks, PID_Reverb, mix);
             HR_OK(hr) ? wprintf(L"[OK] Set Reverb mix = %f\n", mix) : HR_FAIL(hr, "Set Reverb");
         }
-        else if (cmd == L"limiter" && opt.argi + 1 < argc)
-        {
-            float thr = (float)_wtof(argv[opt.argi + 1]);
-            hr = KsSet(ks, PID_Limiter, thr);
-            HR_OK(hr) ? wprintf(L"[OK] Set Limiter threshold = %f\n", thr)
-                      : HR_FAIL(hr, "Set Limiter");
-        }
         else if (cmd == L"blob" && opt.argi + 1 < argc)
         {
             std::vector<BYTE> bytes;
@@ -782,6 +1021,25 @@ int wmain(int argc, wchar_t **argv)
             HR_OK(hr) ? wprintf(L"[OK] Set Blob (%u bytes)\n", (UINT)bytes.size())
                       : HR_FAIL(hr, "Set Blob");
         }
+        else if (cmd == L"wire" && opt.argi + 1 < argc)
+        {
+            std::vector<BYTE> bytes;
+            MyDspParams probe = {};
+            if (!HexToBytes(argv[opt.argi + 1], bytes) ||
+                ParamsWireDecode(bytes.data(), (uint32_t)bytes.size(), probe) != kWireOk)
+            {
+                wprintf(L"[!] wire 需要一条合法的 ParamsWire 消息（16进制，无空格）\n");
+                goto done;
+            }
+            KSPROPERTY prop = {};
+            prop.Set = MYCOMPANY_APO_PROPSETID;
+            prop.Id = PID_ParamsWire;
+            prop.Flags = KSPROPERTY_TYPE_SET;
+            ULONG ret = 0;
+            hr = ks->KsProperty(&prop, sizeof(prop), bytes.data(), (ULONG)bytes.size(), &ret);
+            HR_OK(hr) ? wprintf(L"[OK] Set Wire (%u bytes)\n", (UINT)bytes.size())
+                      : HR_FAIL(hr, "Set Wire");
+        }
         else if (cmd == L"get" && opt.argi + 1 < argc)
         {
             std::wstring which = argv[opt.argi + 1];
@@ -798,12 +1056,6 @@ int wmain(int argc, wchar_t **argv)
                 hr = KsGet(ks, PID_Reverb, m);
                 HR_OK(hr) ? wprintf(L"[OK] Reverb=%f\n", m) : HR_FAIL(hr, "Get Reverb");
             }
-            else if (which == L"limiter")
-            {
-                float t = 0;
-                hr = KsGet(ks, PID_Limiter, t);
-                HR_OK(hr) ? wprintf(L"[OK] Limiter=%f\n", t) : HR_FAIL(hr, "Get Limiter");
-            }
             else
                 wprintf(L"[!] 未实现 get %s\n", which.c_str());
         }
@@ -0,0 +1,52 @@
+// ApoProcessCore.h —— APOProcess 的可移植核心（不依赖 Windows/APO 头文件）
+// EfxApo.cpp 用真实的 APO_CONNECTION_PROPERTY 实例化；EfxTestHost 用字段同名的假结构体测试。
+// 约定：连接格式为 float32 interleaved；in/out 指向同一块缓冲时就地处理，不做任何中间拷贝。
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "dsp_wrapper.h"
+
+namespace ApoCore
+{
+    // 与 audioenginebaseapo.h 的 APO_BUFFER_FLAGS 取值一致（EfxApo.cpp 里有 static_assert）
+    enum : uint32_t
+    {
+        kBufferInvalid = 0,
+        kBufferValid = 1,
+        kBufferSilent = 2
+    };
+
+    // 处理一个连接对；返回 true 表示本次真正跑了 DSP
+    // ConnProp 需要有 pBuffer / u32ValidFrameCount / u32BufferFlags 三个字段
+    template <class ConnProp>
+    inline bool Process(void *dspCtx, unsigned channels, ConnProp *in, ConnProp *out)
+    {
+        if (!in || !out || !out->pBuffer)
+            return false;
+
+        const uint32_t frames = in->u32ValidFrameCount;
+        out->u32ValidFrameCount = frames;
+
+        // 无效输入/没有 DSP：不碰缓冲，只把标志传下去
+        if (frames == 0 || !dspCtx || channels == 0)
+        {
+            out->u32BufferFlags = (in->u32BufferFlags == kBufferValid) ? kBufferValid : kBufferSilent;
+            return false;
+        }
+
+        float *dst = reinterpret_cast<float *>(out->pBuffer);
+        // 静音/无效输入：混响等尾音还没放完时照常输出尾音；链空闲后不碰缓冲、不跑 DSP，只传静音标志
+        if (in->u32BufferFlags != kBufferValid)
+        {
+            const bool tail = dsp_process_silence(dspCtx, dst, frames, channels) != 0;
+            out->u32BufferFlags = tail ? kBufferValid : kBufferSilent;
+            return tail;
+        }
+
+        const float *src = reinterpret_cast<const float *>(in->pBuffer);
+        // src == dst 时 dsp_process_block 原地处理（先解交织到内部工作区，再写回）
+        dsp_process_block(dspCtx, src, dst, frames, channels);
+        out->u32BufferFlags = kBufferValid;
+        return true;
+    }
+}
@@ -0,0 +1,79 @@
+// ApoRtLog.h —— 实时线程用的无锁单生产者/单消费者二进制日志环（每个 APO 实例一个）
+// 实时线程只写定长记录（事件号 + 几个整数），不格式化、不进内核；
+// 非实时线程（PipeThreadMain）定期取出并格式化输出。环满时丢弃新记录并计数。
+// 不依赖 Windows 头文件，EfxTestHost 可直接测试。
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// 事件号（格式化文本见 EfxApo.cpp 的 RtLogText）
+enum ApoRtEvent : uint32_t
+{
+    kRtEvtNone = 0,
+    kRtEvtTick = 1,    // a=本秒处理的块数, b=帧数/块, c=通道数
+    kRtEvtSilent = 2,  // a=本秒跳过的静音块数
+    kRtEvtNoCtx = 3,   // APOProcess 时 DSP 上下文不存在
+};
+
+struct ApoRtRecord
+{
+    uint32_t id;
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+};
+
+template <uint32_t Capacity = 256>
+class ApoRtLogRing
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // 生产者（实时线程）：满了就丢，永不阻塞
+    bool Push(uint32_t id, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0)
+    {
+        const uint32_t w = m_write.load(std::memory_order_relaxed);
+        const uint32_t r = m_read.load(std::memory_order_acquire);
+        if (w - r >= Capacity)
+        {
+            m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        ApoRtRecord &rec = m_recs[w & (Capacity - 1)];
+        rec.id = id;
+        rec.a = a;
+        rec.b = b;
+        rec.c = c;
+        m_write.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者（非实时线程）：逐条交给 fn，返回取出的条数
+    template <class Fn>
+    uint32_t Drain(Fn &&fn)
+    {
+        uint32_t r = m_read.load(std::memory_order_relaxed);
+        const uint32_t w = m_write.load(std::memory_order_acquire);
+        uint32_t n = 0;
+        for (; r != w; ++r, ++n)
+        {
+            const ApoRtRecord rec = m_recs[r & (Capacity - 1)];
+            m_read.store(r + 1, std::memory_order_release);
+            fn(rec);
+        }
+        return n;
+    }
+
+    // 累计丢弃的记录数（只增不减）
+    uint32_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    // 读写位置之间用填充隔开，避免两个线程互相踢缓存行
+    // （用填充而不是 alignas：APO 对象是普通 new 出来的，C++14 下不保证超对齐）
+    std::atomic<uint32_t> m_write{0};
+    std::atomic<uint32_t> m_dropped{0};
+    char m_pad0[64];
+    std::atomic<uint32_t> m_read{0};
+    char m_pad1[64];
+    ApoRtRecord m_recs[Capacity];
+};
@@ -0,0 +1,287 @@
+// ApoShmCtl.h —— 共享内存控制面：按端点一块，里面放一份带版本号的 MyDspParams（seqlock）
+// 控制端（ApoCtl 等）整份写入；APO 的控制线程（PipeThreadMain）定时比较一次序号，没变就直接返回，
+// 变了才把参数拷出来（读者不加锁、不会等写者），应用到 DSP 后实时线程在下一块取到新快照。
+// 写者用 ApoShmPublishWire 发布增量（ParamsWire 线格式）时，块里同时留下这条消息：
+// 读者正好落后一次发布时只拷这条短消息、在本地解码，否则退回整份拷贝。
+// 写者在写的途中退出（进程被杀/崩溃）会把序号留在奇数：等待的一方自旋几次后让出 CPU，
+// 同一个奇数序号停留超过 APO_SHM_STALE_MS 就接管（见 ApoShmBreakStale），谁都不会一直等下去。
+// 只依赖标准库，EfxTestHost 里用两个线程直接测试；映射/打开共享内存的 Win32 代码在 EfxApo.cpp / ApoCtl.cpp。
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <thread>
+#include "MyApoParams.h"
+#include "ParamsWire.h"
+
+// 共享内存对象名 = 前缀 + 端点 ID（IMMDevice::GetId，例如 {0.0.0.00000000}.{guid}），每个端点（渲染/采集各自）一块。
+// APO 跑在 audiodg（服务会话）里，控制端在用户会话，所以要用 Global\ 命名空间
+#define MYCOMPANY_SHM_PREFIX L"Global\\MyCompanyApoParams-"
+#define APO_SHM_NAME_CCH 256 // 对象名（含前缀与结尾 0）的最大长度
+
+// 由端点 ID 拼出对象名；'\' 在对象名里是命名空间分隔符，换成 '_'。ID 为空或放不下时返回 false
+inline bool ApoShmMakeName(const wchar_t *endpointId, wchar_t *out, size_t cch)
+{
+    const wchar_t *prefix = MYCOMPANY_SHM_PREFIX;
+    size_t n = 0;
+    if (!endpointId || !*endpointId || !out || !cch)
+        return false;
+    for (; *prefix && n + 1 < cch; ++prefix)
+        out[n++] = *prefix;
+    for (; *endpointId && n + 1 < cch; ++endpointId)
+        out[n++] = *endpointId == L'\\' ? L'_' : *endpointId;
+    out[n] = 0;
+    return !*prefix && !*endpointId;
+}
+
+#define APO_SHM_MAGIC 0x4D534F41u // 'AOSM'
+#define APO_SHM_LAYOUT_VERSION 4u
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "跨进程共享的原子量必须是无锁的");
+
+struct ApoShmParamsBlock
+{
+    static const uint32_t kWords = (sizeof(MyDspParams) + 3) / 4;
+    static const uint32_t kWireWords = PARAMS_WIRE_MAX_BYTES / 4;
+
+    uint32_t magic;          // APO_SHM_MAGIC，创建方写入
+    uint32_t layoutVersion;  // APO_SHM_LAYOUT_VERSION
+    uint32_t payloadBytes;   // sizeof(MyDspParams)
+    uint32_t reserved;
+    char pad0[48];
+
+    // 序号：偶数 = 稳定，奇数 = 写者正在写；每发布一次 +2
+    std::atomic<uint32_t> seq;
+    char pad1[60];
+
+    // 参数按 32 位字逐个原子读写（relaxed），读者拷贝时不会与写者产生数据竞争
+    std::atomic<uint32_t> words[kWords];
+
+    // 最近一次发布对应的增量消息（seq 同样保护）；0 = 最近一次是整份发布，没有增量
+    std::atomic<uint32_t> wireBytes;
+    std::atomic<uint32_t> wire[kWireWords];
+};
+
+// 创建方调用一次（内存可以是刚映射的全零页）
+inline void ApoShmInit(void *mem)
+{
+    ApoShmParamsBlock *b = new (mem) ApoShmParamsBlock;
+    b->magic = APO_SHM_MAGIC;
+    b->layoutVersion = APO_SHM_LAYOUT_VERSION;
+    b->payloadBytes = static_cast<uint32_t>(sizeof(MyDspParams));
+    b->reserved = 0;
+    b->seq.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < ApoShmParamsBlock::kWords; ++i)
+        b->words[i].store(0, std::memory_order_relaxed);
+    b->wireBytes.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < ApoShmParamsBlock::kWireWords; ++i)
+        b->wire[i].store(0, std::memory_order_relaxed);
+}
+
+inline bool ApoShmValid(const ApoShmParamsBlock *b)
+{
+    return b && b->magic == APO_SHM_MAGIC && b->layoutVersion == APO_SHM_LAYOUT_VERSION &&
+           b->payloadBytes == sizeof(MyDspParams);
+}
+
+#define APO_SHM_STALE_MS 500 // 写者持有写权只够拷一千多字节；同一个奇数序号停留这么久，当作写者已经不在了
+#define APO_SHM_SPINS 64     // 先空转这么多次再开始让出 CPU
+
+// 接管停在奇数序号 odd 上的块：推到下一个偶数并清掉增量消息，所有读者都整份重拷块里现有的内容。
+// 不退回上一个偶数：已经拿到那一份的读者不会再拷，从此与块里写了一半的内容对不上。
+// 写了一半的块里每个字仍是某一次发布的值，整份参数应用前还会经过 ParamsValid。
+// 序号在这期间变过（写者其实还活着）时什么都不做，返回 false
+inline bool ApoShmBreakStale(ApoShmParamsBlock *b, uint32_t odd)
+{
+    b->wireBytes.store(0, std::memory_order_relaxed);
+    return b->seq.compare_exchange_strong(odd, odd + 1, std::memory_order_release, std::memory_order_relaxed);
+}
+
+// 等待方记住看到的奇数序号与第一次看到它的时刻
+struct ApoShmStaleWatch
+{
+    uint32_t odd = 0;
+    std::chrono::steady_clock::time_point since;
+
+    // s 为刚读到的奇数序号；同一个 s 停留超过 APO_SHM_STALE_MS 时接管，接管成功返回 true
+    bool Check(ApoShmParamsBlock *b, uint32_t s)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (s != odd)
+        {
+            odd = s;
+            since = now;
+            return false;
+        }
+        if (now - since < std::chrono::milliseconds(APO_SHM_STALE_MS))
+            return false;
+        odd = 0;
+        return ApoShmBreakStale(b, s);
+    }
+};
+
+// 等奇数序号变掉：先空转，之后每次让出 CPU 并检查写者是否已经不在了。返回新读到的序号
+inline uint32_t ApoShmWaitOdd(ApoShmParamsBlock *b, uint32_t s, uint32_t &spins, ApoShmStaleWatch &watch)
+{
+    if (++spins > APO_SHM_SPINS)
+    {
+        std::this_thread::yield();
+        watch.Check(b, s);
+    }
+    return b->seq.load(std::memory_order_relaxed);
+}
+
+// 写者之间靠 seq 的奇偶互斥：把偶数序号改成奇数即拿到写权，返回拿到时的偶数序号
+inline uint32_t ApoShmWriterLock(ApoShmParamsBlock *b)
+{
+    uint32_t s = b->seq.load(std::memory_order_relaxed);
+    uint32_t spins = 0;
+    ApoShmStaleWatch watch;
+    for (;;)
+    {
+        if (!(s & 1))
+        {
+            if (b->seq.compare_exchange_weak(s, s + 1, std::memory_order_acquire))
+                break;
+            continue; // 失败时 s 已是最新值
+        }
+        s = ApoShmWaitOdd(b, s, spins, watch);
+    }
+    std::atomic_thread_fence(std::memory_order_release); // 奇数序号先于数据可见
+    return s;
+}
+
+// 写者（控制端，非实时）：整份发布
+inline void ApoShmPublish(ApoShmParamsBlock *b, const MyDspParams &p)
+{
+    uint32_t tmp[ApoShmParamsBlock::kWords] = {};
+    memcpy(tmp, &p, sizeof(p));
+
+    const uint32_t s = ApoShmWriterLock(b);
+    for (uint32_t i = 0; i < ApoShmParamsBlock::kWords; ++i)
+        b->words[i].store(tmp[i], std::memory_order_relaxed);
+    b->wireBytes.store(0, std::memory_order_relaxed);
+    b->seq.store(s + 2, std::memory_order_release);
+}
+
+// 写者（控制端，非实时）：发布一条增量消息（一个事务）。
+// 持有写权时把消息解码到当前参数上再整份写回，同时留下消息本身；消息不合法时什么都不改
+inline ParamsWireResult ApoShmPublishWire(ApoShmParamsBlock *b, const void *msg, uint32_t bytes)
+{
+    if (bytes > PARAMS_WIRE_MAX_BYTES)
+        return kWireTruncated;
+    uint32_t tmp[ApoShmParamsBlock::kWords] = {};
+    uint32_t wire[ApoShmParamsBlock::kWireWords] = {};
+    memcpy(wire, msg, bytes);
+
+    const uint32_t s = ApoShmWriterLock(b);
+    for (uint32_t i = 0; i < ApoShmParamsBlock::kWords; ++i)
+        tmp[i] = b->words[i].load(std::memory_order_relaxed);
+    MyDspParams p;
+    memcpy(&p, tmp, sizeof(p));
+    const ParamsWireResult r = ParamsWireDecode(wire, bytes, p);
+    if (r != kWireOk)
+    {
+        b->seq.store(s, std::memory_order_release); // 放弃写权，序号不变
+        return r;
+    }
+    memcpy(tmp, &p, sizeof(p));
+    for (uint32_t i = 0; i < ApoShmParamsBlock::kWords; ++i)
+        b->words[i].store(tmp[i], std::memory_order_relaxed);
+    for (uint32_t i = 0; i < (bytes + 3) / 4; ++i)
+        b->wire[i].store(wire[i], std::memory_order_relaxed);
+    b->wireBytes.store(bytes, std::memory_order_relaxed);
+    b->seq.store(s + 2, std::memory_order_release);
+    return kWireOk;
+}
+
+// 读一份完整快照（非实时侧用，例如控制端改单个字段前先读回）；返回 false 表示还没人写过。
+// 控制端本来就是写者，遇到停在奇数序号上的块同样接管
+inline bool ApoShmRead(ApoShmParamsBlock *b, MyDspParams &out)
+{
+    uint32_t spins = 0;
+    ApoShmStaleWatch watch;
+    for (;;)
+    {
+        const uint32_t s1 = b->seq.load(std::memory_order_acquire);
+        if (s1 & 1)
+        {
+            ApoShmWaitOdd(b, s1, spins, watch);
+            continue;
+        }
+        uint32_t tmp[ApoShmParamsBlock::kWords];
+        for (uint32_t i = 0; i < ApoShmParamsBlock::kWords; ++i)
+            tmp[i] = b->words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (b->seq.load(std::memory_order_relaxed) != s1)
+            continue;
+        memcpy(&out, tmp, sizeof(out));
+        return s1 != 0;
+    }
+}
+
+// 读者（APO 的控制线程）：记住上次看到的序号
+class ApoShmReader
+{
+public:
+    // 有新的完整参数时写到 out 并返回 true；没变化、写者正在写或被打断时返回 false（下一块再试）。
+    // out 必须是上一次 Poll 成功时得到的那份参数（增量消息是相对它解码的）。
+    // 写者死在写的途中时，连续几次 Poll 看到同一个奇数序号超过 APO_SHM_STALE_MS 后接管，下一次 Poll 整份拷贝
+    bool Poll(ApoShmParamsBlock *b, MyDspParams &out)
+    {
+        const uint32_t s1 = b->seq.load(std::memory_order_acquire);
+        if (s1 == m_lastSeq) // 常态：一次比较就返回
+            return false;
+        if (s1 & 1)
+        {
+            m_stale.Check(b, s1);
+            return false;
+        }
+
+        // 只落后一次发布、且那次发布是增量：拷几十字节的消息而不是整份参数
+        if (m_lastSeq != 0 && s1 == m_lastSeq + 2)
+        {
+            const uint32_t n = b->wireBytes.load(std::memory_order_relaxed);
+            if (n != 0 && n <= PARAMS_WIRE_MAX_BYTES)
+            {
+                uint32_t wire[ApoShmParamsBlock::kWireWords];
+                for (uint32_t i = 0; i < (n + 3) / 4; ++i)
+                    wire[i] = b->wire[i].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (b->seq.load(std::memory_order_relaxed) != s1)
+                    return false;
+                if (ParamsWireDecode(wire, n, out) == kWireOk)
+                {
+                    m_lastSeq = s1;
+                    ++m_deltas;
+                    return true;
+                }
+                // 解码失败（不应发生：写者发布前已校验）时退回整份拷贝
+            }
+        }
+
+        uint32_t tmp[ApoShmParamsBlock::kWords];
+        for (uint32_t i = 0; i < ApoShmParamsBlock::kWords; ++i)
+            tmp[i] = b->words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (b->seq.load(std::memory_order_relaxed) != s1)
+            return false;
+
+        memcpy(&out, tmp, sizeof(out));
+        m_lastSeq = s1;
+        ++m_fullCopies;
+        return true;
+    }
+
+    uint32_t LastSeq() const { return m_lastSeq; }
+    uint32_t Deltas() const { return m_deltas; }         // 按增量消息更新的次数
+    uint32_t FullCopies() const { return m_fullCopies; } // 整份拷贝的次数
+
+private:
+    uint32_t m_lastSeq = 0; // 0 = 从未发布
+    uint32_t m_deltas = 0;
+    uint32_t m_fullCopies = 0;
+    ApoShmStaleWatch m_stale;
+};
@@ -2,16 +2,28 @@
 // 变更点（相对你原始版本）：
 // 1) QueryInterface 增加 IAudioSystemEffects “字面量 IID” 兜底，避免不同 SDK 头导致 IID 不一致而返回 E_NOINTERFACE。
 // 2) GetEffectsList 修正：返回“效果 GUID”（你的 APO CLSID），而不是处理模式 GUID（DEFAULT 模式由注册表 FX\0/PM7 告知）。
-// 3) 加入 DbgLog 输出，在 Initialize / LockForProcess / APOProcess 打点，调试时用 DebugView.exe 观察。
-// 4) APOProcess 做一个 20% 的线性衰减，便于立刻用耳朵验证效果链是否生效。
+// 3) 加入 DbgLog 输出，在 Initialize / LockForProcess 打点，调试时用 DebugView.exe 观察；
+//    APOProcess 不直接调 DbgLog，只往 ApoRtLog.h 的日志环写记录，由 PipeThreadMain 取出后再输出。
+// 4) APOProcess 在连接缓冲上就地跑完整 DSP 链（ApoProcessCore.h）；静音缓冲先把混响等尾音放完，之后只传递标志，不做任何运算。
+//    DSP 上下文在 LockForProcess 里按协商好的采样率/通道数创建，UnlockForProcess 时释放。
+// 5) 参数走共享内存（ApoShmCtl.h，每个端点一块）：控制端写入，PipeThreadMain 每 kCtlPollMs 比较一次序号，
+//    有变化才应用（设置函数、EQ 系数设计、处理程序编译都在这个非实时线程上）；APOProcess 只处理，不碰参数。
 
 #include "EfxApo.h"
 #include "MyApoGuids.h"      // 声明 CLSID_MyCompanyEfxApo（你工程已有的 Guids 声明/定义）
+#include "ApoProcessCore.h"  // APOProcess 的可移植核心（EfxTestHost 里也测这一份）
 #include <audioclient.h>
 #include <mmreg.h>
 #include <new>               // std::nothrow
 #include <cstring>           // memcpy
 #include <strsafe.h>         // DbgLog 安全格式化
+#include <sddl.h>            // 共享内存的安全描述符
+#include <mmdeviceapi.h>     // IMMDevice（取端点 ID）
+
+// ApoProcessCore.h 里的缓冲标志必须和 SDK 的取值一致
+static_assert(ApoCore::kBufferInvalid == BUFFER_INVALID, "APO_BUFFER_FLAGS mismatch");
+static_assert(ApoCore::kBufferValid == BUFFER_VALID, "APO_BUFFER_FLAGS mismatch");
+static_assert(ApoCore::kBufferSilent == BUFFER_SILENT, "APO_BUFFER_FLAGS mismatch");
 
 // 旧接口 IID 的字面量常量（防止不同 SDK 头导致 __uuidof(IAudioSystemEffects) 的 GUID 不一致）
 static const GUID IID_IAudioSystemEffects_Legacy =
@@ -27,6 +39,9 @@ DEFINE_GUID(AUDIO_SIGNALPROCESSINGMODE_DEFAULT,
             0xC18E2F7E, 0x933D, 0x4965, 0xB7, 0xD1, 0x1E, 0xEF, 0x22, 0x8D, 0x2A, 0xF3);
 #endif
 
+// 控制线程轮询共享内存的间隔（ms）：序号没变时只是一次比较
+static const DWORD kCtlPollMs = 10;
+
 // ======= 简单日志辅助（用 DebugView.exe 观察 OutputDebugString） =======
 static void DbgLog(const wchar_t* fmt, ...)
 {
@@ -38,6 +53,25 @@ static void DbgLog(const wchar_t* fmt, ...)
     OutputDebugStringW(L"\n");
 }
 
+// 端点 ID：APOInitSystemEffects(2) 里 pDeviceCollection 的最后一项就是本 APO 所在的端点
+static bool GetEndpointId(UINT32 cbDataSize, const BYTE *pbyData, wchar_t *out, size_t cch)
+{
+    if (!pbyData || cbDataSize < sizeof(APOInitSystemEffects)) return false;
+    const auto init = reinterpret_cast<const APOInitSystemEffects *>(pbyData);
+    if (init->APOInit.cbSize < sizeof(APOInitSystemEffects) || !init->pDeviceCollection) return false;
+    UINT n = 0;
+    if (FAILED(init->pDeviceCollection->GetCount(&n)) || !n) return false;
+    IMMDevice *dev = nullptr;
+    if (FAILED(init->pDeviceCollection->Item(n - 1, &dev))) return false;
+    LPWSTR id = nullptr;
+    const HRESULT hr = dev->GetId(&id);
+    dev->Release();
+    if (FAILED(hr) || !id) return false;
+    const bool ok = SUCCEEDED(StringCchCopyW(out, cch, id));
+    CoTaskMemFree(id);
+    return ok;
+}
+
 // ====== 构造 / 析构 ======
 CMyCompanyEfxApo::CMyCompanyEfxApo() {}
 CMyCompanyEfxApo::~CMyCompanyEfxApo()
@@ -50,7 +84,8 @@ CMyCompanyEfxApo::~CMyCompanyEfxApo()
         m_hPipeThread = nullptr;
     }
     if (m_hStopEvt) { CloseHandle(m_hStopEvt); m_hStopEvt = nullptr; }
-    // TODO: if (m_dspCtx) { /* dsp_destroy(m_dspCtx); */ m_dspCtx = nullptr; }
+    CloseSharedParams();
+    if (m_dspCtx) { dsp_destroy_context(m_dspCtx); m_dspCtx = nullptr; }
 }
 
 // ====================== IUnknown ======================
@@ -95,17 +130,20 @@ ULONG STDMETHODCALLTYPE CMyCompanyEfxApo::Release()
 STDMETHODIMP CMyCompanyEfxApo::Initialize(UINT32 cbDataSize, BYTE *pbyData)
 {
     // 你的 SDK 是旧签名：Initialize(cbDataSize, pbyData)
-    UNREFERENCED_PARAMETER(cbDataSize);
-    UNREFERENCED_PARAMETER(pbyData);
+    // pbyData 是 APOInitSystemEffects(2)：只从中取端点 ID，用来给共享内存命名
+    wchar_t endpointId[APO_SHM_NAME_CCH] = {};
+    if (!GetEndpointId(cbDataSize, pbyData, endpointId, _countof(endpointId)))
+        endpointId[0] = 0;
 
-    // TODO: 若使用 APOINIT_SYSTEMEFFECTS 等，这里解析 pbyData
     m_sr = 48000;
     m_ch = 2;
 
-    // m_dspCtx = dsp_create_context(m_sr, m_ch);
+    // DSP 上下文在 LockForProcess 里创建（那时才知道真实的采样率/通道数）
 
     ZeroMemory(&m_paramsActive, sizeof(m_paramsActive));
     ZeroMemory(&m_paramsPending, sizeof(m_paramsPending));
+    m_paramsValid = false;
+    OpenSharedParams(endpointId);
 
     m_hStopEvt    = CreateEventW(nullptr, TRUE, FALSE, nullptr);
     m_hPipeThread = CreateThread(nullptr, 0, &CMyCompanyEfxApo::PipeThreadMain, this, 0, nullptr);
@@ -131,18 +169,42 @@ STDMETHODIMP CMyCompanyEfxApo::LockForProcess(
     }
     UNREFERENCED_PARAMETER(inCount);
     UNREFERENCED_PARAMETER(inDesc);
-    return S_OK;
+
+    // 非实时线程：按协商格式一次性分配好 DSP 的全部内存，APOProcess 里不再分配
+    AcquireSRWLockExclusive(&m_ctlLock);
+    if (m_dspCtx) { dsp_destroy_context(m_dspCtx); m_dspCtx = nullptr; }
+    m_dspCtx = dsp_create_context(m_sr, m_ch);
+    if (m_dspCtx && m_paramsValid) ApplyParams_NoLock(m_paramsActive, nullptr);   // 新上下文沿用控制端最后一次下发的参数（整份写入）
+    UpdateLatency_NoLock();
+    const bool ok = m_dspCtx != nullptr;
+    ReleaseSRWLockExclusive(&m_ctlLock);
+    return ok ? S_OK : E_OUTOFMEMORY;
 }
 
-STDMETHODIMP CMyCompanyEfxApo::UnlockForProcess() { return S_OK; }
+STDMETHODIMP CMyCompanyEfxApo::UnlockForProcess()
+{
+    AcquireSRWLockExclusive(&m_ctlLock);
+    if (m_dspCtx) { dsp_destroy_context(m_dspCtx); m_dspCtx = nullptr; }
+    UpdateLatency_NoLock();
+    ReleaseSRWLockExclusive(&m_ctlLock);
+    return S_OK;
+}
 
 STDMETHODIMP CMyCompanyEfxApo::GetLatency(_Out_ HNSTIME *pLatency)
 {
     if (!pLatency) return E_POINTER;
-    *pLatency = 0; // 最小实现：报告 0；实际可按滤波器组延迟换算
+    // 只有前瞻限幅器引入延迟；HNSTIME 以 100ns 为单位。只读缓存值，不碰 DSP 上下文（可能正被重建/释放）
+    const UINT32 frames = m_latencyFrames.load(std::memory_order_relaxed);
+    *pLatency = m_sr ? (HNSTIME)((UINT64)frames * 10000000ull / m_sr) : 0;
+    return S_OK;
+}
+STDMETHODIMP CMyCompanyEfxApo::Reset()
+{
+    AcquireSRWLockExclusive(&m_ctlLock);
+    if (m_dspCtx) dsp_reset(m_dspCtx);   // 清掉滤波器/混响的历史状态
+    ReleaseSRWLockExclusive(&m_ctlLock);
     return S_OK;
 }
-STDMETHODIMP CMyCompanyEfxApo::Reset() { return S_OK; }
 
 STDMETHODIMP CMyCompanyEfxApo::GetRegistrationProperties(
     _Outptr_result_maybenull_ APO_REG_PROPERTIES **ppRegProps)
@@ -189,28 +251,23 @@ CMyCompanyEfxApo::APOProcess(
     UINT32 inC,  _Inout_updates_(inC)  APO_CONNECTION_PROPERTY **inP,
     UINT32 outC, _Inout_updates_(outC) APO_CONNECTION_PROPERTY **outP)
 {
-    // 最小可听效果：把输出整体衰减到 20%（约 -14 dB），便于“耳朵验证”
-    if (!outC || !outP || !outP[0] || !outP[0]->pBuffer) return;
+    if (!inC || !inP || !inP[0] || !outC || !outP || !outP[0]) return;
 
+    // 参数由 PipeThreadMain 应用并发布，这里不拿锁、不调设置函数：DSP 每块开头取一次最新快照
+    // 假定混音格式为 float32 interleaved（WASAPI 引擎内部常见）；
+    // EFX 通常 in/out 是同一块缓冲，直接原地处理；静音缓冲放完尾音后只传递 BUFFER_SILENT
+    const bool ran = ApoCore::Process(m_dspCtx, m_ch, inP[0], outP[0]);
     const UINT32 frames = outP[0]->u32ValidFrameCount;
-    if (frames == 0 || m_ch == 0) return;
-
-    // 假定混音格式为 float32 interleaved（WASAPI 引擎内部常见）
-    float* out = reinterpret_cast<float*>(outP[0]->pBuffer);
-    const float kGain = 0.2f;
-    const size_t samples = static_cast<size_t>(frames) * static_cast<size_t>(m_ch);
-    for (size_t i = 0; i < samples; ++i) out[i] *= kGain;
-
-    // 节流日志：每秒一条，避免刷屏
-    static DWORD s_lastTick = 0;
-    DWORD now = GetTickCount();
-    if (now - s_lastTick > 1000) {
-        s_lastTick = now;
-        DbgLog(L"[MyAPO] APOProcess tick: frames=%u ch=%u", frames, m_ch);
-    }
 
-    UNREFERENCED_PARAMETER(inC);
-    UNREFERENCED_PARAMETER(inP);
+    // 节流日志：按本实例处理过的音频时长每秒记一条（不读系统时间、不格式化、不进内核）
+    if (ran) ++m_rtBlocks; else ++m_rtSilent;
+    m_rtFrames += frames;
+    if (m_rtFrames >= m_sr) {
+        m_rtLog.Push(kRtEvtTick, m_rtBlocks, frames, m_ch);
+        if (m_rtSilent) m_rtLog.Push(kRtEvtSilent, m_rtSilent);
+        if (!m_dspCtx)  m_rtLog.Push(kRtEvtNoCtx);
+        m_rtFrames = m_rtBlocks = m_rtSilent = 0;
+    }
 }
 
 STDMETHODIMP_(UINT32)
@@ -260,11 +317,143 @@ STDMETHODIMP CMyCompanyEfxApo::Commit() { return S_OK; }
 DWORD WINAPI CMyCompanyEfxApo::PipeThreadMain(LPVOID self)
 {
     auto p = static_cast<CMyCompanyEfxApo *>(self);
-    // TODO: 命名管道/共享内存等接收配置更新；收到后更新 m_paramsPending 并递增 m_paramsSeq
-    if (p && p->m_hStopEvt) WaitForSingleObject(p->m_hStopEvt, INFINITE);
+    if (!p || !p->m_hStopEvt) return 0;
+    // 控制面线程：每 kCtlPollMs 醒一次，比较共享内存序号（有变化才应用参数），
+    // 再把实时线程写下的日志取出来格式化输出
+    while (WaitForSingleObject(p->m_hStopEvt, kCtlPollMs) == WAIT_TIMEOUT)
+    {
+        p->PollSharedParams();
+        p->DrainRtLog();
+    }
+    p->DrainRtLog();
     return 0;
 }
-void CMyCompanyEfxApo::ApplyParams_NoLock(const MyDspParams & /*prm*/)
+
+// 非实时线程（PipeThreadMain）：序号没变时一次比较就过去；变了才拷出参数，与上一份比较后只应用改动的部分。
+// 还没有 DSP 上下文时只记下参数，LockForProcess 建好上下文后整份应用
+void CMyCompanyEfxApo::PollSharedParams()
+{
+    if (!m_shm) return;
+    AcquireSRWLockExclusive(&m_ctlLock);
+    UINT32 changed = 0;
+    const bool got = m_shmReader.Poll(m_shm, m_paramsPending);
+    if (got && !ParamsValid(m_paramsPending)) {
+        // 有 NaN/Inf：DSP 与 m_paramsActive 保持上一份（还没有上下文时也不能留给 LockForProcess）。
+        // m_paramsPending 不回退：它要与共享内存块一致，下一条增量消息相对它解码
+        ++m_applyCounters.rejects;
+        changed = kParamsRejected;
+    } else if (got) {
+        changed = ApplyParams_NoLock(m_paramsPending, m_paramsValid ? &m_paramsActive : nullptr);
+        m_paramsActive = m_paramsPending;
+        m_paramsValid = true;
+        UpdateLatency_NoLock();
+    }
+    const UINT32 seq = m_shmReader.LastSeq();
+    const UINT32 redesigns = m_applyCounters.eqRedesigns;
+    const UINT32 rejects = m_applyCounters.rejects;
+    ReleaseSRWLockExclusive(&m_ctlLock);
+    if (got)
+        DbgLog(L"[MyAPO] params seq=%u changed=0x%x eqRedesigns(total)=%u rejects(total)=%u", seq, changed, redesigns,
+               rejects);
+}
+
+// 调用方持 m_ctlLock：延迟只随限幅器参数变，应用参数/重建上下文之后刷新一次
+void CMyCompanyEfxApo::UpdateLatency_NoLock()
+{
+    m_latencyFrames.store(m_dspCtx ? dsp_get_latency_frames(m_dspCtx) : 0, std::memory_order_relaxed);
+}
+
+// 非实时线程：取出实时日志并格式化（DbgLog 只在这里调用）
+void CMyCompanyEfxApo::DrainRtLog()
+{
+    bool tick = false;
+    m_rtLog.Drain([&tick](const ApoRtRecord &r) {
+        switch (r.id) {
+        case kRtEvtTick:   DbgLog(L"[MyAPO] APOProcess tick: blocks=%u frames=%u ch=%u", r.a, r.b, r.c); tick = true; break;
+        case kRtEvtSilent: DbgLog(L"[MyAPO] APOProcess silent blocks=%u", r.a); break;
+        case kRtEvtNoCtx:  DbgLog(L"[MyAPO] APOProcess without DSP context"); break;
+        default:           DbgLog(L"[MyAPO] rt event %u (%u, %u, %u)", r.id, r.a, r.b, r.c); break;
+        }
+    });
+    const UINT32 dropped = m_rtLog.Dropped();
+    if (dropped != m_rtLogDroppedSeen) {
+        DbgLog(L"[MyAPO] rt log dropped=%u (+%u)", dropped, dropped - m_rtLogDroppedSeen);
+        m_rtLogDroppedSeen = dropped;
+    }
+    if (tick) LogDspStats();
+}
+
+// 非实时线程：跟着每秒一条的 tick 输出 DSP 自己累计的统计（块耗时分位数、各级每子块平均耗时），然后清零，
+// 每条都是上一秒的数。统计没编译进来（DSP_ENABLE_STATS=0）时 dsp_get_stats 返回 0，什么都不输出
+void CMyCompanyEfxApo::LogDspStats()
+{
+    DSP_STATS st;
+    AcquireSRWLockExclusive(&m_ctlLock);   // 上下文可能正被 LockForProcess/UnlockForProcess 重建
+    const int have = m_dspCtx && dsp_get_stats(m_dspCtx, &st);
+    if (have) dsp_reset_stats(m_dspCtx);   // 实时线程在下一块开头清零
+    ReleaseSRWLockExclusive(&m_ctlLock);
+    if (!have || !st.blocks) return;
+
+    const double us = 1e6 / st.ticks_per_second;
+    auto avg = [us](const DSP_STAGE_STATS &s) { return s.calls ? (double)s.ticks * us / (double)s.calls : 0.0; };
+    DbgLog(L"[MyAPO] dsp stats: blocks=%llu avg=%.1fus p99=%.1fus p99.9=%.1fus max=%.1fus bypass=%llu idle=%llu",
+           st.blocks, st.block_avg_us, st.block_p99_us, st.block_p999_us, (double)st.block_max_ticks * us,
+           st.bypass_blocks, st.idle_blocks);
+    DbgLog(L"[MyAPO] dsp stage us/subblock: gain=%.2f eq=%.2f reverb=%.2f conv=%.2f limiter=%.2f tailWaits=%llu",
+           avg(st.stage[DSP_STAGE_GAIN]), avg(st.stage[DSP_STAGE_EQ]), avg(st.stage[DSP_STAGE_REVERB]),
+           avg(st.stage[DSP_STAGE_CONV]), avg(st.stage[DSP_STAGE_LIMITER]), st.reverb_tail_waits);
+}
+// 把一份 MyDspParams 应用到 DSP（调用方持 m_ctlLock：PipeThreadMain 或 LockForProcess，DSP 参数只有这一个写者）
+// prev 为上一次应用的参数：只重设改动的字段；nullptr 表示整份写入。返回改动位掩码（kParamsChanged*）
+UINT32 CMyCompanyEfxApo::ApplyParams_NoLock(const MyDspParams &prm, const MyDspParams *prev)
+{
+    if (!m_dspCtx) return 0;
+    return ParamsApply(m_dspCtx, prev, prm, &m_applyCounters);
+}
+
+// 创建（或打开已有的）按端点命名的共享内存；失败只记日志，APO 照常工作（只是收不到参数）
+void CMyCompanyEfxApo::OpenSharedParams(const wchar_t *endpointId)
+{
+    if (m_shm) return;
+    wchar_t name[APO_SHM_NAME_CCH];
+    if (!ApoShmMakeName(endpointId, name, _countof(name))) {
+        DbgLog(L"[MyAPO] no endpoint id, shared params disabled");
+        return;
+    }
+    // SYSTEM / LocalService（audiodg）完全控制，交互用户可读写
+    PSECURITY_DESCRIPTOR sd = nullptr;
+    SECURITY_ATTRIBUTES sa = { sizeof(sa), nullptr, FALSE };
+    if (ConvertStringSecurityDescriptorToSecurityDescriptorW(
+            L"D:(A;;GA;;;SY)(A;;GA;;;LS)(A;;GRGW;;;IU)", SDDL_REVISION_1, &sd, nullptr))
+        sa.lpSecurityDescriptor = sd;
+
+    m_hShm = CreateFileMappingW(INVALID_HANDLE_VALUE, sd ? &sa : nullptr, PAGE_READWRITE,
+                                0, (DWORD)sizeof(ApoShmParamsBlock), name);
+    const DWORD err = GetLastError();
+    if (sd) LocalFree(sd);
+    if (!m_hShm) {
+        DbgLog(L"[MyAPO] CreateFileMapping failed: %u", err);
+        return;
+    }
+    void *view = MapViewOfFile(m_hShm, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(ApoShmParamsBlock));
+    if (!view) {
+        DbgLog(L"[MyAPO] MapViewOfFile failed: %u", GetLastError());
+        CloseHandle(m_hShm); m_hShm = nullptr;
+        return;
+    }
+    // 同一端点的第二个实例会打开已有对象，不能再清零
+    if (err != ERROR_ALREADY_EXISTS) ApoShmInit(view);
+    m_shm = static_cast<ApoShmParamsBlock *>(view);
+    if (!ApoShmValid(m_shm)) {
+        DbgLog(L"[MyAPO] shared params layout mismatch");
+        CloseSharedParams();
+        return;
+    }
+    DbgLog(L"[MyAPO] shared params ready: %s (%u bytes)", name, (UINT)sizeof(ApoShmParamsBlock));
+}
+
+void CMyCompanyEfxApo::CloseSharedParams()
 {
-    // TODO: 把 pending 参数应用到 DSP；这里留空
+    if (m_shm) { UnmapViewOfFile(m_shm); m_shm = nullptr; }
+    if (m_hShm) { CloseHandle(m_hShm); m_hShm = nullptr; }
 }
@@ -19,6 +19,9 @@
 #include "MyApoGuids.h"
 #include "MyApoParams.h"
 #include "dsp_wrapper.h"
+#include "ApoRtLog.h"   // 实时线程日志环
+#include "ApoShmCtl.h"  // 共享内存控制面
+#include "ParamsApply.h" // 参数增量应用
 
 #include <atomic> // 用到 std::atomic
 
@@ -104,5 +107,30 @@ private:
     HANDLE m_hPipeThread = nullptr;
     HANDLE m_hStopEvt = nullptr;
     static DWORD WINAPI PipeThreadMain(LPVOID self);
-    void ApplyParams_NoLock(const MyDspParams &p);
+    UINT32 ApplyParams_NoLock(const MyDspParams &p, const MyDspParams *prev);
+    ParamsApplyCounters m_applyCounters{}; // PipeThreadMain / LockForProcess 里累加（都持 m_ctlLock）
+
+    // 控制面：PipeThreadMain 应用参数，LockForProcess/UnlockForProcess/Reset 建删/复位 DSP 上下文，都持这把锁；
+    // APOProcess 不拿锁，只处理（DSP 内部每块取一次已发布的快照）
+    SRWLOCK m_ctlLock = SRWLOCK_INIT;
+    std::atomic<UINT32> m_latencyFrames{0}; // GetLatency 只读这个：LockForProcess 与每次应用参数后更新
+    void UpdateLatency_NoLock();
+
+    // 实时线程日志：APOProcess 只往环里写定长记录，PipeThreadMain 负责格式化输出
+    ApoRtLogRing<256> m_rtLog;
+    UINT32 m_rtFrames = 0;      // 以下三个仅实时线程读写：距上次 tick 的帧数/块数/静音块数
+    UINT32 m_rtBlocks = 0;
+    UINT32 m_rtSilent = 0;
+    UINT32 m_rtLogDroppedSeen = 0; // 仅 PipeThreadMain 使用
+    void DrainRtLog();
+    void LogDspStats();            // DrainRtLog 看到 tick 时调用：输出并清零 DSP 运行统计
+
+    // 共享内存控制面：Initialize 里按端点 ID 创建/映射，PipeThreadMain 定时比较一次序号
+    HANDLE m_hShm = nullptr;
+    ApoShmParamsBlock *m_shm = nullptr;
+    ApoShmReader m_shmReader;      // 以下两个只在持 m_ctlLock 时读写
+    bool m_paramsValid = false;    // m_paramsActive 是否来自控制端（重建 DSP 上下文时要重新应用）
+    void OpenSharedParams(const wchar_t *endpointId);
+    void CloseSharedParams();
+    void PollSharedParams();
 };
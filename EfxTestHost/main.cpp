@@ -10,9 +10,19 @@
 #include <iostream>
 #include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <cwchar>
+#include <thread>
+#include <atomic>
 
 #include "dsp_wrapper.h" // 你刚换好的“增益+3段EQ+混响+限幅”版本
 #include "wav_writer.h"  // 前面我给你的 32-bit float WAV 写入器
+#include "ApoProcessCore.h" // APOProcess 的可移植核心
+#include "ApoRtLog.h"       // 实时线程日志环
+#include "ApoShmCtl.h"      // 共享内存控制面（seqlock）
+#include "ParamsApply.h"    // MyDspParams 增量应用
+#include "ParamsWire.h"     // 参数线格式（增量/批量/CRC）
+#include "dsp_fastmath.h"   // 快速数学函数（精度/吞吐对比）
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -126,6 +136,51 @@ static void print_timing(const char *name, const Timing &t, uint32_t blockFrames
               << " | max=" << t.max_us << " us\n";
 }
 
+// 自动校验：失败计数决定进程退出码
+static int g_failures = 0;
+static void check(bool ok, const char *what)
+{
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!ok)
+        g_failures++;
+}
+
+static const char *simd_name(DSP_SIMD_LEVEL l)
+{
+    switch (l)
+    {
+    case DSP_SIMD_SSE2: return "sse2";
+    case DSP_SIMD_AVX2: return "avx2";
+    case DSP_SIMD_NEON: return "neon";
+    default:            return "scalar";
+    }
+}
+
+// 3 段 EQ 全开的上下文（SIMD 对比用）
+static void *make_eq_ctx(uint32_t sampleRate, uint16_t channels)
+{
+    void *ctx = dsp_create_context(sampleRate, channels);
+    dsp_set_gain(ctx, 0.8f);
+    dsp_set_eq_enabled(ctx, 0, 1);
+    dsp_set_eq_params(ctx, 0, 120.f, 0.707f, +6.f);
+    dsp_set_eq_enabled(ctx, 1, 1);
+    dsp_set_eq_params(ctx, 1, 1200.f, 1.2f, -6.f);
+    dsp_set_eq_enabled(ctx, 2, 1);
+    dsp_set_eq_params(ctx, 2, 8000.f, 0.707f, +6.f);
+    dsp_set_reverb_enabled(ctx, 0);
+    dsp_set_limiter_enabled(ctx, 0);
+    return ctx;
+}
+
+// 与 APO_CONNECTION_PROPERTY 字段同名的假结构（测试 ApoProcessCore.h 用）
+struct FakeConnProp
+{
+    uintptr_t pBuffer;
+    uint32_t u32ValidFrameCount;
+    uint32_t u32BufferFlags;
+    uint32_t u32Signature;
+};
+
 int main()
 {
     // ---- 全局基础：Win11 典型音频流格式 ----
@@ -334,6 +389,3217 @@ int main()
         print_timing("sr44100", tim, BLOCK_10MS_441);
     }
 
+    // -------------------------
+    // 用例 I：SIMD biquad 内核 vs 标量回退
+    // 目标：各指令集输出与标量逐位一致；对比 2/8 声道下的耗时
+    // -------------------------
+    {
+        const uint16_t chList[] = {2, 8};
+        for (uint16_t chN : chList)
+        {
+            std::vector<float> in;
+            gen_log_sweep(in, SR48k, chN, 2.0f, 50.0f, 18000.0f, 0.5f);
+            const uint32_t nFrames = static_cast<uint32_t>(in.size() / chN);
+
+            std::vector<float> ref(in.size());
+            void *ctx = make_eq_ctx(SR48k, chN);
+            dsp_set_simd_level(ctx, DSP_SIMD_SCALAR);
+            process_blocked(ctx, in.data(), ref.data(), nFrames, SR48k, chN, BLOCK_10MS, false, tim);
+            dsp_destroy_context(ctx);
+            std::string name = "eq_scalar_" + std::to_string(chN) + "ch";
+            print_timing(name.c_str(), tim, BLOCK_10MS);
+
+            const DSP_SIMD_LEVEL levels[] = {DSP_SIMD_SSE2, DSP_SIMD_AVX2, DSP_SIMD_NEON};
+            for (DSP_SIMD_LEVEL lv : levels)
+            {
+                std::vector<float> out(in.size());
+                ctx = make_eq_ctx(SR48k, chN);
+                if (!dsp_set_simd_level(ctx, lv))
+                {
+                    dsp_destroy_context(ctx);
+                    continue; // 本机不支持
+                }
+                process_blocked(ctx, in.data(), out.data(), nFrames, SR48k, chN, BLOCK_10MS, false, tim);
+                dsp_destroy_context(ctx);
+                name = std::string("eq_") + simd_name(lv) + "_" + std::to_string(chN) + "ch";
+                print_timing(name.c_str(), tim, BLOCK_10MS);
+                name += " bit-exact vs scalar";
+                check(std::equal(out.begin(), out.end(), ref.begin(),
+                                 [](float a, float b) { return std::memcmp(&a, &b, sizeof(float)) == 0; }),
+                      name.c_str());
+            }
+        }
+    }
+
+    // -------------------------
+    // 用例 J：12 段 EQ
+    // 目标：3..11 段与前 3 段同参数时输出一致；12 段里只开 4 段的开销 ≈ 4 段
+    // -------------------------
+    {
+        std::vector<float> in;
+        gen_log_sweep(in, SR48k, CH_ST, 2.0f, 50.0f, 18000.0f, 0.5f);
+        const uint32_t nFrames = static_cast<uint32_t>(in.size() / CH_ST);
+
+        // J1：第 9 段设成高搁架，应与第 2 段（默认高搁架）逐位一致
+        std::vector<float> outA(in.size()), outB(in.size());
+        void *a = dsp_create_context(SR48k, CH_ST);
+        dsp_set_limiter_enabled(a, 0);
+        dsp_set_eq_enabled(a, 2, 1);
+        dsp_set_eq_params(a, 2, 8000.f, 0.707f, +6.f);
+        void *b = dsp_create_context(SR48k, CH_ST);
+        dsp_set_limiter_enabled(b, 0);
+        dsp_set_eq_enabled(b, 9, 1);
+        dsp_set_eq_params_ex(b, 9, 8000.f, 0.707f, +6.f, DSP_EQ_HIGHSHELF);
+        process_blocked(a, in.data(), outA.data(), nFrames, SR48k, CH_ST, BLOCK_10MS, false, tim);
+        process_blocked(b, in.data(), outB.data(), nFrames, SR48k, CH_ST, BLOCK_10MS, false, tim);
+        dsp_destroy_context(a);
+        dsp_destroy_context(b);
+        check(outA == outB, "eq band 9 highshelf == band 2 highshelf");
+
+        // J2：12 段预设，分别全开 / 只开 4 段
+        const float freqs[MY_EQ_BANDS] = {60, 120, 250, 400, 630, 1000, 1600, 2500, 4000, 6300, 10000, 14000};
+        const int onCounts[] = {MY_EQ_BANDS, 4};
+        for (int on : onCounts)
+        {
+            std::vector<float> out(in.size());
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_limiter_enabled(ctx, 0);
+            for (int band = 0; band < MY_EQ_BANDS; ++band)
+            {
+                const DSP_EQ_TYPE type = band == 0 ? DSP_EQ_LOWSHELF
+                                       : band == MY_EQ_BANDS - 1 ? DSP_EQ_HIGHSHELF : DSP_EQ_PEAK;
+                dsp_set_eq_params_ex(ctx, band, freqs[band], 1.0f, (band & 1) ? -3.f : +3.f, type);
+                dsp_set_eq_enabled(ctx, band, band < on ? 1 : 0);
+            }
+            process_blocked(ctx, in.data(), out.data(), nFrames, SR48k, CH_ST, BLOCK_10MS, false, tim);
+            dsp_destroy_context(ctx);
+            std::string name = "eq12_" + std::to_string(on) + "on";
+            print_timing(name.c_str(), tim, BLOCK_10MS);
+        }
+    }
+
+    // -------------------------
+    // 用例 K：分级流水线与块大小无关
+    // 目标：全链路（增益+EQ+混响+限幅）在不同块大小（含 >DSP_SUBBLOCK 与 1 帧）下逐位一致
+    // -------------------------
+    {
+        std::vector<float> in;
+        gen_log_sweep(in, SR48k, CH_ST, 1.0f, 50.0f, 18000.0f, 0.5f);
+        const uint32_t nFrames = static_cast<uint32_t>(in.size() / CH_ST);
+        const uint32_t blockList[] = {480, 441, 1000, 1};
+        std::vector<float> ref;
+        for (uint32_t blk : blockList)
+        {
+            std::vector<float> out(in.size());
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_gain(ctx, 1.2f);
+            dsp_set_eq_enabled(ctx, 0, 1);
+            dsp_set_eq_params(ctx, 0, 120.f, 0.707f, +6.f);
+            dsp_set_eq_enabled(ctx, 1, 1);
+            dsp_set_eq_params(ctx, 1, 1200.f, 1.2f, -6.f);
+            dsp_set_reverb_enabled(ctx, 1);
+            dsp_set_reverb_params(ctx, 0.25f, 0.7f, 0.3f, 20.f);
+            dsp_set_limiter_enabled(ctx, 1);
+            process_blocked(ctx, in.data(), out.data(), nFrames, SR48k, CH_ST, blk, false, tim);
+            dsp_destroy_context(ctx);
+            std::string name = "chain_block" + std::to_string(blk);
+            print_timing(name.c_str(), tim, blk);
+            if (ref.empty())
+                ref = out;
+            else
+                check(out == ref, (name + " == chain_block480").c_str());
+        }
+    }
+
+    // -------------------------
+    // 用例 L：参数快照并发压力（另一线程狂调设置函数，同时持续处理）
+    // 目标：实时线程每块只取一次完整快照——
+    //   1) 增益在块内恒定且只可能是发布过的值（看不到半新半旧）；
+    //   2) EQ 系数频繁改写时输出不超过参数范围内的最大稳态增益（系数撕裂/发散会远远超出）；
+    //   3) 停止改写后，最终参数与“直接设置同样参数的新实例”逐位一致。
+    // -------------------------
+    {
+        const uint32_t blk = 480;
+        const int nBlocks = 4000;
+        std::vector<float> ones(blk * CH_ST, 1.0f), out(blk * CH_ST);
+
+        // 1) 增益：输入恒为 1，关掉 EQ/限幅/平滑后输出就是本块用到的增益
+        {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_limiter_enabled(ctx, 0);
+            dsp_set_smoothing_ms(ctx, 0.0f); // 平滑会让增益在块内过渡，这里只看快照的原子性
+            std::atomic<bool> stop(false);
+            std::thread writer([&]() {
+                unsigned i = 0;
+                while (!stop.load(std::memory_order_relaxed))
+                    dsp_set_gain(ctx, (i++ & 1) ? 2.0f : 0.5f);
+            });
+            bool blockConst = true, valueOk = true;
+            for (int b = 0; b < nBlocks; ++b)
+            {
+                dsp_process_block(ctx, ones.data(), out.data(), blk, CH_ST);
+                const float g = out[0];
+                if (g != 0.5f && g != 2.0f && g != 1.0f)
+                    valueOk = false;
+                for (float v : out)
+                    if (v != g)
+                        blockConst = false;
+            }
+            stop = true;
+            writer.join();
+            dsp_destroy_context(ctx);
+            check(blockConst, "stress gain constant within each block");
+            check(valueOk, "stress gain only takes published values");
+        }
+
+        // 2)+3) EQ：两个线程同时改同一组段（设置函数之间也要互斥），处理线程看输出
+        {
+            std::vector<float> in;
+            gen_log_sweep(in, SR48k, CH_ST, 1.0f, 50.0f, 18000.0f, 0.5f);
+            const uint32_t nFrames = static_cast<uint32_t>(in.size() / CH_ST);
+
+            // 只改前 kHammerBands 段（其余段保持关闭），增益 ±kHammerDb；搁架的 Q 不超过 0.7（再大会在转折处过冲）。
+            // 这样每段幅频响应都在 [1/Gmax, Gmax] 内（Gmax = 10^(2·kHammerDb/20)，本仓库的 A 取 10^(dB/20)），
+            // 整条链的稳态增益不超过 总增益 × Gmax^kHammerBands
+            const int kHammerBands = 4;
+            const int kHammerDb = 6;
+            void *ctx = make_eq_ctx(SR48k, CH_ST);
+            std::atomic<bool> stop(false);
+            auto hammer = [&](unsigned seed) {
+                unsigned i = seed;
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    const int band = static_cast<int>(i % kHammerBands);
+                    const DSP_EQ_TYPE type = static_cast<DSP_EQ_TYPE>(i % 3u);
+                    const float q = type == DSP_EQ_PEAK ? 0.3f + static_cast<float>(i % 70u) * 0.1f
+                                                        : 0.3f + static_cast<float>(i % 5u) * 0.1f;
+                    dsp_set_eq_enabled(ctx, band, (i >> 3) & 1);
+                    dsp_set_eq_params_ex(ctx, band, 30.f + static_cast<float>((i * 7919u) % 18000u), q,
+                                         static_cast<float>(static_cast<int>(i % (2u * kHammerDb + 1u)) - kHammerDb),
+                                         type);
+                    ++i;
+                }
+            };
+            std::thread w1(hammer, 0u), w2(hammer, 12345u);
+            bool finite = true;
+            float peak = 0.f;
+            for (int b = 0; b < nBlocks; ++b)
+            {
+                const uint32_t off = (static_cast<uint32_t>(b) * blk) % (nFrames - blk);
+                dsp_process_block(ctx, in.data() + static_cast<size_t>(off) * CH_ST, out.data(), blk, CH_ST);
+                for (float v : out)
+                {
+                    if (!std::isfinite(v))
+                        finite = false;
+                    peak = std::max(peak, std::fabs(v));
+                }
+            }
+            stop = true;
+            w1.join();
+            w2.join();
+            float inPeak = 0.f;
+            for (float v : in)
+                inPeak = std::max(inPeak, std::fabs(v));
+            // 改系数那一刻的暂态会略超稳态响应，留 2 倍余量；撕裂的系数组/发散会超出几个数量级
+            const float bound = 2.f * 0.8f * inPeak *
+                                std::pow(std::pow(10.f, 2.f * kHammerDb / 20.f), static_cast<float>(kHammerBands));
+            check(finite, "stress eq output finite");
+            check(peak <= bound, "stress eq peak within max EQ gain of the hammered range");
+            std::cout << "[INFO] stress eq peak=" << peak << " bound=" << bound << "\n";
+
+            // 收尾：两边设同一组最终参数，复位状态后逐位比较
+            void *ref = make_eq_ctx(SR48k, CH_ST);
+            for (int b = 0; b < MY_EQ_BANDS; ++b)
+            {
+                const int on = (b % 3) == 0;
+                dsp_set_eq_enabled(ctx, b, on);
+                dsp_set_eq_enabled(ref, b, on);
+                dsp_set_eq_params_ex(ctx, b, 100.f * (b + 1), 1.0f, 3.0f, DSP_EQ_PEAK);
+                dsp_set_eq_params_ex(ref, b, 100.f * (b + 1), 1.0f, 3.0f, DSP_EQ_PEAK);
+            }
+            dsp_reset(ctx);
+            dsp_reset(ref);
+            std::vector<float> o1(in.size()), o2(in.size());
+            process_blocked(ctx, in.data(), o1.data(), nFrames, SR48k, CH_ST, blk, false, tim);
+            process_blocked(ref, in.data(), o2.data(), nFrames, SR48k, CH_ST, blk, false, tim);
+            check(o1 == o2, "stress eq final snapshot == fresh context");
+            dsp_destroy_context(ref);
+            dsp_destroy_context(ctx);
+        }
+    }
+
+    // -------------------------
+    // 用例 M：混响延迟线预分配（改参数/复位不再重新分配）
+    // 目标：1) 先设参数后开启、先开启后设参数结果一致；
+    //       2) 复位后重跑与新实例逐位一致；
+    //       3) 另一线程反复改混响参数时持续处理，输出有限。
+    // -------------------------
+    {
+        const uint32_t blk = 480;
+        std::vector<float> in;
+        gen_log_sweep(in, SR48k, CH_ST, 1.0f, 50.0f, 18000.0f, 0.5f);
+        const uint32_t nFrames = static_cast<uint32_t>(in.size() / CH_ST);
+        std::vector<float> o1(in.size()), o2(in.size()), o3(in.size());
+
+        void *a = dsp_create_context(SR48k, CH_ST);
+        dsp_set_reverb_enabled(a, 1);
+        dsp_set_reverb_params(a, 0.3f, 0.8f, 0.2f, 35.f);
+        void *b = dsp_create_context(SR48k, CH_ST);
+        dsp_set_reverb_params(b, 0.3f, 0.8f, 0.2f, 35.f);
+        dsp_set_reverb_enabled(b, 1);
+        process_blocked(a, in.data(), o1.data(), nFrames, SR48k, CH_ST, blk, false, tim);
+        process_blocked(b, in.data(), o2.data(), nFrames, SR48k, CH_ST, blk, false, tim);
+        check(o1 == o2, "reverb params/enable order independent");
+
+        dsp_reset(a);
+        process_blocked(a, in.data(), o3.data(), nFrames, SR48k, CH_ST, blk, false, tim);
+        check(o3 == o1, "reverb reset == fresh context");
+        dsp_destroy_context(b);
+
+        std::atomic<bool> stop(false);
+        std::thread writer([&]() {
+            unsigned i = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                dsp_set_reverb_params(a, 0.1f * (i % 10u), 0.2f + 0.05f * (i % 16u), 0.07f * (i % 11u),
+                                      static_cast<float>(i % 101u));
+                ++i;
+            }
+        });
+        bool finite = true;
+        for (int n = 0; n < 2000; ++n)
+        {
+            const uint32_t off = (static_cast<uint32_t>(n) * blk) % (nFrames - blk);
+            dsp_process_block(a, in.data() + static_cast<size_t>(off) * CH_ST, o1.data(), blk, CH_ST);
+            for (uint32_t k = 0; k < blk * CH_ST; ++k)
+                if (!std::isfinite(o1[k]))
+                    finite = false;
+        }
+        stop = true;
+        writer.join();
+        dsp_destroy_context(a);
+        check(finite, "reverb reconfigure under load finite");
+    }
+
+    // -------------------------
+    // 用例 N：单实例内存占用（一次分配，随通道数/采样率线性增长）
+    // -------------------------
+    {
+        const uint32_t srList[] = {SR441k, SR48k, 96000};
+        const uint16_t chList[] = {2, 8};
+        for (uint32_t sr : srList)
+        {
+            size_t prev = 0;
+            for (uint16_t chN : chList)
+            {
+                void *ctx = dsp_create_context(sr, chN);
+                const size_t bytes = dsp_get_memory_footprint(ctx);
+                std::cout << "[INFO] footprint sr=" << sr << " ch=" << chN << " : " << bytes << " bytes\n";
+                check(bytes > prev, ("footprint grows with channels @" + std::to_string(sr)).c_str());
+                prev = bytes;
+                dsp_destroy_context(ctx);
+            }
+        }
+    }
+
+    // -------------------------
+    // 用例 O：APOProcess 核心（假连接属性）
+    // 目标：1) 有效缓冲就地处理与直接调 dsp_process_block 逐位一致；
+    //       2) BUFFER_SILENT 期间尾音没放完时照常输出（等同输入全 0 的 dsp_process_block），标志为有效；
+    //       3) in/out 不同缓冲时结果同样一致。
+    // -------------------------
+    {
+        const uint32_t blk = 480;
+        std::vector<float> in;
+        gen_log_sweep(in, SR48k, CH_ST, 0.2f, 50.0f, 18000.0f, 0.5f);
+        const uint32_t nBlocks = static_cast<uint32_t>(in.size() / CH_ST) / blk;
+
+        auto make = [&]() {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_gain(ctx, 1.2f);
+            dsp_set_eq_enabled(ctx, 1, 1);
+            dsp_set_eq_params(ctx, 1, 1200.f, 1.2f, -6.f);
+            dsp_set_reverb_enabled(ctx, 1);
+            return ctx;
+        };
+        void *ref = make();
+        void *apo = make();
+        void *apo2 = make();
+        bool inplaceOk = true, silentOk = true, oopOk = true;
+        std::vector<float> r(blk * CH_ST), a(blk * CH_ST), o(blk * CH_ST), z(blk * CH_ST, 0.0f);
+        for (uint32_t b = 0; b < nBlocks; ++b)
+        {
+            const float *src = in.data() + static_cast<size_t>(b) * blk * CH_ST;
+
+            // 就地：in/out 是同一个连接属性/同一块缓冲；每块之前插一块静音（缓冲里是垃圾，不能当输入读）
+            dsp_process_block(ref, z.data(), r.data(), blk, CH_ST);
+            std::fill(a.begin(), a.end(), 123.0f);
+            FakeConnProp s{reinterpret_cast<uintptr_t>(a.data()), blk, ApoCore::kBufferSilent, 0};
+            FakeConnProp so{reinterpret_cast<uintptr_t>(a.data()), 0, ApoCore::kBufferValid, 0};
+            if (!ApoCore::Process(apo, CH_ST, &s, &so) || so.u32BufferFlags != ApoCore::kBufferValid ||
+                so.u32ValidFrameCount != blk || a != r)
+                silentOk = false;
+            dsp_process_block(apo2, z.data(), o.data(), blk, CH_ST);
+
+            dsp_process_block(ref, src, r.data(), blk, CH_ST);
+
+            std::copy(src, src + blk * CH_ST, a.begin());
+            FakeConnProp io{reinterpret_cast<uintptr_t>(a.data()), blk, ApoCore::kBufferValid, 0};
+            ApoCore::Process(apo, CH_ST, &io, &io);
+            if (a != r || io.u32BufferFlags != ApoCore::kBufferValid)
+                inplaceOk = false;
+
+            // 非就地
+            FakeConnProp ci{reinterpret_cast<uintptr_t>(src), blk, ApoCore::kBufferValid, 0};
+            FakeConnProp co{reinterpret_cast<uintptr_t>(o.data()), 0, ApoCore::kBufferInvalid, 0};
+            ApoCore::Process(apo2, CH_ST, &ci, &co);
+            if (o != r || co.u32ValidFrameCount != blk || co.u32BufferFlags != ApoCore::kBufferValid)
+                oopOk = false;
+        }
+        dsp_destroy_context(ref);
+        dsp_destroy_context(apo);
+        dsp_destroy_context(apo2);
+        check(inplaceOk, "apo core in-place == dsp_process_block");
+        check(silentOk, "apo core silent buffer plays the tail like zero input");
+        check(oopOk, "apo core out-of-place == dsp_process_block");
+    }
+
+    // -------------------------
+    // 用例 P：实时日志环（SPSC）
+    // 目标：1) 满了丢新记录并计数，不覆盖旧记录；
+    //       2) 生产者/消费者并发时，收到的记录按序、不重不乱，收到 + 丢弃 == 写入总数。
+    // -------------------------
+    {
+        {
+            ApoRtLogRing<16> ring;
+            for (uint32_t i = 0; i < 20; ++i)
+                ring.Push(kRtEvtTick, i);
+            uint32_t next = 0;
+            bool ordered = true;
+            const uint32_t n = ring.Drain([&](const ApoRtRecord &r) {
+                if (r.a != next++)
+                    ordered = false;
+            });
+            check(n == 16 && ordered && ring.Dropped() == 4, "rtlog overflow drops newest and counts");
+        }
+        {
+            static ApoRtLogRing<256> ring; // 放静态区：对象较大
+            const uint32_t total = 200000;
+            std::thread producer([&]() {
+                for (uint32_t i = 0; i < total; ++i)
+                {
+                    ring.Push(kRtEvtTick, i, ~i);
+                    if ((i & 63) == 63)
+                        std::this_thread::yield(); // 模拟实时线程按块突发写入
+                }
+            });
+            uint32_t got = 0, last = 0;
+            bool ok = true, first = true, done = false;
+            while (!done)
+            {
+                done = (got + ring.Dropped() >= total);
+                ring.Drain([&](const ApoRtRecord &r) {
+                    if (r.b != ~r.a || (!first && r.a <= last))
+                        ok = false;
+                    first = false;
+                    last = r.a;
+                    ++got;
+                });
+            }
+            producer.join();
+            got += ring.Drain([](const ApoRtRecord &) {});
+            std::cout << "[INFO] rtlog spsc: received=" << got << " dropped=" << ring.Dropped() << "\n";
+            check(ok, "rtlog spsc records intact and ordered");
+            check(got + ring.Dropped() == total, "rtlog spsc received + dropped == pushed");
+        }
+    }
+
+    // -------------------------
+    // 用例 Q：DSP 内部运行统计（dsp_get_stats / dsp_reset_stats）
+    // 目标：各级有计时（EQ 整张段表每子块计一次时；0 dB 的段与折进 EQ 的增益不跑），直方图总数等于块数，分位数单调；
+//       清零后重新计数
+    // -------------------------
+    {
+        const uint32_t blk = 480;
+        std::vector<float> in;
+        gen_log_sweep(in, SR48k, CH_ST, 2.0f, 50.0f, 18000.0f, 0.5f);
+        const uint32_t nFrames = static_cast<uint32_t>(in.size() / CH_ST);
+        std::vector<float> out(in.size());
+
+        void *ctx = make_eq_ctx(SR48k, CH_ST);
+        dsp_set_eq_enabled(ctx, 7, 1);
+        dsp_set_eq_params(ctx, 7, 3000.f, 1.0f, +3.f);
+        dsp_set_eq_enabled(ctx, 8, 1); // 0 dB：发布时就从段表里去掉
+        dsp_set_reverb_enabled(ctx, 1);
+        dsp_set_limiter_enabled(ctx, 1);
+        process_blocked(ctx, in.data(), out.data(), nFrames, SR48k, CH_ST, blk, false, tim);
+
+        DSP_STATS st;
+        if (dsp_get_stats(ctx, &st))
+        {
+            static const char *stageName[DSP_STAGE_COUNT] = {"gain", "eq", "reverb", "limiter", "conv"};
+            const double us = 1e6 / st.ticks_per_second;
+            for (int i = 0; i < DSP_STAGE_COUNT; ++i)
+                std::cout << "[STATS] " << stageName[i] << " calls=" << st.stage[i].calls
+                          << " avg=" << (st.stage[i].calls ? st.stage[i].ticks * us / st.stage[i].calls : 0.0)
+                          << " us max=" << st.stage[i].max_ticks * us << " us\n";
+            if (st.eq_band_runs)
+                std::cout << "[STATS] eq per band avg=" << st.stage[DSP_STAGE_EQ].ticks * us / st.eq_band_runs
+                          << " us\n";
+            std::cout << "[STATS] block avg=" << st.block_avg_us << " p50=" << st.block_p50_us
+                      << " p99=" << st.block_p99_us << " p99.9=" << st.block_p999_us
+                      << " max=" << st.block_max_ticks * us << " us\n";
+
+            uint64_t histTotal = 0;
+            for (uint64_t h : st.block_hist)
+                histTotal += h;
+            const uint64_t expectBlocks = (nFrames + blk - 1) / blk;
+            uint64_t expectSub = 0; // 每块按 256 帧（DSP_SUBBLOCK）切成子块
+            for (uint32_t done = 0; done < nFrames; done += blk)
+                expectSub += (std::min(blk, nFrames - done) + 255) / 256;
+            check(st.blocks == expectBlocks && histTotal == st.blocks && st.frames == nFrames,
+                  "stats block count / histogram total");
+            check(st.stage[DSP_STAGE_EQ].calls && st.stage[DSP_STAGE_REVERB].calls && st.stage[DSP_STAGE_LIMITER].calls,
+                  "stats every enabled stage timed");
+            check(st.stage[DSP_STAGE_GAIN].calls == 0, "stats no separate gain stage (folded into eq)");
+            check(st.stage[DSP_STAGE_EQ].calls == expectSub && st.eq_band_runs == 4 * expectSub,
+                  "stats eq cascade timed once per sub-block, only non-flat bands run");
+            check(st.block_p50_us <= st.block_p99_us && st.block_p99_us <= st.block_p999_us,
+                  "stats percentiles monotonic");
+
+            dsp_reset_stats(ctx);
+            dsp_process_block(ctx, in.data(), out.data(), blk, CH_ST);
+            dsp_get_stats(ctx, &st);
+            check(st.blocks == 1 && st.frames == blk, "stats reset");
+        }
+        else
+        {
+            std::cout << "[INFO] DSP_ENABLE_STATS=0, skip\n";
+        }
+        dsp_destroy_context(ctx);
+    }
+
+    // -------------------------
+    // 用例 R：共享内存控制面（seqlock 快照，两线程）
+    // 目标：1) 没有新发布时 Poll 一次比较就返回 false；
+    //       2) 写者狂发时，读者拿到的每一份参数都是某一次完整发布（所有字段来自同一个 k），且 k 单调不减；
+    //       3) 写者停下后读者最终拿到最后一份；
+    //       4) 对象名按端点 ID 区分（渲染/采集各一块），ID 里的 '\' 不会变成命名空间分隔符；
+    //       5) 写者死在写的途中（序号停在奇数）：其他写者/读者超时后接管，不会永远等下去。
+    // -------------------------
+    {
+        // 共享内存在真实场景里是映射页；这里用普通堆内存代替
+        std::vector<uint8_t> mem(sizeof(ApoShmParamsBlock) + 64);
+        ApoShmParamsBlock *blk = reinterpret_cast<ApoShmParamsBlock *>(mem.data());
+        ApoShmInit(blk);
+        check(ApoShmValid(blk), "shm block header valid");
+
+        ApoShmReader reader;
+        MyDspParams got{};
+        check(!reader.Poll(blk, got), "shm poll without publish returns false");
+
+        auto fill = [](MyDspParams &p, uint32_t k) {
+            memset(&p, 0, sizeof(p));
+            p.gain = static_cast<float>(k);
+            for (int b = 0; b < MY_EQ_BANDS; ++b)
+            {
+                p.eq[b].enabled = static_cast<int32_t>(k & 1);
+                p.eq[b].freq = static_cast<float>(k + b);
+                p.eq[b].gain_db = -static_cast<float>(k);
+            }
+            p.reverb.wet = static_cast<float>(k);
+            p.limiterEnabled = static_cast<int32_t>(k);
+            p.opcodeSize = k;
+            memset(p.opcode, static_cast<int>(k & 0xFF), sizeof(p.opcode));
+        };
+        auto consistent = [](const MyDspParams &p, uint32_t &k) {
+            k = p.opcodeSize;
+            if (p.gain != static_cast<float>(k) || p.reverb.wet != static_cast<float>(k) ||
+                p.limiterEnabled != static_cast<int32_t>(k))
+                return false;
+            for (int b = 0; b < MY_EQ_BANDS; ++b)
+                if (p.eq[b].freq != static_cast<float>(k + b) || p.eq[b].gain_db != -static_cast<float>(k) ||
+                    p.eq[b].enabled != static_cast<int32_t>(k & 1))
+                    return false;
+            for (uint8_t v : p.opcode)
+                if (v != static_cast<uint8_t>(k & 0xFF))
+                    return false;
+            return true;
+        };
+
+        const uint32_t total = 20000;
+        std::atomic<bool> writerDone(false);
+        std::thread writer([&]() {
+            MyDspParams p;
+            for (uint32_t k = 1; k <= total; ++k)
+            {
+                fill(p, k);
+                ApoShmPublish(blk, p);
+                if ((k & 7) == 0)
+                    std::this_thread::yield(); // 给读者留出完整读取的窗口
+            }
+            writerDone = true;
+        });
+        bool ok = true;
+        uint32_t lastK = 0, polls = 0, hits = 0;
+        for (;;)
+        {
+            const bool finished = writerDone.load();
+            ++polls;
+            if (reader.Poll(blk, got))
+            {
+                ++hits;
+                uint32_t k = 0;
+                if (!consistent(got, k) || k < lastK)
+                    ok = false;
+                lastK = k;
+            }
+            if (finished && lastK == total)
+                break;
+            if (finished && polls > total * 100u)
+                break;
+            std::this_thread::yield(); // 读者相当于每块轮询一次
+        }
+        writer.join();
+        std::cout << "[INFO] shm seqlock: polls=" << polls << " snapshots=" << hits << "\n";
+        check(ok, "shm snapshots complete and ordered");
+        check(lastK == total, "shm reader converges to last publish");
+        check(!reader.Poll(blk, got), "shm poll after convergence returns false");
+
+        MyDspParams back{};
+        uint32_t k = 0;
+        check(ApoShmRead(blk, back) && consistent(back, k) && k == total, "shm read-back");
+
+        // 写者拿到写权后死掉（序号停在奇数、数据写了一半）：下一个写者等 APO_SHM_STALE_MS 后接管，不会永远等下去
+        {
+            const uint32_t held = ApoShmWriterLock(blk);
+            blk->words[0].store(0x7FC00000u, std::memory_order_relaxed); // gain 写成 NaN 就“死了”
+            check(!reader.Poll(blk, got), "shm poll while writer holds the lock returns false");
+            MyDspParams p;
+            fill(p, total + 1);
+            const auto t0 = std::chrono::steady_clock::now();
+            ApoShmPublish(blk, p);
+            const double waitedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << "[INFO] shm stale writer recovered after " << waitedMs << " ms\n";
+            check(blk->seq.load() == held + 4 && waitedMs >= APO_SHM_STALE_MS * 0.9 && reader.Poll(blk, got) &&
+                      consistent(got, k) && k == total + 1,
+                  "shm writer recovers from a dead writer");
+
+            // 只有读者（APO）在：连续轮询看到同一个奇数序号超时后接管，整份拷出块里现有的内容
+            ApoShmWriterLock(blk);
+            blk->words[0].store(0x7FC00000u, std::memory_order_relaxed);
+            bool recovered = false;
+            for (int i = 0; i < 200 && !recovered; ++i) // 最多 2 s，每块 10 ms 轮询一次
+            {
+                recovered = reader.Poll(blk, got);
+                if (!recovered)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            check(recovered && !(blk->seq.load() & 1) && std::isnan(got.gain) && !ParamsValid(got) &&
+                      ApoShmRead(blk, back) && memcmp(&back, &got, sizeof(got)) == 0,
+                  "shm reader recovers from a dead writer (torn blob caught by ParamsValid)");
+        }
+
+        wchar_t nRender[APO_SHM_NAME_CCH], nCapture[APO_SHM_NAME_CCH], nOdd[APO_SHM_NAME_CCH], nShort[32];
+        const bool named = ApoShmMakeName(L"{0.0.0.00000000}.{7f5c8e1a-0d2b-4c6e-9a51-3b8f2d4e6a10}", nRender, APO_SHM_NAME_CCH) &&
+                           ApoShmMakeName(L"{0.0.1.00000000}.{7f5c8e1a-0d2b-4c6e-9a51-3b8f2d4e6a10}", nCapture, APO_SHM_NAME_CCH) &&
+                           ApoShmMakeName(L"a\\b", nOdd, APO_SHM_NAME_CCH);
+        check(named && wcscmp(nRender, nCapture) != 0 &&
+                  wcsncmp(nRender, MYCOMPANY_SHM_PREFIX, wcslen(MYCOMPANY_SHM_PREFIX)) == 0 &&
+                  wcschr(nOdd + wcslen(MYCOMPANY_SHM_PREFIX), L'\\') == nullptr,
+              "shm name is per endpoint");
+        check(!ApoShmMakeName(L"", nShort, 32) && !ApoShmMakeName(nullptr, nShort, 32) &&
+                  !ApoShmMakeName(L"{0.0.0.00000000}.{7f5c8e1a-0d2b-4c6e-9a51-3b8f2d4e6a10}", nShort, 32),
+              "shm name rejects empty or truncated endpoint id");
+    }
+
+    // -------------------------
+    // 用例 S：MyDspParams 增量应用
+    // 目标：1) 首次整份写入：12 段全部设计一次；
+    //       2) 只拖动一个滑块：恰好 1 段重设计，混响/限幅不动；
+    //       3) 同一份参数再来一次：什么都不做（noop）；
+    //       4) 增量应用后的输出与直接整份配置的上下文逐样本一致；
+    //       5) 带 NaN/Inf 的一份整份拒绝，DSP 不变；
+    //       6) 设置函数本身也不让 NaN/超范围的值进入快照。
+    // -------------------------
+    {
+        MyDspParams p0{};
+        p0.gain = 0.8f;
+        for (int b = 0; b < MY_EQ_BANDS; ++b)
+        {
+            p0.eq[b].enabled = (b % 3) != 2;
+            p0.eq[b].freq = 60.0f * static_cast<float>(b + 1) * static_cast<float>(b + 1);
+            p0.eq[b].q = 0.9f;
+            p0.eq[b].gain_db = static_cast<float>((b % 5) - 2) * 2.0f;
+            p0.eq[b].type = b == 0 ? 1 : (b == MY_EQ_BANDS - 1 ? 2 : 0);
+        }
+        p0.reverb.enabled = 1;
+        p0.reverb.wet = 0.2f;
+        p0.reverb.room = 0.6f;
+        p0.reverb.damp = 0.3f;
+        p0.reverb.pre_ms = 20.0f;
+        p0.limiterEnabled = 1;
+
+        void *ctxA = dsp_create_context(SR48k, CH_ST);
+        void *ctxB = dsp_create_context(SR48k, CH_ST);
+        ParamsApplyCounters c{};
+        const uint32_t m0 = ParamsApply(ctxA, nullptr, p0, &c);
+        check(m0 == (kParamsChangedGain | kParamsChangedEq | kParamsChangedReverb | kParamsChangedLimiter) &&
+                  c.fullApplies == 1 && c.eqRedesigns == MY_EQ_BANDS && c.reverbUpdates == 1,
+              "params full apply touches every field");
+
+        MyDspParams p1 = p0;
+        p1.eq[4].gain_db += 1.5f; // 拖动一个滑块
+        const ParamsApplyCounters before = c;
+        const uint32_t m1 = ParamsApply(ctxA, &p0, p1, &c);
+        check(m1 == kParamsChangedEq && c.eqRedesigns - before.eqRedesigns == 1 &&
+                  c.eqToggles == before.eqToggles && c.reverbUpdates == before.reverbUpdates &&
+                  c.gainWrites == before.gainWrites && c.limiterWrites == before.limiterWrites,
+              "params one slider -> one band redesign");
+
+        MyDspParams p2 = p1;
+        p2.eq[7].enabled = !p2.eq[7].enabled; // 只改开关：不需要重设计
+        const ParamsApplyCounters before2 = c;
+        ParamsApply(ctxA, &p1, p2, &c);
+        check(c.eqRedesigns == before2.eqRedesigns && c.eqToggles - before2.eqToggles == 1,
+              "params band toggle without redesign");
+
+        const uint32_t noopsBefore = c.noops;
+        check(ParamsApply(ctxA, &p2, p2, &c) == 0 && c.noops == noopsBefore + 1, "params identical blob is a noop");
+        std::cout << "[INFO] params apply: applies=" << c.applies << " eqRedesigns=" << c.eqRedesigns
+                  << " noops=" << c.noops << "\n";
+
+        ParamsApply(ctxB, nullptr, p2, nullptr);
+        std::vector<float> in, outA, outB;
+        gen_log_sweep(in, SR48k, CH_ST, 0.5f, 50.0f, 18000.0f, 0.5f);
+        const uint32_t frames = static_cast<uint32_t>(in.size() / CH_ST);
+        outA.resize(in.size());
+        outB.resize(in.size());
+        Timing t{};
+        process_blocked(ctxA, in.data(), outA.data(), frames, SR48k, CH_ST, 480, false, t);
+        process_blocked(ctxB, in.data(), outB.data(), frames, SR48k, CH_ST, 480, false, t);
+        check(memcmp(outA.data(), outB.data(), outA.size() * sizeof(float)) == 0,
+              "params incremental == full apply (bit-exact)");
+
+        // 5) 共享内存里来了一份带 NaN/Inf 的参数：整份拒绝，同一份里合法的改动也不生效
+        MyDspParams bad = p2;
+        bad.gain = 2.0f;
+        bad.eq[3].q = std::nanf("");
+        MyDspParams inf = p2;
+        inf.limiter.release_ms = INFINITY;
+        const ParamsApplyCounters before3 = c;
+        const uint32_t mBad = ParamsApply(ctxA, &p2, bad, &c);
+        const uint32_t mInf = ParamsApply(ctxA, &p2, inf, &c);
+        check(mBad == kParamsRejected && mInf == kParamsRejected && c.rejects == before3.rejects + 2 &&
+                  c.applies == before3.applies && c.gainWrites == before3.gainWrites && !ParamsValid(bad) &&
+                  ParamsValid(p2),
+              "params with NaN/Inf rejected whole");
+        dsp_reset(ctxA);
+        dsp_reset(ctxB);
+        process_blocked(ctxA, in.data(), outA.data(), frames, SR48k, CH_ST, 480, false, t);
+        process_blocked(ctxB, in.data(), outB.data(), frames, SR48k, CH_ST, 480, false, t);
+        check(memcmp(outA.data(), outB.data(), outA.size() * sizeof(float)) == 0,
+              "params rejected blob leaves DSP unchanged");
+
+        // 6) 直接调用的设置函数：NaN 增益被忽略、超大增益夹到 +24 dB，NaN 的 EQ 参数落到范围端点，输出始终有限
+        void *ctxC = dsp_create_context(SR48k, CH_ST);
+        dsp_set_gain(ctxC, 0.5f);
+        dsp_set_gain(ctxC, std::nanf(""));
+        process_blocked(ctxC, in.data(), outA.data(), frames, SR48k, CH_ST, 480, false, t);
+        float peakIn = 0.f, ratio = 0.f;
+        for (size_t i = 0; i < in.size(); ++i)
+            peakIn = std::max(peakIn, std::fabs(in[i]));
+        for (size_t i = 0; i < in.size(); ++i)
+            ratio = std::max(ratio, std::fabs(outA[i]) / peakIn);
+        const bool nanGainIgnored = std::fabs(ratio - 0.5f) < 1e-3f;
+        dsp_reset(ctxC);
+        dsp_set_limiter_enabled(ctxC, 0); // 否则限幅器把峰值压住，看不出增益有没有夹住
+        dsp_set_gain(ctxC, 1e9f);
+        dsp_set_eq_params(ctxC, 0, std::nanf(""), std::nanf(""), std::nanf(""));
+        dsp_set_eq_enabled(ctxC, 0, 1);
+        dsp_set_reverb_params(ctxC, std::nanf(""), std::nanf(""), std::nanf(""), std::nanf(""));
+        dsp_set_reverb_enabled(ctxC, 1);
+        process_blocked(ctxC, in.data(), outA.data(), frames, SR48k, CH_ST, 480, false, t);
+        bool finite = true;
+        float peakOut = 0.f;
+        for (float v : outA)
+        {
+            finite &= std::isfinite(v);
+            peakOut = std::max(peakOut, std::fabs(v));
+        }
+        std::cout << "[INFO] params sanitize: nan gain ratio=" << ratio << " huge gain peak=" << peakOut << "\n";
+        check(nanGainIgnored && finite && peakOut < 16.f * peakIn * 1.5f,
+              "setters ignore NaN gain and clamp out-of-range values");
+        dsp_destroy_context(ctxC);
+        dsp_destroy_context(ctxA);
+        dsp_destroy_context(ctxB);
+    }
+
+    // -------------------------
+    // 用例 T：参数线格式（ParamsWire）
+    // 目标：1) 整份编码/解码往返逐字节一致，且比 MyDspParams 小；
+    //       2) 随机改动的增量消息解码到旧参数上 == 新参数；拖一个滑块的消息只有一条记录；
+    //       3) 坏 CRC / 截断 / 坏记录：整条拒绝，参数不变；未知 tag 跳过；
+    //       4) 共享内存里读者只落后一次发布时走增量消息，结果与整份读回一致；
+    //       5) 编码 + 解码吞吐。
+    // -------------------------
+    {
+        uint32_t rng = 12345u;
+        auto rnd = [&rng]() {
+            rng = rng * 1664525u + 1013904223u;
+            return rng >> 8;
+        };
+        auto randomParams = [&](MyDspParams &p) {
+            memset(&p, 0, sizeof(p));
+            p.gain = static_cast<float>(rnd() % 2000) / 1000.0f;
+            for (int b = 0; b < MY_EQ_BANDS; ++b)
+            {
+                p.eq[b].enabled = static_cast<int32_t>(rnd() & 1);
+                p.eq[b].freq = static_cast<float>(20 + rnd() % 19980);
+                p.eq[b].q = static_cast<float>(300 + rnd() % 7700) / 1000.0f;
+                p.eq[b].gain_db = static_cast<float>(static_cast<int>(rnd() % 4801) - 2400) / 100.0f;
+                p.eq[b].type = static_cast<int32_t>(rnd() % 3);
+            }
+            p.reverb.enabled = static_cast<int32_t>(rnd() & 1);
+            p.reverb.wet = static_cast<float>(rnd() % 1000) / 1000.0f;
+            p.reverb.room = static_cast<float>(rnd() % 1000) / 1000.0f;
+            p.reverb.damp = static_cast<float>(rnd() % 1000) / 1000.0f;
+            p.reverb.pre_ms = static_cast<float>(rnd() % 100);
+            p.limiterEnabled = static_cast<int32_t>(rnd() & 1);
+            p.opcodeSize = rnd() % 40;
+            for (uint32_t i = 0; i < p.opcodeSize; ++i)
+                p.opcode[i] = static_cast<uint8_t>(rnd());
+        };
+        // 随机改几个字段（模拟界面上的操作）
+        auto mutate = [&](MyDspParams &p) {
+            const uint32_t edits = 1 + rnd() % 4;
+            for (uint32_t k = 0; k < edits; ++k)
+            {
+                const int b = static_cast<int>(rnd() % MY_EQ_BANDS);
+                switch (rnd() % 8)
+                {
+                case 0: p.gain = static_cast<float>(rnd() % 2000) / 1000.0f; break;
+                case 1: p.eq[b].gain_db = static_cast<float>(static_cast<int>(rnd() % 4801) - 2400) / 100.0f; break;
+                case 2: p.eq[b].freq = static_cast<float>(20 + rnd() % 19980); break;
+                case 3: p.eq[b].enabled = !p.eq[b].enabled; break;
+                case 4: p.eq[b].type = static_cast<int32_t>(rnd() % 3); break;
+                case 5: p.reverb.wet = static_cast<float>(rnd() % 1000) / 1000.0f; break;
+                case 6: p.reverb.room = static_cast<float>(rnd() % 1000) / 1000.0f; break;
+                default: p.limiterEnabled = !p.limiterEnabled; break;
+                }
+            }
+        };
+
+        uint8_t msg[PARAMS_WIRE_MAX_BYTES];
+        MyDspParams a, b2, dec;
+        randomParams(a);
+        const uint32_t fullBytes = ParamsWireEncodeDelta(nullptr, a, msg, sizeof(msg));
+        memset(&dec, 0, sizeof(dec));
+        uint32_t recs = 0;
+        check(fullBytes > 0 && fullBytes < sizeof(MyDspParams) &&
+                  ParamsWireDecode(msg, fullBytes, dec, &recs) == kWireOk && memcmp(&dec, &a, sizeof(a)) == 0,
+              "wire full round-trip");
+        std::cout << "[INFO] wire full=" << fullBytes << " bytes (MyDspParams=" << sizeof(MyDspParams)
+                  << ", records=" << recs << ")\n";
+
+        bool rtOk = true;
+        uint64_t deltaBytes = 0;
+        for (int i = 0; i < 2000; ++i)
+        {
+            b2 = a;
+            mutate(b2);
+            const uint32_t n = ParamsWireEncodeDelta(&a, b2, msg, sizeof(msg));
+            dec = a;
+            if (!n || ParamsWireDecode(msg, n, dec) != kWireOk || memcmp(&dec, &b2, sizeof(dec)) != 0)
+                rtOk = false;
+            deltaBytes += n;
+            a = b2;
+        }
+        check(rtOk, "wire delta round-trip (2000 random edits)");
+        std::cout << "[INFO] wire delta avg=" << (deltaBytes / 2000.0) << " bytes\n";
+
+        b2 = a;
+        b2.eq[5].gain_db += 0.5f; // 拖一个滑块
+        const uint32_t slider = ParamsWireEncodeDelta(&a, b2, msg, sizeof(msg));
+        dec = a;
+        check(slider == sizeof(ParamsWireHeader) + 8 && ParamsWireDecode(msg, slider, dec, &recs) == kWireOk &&
+                  recs == 1 && memcmp(&dec, &b2, sizeof(dec)) == 0,
+              "wire one slider = one 8-byte record");
+
+        // 批量：一个事务里多条命令；其中一条不合法时整条拒绝，参数不变
+        {
+            ParamsWireWriter w(msg, sizeof(msg));
+            w.Gain(0.25f);
+            w.EqGain(1, 6.0f);
+            w.ReverbWet(0.5f);
+            const uint8_t future[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+            w.Record(200, 0, future, 6); // 以后版本的新 tag：跳过
+            w.Limiter(false);
+            const uint32_t n = w.Finish();
+            dec = a;
+            const bool ok = ParamsWireDecode(msg, n, dec, &recs) == kWireOk && recs == 5 && dec.gain == 0.25f &&
+                            dec.eq[1].gain_db == 6.0f && dec.reverb.wet == 0.5f && dec.limiterEnabled == 0;
+            check(ok, "wire batch applies all records, skips unknown tag");
+
+            MyDspParams keep = a;
+            msg[n - 1] ^= 0x40; // 改坏最后一个字节
+            check(ParamsWireDecode(msg, n, keep) == kWireBadCrc && memcmp(&keep, &a, sizeof(a)) == 0,
+                  "wire bad crc rejected, params untouched");
+            msg[n - 1] ^= 0x40;
+            check(ParamsWireDecode(msg, n - 4, keep) == kWireTruncated && memcmp(&keep, &a, sizeof(a)) == 0,
+                  "wire truncated rejected");
+
+            ParamsWireWriter w2(msg, sizeof(msg));
+            w2.Gain(0.1f);
+            w2.EqGain(MY_EQ_BANDS, 3.0f); // 段号越界
+            const uint32_t n2 = w2.Finish();
+            check(ParamsWireDecode(msg, n2, keep) == kWireBadRecord && memcmp(&keep, &a, sizeof(a)) == 0,
+                  "wire bad record rejects whole transaction");
+            ParamsWireWriter w3(msg, 32);
+            w3.Reverb(a.reverb);
+            check(w3.Finish() == 0, "wire writer overflow reported");
+        }
+
+        // 共享内存：增量发布 + 读者走增量路径
+        {
+            std::vector<uint8_t> mem(sizeof(ApoShmParamsBlock) + 64);
+            ApoShmParamsBlock *blk = reinterpret_cast<ApoShmParamsBlock *>(mem.data());
+            ApoShmInit(blk);
+            ApoShmReader reader;
+            MyDspParams got{}, back{};
+
+            randomParams(a);
+            ApoShmPublish(blk, a);
+            check(reader.Poll(blk, got) && reader.FullCopies() == 1 && memcmp(&got, &a, sizeof(a)) == 0,
+                  "shm full publish -> full copy");
+
+            bool ok = true;
+            for (int i = 0; i < 50; ++i)
+            {
+                b2 = a;
+                mutate(b2);
+                const uint32_t n = ParamsWireEncodeDelta(&a, b2, msg, sizeof(msg));
+                ok &= ApoShmPublishWire(blk, msg, n) == kWireOk;
+                ok &= reader.Poll(blk, got) && memcmp(&got, &b2, sizeof(got)) == 0;
+                a = b2;
+            }
+            check(ok && reader.Deltas() == 50 && reader.FullCopies() == 1, "shm wire publish -> delta path");
+
+            // 读者落后两次：退回整份拷贝
+            for (int i = 0; i < 2; ++i)
+            {
+                b2 = a;
+                mutate(b2);
+                const uint32_t n = ParamsWireEncodeDelta(&a, b2, msg, sizeof(msg));
+                ApoShmPublishWire(blk, msg, n);
+                a = b2;
+            }
+            check(reader.Poll(blk, got) && reader.FullCopies() == 2 && memcmp(&got, &a, sizeof(a)) == 0 &&
+                      ApoShmRead(blk, back) && memcmp(&back, &a, sizeof(a)) == 0,
+                  "shm reader behind two publishes falls back to full copy");
+
+            b2 = a;
+            b2.gain += 1.0f;
+            const uint32_t nBad = ParamsWireEncodeDelta(&a, b2, msg, sizeof(msg));
+            msg[sizeof(ParamsWireHeader)] ^= 1; // 记录区被改坏：CRC 不符
+            const uint32_t seqBefore = blk->seq.load();
+            check(ApoShmPublishWire(blk, msg, nBad) == kWireBadCrc && blk->seq.load() == seqBefore &&
+                      ApoShmRead(blk, back) && memcmp(&back, &a, sizeof(a)) == 0,
+                  "shm invalid wire not published");
+
+            // 两线程：写者连续发增量，读者每轮 Poll 一次；最终读者手里的参数与整份读回一致
+            const uint32_t total = 5000;
+            std::atomic<bool> writerDone(false);
+            std::thread writer([&]() {
+                uint8_t m[PARAMS_WIRE_MAX_BYTES];
+                for (uint32_t k = 1; k <= total; ++k)
+                {
+                    ParamsWireWriter w(m, sizeof(m));
+                    w.Gain(static_cast<float>(k));
+                    w.EqGain(static_cast<int>(k % MY_EQ_BANDS), static_cast<float>(k));
+                    ApoShmPublishWire(blk, m, w.Finish());
+                    if ((k & 7) == 0)
+                        std::this_thread::yield();
+                }
+                writerDone = true;
+            });
+            bool conv = false;
+            for (uint32_t polls = 0; polls < total * 100u; ++polls)
+            {
+                const bool finished = writerDone.load();
+                reader.Poll(blk, got);
+                if (finished && got.gain == static_cast<float>(total))
+                {
+                    conv = true;
+                    break;
+                }
+                std::this_thread::yield();
+            }
+            writer.join();
+            std::cout << "[INFO] shm wire: deltas=" << reader.Deltas() << " fullCopies=" << reader.FullCopies() << "\n";
+            check(conv && ApoShmRead(blk, back) && memcmp(&back, &got, sizeof(got)) == 0,
+                  "shm wire concurrent reader converges");
+        }
+
+        // 吞吐：每条消息是随机改动的增量
+        {
+            const int N = 200000;
+            std::vector<MyDspParams> states(64);
+            for (auto &s2 : states)
+                randomParams(s2);
+            auto t0 = std::chrono::high_resolution_clock::now();
+            uint64_t bytes = 0;
+            uint32_t sink = 0;
+            for (int i = 0; i < N; ++i)
+            {
+                const MyDspParams &from = states[i & 63];
+                b2 = from;
+                b2.eq[i % MY_EQ_BANDS].gain_db += 0.5f;
+                b2.gain += 0.01f;
+                const uint32_t n = ParamsWireEncodeDelta(&from, b2, msg, sizeof(msg));
+                dec = from;
+                sink += (ParamsWireDecode(msg, n, dec) == kWireOk) ? 1u : 0u;
+                bytes += n;
+            }
+            auto t1 = std::chrono::high_resolution_clock::now();
+            const double sec = std::chrono::duration<double>(t1 - t0).count();
+            std::cout << "[INFO] wire encode+decode: " << (sec * 1e9 / N) << " ns/msg, "
+                      << (bytes / sec / 1e6) << " MB/s\n";
+            check(sink == static_cast<uint32_t>(N), "wire throughput loop decoded every message");
+        }
+    }
+
+    // -------------------------
+    // 用例 U：帧精确的定时参数事件
+    // 目标：1) 增益事件落在指定帧上（前一帧旧值、该帧起新值），与块大小无关（128 / 480 / 441）；
+    //       2) EQ + 混响事件：结果与“在该帧处切开、立即设置”的参考处理逐样本一致；
+    //       3) 队列满时返回 0；流位置 = 已处理帧数。
+    // -------------------------
+    {
+        const uint32_t blockSizes[] = {128, 480, 441};
+        const uint32_t N = 4800;
+        for (uint32_t B : blockSizes)
+        {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_limiter_enabled(ctx, 0);
+            dsp_begin_update(ctx);
+            dsp_set_gain(ctx, 0.25f);
+            check(dsp_commit_update_at(ctx, 1000) == 1, "event queued");
+            dsp_begin_update(ctx);
+            dsp_set_gain(ctx, 2.0f);
+            dsp_commit_update_at(ctx, 1001); // 只持续 1 帧的事件
+            dsp_begin_update(ctx);
+            dsp_set_gain(ctx, 1.0f);
+            dsp_commit_update_at(ctx, 3333);
+
+            std::vector<float> buf(static_cast<size_t>(N) * CH_ST, 0.5f);
+            for (uint32_t done = 0; done < N; done += B)
+            {
+                const uint32_t n = std::min(B, N - done);
+                dsp_process_block(ctx, buf.data() + static_cast<size_t>(done) * CH_ST, buf.data() + static_cast<size_t>(done) * CH_ST, n, CH_ST);
+            }
+            bool ok = true;
+            for (uint32_t f = 0; f < N; ++f)
+            {
+                const float want = f < 1000 ? 0.5f : (f == 1000 ? 0.125f : (f < 3333 ? 1.0f : 0.5f));
+                for (uint32_t c = 0; c < CH_ST; ++c)
+                    ok &= buf[static_cast<size_t>(f) * CH_ST + c] == want;
+            }
+            const std::string name = "gain events land on exact frame (block=" + std::to_string(B) + ")";
+            check(ok, name.c_str());
+            check(dsp_get_stream_position(ctx) == N, "stream position == processed frames");
+            dsp_destroy_context(ctx);
+        }
+
+        std::vector<float> in;
+        gen_log_sweep(in, SR48k, CH_ST, 0.25f, 50.0f, 18000.0f, 0.5f);
+        const uint32_t frames = static_cast<uint32_t>(in.size() / CH_ST);
+        const uint32_t F = 2017;
+        auto setup = [](void *ctx) {
+            dsp_set_eq_enabled(ctx, 1, 1);
+            dsp_set_eq_params(ctx, 1, 1000.0f, 1.0f, 6.0f);
+        };
+        auto change = [](void *ctx) {
+            dsp_set_eq_params_ex(ctx, 1, 3000.0f, 2.0f, -9.0f, DSP_EQ_PEAK);
+            dsp_set_eq_enabled(ctx, 4, 1);
+            dsp_set_reverb_params(ctx, 0.3f, 0.6f, 0.2f, 5.0f);
+            dsp_set_reverb_enabled(ctx, 1);
+        };
+        // 参考：在 F 处切开，两段之间立即设置（关掉平滑，立即设置才会在 F 处直接跳变）
+        std::vector<float> ref(in.size());
+        void *r = dsp_create_context(SR48k, CH_ST);
+        dsp_set_smoothing_ms(r, 0.0f);
+        setup(r);
+        dsp_process_block(r, in.data(), ref.data(), F, CH_ST);
+        dsp_begin_update(r);
+        change(r);
+        dsp_commit_update(r);
+        dsp_process_block(r, in.data() + static_cast<size_t>(F) * CH_ST, ref.data() + static_cast<size_t>(F) * CH_ST, frames - F, CH_ST);
+        dsp_destroy_context(r);
+
+        for (uint32_t B : blockSizes)
+        {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            setup(ctx);
+            dsp_begin_update(ctx);
+            change(ctx);
+            dsp_commit_update_at(ctx, F);
+            std::vector<float> out(in.size());
+            Timing t{};
+            process_blocked(ctx, in.data(), out.data(), frames, SR48k, CH_ST, B, false, t);
+            const std::string name = "eq+reverb event == split reference (block=" + std::to_string(B) + ")";
+            check(memcmp(out.data(), ref.data(), out.size() * sizeof(float)) == 0, name.c_str());
+            dsp_destroy_context(ctx);
+        }
+
+        void *ctx = dsp_create_context(SR48k, CH_ST);
+        int accepted = 0;
+        for (int i = 0; i < 17; ++i)
+        {
+            dsp_begin_update(ctx);
+            dsp_set_gain(ctx, 0.5f + 0.01f * static_cast<float>(i));
+            accepted += dsp_commit_update_at(ctx, 100000u + static_cast<uint64_t>(i));
+        }
+        check(accepted == 16, "event queue holds 16, 17th falls back to immediate publish");
+        dsp_destroy_context(ctx);
+    }
+
+    // -------------------------
+    // 用例 V：参数平滑（增益/湿度斜坡 + EQ 系数插值）
+    // 目标：1) 改增益后输出在 10ms 内线性过渡、终点精确、之后恒定；中途再改从当前值接着走，不跳；
+    //       2) 各 SIMD 指令集的斜坡输出逐位一致；
+    //       3) 关混响时湿度淡出，走完后输出与干声逐位一致；
+    //       4) EQ 大幅改动时，有插值的输出比直接跳变的“拉链”尖峰小；
+    //       5) 没有斜坡时走常量路径：平滑开/关的静态处理耗时相当。
+    // -------------------------
+    {
+        const uint32_t B = 128;
+        const uint32_t rampLen = SR48k / 100; // 默认 10ms
+        auto run = [&](void *ctx, const std::vector<float> &in, std::vector<float> &out) {
+            out.resize(in.size());
+            const uint32_t frames = static_cast<uint32_t>(in.size() / CH_ST);
+            for (uint32_t done = 0; done < frames; done += B)
+            {
+                const uint32_t n = std::min(B, frames - done);
+                dsp_process_block(ctx, in.data() + static_cast<size_t>(done) * CH_ST, out.data() + static_cast<size_t>(done) * CH_ST, n, CH_ST);
+            }
+        };
+
+        // 1) 增益斜坡
+        std::vector<float> ones(static_cast<size_t>(2048) * CH_ST, 1.0f), out, warm;
+        void *ctx = dsp_create_context(SR48k, CH_ST);
+        dsp_set_limiter_enabled(ctx, 0);
+        run(ctx, ones, warm); // 先跑起来（首块之前的设置不平滑）
+        dsp_set_gain(ctx, 0.5f);
+        run(ctx, ones, out);
+        bool mono = true, endExact = true;
+        float maxStep = 0.0f;
+        for (uint32_t n = 0; n < 2048; ++n)
+        {
+            const float v = out[static_cast<size_t>(n) * CH_ST];
+            const float prev = n ? out[static_cast<size_t>(n - 1) * CH_ST] : 1.0f;
+            mono &= v <= prev && out[static_cast<size_t>(n) * CH_ST + 1] == v;
+            maxStep = std::max(maxStep, prev - v);
+            if (n >= rampLen - 1)
+                endExact &= v == 0.5f;
+        }
+        check(out[0] < 1.0f && out[0] > 0.99f && mono, "smooth gain ramps monotonically (no jump)");
+        check(endExact, "smooth gain lands exactly on target after 10ms");
+        check(maxStep <= 0.5f / rampLen * 1.01f, "smooth gain step == linear slope");
+
+        // 斜坡中途改目标：从当前值继续，不跳
+        dsp_set_gain(ctx, 2.0f);
+        std::vector<float> part(static_cast<size_t>(200) * CH_ST, 1.0f), o1, o2;
+        run(ctx, part, o1);
+        dsp_set_gain(ctx, 0.25f);
+        run(ctx, ones, o2);
+        const float jump = std::fabs(o2[0] - o1[o1.size() - 1]);
+        check(jump <= 2.0f / rampLen * 1.01f && o2[o2.size() - 1] == 0.25f, "smooth retarget mid-ramp continues from current value");
+        dsp_destroy_context(ctx);
+
+        // 2) 各指令集逐位一致
+        {
+            std::vector<float> sweep, ref, got;
+            gen_log_sweep(sweep, SR48k, CH_ST, 0.1f, 100.0f, 10000.0f, 0.5f);
+            auto rampRun = [&](DSP_SIMD_LEVEL lv, std::vector<float> &o) {
+                void *c = dsp_create_context(SR48k, CH_ST);
+                if (!dsp_set_simd_level(c, lv))
+                {
+                    dsp_destroy_context(c);
+                    return false;
+                }
+                std::vector<float> w;
+                run(c, sweep, w);
+                dsp_set_gain(c, 0.3f);
+                dsp_set_eq_enabled(c, 1, 1);
+                dsp_set_eq_params(c, 1, 2000.0f, 1.0f, 9.0f);
+                dsp_set_reverb_enabled(c, 1);
+                run(c, sweep, o);
+                dsp_destroy_context(c);
+                return true;
+            };
+            rampRun(DSP_SIMD_SCALAR, ref);
+            const DSP_SIMD_LEVEL levels[] = {DSP_SIMD_SSE2, DSP_SIMD_AVX2, DSP_SIMD_NEON};
+            for (DSP_SIMD_LEVEL lv : levels)
+            {
+                if (!rampRun(lv, got))
+                    continue;
+                const std::string name = std::string("smooth ramps bit-exact ") + simd_name(lv) + " vs scalar";
+                check(memcmp(got.data(), ref.data(), ref.size() * sizeof(float)) == 0, name.c_str());
+            }
+        }
+
+        // 3) 关混响：湿度淡出，之后与干声一致
+        {
+            std::vector<float> sweep, a, b;
+            gen_log_sweep(sweep, SR48k, CH_ST, 0.2f, 100.0f, 10000.0f, 0.5f);
+            void *wet = dsp_create_context(SR48k, CH_ST);
+            void *dry = dsp_create_context(SR48k, CH_ST);
+            dsp_set_limiter_enabled(wet, 0); // 限幅器的增益包络带记忆，两边的历史不同
+            dsp_set_limiter_enabled(dry, 0);
+            dsp_set_reverb_enabled(wet, 1);
+            run(wet, sweep, a);
+            run(dry, sweep, b);
+            dsp_set_reverb_enabled(wet, 0);
+            run(wet, sweep, a);
+            run(dry, sweep, b);
+            bool tailDry = true;
+            for (size_t i = static_cast<size_t>(rampLen) * CH_ST; i < a.size(); ++i)
+                tailDry &= a[i] == b[i];
+            check(tailDry && a[0] != b[0], "smooth reverb off fades wet out, then exactly dry");
+            dsp_destroy_context(wet);
+            dsp_destroy_context(dry);
+        }
+
+        // 4) EQ：+12dB → -12dB 的低频峰值，看输出二阶差分的尖峰
+        {
+            std::vector<float> sine(static_cast<size_t>(SR48k / 5) * CH_ST);
+            for (size_t n = 0; n < sine.size() / CH_ST; ++n)
+                for (uint32_t ch = 0; ch < CH_ST; ++ch)
+                    sine[n * CH_ST + ch] = 0.1f * std::sin(2.0f * 3.14159265f * 200.0f * static_cast<float>(n) / SR48k);
+            auto zipper = [&](float ms) {
+                void *c = dsp_create_context(SR48k, CH_ST);
+                dsp_set_smoothing_ms(c, ms);
+                dsp_set_limiter_enabled(c, 0);
+                dsp_set_eq_enabled(c, 1, 1);
+                dsp_set_eq_params(c, 1, 200.0f, 2.0f, 12.0f);
+                std::vector<float> o;
+                run(c, sine, o);
+                dsp_set_eq_params(c, 1, 200.0f, 2.0f, -12.0f);
+                run(c, sine, o);
+                float peak = 0.0f;
+                for (size_t n = 2; n < 2000; ++n)
+                    peak = std::max(peak, std::fabs(o[n * CH_ST] - 2.0f * o[(n - 1) * CH_ST] + o[(n - 2) * CH_ST]));
+                dsp_destroy_context(c);
+                return peak;
+            };
+            const float hard = zipper(0.0f), smooth = zipper(10.0f);
+            std::cout << "[INFO] eq switch 2nd-diff peak: hard=" << hard << " smoothed=" << smooth << "\n";
+            check(smooth < hard * 0.75f, "smooth eq interpolation reduces zipper transient");
+        }
+
+        // 5) 静态参数下的开销：平滑开/关都走常量路径
+        {
+            std::vector<float> sweep, o;
+            gen_log_sweep(sweep, SR48k, CH_ST, 2.0f, 50.0f, 18000.0f, 0.5f);
+            double t[2];
+            for (int i = 0; i < 2; ++i)
+            {
+                void *c = make_eq_ctx(SR48k, CH_ST);
+                dsp_set_smoothing_ms(c, i ? 10.0f : 0.0f);
+                dsp_set_gain(c, 0.8f);
+                dsp_set_reverb_enabled(c, 1);
+                run(c, sweep, o); // 预热 + 吃掉首块
+                auto t0 = std::chrono::high_resolution_clock::now();
+                for (int r = 0; r < 3; ++r)
+                    run(c, sweep, o);
+                t[i] = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+                dsp_destroy_context(c);
+            }
+            std::cout << "[INFO] static params: smoothing off " << (t[0] * 1e3) << " ms, on " << (t[1] * 1e3) << " ms\n";
+        }
+    }
+
+    // -------------------------
+    // 用例 W：前瞻限幅器（滑动最大值 + 释放 + 滑动平均，通道联动）
+    // 目标：1) 低于阈值的信号原样通过，只延迟 dsp_get_latency_frames 帧（前瞻 0 / 1.5 / 5ms）；
+    //       2) 砖墙：+12dB 的扫频经过限幅后样本峰值不超过阈值；
+    //       3) 通道联动：安静的声道和响的声道乘同一个增益；
+    //       4) 真峰值：fs/4、相位 45° 的正弦（样本只有峰值的 0.707）按插值后的峰值压；
+    //       5) 软限幅模式仍可用，且没有延迟；
+    //       6) 前瞻 0.5ms 与 10ms 的耗时相当（每样本 O(1)）。
+    // -------------------------
+    {
+        const uint32_t B = 480;
+        auto run = [&](void *ctx, const std::vector<float> &in, std::vector<float> &out) {
+            out.resize(in.size());
+            const uint32_t frames = static_cast<uint32_t>(in.size() / CH_ST);
+            for (uint32_t done = 0; done < frames; done += B)
+            {
+                const uint32_t n = std::min(B, frames - done);
+                dsp_process_block(ctx, in.data() + static_cast<size_t>(done) * CH_ST, out.data() + static_cast<size_t>(done) * CH_ST, n, CH_ST);
+            }
+        };
+        std::vector<float> sweep, out;
+        gen_log_sweep(sweep, SR48k, CH_ST, 1.0f, 50.0f, 18000.0f, 0.5f);
+
+        // 1) 透明 + 延迟
+        const float lookMs[] = {0.0f, 1.5f, 5.0f};
+        for (float ms : lookMs)
+        {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_limiter_params(ctx, DSP_LIMITER_DEFAULT_THRESHOLD, ms, DSP_LIMITER_DEFAULT_RELEASE_MS, 0);
+            const unsigned lat = dsp_get_latency_frames(ctx);
+            run(ctx, sweep, out);
+            bool same = lat == static_cast<unsigned>(ms * SR48k / 1000.0f + 0.5f);
+            for (size_t i = 0; i < out.size(); ++i)
+                same &= out[i] == (i >= static_cast<size_t>(lat) * CH_ST ? sweep[i - static_cast<size_t>(lat) * CH_ST] : 0.0f);
+            const std::string name = "limiter below threshold is a pure " + std::to_string(lat) + "-frame delay";
+            check(same, name.c_str());
+            dsp_destroy_context(ctx);
+        }
+
+        // 2) 砖墙
+        {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_gain(ctx, 4.0f);
+            dsp_set_limiter_params(ctx, 0.5f, 1.5f, 50.0f, 0);
+            run(ctx, sweep, out);
+            float peak = 0.0f;
+            for (float v : out)
+                peak = std::max(peak, std::fabs(v));
+            std::cout << "[INFO] limiter +12dB sweep, threshold 0.5: output peak=" << peak << "\n";
+            check(peak <= 0.5f * 1.000001f && peak > 0.49f, "limiter output never exceeds threshold");
+            dsp_destroy_context(ctx);
+        }
+
+        // 3) 通道联动：左声道响、右声道安静
+        {
+            std::vector<float> in(static_cast<size_t>(SR48k / 2) * CH_ST);
+            for (size_t n = 0; n < in.size() / CH_ST; ++n)
+            {
+                const float t = static_cast<float>(n) / SR48k;
+                in[n * CH_ST + 0] = 1.5f * std::sin(2.0f * 3.14159265f * 220.0f * t) * (n > SR48k / 8 ? 1.0f : 0.1f);
+                in[n * CH_ST + 1] = 0.1f * std::sin(2.0f * 3.14159265f * 1330.0f * t);
+            }
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            const size_t lat = dsp_get_latency_frames(ctx);
+            run(ctx, in, out);
+            float maxDiff = 0.0f, minR = 1.0f;
+            for (size_t n = lat; n < in.size() / CH_ST; ++n)
+            {
+                const float *x = &in[(n - lat) * CH_ST];
+                const float *y = &out[n * CH_ST];
+                if (std::fabs(x[0]) < 1e-2f || std::fabs(x[1]) < 1e-2f)
+                    continue;
+                const float gl = y[0] / x[0], gr = y[1] / x[1];
+                maxDiff = std::max(maxDiff, std::fabs(gl - gr));
+                minR = std::min(minR, gr);
+            }
+            check(maxDiff < 1e-4f && minR < 0.75f, "limiter gain is linked across channels");
+            dsp_destroy_context(ctx);
+        }
+
+        // 4) 真峰值
+        {
+            std::vector<float> in(static_cast<size_t>(SR48k / 4) * CH_ST);
+            for (size_t n = 0; n < in.size() / CH_ST; ++n)
+                for (uint32_t ch = 0; ch < CH_ST; ++ch)
+                    in[n * CH_ST + ch] = std::sin(1.57079633f * static_cast<float>(n) + 0.78539816f);
+            float peak[2];
+            unsigned lat[2];
+            for (int tp = 0; tp < 2; ++tp)
+            {
+                void *ctx = dsp_create_context(SR48k, CH_ST);
+                dsp_set_limiter_params(ctx, 0.5f, 1.5f, 50.0f, tp);
+                lat[tp] = dsp_get_latency_frames(ctx);
+                run(ctx, in, out);
+                peak[tp] = 0.0f;
+                for (size_t i = out.size() / 2; i < out.size(); ++i)
+                    peak[tp] = std::max(peak[tp], std::fabs(out[i]));
+                dsp_destroy_context(ctx);
+            }
+            std::cout << "[INFO] fs/4 sine (true peak 1.0, sample peak 0.707), threshold 0.5: sample-peak mode " << peak[0]
+                      << ", true-peak mode " << peak[1] << " (true peak ~" << peak[1] * 1.41421356f << ")\n";
+            check(peak[0] > 0.49f && peak[1] < 0.5f * 0.7071f * 1.03f && lat[1] == lat[0] + 4,
+                  "limiter true-peak mode limits inter-sample peaks (+4 frames latency)");
+        }
+
+        // 5) 软限幅模式
+        {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_limiter_mode(ctx, DSP_LIMITER_SOFTCLIP);
+            run(ctx, sweep, out);
+            bool ok = dsp_get_latency_frames(ctx) == 0;
+            for (size_t i = 0; i < out.size(); ++i)
+                ok &= std::fabs(out[i] - std::tanh(1.5f * sweep[i])) < 1e-6f;
+            check(ok, "limiter softclip mode: tanh, zero latency");
+            dsp_destroy_context(ctx);
+        }
+
+        // 6) 前瞻长度不影响每样本开销
+        {
+            std::vector<float> loud, o;
+            gen_log_sweep(loud, SR48k, CH_ST, 2.0f, 50.0f, 18000.0f, 0.9f);
+            double t[2];
+            const float ms[2] = {0.5f, 10.0f};
+            for (int i = 0; i < 2; ++i)
+            {
+                void *ctx = dsp_create_context(SR48k, CH_ST);
+                dsp_set_gain(ctx, 2.0f);
+                dsp_set_limiter_params(ctx, 0.5f, ms[i], 50.0f, 0);
+                run(ctx, loud, o);
+                auto t0 = std::chrono::high_resolution_clock::now();
+                for (int r = 0; r < 3; ++r)
+                    run(ctx, loud, o);
+                t[i] = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+                dsp_destroy_context(ctx);
+            }
+            std::cout << "[INFO] limiter 6s stereo: lookahead 0.5ms " << (t[0] * 1e3) << " ms, 10ms " << (t[1] * 1e3) << " ms\n";
+        }
+
+        // 7) 控制面：MyLimiter 经线格式增量下发，ParamsApply 生效后延迟随之改变；全 0 的旧参数用默认值
+        {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            MyDspParams a{}, b{};
+            a.gain = 1.0f;
+            a.limiterEnabled = 1;
+            ParamsApply(ctx, nullptr, a, nullptr);
+            const unsigned latDefault = dsp_get_latency_frames(ctx);
+            b = a;
+            b.limiter.threshold = 0.5f;
+            b.limiter.lookahead_ms = 5.0f;
+            b.limiter.release_ms = 100.0f;
+            b.limiter.truePeak = 1;
+            uint8_t msg[PARAMS_WIRE_MAX_BYTES];
+            const uint32_t bytes = ParamsWireEncodeDelta(&a, b, msg, sizeof(msg));
+            MyDspParams dec = a;
+            uint32_t records = 0;
+            const bool wireOk = ParamsWireDecode(msg, bytes, dec, &records) == kWireOk && records == 1 &&
+                                memcmp(&dec, &b, sizeof(b)) == 0;
+            const uint32_t mask = ParamsApply(ctx, &a, dec, nullptr);
+            check(wireOk && mask == kParamsChangedLimiter && latDefault == 72 && dsp_get_latency_frames(ctx) == 240 + 4,
+                  "limiter params travel as one wire record and set the reported latency");
+            dsp_destroy_context(ctx);
+        }
+    }
+
+    // -------------------------
+    // 用例 X：快速数学函数（dsp_fastmath.h）的精度与吞吐
+    // 目标：1) 逐点扫描各函数的定义域，最大误差不超过头文件里写明的上限（参考值用 double 版 libm）；
+    //       2) 各指令集的数组版本与标量版本逐位一致；
+    //       3) 吞吐：libm(float) / 快速标量 / 数组版本各跑 1M 个值，打印每个值的耗时。
+    // -------------------------
+    {
+        auto sweep = [](float lo, float hi, size_t n) {
+            std::vector<float> v(n);
+            for (size_t i = 0; i < n; ++i)
+                v[i] = static_cast<float>(lo + (static_cast<double>(hi) - lo) * static_cast<double>(i) / static_cast<double>(n - 1));
+            return v;
+        };
+        const std::vector<float> xe = sweep(-126.0f, 126.0f, 1000003), xd = sweep(-120.0f, 120.0f, 1000003),
+                                 xt = sweep(-12.0f, 12.0f, 1000003), xs = sweep(-100.0f, 100.0f, 1000003);
+
+        // 1) 精度
+        double eExp = 0, eDb = 0, eTanhAbs = 0, eTanhRel = 0, eSin = 0, eCos = 0;
+        for (float x : xe)
+        {
+            const double r = std::exp2(static_cast<double>(x));
+            eExp = std::max(eExp, std::fabs(dsp_fast_exp2f(x) - r) / r);
+        }
+        for (float x : xd)
+        {
+            const double r = std::pow(10.0, static_cast<double>(x) / 20.0);
+            eDb = std::max(eDb, std::fabs(dsp_fast_db_to_linear(x) - r) / r);
+        }
+        for (float x : xt)
+        {
+            const double r = std::tanh(static_cast<double>(x)), e = std::fabs(dsp_fast_tanhf(x) - r);
+            eTanhAbs = std::max(eTanhAbs, e);
+            if (r != 0.0)
+                eTanhRel = std::max(eTanhRel, e / std::fabs(r));
+        }
+        for (float x : {1e-30f, 1e-12f, 1e-6f, -3e-4f}) // 小信号：相对精度
+            eTanhRel = std::max(eTanhRel, std::fabs(dsp_fast_tanhf(x) - std::tanh(static_cast<double>(x))) / std::fabs(static_cast<double>(x)));
+        for (float x : xs)
+        {
+            float s, c;
+            dsp_fast_sincosf(x, &s, &c);
+            eSin = std::max(eSin, std::fabs(s - std::sin(static_cast<double>(x))));
+            eCos = std::max(eCos, std::fabs(c - std::cos(static_cast<double>(x))));
+        }
+        std::cout << "[INFO] fastmath max error: exp2 rel=" << eExp << " db_to_linear rel=" << eDb
+                  << " tanh abs=" << eTanhAbs << " rel=" << eTanhRel << " sin abs=" << eSin << " cos abs=" << eCos << "\n";
+        check(eExp < 3e-7, "fastmath exp2 relative error < 3e-7 on [-126,126]");
+        check(eDb < 1.2e-6, "fastmath db_to_linear relative error < 1.2e-6 on [-120,120] dB");
+        check(eTanhAbs < 1.5e-7 && eTanhRel < 2.5e-7, "fastmath tanh abs error < 1.5e-7, rel < 2.5e-7");
+        check(eSin < 1e-7 && eCos < 1e-7, "fastmath sincos abs error < 1e-7 on [-100,100]");
+
+        // 2) 数组版本与标量逐位一致（含尾巴：长度不是向量宽度的倍数）
+        const DspVecMath *ref = dsp_fastmath_vec(DSP_SIMD_SCALAR);
+        const DSP_SIMD_LEVEL levels[] = {DSP_SIMD_SSE2, DSP_SIMD_AVX2, DSP_SIMD_NEON};
+        std::vector<float> a(xs.size()), b(xs.size()), a2(xs.size()), b2(xs.size());
+        for (DSP_SIMD_LEVEL lv : levels)
+        {
+            const DspVecMath *vm = dsp_fastmath_vec(lv);
+            if (!vm)
+                continue;
+            bool same = true;
+            ref->exp2(xe.data(), a.data(), xe.size());
+            vm->exp2(xe.data(), b.data(), xe.size());
+            same &= memcmp(a.data(), b.data(), xe.size() * sizeof(float)) == 0;
+            ref->db_to_linear(xd.data(), a.data(), xd.size());
+            vm->db_to_linear(xd.data(), b.data(), xd.size());
+            same &= memcmp(a.data(), b.data(), xd.size() * sizeof(float)) == 0;
+            ref->tanh(xt.data(), a.data(), xt.size());
+            vm->tanh(xt.data(), b.data(), xt.size());
+            same &= memcmp(a.data(), b.data(), xt.size() * sizeof(float)) == 0;
+            ref->sincos(xs.data(), a.data(), a2.data(), xs.size());
+            vm->sincos(xs.data(), b.data(), b2.data(), xs.size());
+            same &= memcmp(a.data(), b.data(), xs.size() * sizeof(float)) == 0 &&
+                    memcmp(a2.data(), b2.data(), xs.size() * sizeof(float)) == 0;
+            const std::string name = std::string("fastmath ") + simd_name(lv) + " arrays bit-exact vs scalar";
+            check(same, name.c_str());
+        }
+
+        // 3) 吞吐（ns/值）
+        const size_t N = 1u << 20;
+        const std::vector<float> in = sweep(-8.0f, 8.0f, N);
+        std::vector<float> o1(N), o2(N);
+        volatile float sink = 0.0f;
+        auto bench = [&](auto &&fn) {
+            fn(); // 预热
+            const auto t0 = clock_type::now();
+            for (int r = 0; r < 5; ++r)
+                fn();
+            sink = sink + o1[N / 3] + o2[N / 7];
+            return std::chrono::duration<double>(clock_type::now() - t0).count() * 1e9 / (5.0 * N);
+        };
+        DSP_SIMD_LEVEL bestLv = DSP_SIMD_SCALAR;
+        for (DSP_SIMD_LEVEL lv : {DSP_SIMD_SSE2, DSP_SIMD_NEON, DSP_SIMD_AVX2})
+            if (dsp_fastmath_vec(lv))
+                bestLv = lv;
+        const DspVecMath *best = dsp_fastmath_vec(bestLv);
+        struct Row
+        {
+            const char *name;
+            double libm, fast, vec;
+        } rows[] = {
+            {"exp2", bench([&] { for (size_t i = 0; i < N; ++i) o1[i] = std::exp2(in[i]); }),
+             bench([&] { ref->exp2(in.data(), o1.data(), N); }), bench([&] { best->exp2(in.data(), o1.data(), N); })},
+            {"db_to_linear", bench([&] { for (size_t i = 0; i < N; ++i) o1[i] = std::pow(10.0f, in[i] * 0.05f); }),
+             bench([&] { ref->db_to_linear(in.data(), o1.data(), N); }), bench([&] { best->db_to_linear(in.data(), o1.data(), N); })},
+            {"tanh", bench([&] { for (size_t i = 0; i < N; ++i) o1[i] = std::tanh(in[i]); }),
+             bench([&] { ref->tanh(in.data(), o1.data(), N); }), bench([&] { best->tanh(in.data(), o1.data(), N); })},
+            {"sincos", bench([&] { for (size_t i = 0; i < N; ++i) { o1[i] = std::sin(in[i]); o2[i] = std::cos(in[i]); } }),
+             bench([&] { ref->sincos(in.data(), o1.data(), o2.data(), N); }), bench([&] { best->sincos(in.data(), o1.data(), o2.data(), N); })},
+        };
+        for (const Row &r : rows)
+            std::cout << "[INFO] fastmath " << r.name << ": libm " << r.libm << " ns, fast scalar " << r.fast << " ns, "
+                      << simd_name(bestLv) << " " << r.vec << " ns (per value)\n";
+    }
+
+    // -------------------------
+    // 用例 Y：均匀分块 FFT 卷积（房间校正 FIR）
+    // 目标：1) 与直接型 FIR（double 累加）对比：两声道各自的 IR（6000 抽头），分块 64 / 256，宿主块 480 帧；
+    //       2) 延迟 = 分块长度（dsp_get_latency_frames 与限幅器前瞻相加）；单位冲激 IR 就是纯延迟；
+    //       3) 各指令集的频域乘加内核输出逐位一致；
+    //       4) 运行中换 IR（分块长度相同）：接上输入历史，切换点之前与旧 IR、之后与一开始就用新 IR 的输出逐位相同；
+    //       5) 另一线程反复载入/卸载 IR、开关卷积级，同时持续处理；
+    //       6) 吞吐：IR 1k / 8k / 48k 抽头时每块耗时，与直接型 FIR 对比。
+    // -------------------------
+    {
+        const uint32_t B = 480;
+        auto run = [&](void *ctx, const float *in, float *out, size_t frames) {
+            for (size_t done = 0; done < frames; done += B)
+            {
+                const uint32_t n = static_cast<uint32_t>(std::min<size_t>(B, frames - done));
+                dsp_process_block(ctx, in + done * CH_ST, out + done * CH_ST, n, CH_ST);
+            }
+        };
+        auto make_ctx = [&]() {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_limiter_enabled(ctx, 0);
+            return ctx;
+        };
+        // 指数衰减的伪随机 IR（平面排布，rows 条）
+        auto make_ir = [](size_t taps, unsigned rows, uint32_t seed) {
+            std::vector<float> h(taps * rows);
+            uint32_t s = seed;
+            for (size_t i = 0; i < h.size(); ++i)
+            {
+                s = s * 1664525u + 1013904223u;
+                const float u = static_cast<float>(s >> 8) / 16777216.0f * 2.0f - 1.0f;
+                h[i] = u * std::exp(-4.0f * static_cast<float>(i % taps) / static_cast<float>(taps)) * 0.05f;
+            }
+            return h;
+        };
+        std::vector<float> sweep, out;
+        gen_log_sweep(sweep, SR48k, CH_ST, 0.5f, 50.0f, 18000.0f, 0.5f);
+        const size_t frames = sweep.size() / CH_ST;
+        out.resize(sweep.size());
+
+        // 1) 精度
+        {
+            const size_t taps = 6000;
+            const std::vector<float> ir = make_ir(taps, CH_ST, 1);
+            std::vector<double> ref(sweep.size(), 0.0);
+            double peak = 0.0;
+            for (uint16_t c = 0; c < CH_ST; ++c)
+                for (size_t n = 0; n < frames; ++n)
+                {
+                    double acc = 0.0;
+                    for (size_t k = 0; k <= std::min(n, taps - 1); ++k)
+                        acc += static_cast<double>(ir[c * taps + k]) * sweep[(n - k) * CH_ST + c];
+                    ref[n * CH_ST + c] = acc;
+                    peak = std::max(peak, std::fabs(acc));
+                }
+            for (unsigned part : {64u, 256u})
+            {
+                void *ctx = make_ctx();
+                const bool loaded = dsp_set_conv_ir(ctx, ir.data(), taps, CH_ST, part) == 1;
+                const unsigned lat = dsp_get_latency_frames(ctx);
+                run(ctx, sweep.data(), out.data(), frames);
+                double err = 0.0;
+                bool silentHead = true;
+                for (size_t i = 0; i < out.size(); ++i)
+                {
+                    if (i < static_cast<size_t>(lat) * CH_ST)
+                        silentHead &= out[i] == 0.0f;
+                    else
+                        err = std::max(err, std::fabs(out[i] - ref[i - static_cast<size_t>(lat) * CH_ST]));
+                }
+                std::cout << "[INFO] conv " << taps << " taps, partition " << part << ": max error " << err / peak
+                          << " (relative to output peak " << peak << ")\n";
+                const std::string name = "conv partition " + std::to_string(part) + " matches direct-form FIR (rel err < 1e-5)";
+                check(loaded && lat == part && silentHead && err < 1e-5 * peak, name.c_str());
+                dsp_destroy_context(ctx);
+            }
+        }
+
+        // 2) 延迟：单位冲激 IR = 纯延迟；与前瞻限幅器的延迟相加
+        {
+            void *ctx = make_ctx();
+            const float delta = 1.0f;
+            dsp_set_conv_ir(ctx, &delta, 1, 1, 128);
+            const unsigned lat = dsp_get_latency_frames(ctx);
+            run(ctx, sweep.data(), out.data(), frames);
+            double err = 0.0;
+            for (size_t i = static_cast<size_t>(lat) * CH_ST; i < out.size(); ++i)
+                err = std::max(err, static_cast<double>(std::fabs(out[i] - sweep[i - static_cast<size_t>(lat) * CH_ST])));
+            check(lat == 128 && err < 1e-6, "conv unit impulse is a pure partition-length delay");
+            dsp_set_limiter_enabled(ctx, 1);
+            check(dsp_get_latency_frames(ctx) == 128 + 72, "latency = conv partition + limiter lookahead");
+            dsp_set_conv_enabled(ctx, 0);
+            check(dsp_get_latency_frames(ctx) == 72, "disabled conv adds no latency");
+            dsp_set_conv_ir(ctx, nullptr, 0, 0, 0);
+            dsp_set_conv_enabled(ctx, 1);
+            check(dsp_get_latency_frames(ctx) == 72, "unloaded conv adds no latency");
+            dsp_destroy_context(ctx);
+        }
+
+        // 3) 各指令集逐位一致
+        {
+            const std::vector<float> ir = make_ir(3000, CH_ST, 5);
+            std::vector<float> ref(sweep.size());
+            void *ctx = make_ctx();
+            dsp_set_simd_level(ctx, DSP_SIMD_SCALAR);
+            dsp_set_conv_ir(ctx, ir.data(), 3000, CH_ST, 0);
+            run(ctx, sweep.data(), ref.data(), frames);
+            dsp_destroy_context(ctx);
+            for (DSP_SIMD_LEVEL lv : {DSP_SIMD_SSE2, DSP_SIMD_AVX2, DSP_SIMD_NEON})
+            {
+                ctx = make_ctx();
+                if (dsp_set_simd_level(ctx, lv))
+                {
+                    dsp_set_conv_ir(ctx, ir.data(), 3000, CH_ST, 0);
+                    run(ctx, sweep.data(), out.data(), frames);
+                    const std::string name = std::string("conv ") + simd_name(lv) + " bit-exact vs scalar";
+                    check(memcmp(out.data(), ref.data(), out.size() * sizeof(float)) == 0, name.c_str());
+                }
+                dsp_destroy_context(ctx);
+            }
+        }
+
+        // 4) 运行中换 IR：切换后的第一个分块边界起与“一开始就用新 IR”逐位相同，之前与旧 IR 相同
+        {
+            const size_t taps = 4000;
+            const unsigned part = 256;
+            const std::vector<float> irA = make_ir(taps, 1, 7), irB = make_ir(taps, 1, 8);
+            std::vector<float> refA(sweep.size()), refB(sweep.size());
+            void *ctx = make_ctx();
+            dsp_set_conv_ir(ctx, irA.data(), taps, 1, part);
+            run(ctx, sweep.data(), refA.data(), frames);
+            dsp_destroy_context(ctx);
+            ctx = make_ctx();
+            dsp_set_conv_ir(ctx, irB.data(), taps, 1, part);
+            run(ctx, sweep.data(), refB.data(), frames);
+            dsp_destroy_context(ctx);
+
+            const size_t F0 = 25 * B; // 换 IR 的位置（块边界，不在分块边界上）
+            const size_t s0 = (F0 / part + 1) * part;
+            ctx = make_ctx();
+            dsp_set_conv_ir(ctx, irA.data(), taps, 1, part);
+            run(ctx, sweep.data(), out.data(), F0);
+            dsp_set_conv_ir(ctx, irB.data(), taps, 1, part);
+            run(ctx, sweep.data() + F0 * CH_ST, out.data() + F0 * CH_ST, frames - F0);
+            dsp_destroy_context(ctx);
+            const bool before = memcmp(out.data(), refA.data(), s0 * CH_ST * sizeof(float)) == 0;
+            const bool after = memcmp(out.data() + s0 * CH_ST, refB.data() + s0 * CH_ST, (frames - s0) * CH_ST * sizeof(float)) == 0;
+            check(before && after, "conv IR swap keeps input history (no gap, bit-exact vs new IR from start)");
+        }
+
+        // 5) 并发：另一线程反复载入/卸载 IR、开关卷积级
+        {
+            void *ctx = make_ctx();
+            std::vector<float> irs[2] = {make_ir(2000, 1, 11), make_ir(2000, CH_ST, 12)};
+            std::atomic<bool> stop(false);
+            std::thread loader([&] {
+                for (int i = 0; !stop.load(); ++i)
+                {
+                    if (i % 7 == 6)
+                        dsp_set_conv_ir(ctx, nullptr, 0, 0, 0);
+                    else
+                        dsp_set_conv_ir(ctx, irs[i & 1].data(), 2000, (i & 1) ? CH_ST : 1, (i % 3) ? 256 : 128);
+                    if (i % 5 == 4)
+                        dsp_set_conv_enabled(ctx, (i / 5) & 1);
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            });
+            bool finite = true;
+            for (int r = 0; r < 20; ++r)
+            {
+                run(ctx, sweep.data(), out.data(), frames);
+                for (float v : out)
+                    finite &= std::isfinite(v);
+            }
+            stop = true;
+            loader.join();
+            check(finite, "conv concurrent IR loading while processing");
+            dsp_destroy_context(ctx);
+        }
+
+        // 6) 吞吐：分块 256，两声道各自的 IR；直接型 FIR（4 路累加）只跑一小段再按帧数折算
+        {
+            const size_t nFrames = 48000 * 2;
+            std::vector<float> noise(nFrames * CH_ST), o(nFrames * CH_ST);
+            uint32_t s = 99;
+            for (float &v : noise)
+            {
+                s = s * 1664525u + 1013904223u;
+                v = static_cast<float>(s >> 8) / 16777216.0f - 0.5f;
+            }
+            for (size_t taps : {1024u, 8192u, 48000u})
+            {
+                const std::vector<float> ir = make_ir(taps, CH_ST, 21);
+                void *ctx = make_ctx();
+                dsp_set_conv_ir(ctx, ir.data(), taps, CH_ST, 256);
+                run(ctx, noise.data(), o.data(), 48000); // 预热
+                const auto t0 = clock_type::now();
+                run(ctx, noise.data(), o.data(), nFrames);
+                const double convUs = std::chrono::duration<double>(clock_type::now() - t0).count() * 1e6 / (nFrames / B);
+                dsp_destroy_context(ctx);
+
+                const size_t dFrames = std::max<size_t>(B, std::min<size_t>(nFrames, 100000000 / taps));
+                volatile float sink = 0.0f;
+                const auto t1 = clock_type::now();
+                for (uint16_t c = 0; c < CH_ST; ++c)
+                    for (size_t n = taps; n < taps + dFrames && n < nFrames; ++n)
+                    {
+                        const float *h = ir.data() + c * taps;
+                        float a0 = 0.0f, a1 = 0.0f, a2 = 0.0f, a3 = 0.0f;
+                        size_t k = 0;
+                        for (; k + 4 <= taps; k += 4)
+                        {
+                            a0 += h[k] * noise[(n - k) * CH_ST + c];
+                            a1 += h[k + 1] * noise[(n - k - 1) * CH_ST + c];
+                            a2 += h[k + 2] * noise[(n - k - 2) * CH_ST + c];
+                            a3 += h[k + 3] * noise[(n - k - 3) * CH_ST + c];
+                        }
+                        sink = sink + (a0 + a1) + (a2 + a3);
+                    }
+                const size_t ran = std::min(dFrames, nFrames - taps);
+                const double directUs = std::chrono::duration<double>(clock_type::now() - t1).count() * 1e6 / (static_cast<double>(ran) / B);
+                std::cout << "[INFO] conv " << taps << " taps x" << CH_ST << "ch: partitioned FFT " << convUs
+                          << " us/block(480), direct-form " << directUs << " us/block (x" << directUs / convUs << ")\n";
+                if (taps == 48000)
+                    check(directUs > 5.0 * convUs, "conv 48k-tap IR at least 5x cheaper than direct form");
+            }
+        }
+    }
+
+    // -------------------------
+    // 用例 Z：IR 混响（非均匀分块卷积：直接型头部 + 实时线程小分块 + 后台线程大分块）
+    // 目标：1) wet=1 时与直接型 FIR（double 累加）对比，零延迟；两声道各自的 IR（12000 抽头，三段都用到），宿主块 480 / 97 帧；
+    //       2) 单位冲激 IR = 直通（逐位相同），冲激落在尾部段（5000 帧）= 纯延迟；不增加链路延迟；
+    //       3) wet=0.25 时按 0.75·干 + 0.25·湿 混合；
+    //       4) 各指令集逐位一致（后台线程用的也是当前指令集的乘加内核）；
+    //       5) 运行中换 IR：切换点之前与旧 IR、两个尾部分块之后与一开始就用新 IR 的输出逐位相同；
+    //       6) 另一线程反复载入/卸载 IR、切换算法、开关混响，同时持续处理；
+    //       7) 3 秒 IR 按实时节奏（每块 10ms）运行：每次回调的耗时、实时线程等后台线程的次数。
+    // -------------------------
+    {
+        const uint32_t B = 480;
+        auto run = [&](void *ctx, const float *in, float *out, size_t frames, uint32_t blk) {
+            for (size_t done = 0; done < frames; done += blk)
+            {
+                const uint32_t n = static_cast<uint32_t>(std::min<size_t>(blk, frames - done));
+                dsp_process_block(ctx, in + done * CH_ST, out + done * CH_ST, n, CH_ST);
+            }
+        };
+        auto make_ctx = [&](float wet) {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_limiter_enabled(ctx, 0);
+            dsp_set_smoothing_ms(ctx, 0.0f);
+            dsp_set_reverb_type(ctx, DSP_REVERB_IR);
+            dsp_set_reverb_params(ctx, wet, 0.7f, 0.3f, 20.0f);
+            dsp_set_reverb_enabled(ctx, 1);
+            return ctx;
+        };
+        // 指数衰减的伪随机 IR（平面排布，rows 条）
+        auto make_ir = [](size_t taps, unsigned rows, uint32_t seed) {
+            std::vector<float> h(taps * rows);
+            uint32_t s = seed;
+            for (size_t i = 0; i < h.size(); ++i)
+            {
+                s = s * 1664525u + 1013904223u;
+                const float u = static_cast<float>(s >> 8) / 16777216.0f * 2.0f - 1.0f;
+                h[i] = u * std::exp(-4.0f * static_cast<float>(i % taps) / static_cast<float>(taps)) * 0.05f;
+            }
+            return h;
+        };
+        std::vector<float> sweep, out;
+        gen_log_sweep(sweep, SR48k, CH_ST, 0.5f, 50.0f, 18000.0f, 0.5f);
+        const size_t frames = sweep.size() / CH_ST;
+        out.resize(sweep.size());
+
+        // 1) + 3) 精度 / 湿度混合
+        {
+            const size_t taps = 12000;
+            const std::vector<float> ir = make_ir(taps, CH_ST, 31);
+            std::vector<double> ref(sweep.size(), 0.0);
+            double peak = 0.0;
+            for (uint16_t c = 0; c < CH_ST; ++c)
+                for (size_t n = 0; n < frames; ++n)
+                {
+                    double acc = 0.0;
+                    for (size_t k = 0; k <= std::min(n, taps - 1); ++k)
+                        acc += static_cast<double>(ir[c * taps + k]) * sweep[(n - k) * CH_ST + c];
+                    ref[n * CH_ST + c] = acc;
+                    peak = std::max(peak, std::fabs(acc));
+                }
+            for (uint32_t blk : {B, 97u})
+            {
+                void *ctx = make_ctx(1.0f);
+                const bool loaded = dsp_set_reverb_ir(ctx, ir.data(), taps, CH_ST) == 1;
+                const unsigned lat = dsp_get_latency_frames(ctx);
+                run(ctx, sweep.data(), out.data(), frames, blk);
+                double err = 0.0;
+                for (size_t i = 0; i < out.size(); ++i)
+                    err = std::max(err, std::fabs(out[i] - ref[i]));
+                std::cout << "[INFO] IR reverb " << taps << " taps, block " << blk << ": max error " << err / peak
+                          << " (relative to output peak " << peak << ")\n";
+                const std::string name = "IR reverb (block " + std::to_string(blk) + ") matches direct-form FIR with zero latency";
+                check(loaded && lat == 0 && err < 1e-5 * peak, name.c_str());
+                dsp_destroy_context(ctx);
+            }
+            {
+                void *ctx = make_ctx(0.25f);
+                dsp_set_reverb_ir(ctx, ir.data(), taps, CH_ST);
+                run(ctx, sweep.data(), out.data(), frames, B);
+                double err = 0.0;
+                for (size_t i = 0; i < out.size(); ++i)
+                    err = std::max(err, std::fabs(out[i] - (0.75 * sweep[i] + 0.25 * ref[i])));
+                check(err < 1e-5 * peak + 1e-6, "IR reverb wet 0.25 mixes 0.75 dry + 0.25 convolved");
+                dsp_destroy_context(ctx);
+            }
+        }
+
+        // 2) 单位冲激：落在头部 = 直通，落在尾部段 = 纯延迟
+        {
+            void *ctx = make_ctx(1.0f);
+            const float delta = 1.0f;
+            dsp_set_reverb_ir(ctx, &delta, 1, 1);
+            run(ctx, sweep.data(), out.data(), frames, B);
+            check(memcmp(out.data(), sweep.data(), out.size() * sizeof(float)) == 0, "IR reverb unit impulse at 0 is bit-exact passthrough");
+            dsp_destroy_context(ctx);
+
+            const size_t D = 5000;
+            std::vector<float> ir(D + 1, 0.0f);
+            ir[D] = 1.0f;
+            ctx = make_ctx(1.0f);
+            dsp_set_reverb_ir(ctx, ir.data(), ir.size(), 1);
+            run(ctx, sweep.data(), out.data(), frames, B);
+            double err = 0.0;
+            for (size_t i = 0; i < out.size(); ++i)
+                err = std::max(err, static_cast<double>(std::fabs(out[i] - (i >= D * CH_ST ? sweep[i - D * CH_ST] : 0.0f))));
+            check(err < 1e-6 && dsp_get_latency_frames(ctx) == 0, "IR reverb impulse in the worker tail segment is an exact delay");
+            dsp_destroy_context(ctx);
+        }
+
+        // 4) 各指令集逐位一致
+        {
+            const std::vector<float> ir = make_ir(9000, CH_ST, 33);
+            std::vector<float> ref(sweep.size());
+            void *ctx = make_ctx(0.5f);
+            dsp_set_simd_level(ctx, DSP_SIMD_SCALAR);
+            dsp_set_reverb_ir(ctx, ir.data(), 9000, CH_ST);
+            run(ctx, sweep.data(), ref.data(), frames, B);
+            dsp_destroy_context(ctx);
+            for (DSP_SIMD_LEVEL lv : {DSP_SIMD_SSE2, DSP_SIMD_AVX2, DSP_SIMD_NEON})
+            {
+                ctx = make_ctx(0.5f);
+                if (dsp_set_simd_level(ctx, lv))
+                {
+                    dsp_set_reverb_ir(ctx, ir.data(), 9000, CH_ST);
+                    run(ctx, sweep.data(), out.data(), frames, B);
+                    const std::string name = std::string("IR reverb ") + simd_name(lv) + " bit-exact vs scalar";
+                    check(memcmp(out.data(), ref.data(), out.size() * sizeof(float)) == 0, name.c_str());
+                }
+                dsp_destroy_context(ctx);
+            }
+        }
+
+        // 5) 运行中换 IR：尾部还有一块按旧 IR 算好的输出、一块在后台线程上，之后与新 IR 逐位相同
+        {
+            const size_t taps = 8000;
+            const std::vector<float> irA = make_ir(taps, 1, 41), irB = make_ir(taps, 1, 42);
+            std::vector<float> refA(sweep.size()), refB(sweep.size());
+            void *ctx = make_ctx(1.0f);
+            dsp_set_reverb_ir(ctx, irA.data(), taps, 1);
+            run(ctx, sweep.data(), refA.data(), frames, B);
+            dsp_destroy_context(ctx);
+            ctx = make_ctx(1.0f);
+            dsp_set_reverb_ir(ctx, irB.data(), taps, 1);
+            run(ctx, sweep.data(), refB.data(), frames, B);
+            dsp_destroy_context(ctx);
+
+            const size_t F0 = 25 * B;
+            const size_t s0 = (F0 / 1024 + 2) * 1024;
+            ctx = make_ctx(1.0f);
+            dsp_set_reverb_ir(ctx, irA.data(), taps, 1);
+            run(ctx, sweep.data(), out.data(), F0, B);
+            dsp_set_reverb_ir(ctx, irB.data(), taps, 1);
+            run(ctx, sweep.data() + F0 * CH_ST, out.data() + F0 * CH_ST, frames - F0, B);
+            dsp_destroy_context(ctx);
+            const bool before = memcmp(out.data(), refA.data(), F0 * CH_ST * sizeof(float)) == 0;
+            const bool after = memcmp(out.data() + s0 * CH_ST, refB.data() + s0 * CH_ST, (frames - s0) * CH_ST * sizeof(float)) == 0;
+            check(before && after, "IR reverb swap keeps input history (bit-exact vs new IR after two tail partitions)");
+        }
+
+        // 6) 并发：另一线程反复载入/卸载 IR、切换算法、开关混响
+        {
+            void *ctx = make_ctx(0.5f);
+            std::vector<float> irs[2] = {make_ir(30000, 1, 51), make_ir(1500, CH_ST, 52)};
+            std::atomic<bool> stop(false);
+            std::thread loader([&] {
+                for (int i = 0; !stop.load(); ++i)
+                {
+                    if (i % 7 == 6)
+                        dsp_set_reverb_ir(ctx, nullptr, 0, 0);
+                    else
+                        dsp_set_reverb_ir(ctx, irs[i & 1].data(), (i & 1) ? 1500 : 30000, (i & 1) ? CH_ST : 1);
+                    if (i % 5 == 4)
+                        dsp_set_reverb_type(ctx, ((i / 5) & 1) ? DSP_REVERB_SCHROEDER : DSP_REVERB_IR);
+                    if (i % 11 == 10)
+                        dsp_set_reverb_enabled(ctx, (i / 11) & 1);
+                    std::this_thread::sleep_for(std::chrono::microseconds(300));
+                }
+            });
+            bool finite = true;
+            for (int r = 0; r < 10; ++r)
+            {
+                run(ctx, sweep.data(), out.data(), frames, B);
+                for (float v : out)
+                    finite &= std::isfinite(v);
+            }
+            stop = true;
+            loader.join();
+            check(finite, "IR reverb concurrent IR loading / type switching while processing");
+            dsp_destroy_context(ctx);
+        }
+
+        // 7) 3 秒 IR，两声道：按实时节奏跑 1 秒，看每次回调的耗时；再不限速跑一遍作对比（此时实时线程要等后台线程）
+        {
+            const size_t taps = 48000 * 3;
+            const std::vector<float> ir = make_ir(taps, CH_ST, 61);
+            std::vector<float> noise(48000 * CH_ST), o(noise.size());
+            uint32_t s = 77;
+            for (float &v : noise)
+            {
+                s = s * 1664525u + 1013904223u;
+                v = static_cast<float>(s >> 8) / 16777216.0f - 0.5f;
+            }
+            void *ctx = make_ctx(0.3f);
+            dsp_set_reverb_ir(ctx, ir.data(), taps, CH_ST);
+            run(ctx, noise.data(), o.data(), 48000, B); // 预热
+            dsp_reset_stats(ctx);
+            const size_t nBlocks = 48000 / B;
+            double sumUs = 0.0, maxUs = 0.0;
+            auto deadline = clock_type::now();
+            for (size_t b = 0; b < nBlocks; ++b)
+            {
+                const auto t0 = clock_type::now();
+                dsp_process_block(ctx, noise.data() + b * B * CH_ST, o.data() + b * B * CH_ST, B, CH_ST);
+                const double us = std::chrono::duration<double>(clock_type::now() - t0).count() * 1e6;
+                sumUs += us;
+                maxUs = std::max(maxUs, us);
+                deadline += std::chrono::microseconds(10000);
+                std::this_thread::sleep_until(deadline);
+            }
+            DSP_STATS st;
+            const bool haveStats = dsp_get_stats(ctx, &st) == 1;
+            const auto t1 = clock_type::now();
+            run(ctx, noise.data(), o.data(), 48000, B);
+            const double offUs = std::chrono::duration<double>(clock_type::now() - t1).count() * 1e6 / nBlocks;
+            std::cout << "[INFO] IR reverb " << taps << " taps x" << CH_ST << "ch, real-time pacing: avg " << sumUs / nBlocks
+                      << " us/block(480), max " << maxUs << " us, RT waits for worker "
+                      << (haveStats ? std::to_string(st.reverb_tail_waits) : std::string("n/a"))
+                      << "; unpaced (RT waits for the worker) " << offUs << " us/block\n";
+            check(maxUs < 10000.0, "IR reverb 3 s IR: every real-time callback finishes within its 10 ms period");
+            dsp_destroy_context(ctx);
+        }
+    }
+
+    // -------------------------
+    // 用例 AA：FDN 混响（8 线反馈延迟网络，Hadamard 混合，一阶低通阻尼）
+    // 目标：1) 冲激响应按 room_size 映射的 RT60 衰减（damp=0 时由能量衰减斜率估计，误差 < 20%）；
+    //       2) damp 真正起作用：尾部高频能量占比随 damp 下降；
+    //       3) 两声道输入相同，湿声几乎不相关（两声道共用一个 FDN，两路输出抽头符号正交）；
+    //       4) 各指令集逐位一致；
+    //       5) 运行中在 Schroeder / FDN / IR 之间切换；
+    //       6) 每通道代价：与 Schroeder 对比，2 / 8 声道；立体声时不超过 Schroeder 的 2 倍。
+    // -------------------------
+    {
+        const uint32_t B = 480;
+        auto make_ctx = [&](unsigned ch, DSP_REVERB_TYPE type, float room, float damp) {
+            void *ctx = dsp_create_context(SR48k, ch);
+            dsp_set_limiter_enabled(ctx, 0);
+            dsp_set_smoothing_ms(ctx, 0.0f);
+            dsp_set_reverb_type(ctx, type);
+            dsp_set_reverb_params(ctx, 1.0f, room, damp, 0.0f);
+            dsp_set_reverb_enabled(ctx, 1);
+            return ctx;
+        };
+        auto run = [&](void *ctx, const float *in, float *out, size_t frames, unsigned ch) {
+            for (size_t done = 0; done < frames; done += B)
+            {
+                const uint32_t n = static_cast<uint32_t>(std::min<size_t>(B, frames - done));
+                dsp_process_block(ctx, in + done * ch, out + done * ch, n, ch);
+            }
+        };
+        // 两声道冲激响应（3 秒）
+        auto impulse_response = [&](float room, float damp) {
+            const size_t N = SR48k * 3;
+            std::vector<float> in(N * CH_ST, 0.0f), out(N * CH_ST);
+            in[0] = in[1] = 1.0f;
+            void *ctx = make_ctx(CH_ST, DSP_REVERB_FDN, room, damp);
+            run(ctx, in.data(), out.data(), N, CH_ST);
+            dsp_destroy_context(ctx);
+            return out;
+        };
+        auto energy = [](const std::vector<float> &x, size_t ch, size_t a, size_t b) {
+            double e = 0.0;
+            for (size_t n = a; n < b; ++n)
+                e += static_cast<double>(x[n * CH_ST + ch]) * x[n * CH_ST + ch];
+            return e;
+        };
+
+        // 1) RT60：0.2s~0.4s 与 0.8s~1.0s 两段能量之差换算成斜率
+        for (float room : {0.5f, 0.8f})
+        {
+            const std::vector<float> ir = impulse_response(room, 0.0f);
+            const double e1 = energy(ir, 0, SR48k / 5, SR48k * 2 / 5), e2 = energy(ir, 0, SR48k * 4 / 5, SR48k);
+            const double slope = 10.0 * std::log10(e1 / e2) / 0.6; // dB/s
+            const double t60 = 60.0 / slope, expect = 0.2 + 2.8 * room * room;
+            std::cout << "[INFO] FDN room " << room << ": measured T60 " << t60 << " s, expected " << expect << " s\n";
+            const std::string name = "FDN decay follows room_size (room " + std::to_string(room).substr(0, 3) + ")";
+            check(std::fabs(t60 - expect) < 0.2 * expect, name.c_str());
+        }
+
+        // 2) + 3) 阻尼与声道去相关
+        {
+            auto hf_ratio = [&](const std::vector<float> &x) {
+                double d = 0.0, e = 0.0;
+                for (size_t n = SR48k / 2 + 1; n < SR48k; ++n)
+                {
+                    const double v = x[n * CH_ST], dv = v - x[(n - 1) * CH_ST];
+                    d += dv * dv;
+                    e += v * v;
+                }
+                return d / e; // 一阶差分能量 / 总能量：高频占比越大越接近 2
+            };
+            const std::vector<float> ir0 = impulse_response(0.7f, 0.0f), ir7 = impulse_response(0.7f, 0.7f);
+            const double h0 = hf_ratio(ir0), h7 = hf_ratio(ir7);
+            std::cout << "[INFO] FDN tail HF ratio: damp 0 -> " << h0 << ", damp 0.7 -> " << h7 << "\n";
+            check(h7 < 0.5 * h0, "FDN damping lowpasses the tail");
+
+            double lr = 0.0;
+            for (size_t n = 0; n < ir0.size() / CH_ST; ++n)
+                lr += static_cast<double>(ir0[n * CH_ST]) * ir0[n * CH_ST + 1];
+            const double corr = lr / std::sqrt(energy(ir0, 0, 0, ir0.size() / CH_ST) * energy(ir0, 1, 0, ir0.size() / CH_ST));
+            std::cout << "[INFO] FDN L/R correlation " << corr << "\n";
+            check(std::fabs(corr) < 0.2, "FDN channels are decorrelated");
+        }
+
+        // 4) 各指令集逐位一致（带预延迟、湿度 0.4）
+        {
+            std::vector<float> sweep, ref, out;
+            gen_log_sweep(sweep, SR48k, CH_ST, 1.0f, 50.0f, 18000.0f, 0.5f);
+            const size_t frames = sweep.size() / CH_ST;
+            ref.resize(sweep.size());
+            out.resize(sweep.size());
+            void *ctx = make_ctx(CH_ST, DSP_REVERB_FDN, 0.8f, 0.4f);
+            dsp_set_reverb_params(ctx, 0.4f, 0.8f, 0.4f, 15.0f);
+            dsp_set_simd_level(ctx, DSP_SIMD_SCALAR);
+            run(ctx, sweep.data(), ref.data(), frames, CH_ST);
+            dsp_destroy_context(ctx);
+            for (DSP_SIMD_LEVEL lv : {DSP_SIMD_SSE2, DSP_SIMD_AVX2, DSP_SIMD_NEON})
+            {
+                ctx = make_ctx(CH_ST, DSP_REVERB_FDN, 0.8f, 0.4f);
+                dsp_set_reverb_params(ctx, 0.4f, 0.8f, 0.4f, 15.0f);
+                if (dsp_set_simd_level(ctx, lv))
+                {
+                    run(ctx, sweep.data(), out.data(), frames, CH_ST);
+                    const std::string name = std::string("FDN ") + simd_name(lv) + " bit-exact vs scalar";
+                    check(memcmp(out.data(), ref.data(), out.size() * sizeof(float)) == 0, name.c_str());
+                }
+                dsp_destroy_context(ctx);
+            }
+
+            // 5) 运行中切换算法（带平滑）：每 10 块换一次，输出有限且一直有湿声
+            ctx = make_ctx(CH_ST, DSP_REVERB_SCHROEDER, 0.7f, 0.3f);
+            dsp_set_smoothing_ms(ctx, 10.0f);
+            dsp_set_reverb_params(ctx, 0.5f, 0.7f, 0.3f, 20.0f);
+            const float delta = 1.0f;
+            dsp_set_reverb_ir(ctx, &delta, 1, 1);
+            static const DSP_REVERB_TYPE order[] = {DSP_REVERB_FDN, DSP_REVERB_IR, DSP_REVERB_SCHROEDER};
+            bool finite = true;
+            for (size_t b = 0, k = 0; b * B < frames; ++b)
+            {
+                if (b % 10 == 9)
+                    dsp_set_reverb_type(ctx, order[k++ % 3]);
+                const uint32_t n = static_cast<uint32_t>(std::min<size_t>(B, frames - b * B));
+                dsp_process_block(ctx, sweep.data() + b * B * CH_ST, out.data() + b * B * CH_ST, n, CH_ST);
+            }
+            for (float v : out)
+                finite &= std::isfinite(v) && std::fabs(v) < 4.0f;
+            check(finite, "reverb type switches at runtime (Schroeder / FDN / IR)");
+            dsp_destroy_context(ctx);
+        }
+
+        // 6) 每通道代价：整条链（只开混响）减去关掉混响的同一条链，折算成每通道每样本
+        {
+            const size_t frames = SR48k * 2;
+            for (unsigned ch : {2u, 8u})
+            {
+                std::vector<float> in(frames * ch), out(in.size());
+                uint32_t s = 5;
+                for (float &v : in)
+                {
+                    s = s * 1664525u + 1013904223u;
+                    v = static_cast<float>(s >> 8) / 16777216.0f - 0.5f;
+                }
+                auto time_ns = [&](int type) {
+                    void *ctx = make_ctx(ch, type < 0 ? DSP_REVERB_SCHROEDER : static_cast<DSP_REVERB_TYPE>(type), 0.7f, 0.3f);
+                    if (type < 0)
+                        dsp_set_reverb_enabled(ctx, 0);
+                    run(ctx, in.data(), out.data(), frames / 4, ch); // 预热
+                    double best = 1e30;
+                    for (int r = 0; r < 3; ++r)
+                    {
+                        const auto t0 = clock_type::now();
+                        run(ctx, in.data(), out.data(), frames, ch);
+                        best = std::min(best, std::chrono::duration<double>(clock_type::now() - t0).count());
+                    }
+                    dsp_destroy_context(ctx);
+                    return best * 1e9 / (static_cast<double>(frames) * ch);
+                };
+                // 单核机器上计时抖动大：整组重测几次，有一次满足就算通过
+                bool met = false;
+                for (int attempt = 0; attempt < 5 && !met; ++attempt)
+                {
+                    const double base = time_ns(-1);
+                    const double schroeder = time_ns(DSP_REVERB_SCHROEDER) - base, fdn = time_ns(DSP_REVERB_FDN) - base;
+                    std::cout << "[INFO] reverb cost per channel-sample (" << ch << "ch): Schroeder " << schroeder
+                              << " ns, FDN(8 lines) " << fdn << " ns (x" << fdn / schroeder << ")\n";
+                    met = ch != 2 || fdn < 2.0 * schroeder;
+                }
+                if (ch == 2)
+                    check(met, "FDN (8 lines) costs at most 2x the 4-comb Schroeder per channel");
+            }
+        }
+    }
+
+    // -------------------------
+    // 用例 AB：混响发送总线（所有通道共用 1~2 路混响）
+    // 目标：1) 立体声时总线与逐通道结果逐位相同（Schroeder / FDN）；
+    //       2) 发送/返回电平：ret=0 的通道保持干声，没有送入的那一路总线没有湿声；
+    //       3) IR 混响走总线：δ 冲激 IR 下各通道湿声 = 同奇偶各通道之和；
+    //       4) 运行中切换路由输出正常；
+    //       5) 8 声道：只分配总线的实例内存远小于逐通道，混响代价与通道数基本无关。
+    // -------------------------
+    {
+        const uint32_t B = 480;
+        auto run = [&](void *ctx, const float *in, float *out, size_t frames, unsigned ch) {
+            for (size_t done = 0; done < frames; done += B)
+            {
+                const uint32_t n = static_cast<uint32_t>(std::min<size_t>(B, frames - done));
+                dsp_process_block(ctx, in + done * ch, out + done * ch, n, ch);
+            }
+        };
+        auto make_ctx = [&](unsigned ch, unsigned flags, DSP_REVERB_TYPE type, DSP_REVERB_ROUTING routing) {
+            void *ctx = dsp_create_context_ex(SR48k, ch, flags);
+            dsp_set_limiter_enabled(ctx, 0);
+            dsp_set_smoothing_ms(ctx, 0.0f);
+            dsp_set_reverb_type(ctx, type);
+            dsp_set_reverb_routing(ctx, routing);
+            dsp_set_reverb_params(ctx, 0.4f, 0.8f, 0.3f, 10.0f);
+            dsp_set_reverb_enabled(ctx, 1);
+            return ctx;
+        };
+        auto noise = [](std::vector<float> &v, uint32_t s) {
+            for (float &x : v)
+            {
+                s = s * 1664525u + 1013904223u;
+                x = static_cast<float>(s >> 8) / 16777216.0f - 0.5f;
+            }
+        };
+
+        // 1) 立体声：总线 = 逐通道
+        {
+            std::vector<float> sweep, a, b;
+            gen_log_sweep(sweep, SR48k, CH_ST, 0.5f, 50.0f, 18000.0f, 0.5f);
+            const size_t frames = sweep.size() / CH_ST;
+            a.resize(sweep.size());
+            b.resize(sweep.size());
+            for (DSP_REVERB_TYPE type : {DSP_REVERB_SCHROEDER, DSP_REVERB_FDN})
+            {
+                void *ctx = make_ctx(CH_ST, 0, type, DSP_REVERB_PER_CHANNEL);
+                run(ctx, sweep.data(), a.data(), frames, CH_ST);
+                dsp_destroy_context(ctx);
+                ctx = make_ctx(CH_ST, 0, type, DSP_REVERB_SEND_BUS);
+                run(ctx, sweep.data(), b.data(), frames, CH_ST);
+                dsp_destroy_context(ctx);
+                const std::string name = std::string("stereo send bus == per-channel (") +
+                                         (type == DSP_REVERB_FDN ? "FDN" : "Schroeder") + ")";
+                check(memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0, name.c_str());
+            }
+        }
+
+        // 2) 发送/返回电平：4 声道，只有通道 0 有信号（用 Schroeder：两路总线各自独立；
+        //    FDN 的两路共用一个反馈网络，偶数路的输入也会出现在奇数路的湿声里）
+        {
+            const unsigned ch = 4;
+            const size_t frames = SR48k / 2;
+            std::vector<float> in(frames * ch, 0.0f), out(in.size());
+            std::vector<float> mono(frames);
+            noise(mono, 11);
+            for (size_t n = 0; n < frames; ++n)
+                in[n * ch] = in[n * ch + 3] = mono[n];   // 通道 3 也有信号，但发送为 0
+            void *ctx = make_ctx(ch, 0, DSP_REVERB_SCHROEDER, DSP_REVERB_SEND_BUS);
+            dsp_set_reverb_send(ctx, 3, 0.0f, 0.0f);     // 类似 LFE：不送也不收
+            run(ctx, in.data(), out.data(), frames, ch);
+            double e1 = 0.0, e2 = 0.0;
+            bool dry3 = true;
+            for (size_t n = 0; n < frames; ++n)
+            {
+                e1 += static_cast<double>(out[n * ch + 1]) * out[n * ch + 1];
+                e2 += static_cast<double>(out[n * ch + 2]) * out[n * ch + 2];
+                dry3 &= out[n * ch + 3] == in[n * ch + 3];
+            }
+            check(dry3, "reverb return 0 leaves the channel dry");
+            check(e1 == 0.0, "odd bus is silent when only even channels send");
+            check(e2 > 1.0, "even channels receive the shared reverb");
+            check(dsp_set_reverb_send(ctx, DSP_REVERB_MAX_SENDS, 1.0f, 1.0f) == 0, "reverb send rejects out-of-range channel");
+            dsp_destroy_context(ctx);
+        }
+
+        // 3) IR 混响走总线（只分配总线的实例）：δ IR、湿度 1 → 输出 = 同奇偶通道之和
+        {
+            const unsigned ch = 6;
+            const size_t frames = SR48k / 4;
+            std::vector<float> in(frames * ch), out(in.size());
+            noise(in, 23);
+            void *ctx = make_ctx(ch, DSP_CREATE_REVERB_BUS_ONLY, DSP_REVERB_IR, DSP_REVERB_PER_CHANNEL);
+            dsp_set_reverb_params(ctx, 1.0f, 0.8f, 0.3f, 10.0f);
+            const float delta = 1.0f;
+            check(dsp_set_reverb_ir(ctx, &delta, 1, 1) == 1, "bus-only context loads a reverb IR");
+            dsp_set_reverb_send(ctx, 4, 0.5f, 1.0f);
+            run(ctx, in.data(), out.data(), frames, ch);
+            float maxErr = 0.0f;
+            for (size_t n = 0; n < frames; ++n)
+            {
+                const float *x = &in[n * ch];
+                const float bus[2] = {x[0] + x[2] + 0.5f * x[4], x[1] + x[3] + x[5]};
+                for (unsigned c = 0; c < ch; ++c)
+                    maxErr = std::max(maxErr, std::fabs(out[n * ch + c] - bus[c & 1]));
+            }
+            std::cout << "[INFO] IR send bus max error vs summed channels: " << maxErr << "\n";
+            check(maxErr < 1e-5f, "IR reverb on the send bus (bus-only context)");
+            dsp_destroy_context(ctx);
+        }
+
+        // 4) 运行中切换路由（带平滑）
+        {
+            const unsigned ch = 6;
+            const size_t frames = SR48k;
+            std::vector<float> in(frames * ch), out(in.size());
+            noise(in, 37);
+            void *ctx = make_ctx(ch, 0, DSP_REVERB_FDN, DSP_REVERB_PER_CHANNEL);
+            dsp_set_smoothing_ms(ctx, 10.0f);
+            bool ok = true;
+            for (size_t b = 0; b * B < frames; ++b)
+            {
+                if (b % 8 == 7)
+                    dsp_set_reverb_routing(ctx, (b / 8) & 1 ? DSP_REVERB_PER_CHANNEL : DSP_REVERB_SEND_BUS);
+                if (b % 24 == 23)
+                    dsp_set_reverb_type(ctx, (b / 24) & 1 ? DSP_REVERB_FDN : DSP_REVERB_SCHROEDER);
+                const uint32_t n = static_cast<uint32_t>(std::min<size_t>(B, frames - b * B));
+                dsp_process_block(ctx, in.data() + b * B * ch, out.data() + b * B * ch, n, ch);
+            }
+            for (float v : out)
+                ok &= std::isfinite(v) && std::fabs(v) < 8.0f;
+            check(ok, "reverb routing switches at runtime");
+            dsp_destroy_context(ctx);
+        }
+
+        // 5) 8 声道：内存与每块代价
+        {
+            const unsigned ch = 8;
+            const size_t frames = SR48k * 2;
+            std::vector<float> in(frames * ch), out(in.size());
+            noise(in, 41);
+            void *per = make_ctx(ch, 0, DSP_REVERB_FDN, DSP_REVERB_PER_CHANNEL);
+            void *bus = make_ctx(ch, DSP_CREATE_REVERB_BUS_ONLY, DSP_REVERB_FDN, DSP_REVERB_PER_CHANNEL);
+            void *bus2 = make_ctx(CH_ST, DSP_CREATE_REVERB_BUS_ONLY, DSP_REVERB_FDN, DSP_REVERB_PER_CHANNEL);
+            const size_t mPer = dsp_get_memory_footprint(per), mBus = dsp_get_memory_footprint(bus),
+                         mBus2 = dsp_get_memory_footprint(bus2);
+            std::cout << "[INFO] 8ch memory: per-channel reverb " << mPer / 1024 << " KB, bus-only " << mBus / 1024
+                      << " KB (stereo bus-only " << mBus2 / 1024 << " KB)\n";
+            check(mBus * 3 < mPer && mBus < mBus2 + 64 * 1024, "bus-only reverb memory does not scale with channels");
+            dsp_destroy_context(bus2);
+
+            auto time_ms = [&](void *ctx) {
+                run(ctx, in.data(), out.data(), frames / 4, ch);   // 预热
+                double best = 1e30;
+                for (int r = 0; r < 3; ++r)
+                {
+                    const auto t0 = clock_type::now();
+                    run(ctx, in.data(), out.data(), frames, ch);
+                    best = std::min(best, std::chrono::duration<double, std::milli>(clock_type::now() - t0).count());
+                }
+                return best;
+            };
+            // 三个实例都开同一个增益级，dry 与另外两个跑同一条链（不会因为没有要跑的级而走捷径），
+            // 减去 dry 之后只剩混响本身的代价
+            void *dry = make_ctx(ch, 0, DSP_REVERB_FDN, DSP_REVERB_PER_CHANNEL);
+            dsp_set_reverb_enabled(dry, 0);
+            for (void *ctx : {per, bus, dry})
+                dsp_set_gain(ctx, 0.5f);
+            // 单核机器上计时抖动大：整组重测几次，有一次满足就算通过
+            bool met = false;
+            for (int attempt = 0; attempt < 5 && !met; ++attempt)
+            {
+                const double base = time_ms(dry);
+                const double tPer = time_ms(per) - base, tBus = time_ms(bus) - base;
+                std::cout << "[INFO] 8ch FDN reverb cost for 2 s: per-channel " << tPer << " ms, send bus " << tBus
+                          << " ms (x" << tPer / tBus << ")\n";
+                met = tBus * 2.0 < tPer;
+            }
+            check(met, "send bus reverb is much cheaper than per-channel at 8ch");
+            dsp_destroy_context(dry);
+            dsp_destroy_context(per);
+            dsp_destroy_context(bus);
+        }
+    }
+
+    // -------------------------
+    // 用例 AC：Schroeder 混响的打包梳状组（4 梳状首尾相接放在一块内存里、沿时间方向向量化）
+    // 目标：1) 与原来逐样本的写法（这里照抄一份作参照）逐位相同，各指令集、各种块长、中途改参数；
+    //       2) 每通道代价：混响级至少比参照写法便宜一倍。
+    // -------------------------
+    {
+        // 原来的逐样本 Schroeder：预延迟 → 4 个梳状（各自一条环形缓冲）求和 ×0.25 → 2 个全通
+        struct RefSchroeder
+        {
+            struct Line
+            {
+                std::vector<float> buf;
+                size_t idx = 0;
+                float fb = 0.0f;
+            };
+            std::vector<float> pd;
+            size_t pdw = 0;
+            Line comb[4], ap[2];
+            float damp = 0.0f;
+
+            static int ms(float v, unsigned sr)
+            {
+                const int n = static_cast<int>(v * 0.001f * static_cast<float>(sr) + 0.5f);
+                return n < 1 ? 1 : n;
+            }
+            RefSchroeder(unsigned sr, float preMs)
+            {
+                static const float comb_ms[4] = {29.7f, 37.1f, 41.1f, 43.7f};
+                static const float ap_ms[2] = {5.0f, 1.7f};
+                pd.assign(static_cast<size_t>(ms(preMs, sr)), 0.0f);
+                for (int i = 0; i < 4; ++i)
+                    comb[i].buf.assign(static_cast<size_t>(ms(comb_ms[i] * 48000.f / static_cast<float>(sr), sr)), 0.0f);
+                for (int i = 0; i < 2; ++i)
+                {
+                    ap[i].buf.assign(static_cast<size_t>(ms(ap_ms[i] * 48000.f / static_cast<float>(sr), sr)), 0.0f);
+                    ap[i].fb = 0.5f;
+                }
+            }
+            void set(float room, float d)
+            {
+                static const float fb[4] = {0.77f, 0.80f, 0.84f, 0.88f};
+                for (int i = 0; i < 4; ++i)
+                    comb[i].fb = fb[i] * room;
+                damp = d;
+            }
+            float process(float x)
+            {
+                const float p = pd[pdw];
+                pd[pdw] = x;
+                if (++pdw == pd.size())
+                    pdw = 0;
+                float s = 0.0f;
+                for (Line &c : comb)
+                {
+                    const float y = c.buf[c.idx];
+                    const float z = (1.f - damp) * y + damp * 0.f;
+                    c.buf[c.idx] = p + z * c.fb;
+                    if (++c.idx == c.buf.size())
+                        c.idx = 0;
+                    s += y;
+                }
+                s *= 0.25f;
+                for (Line &a : ap)
+                {
+                    const float y = a.buf[a.idx];
+                    const float v = s + (-a.fb) * y;
+                    a.buf[a.idx] = v;
+                    s = y + a.fb * v;
+                    if (++a.idx == a.buf.size())
+                        a.idx = 0;
+                }
+                return s;
+            }
+        };
+
+        std::vector<float> sweep;
+        gen_log_sweep(sweep, SR48k, CH_ST, 1.5f, 50.0f, 18000.0f, 0.5f);
+        const size_t frames = sweep.size() / CH_ST, half = frames / 2;
+        const float wet = 0.35f;
+
+        // 参照输出：前一半 room 0.8 / damp 0.3，后一半 room 0.5 / damp 0.6，预延迟 12ms
+        // 跑 3 遍取最快的一遍当参照代价（与下面打包版的计时同样取最好成绩）
+        std::vector<float> ref(sweep.size());
+        double refSec = 1e30;
+        for (int rep = 0; rep < 3; ++rep)
+        {
+            RefSchroeder r[CH_ST] = {RefSchroeder(SR48k, 12.0f), RefSchroeder(SR48k, 12.0f)};
+            const auto t0 = clock_type::now();
+            for (size_t n = 0; n < frames; ++n)
+                for (unsigned c = 0; c < CH_ST; ++c)
+                {
+                    if (n == 0)
+                        r[c].set(0.8f, 0.3f);
+                    else if (n == half)
+                        r[c].set(0.5f, 0.6f);
+                    const float x = sweep[n * CH_ST + c];
+                    ref[n * CH_ST + c] = (1.0f - wet) * x + wet * r[c].process(x);
+                }
+            refSec = std::min(refSec, std::chrono::duration<double>(clock_type::now() - t0).count());
+        }
+
+        static const uint32_t blocks[] = {1, 7, 64, 255, 256, 257, 480, 1024};
+        auto run = [&](DSP_SIMD_LEVEL lv, std::vector<float> &out) {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            if (!dsp_set_simd_level(ctx, lv))
+            {
+                dsp_destroy_context(ctx);
+                return false;
+            }
+            dsp_set_limiter_enabled(ctx, 0);
+            dsp_set_smoothing_ms(ctx, 0.0f);
+            dsp_set_reverb_params(ctx, wet, 0.8f, 0.3f, 12.0f);
+            dsp_set_reverb_enabled(ctx, 1);
+            out.resize(sweep.size());
+            size_t done = 0;
+            for (size_t k = 0; done < frames; ++k)
+            {
+                uint32_t n = static_cast<uint32_t>(std::min<size_t>(blocks[k % 8], frames - done));
+                if (done < half && done + n > half)
+                    n = static_cast<uint32_t>(half - done);   // 改参数正好落在 half
+                if (done == half)
+                    dsp_set_reverb_params(ctx, wet, 0.5f, 0.6f, 12.0f);
+                dsp_process_block(ctx, sweep.data() + done * CH_ST, out.data() + done * CH_ST, n, CH_ST);
+                done += n;
+            }
+            dsp_destroy_context(ctx);
+            return true;
+        };
+        for (DSP_SIMD_LEVEL lv : {DSP_SIMD_SCALAR, DSP_SIMD_SSE2, DSP_SIMD_AVX2, DSP_SIMD_NEON})
+        {
+            std::vector<float> out;
+            if (!run(lv, out))
+                continue;
+            const std::string name = std::string("packed Schroeder ") + simd_name(lv) + " bit-exact vs per-sample reference";
+            check(memcmp(out.data(), ref.data(), out.size() * sizeof(float)) == 0, name.c_str());
+        }
+
+        // 每通道代价：整条链（开混响）减去关掉混响的同一条链。两边都开一个增益级，
+        // 否则关掉混响时整块直通，交织/解交织与分段的开销都会算到混响头上
+        {
+            std::vector<float> out(sweep.size());
+            auto time_sec = [&](int enabled) {
+                void *ctx = dsp_create_context(SR48k, CH_ST);
+                dsp_set_limiter_enabled(ctx, 0);
+                dsp_set_gain(ctx, 0.5f);
+                dsp_set_reverb_params(ctx, wet, 0.8f, 0.3f, 12.0f);
+                dsp_set_reverb_enabled(ctx, enabled);
+                double best = 1e30;
+                for (int r = 0; r < 3; ++r)
+                {
+                    const auto t0 = clock_type::now();
+                    for (size_t done = 0; done < frames; done += 480)
+                    {
+                        const uint32_t n = static_cast<uint32_t>(std::min<size_t>(480, frames - done));
+                        dsp_process_block(ctx, sweep.data() + done * CH_ST, out.data() + done * CH_ST, n, CH_ST);
+                    }
+                    best = std::min(best, std::chrono::duration<double>(clock_type::now() - t0).count());
+                }
+                dsp_destroy_context(ctx);
+                return best;
+            };
+            // 单核机器上计时抖动大：打包版重测几次，有一次满足就算通过（参照已取 3 遍里最快的）
+            const double perSample = 1e9 / (static_cast<double>(frames) * CH_ST), scalar = refSec * perSample;
+            bool met = false;
+            for (int attempt = 0; attempt < 5 && !met; ++attempt)
+            {
+                const double packed = (time_sec(1) - time_sec(0)) * perSample;
+                std::cout << "[INFO] Schroeder reverb per channel-sample: per-sample reference " << scalar
+                          << " ns, packed comb bank " << packed << " ns (x" << scalar / packed << ")\n";
+                met = packed * 2.0 < scalar;
+            }
+            check(met, "packed Schroeder costs under half the per-sample loop");
+        }
+    }
+
+    // -------------------------
+    // 用例 AD：静音跳过（输入静音后放完尾音进入空闲）+ 冲零
+    // 目标：1) 输入静音后尾音照常放出，输出安静够久才进入空闲，空闲后 dsp_process_silence 不动缓冲；
+    //          dsp_process_block 喂全 0（标量回退）与 dsp_process_silence 逐位相同；尾音里没有非规格化数；
+    //       2) 空闲期间流位置照常推进，立即设置与定时事件都生效；恢复后与新建实例逐位相同；
+    //       3) APO 核心：BUFFER_SILENT 先输出尾音，放完后只传标志、不碰缓冲；
+    //       4) IR 混响：IR 没放完之前不进入空闲；
+    //       5) 8 声道空闲流每块代价 vs 有声音时。
+    // -------------------------
+    {
+        const uint32_t B = 480;
+        auto noise = [](std::vector<float> &v, uint32_t s, float amp) {
+            for (float &x : v)
+            {
+                s = s * 1664525u + 1013904223u;
+                x = (static_cast<float>(s >> 8) / 16777216.0f - 0.5f) * amp;
+            }
+        };
+        std::vector<float> convIr(2048);
+        noise(convIr, 5, 0.05f);
+        for (size_t i = 0; i < convIr.size(); ++i)
+            convIr[i] *= std::exp(-static_cast<float>(i) / 300.0f);
+        convIr[0] = 1.0f;
+        auto make = [&](float gain, float wet) {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_smoothing_ms(ctx, 0.0f);
+            dsp_set_gain(ctx, gain);
+            dsp_set_eq_enabled(ctx, 1, 1);
+            dsp_set_eq_params(ctx, 1, 1200.f, 1.2f, -6.f);
+            dsp_set_reverb_params(ctx, wet, 0.8f, 0.3f, 12.0f);
+            dsp_set_reverb_enabled(ctx, 1);
+            dsp_set_conv_ir(ctx, convIr.data(), convIr.size(), 1, 0);
+            return ctx;
+        };
+        std::vector<float> sweep;
+        gen_log_sweep(sweep, SR48k, CH_ST, 0.5f, 50.0f, 18000.0f, 0.5f);
+        const size_t sweepFrames = sweep.size() / CH_ST;
+        auto feed = [&](void *ctx, std::vector<float> &out) {
+            out.resize(sweep.size());
+            for (size_t done = 0; done < sweepFrames; done += B)
+            {
+                const uint32_t n = static_cast<uint32_t>(std::min<size_t>(B, sweepFrames - done));
+                dsp_process_block(ctx, sweep.data() + done * CH_ST, out.data() + done * CH_ST, n, CH_ST);
+            }
+        };
+
+        // 1) 尾音 → 空闲
+        void *a = make(1.0f, 0.35f);
+        void *b = make(1.0f, 0.35f);
+        dsp_set_simd_level(b, DSP_SIMD_SCALAR);   // 静音检测与各级内核的标量回退也走一遍
+        std::vector<float> oa, ob;
+        feed(a, oa);
+        feed(b, ob);
+        const size_t silentBlocks = 3 * SR48k / B;
+        std::vector<float> bufA(B * CH_ST), bufB(B * CH_ST), zero(B * CH_ST, 0.0f);
+        size_t tailBlocks = 0;
+        float firstPeak = 0.0f, lastPeak = 0.0f;
+        bool same = true, untouched = true, noSubnormal = true, stayIdle = true;
+        for (size_t k = 0; k < silentBlocks; ++k)
+        {
+            std::fill(bufA.begin(), bufA.end(), 123.0f);
+            const int tail = dsp_process_silence(a, bufA.data(), B, CH_ST);
+            dsp_process_block(b, zero.data(), bufB.data(), B, CH_ST);
+            if (!tail)
+            {
+                untouched &= bufA[0] == 123.0f && bufA.back() == 123.0f;
+                same &= std::all_of(bufB.begin(), bufB.end(), [](float v) { return v == 0.0f; });
+                stayIdle &= k >= tailBlocks;
+                continue;
+            }
+            if (k != tailBlocks)
+                stayIdle = false;
+            ++tailBlocks;
+            same &= bufA == bufB;
+            float peak = 0.0f;
+            for (float v : bufA)
+            {
+                peak = std::max(peak, std::fabs(v));
+                noSubnormal &= std::fpclassify(v) != FP_SUBNORMAL;
+            }
+            if (k == 0)
+                firstPeak = peak;
+            lastPeak = peak;
+        }
+        std::cout << "[INFO] silence: tail ran " << tailBlocks << " blocks (" << tailBlocks * B * 1000.0 / SR48k
+                  << " ms), first tail block peak " << firstPeak << ", last " << lastPeak << "\n";
+        check(tailBlocks * B > convIr.size() && tailBlocks < silentBlocks && firstPeak > 1e-3f,
+              "silent input keeps the reverb/conv tail running, then goes idle");
+        check(lastPeak <= DSP_SILENCE_LEVEL, "idle only after the output has decayed below the silence level");
+        check(stayIdle && untouched, "idle chain leaves the buffer untouched and stays idle while silent");
+        check(same, "zero-input dsp_process_block (scalar) == dsp_process_silence (tail and idle)");
+        check(noSubnormal, "no denormals in the decaying tail (flush-to-zero)");
+        DSP_STATS st;
+        if (dsp_get_stats(a, &st))
+            check(st.tail_blocks == tailBlocks && st.idle_blocks == silentBlocks - tailBlocks,
+                  "stats count tail and idle blocks");
+
+        // 2) 空闲期间改参数（立即 + 定时事件），恢复后与新建实例相同
+        dsp_set_gain(a, 0.8f);
+        dsp_begin_update(a);
+        dsp_set_reverb_params(a, 0.5f, 0.8f, 0.3f, 12.0f);
+        const uint64_t evAt = dsp_get_stream_position(a) + 2 * B + 17;
+        dsp_commit_update_at(a, evAt);
+        for (int k = 0; k < 10; ++k)
+            dsp_process_block(a, zero.data(), bufA.data(), B, CH_ST);
+        const uint64_t expectPos = static_cast<uint64_t>(sweepFrames) + (silentBlocks + 10) * B;
+        check(dsp_get_stream_position(a) == expectPos, "stream position advances while idle");
+        void *fresh = make(0.8f, 0.5f);
+        std::vector<float> ra, rf;
+        feed(a, ra);
+        feed(fresh, rf);
+        check(ra == rf, "resume after idle == fresh context (params changed while idle applied)");
+        dsp_destroy_context(a);
+        dsp_destroy_context(b);
+        dsp_destroy_context(fresh);
+
+        // 3) APO 核心
+        {
+            void *ctx = make(1.0f, 0.35f);
+            std::vector<float> buf(B * CH_ST);
+            std::copy(sweep.begin(), sweep.begin() + buf.size(), buf.begin());
+            FakeConnProp io{reinterpret_cast<uintptr_t>(buf.data()), B, ApoCore::kBufferValid, 0};
+            ApoCore::Process(ctx, CH_ST, &io, &io);
+            size_t valid = 0, silent = 0;
+            bool order = true, kept = true;
+            for (size_t k = 0; k < silentBlocks; ++k)
+            {
+                std::fill(buf.begin(), buf.end(), 123.0f);
+                FakeConnProp s{reinterpret_cast<uintptr_t>(buf.data()), B, ApoCore::kBufferSilent, 0};
+                const bool ran = ApoCore::Process(ctx, CH_ST, &s, &s);
+                if (ran != (s.u32BufferFlags == ApoCore::kBufferValid))
+                    order = false;
+                if (ran)
+                {
+                    order &= silent == 0;
+                    ++valid;
+                }
+                else
+                {
+                    kept &= buf[0] == 123.0f && s.u32ValidFrameCount == B;
+                    ++silent;
+                }
+            }
+            check(valid > 0 && silent > 0 && order && kept, "apo core: BUFFER_SILENT plays the tail, then passes the flag");
+            dsp_destroy_context(ctx);
+        }
+
+        // 4) IR 混响：0.5 s 的 IR 放完之前不进入空闲
+        {
+            std::vector<float> ir(SR48k / 2);
+            noise(ir, 9, 1.0f);
+            for (size_t i = 0; i < ir.size(); ++i)
+                ir[i] *= 0.1f * std::exp(-static_cast<float>(i) / 8000.0f);
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_limiter_enabled(ctx, 0);
+            dsp_set_reverb_type(ctx, DSP_REVERB_IR);
+            dsp_set_reverb_ir(ctx, ir.data(), ir.size(), 1);
+            dsp_set_reverb_params(ctx, 0.4f, 0.8f, 0.3f, 0.0f);
+            dsp_set_reverb_enabled(ctx, 1);
+            std::vector<float> out;
+            feed(ctx, out);
+            std::vector<float> buf(B * CH_ST);
+            size_t tail = 0;
+            while (tail < silentBlocks && dsp_process_silence(ctx, buf.data(), B, CH_ST))
+                ++tail;
+            std::cout << "[INFO] IR reverb (" << ir.size() << " taps) tail ran " << tail * B << " frames\n";
+            check(tail * B >= ir.size() && tail < silentBlocks, "IR reverb tail plays out before idle");
+            dsp_destroy_context(ctx);
+        }
+
+        // 5) 8 声道空闲流：每块代价
+        {
+            const unsigned ch = 8;
+            const size_t frames = SR48k * 2;
+            std::vector<float> in(frames * ch), out(in.size()), z(frames * ch, 0.0f);
+            noise(in, 41, 1.0f);
+            void *ctx = dsp_create_context(SR48k, ch);
+            dsp_set_eq_enabled(ctx, 1, 1);
+            dsp_set_eq_params(ctx, 1, 1200.f, 1.2f, -6.f);
+            dsp_set_reverb_type(ctx, DSP_REVERB_FDN);
+            dsp_set_reverb_params(ctx, 0.3f, 0.8f, 0.3f, 10.0f);
+            dsp_set_reverb_enabled(ctx, 1);
+            auto time_us = [&](const std::vector<float> &src) {
+                double best = 1e30;
+                for (int r = 0; r < 3; ++r)
+                {
+                    const auto t0 = clock_type::now();
+                    for (size_t done = 0; done < frames; done += B)
+                        dsp_process_block(ctx, src.data() + done * ch, out.data() + done * ch, B, ch);
+                    best = std::min(best, std::chrono::duration<double, std::micro>(clock_type::now() - t0).count());
+                }
+                return best / static_cast<double>(frames / B);
+            };
+            const double active = time_us(in);
+            for (int k = 0; k < 5 && dsp_process_silence(ctx, out.data(), frames, ch); ++k)
+            {
+            }
+            const double idle = time_us(z);
+            std::cout << "[INFO] 8ch idle stream: " << idle << " us per 10 ms block vs " << active
+                      << " us with signal (x" << active / idle << ")\n";
+            check(idle * 20.0 < active, "idle stream costs a small fraction of an active one");
+            if (dsp_get_stats(ctx, &st))
+                std::cout << "[INFO] 8ch stats: " << st.blocks << " blocks, " << st.tail_blocks << " tail, "
+                          << st.idle_blocks << " idle\n";
+            dsp_destroy_context(ctx);
+        }
+    }
+
+    // -------------------------
+    // 用例 AE：恒等旁路
+    // 目标：1) 参数整体恒等（增益 1、0 dB 的 EQ 段、湿度 0 的混响、限幅器关）时就地处理逐位不动，非就地逐位复制；
+    //       2) 开限幅器（有前瞻延迟）退出旁路：先等延迟填满再交叉淡化，110 Hz 正弦上没有咔嗒（切换点不在过零处）；
+    //       2b) 关掉前瞻限幅器/卷积后进入旁路：先放完延迟再淡化到干声，同样没有跳变；
+    //       3) 旁路中装上卷积 IR 立即退出旁路；
+    //       4) 8 声道旁路每块代价 vs 跑完整条链。
+    // -------------------------
+    {
+        const uint32_t B = 480;
+        auto make = [&](unsigned ch) {
+            void *ctx = dsp_create_context(SR48k, ch);
+            dsp_set_limiter_enabled(ctx, 0);
+            dsp_set_eq_enabled(ctx, 2, 1);
+            dsp_set_eq_params(ctx, 2, 1000.f, 1.0f, 0.0f);
+            dsp_set_reverb_params(ctx, 0.0f, 0.8f, 0.3f, 12.0f);
+            dsp_set_reverb_enabled(ctx, 1);
+            return ctx;
+        };
+        std::vector<float> sine(static_cast<size_t>(SR48k) * CH_ST);
+        for (size_t n = 0; n < sine.size() / CH_ST; ++n)
+            for (unsigned c = 0; c < CH_ST; ++c)
+                sine[n * CH_ST + c] = 0.5f * std::sin(2.0f * 3.14159265f * 110.0f * static_cast<float>(n) / SR48k);
+        const size_t blocks = sine.size() / CH_ST / B;
+
+        // 1) 就地 / 非就地
+        void *ctx = make(CH_ST);
+        std::vector<float> buf = sine, out(sine.size());
+        for (size_t k = 0; k < blocks; ++k)
+            dsp_process_block(ctx, buf.data() + k * B * CH_ST, buf.data() + k * B * CH_ST, B, CH_ST);
+        check(buf == sine, "identity chain in-place leaves the buffer bit-exact");
+        for (size_t k = 0; k < blocks; ++k)
+            dsp_process_block(ctx, sine.data() + k * B * CH_ST, out.data() + k * B * CH_ST, B, CH_ST);
+        check(out == sine, "identity chain out-of-place is an exact copy");
+        DSP_STATS st;
+        if (dsp_get_stats(ctx, &st))
+            check(st.bypass_blocks == 2 * blocks && st.blocks == 2 * blocks, "stats count bypassed blocks");
+
+        // 2) 开限幅器：输出逐帧差不超过正弦本身的最大斜率（再留一点余量）
+        float natural = 0.0f;
+        for (size_t n = 1; n < sine.size() / CH_ST; ++n)
+            natural = std::max(natural, std::fabs(sine[n * CH_ST] - sine[(n - 1) * CH_ST]));
+        auto max_step = [&](bool bypassTest) {
+            void *c = make(CH_ST);
+            if (!bypassTest)
+                dsp_set_gain(c, 0.999f); // 不是恒等：一直跑处理链
+            std::vector<float> o(sine.size());
+            for (size_t k = 0; k < blocks; ++k)
+            {
+                if (k == blocks / 3)
+                    dsp_set_limiter_enabled(c, 1);
+                dsp_process_block(c, sine.data() + k * B * CH_ST, o.data() + k * B * CH_ST, B, CH_ST);
+            }
+            float m = 0.0f;
+            for (size_t n = 1; n < o.size() / CH_ST; ++n)
+                m = std::max(m, std::fabs(o[n * CH_ST] - o[(n - 1) * CH_ST]));
+            dsp_destroy_context(c);
+            return m;
+        };
+        const float leaveStep = max_step(true), chainStep = max_step(false);
+        std::cout << "[INFO] limiter on from bypass: max step " << leaveStep << " (sine " << natural
+                  << ", without bypass " << chainStep << ")\n";
+        check(leaveStep < natural * 1.5f, "leaving bypass into the lookahead limiter is click-free");
+
+        // 2b) 反过来：关掉前瞻限幅器/卷积（延迟线里还有声音）后进入旁路，先放完延迟再淡化到干声
+        auto enter_step = [&](bool conv, bool &bypassedAtEnd) {
+            void *c = make(CH_ST);
+            std::vector<float> d(64, 0.0f);
+            d[0] = 1.0f; // 纯延迟一个分块
+            if (conv)
+                dsp_set_conv_ir(c, d.data(), d.size(), 1, 256);
+            else
+                dsp_set_limiter_params(c, 1.0f, 5.0f, 50.0f, 1); // 前瞻 5 ms + 真峰值，门限以下只是延迟
+            dsp_set_limiter_enabled(c, conv ? 0 : 1);
+            std::vector<float> o(sine.size());
+            for (size_t k = 0; k < blocks; ++k)
+            {
+                if (k == blocks / 3)
+                {
+                    if (conv)
+                        dsp_set_conv_enabled(c, 0);
+                    else
+                        dsp_set_limiter_enabled(c, 0);
+                }
+                dsp_process_block(c, sine.data() + k * B * CH_ST, o.data() + k * B * CH_ST, B, CH_ST);
+            }
+            float m = 0.0f;
+            for (size_t n = 1; n < o.size() / CH_ST; ++n)
+                m = std::max(m, std::fabs(o[n * CH_ST] - o[(n - 1) * CH_ST]));
+            DSP_STATS s{};
+            bypassedAtEnd = std::equal(o.end() - B * CH_ST, o.end(), sine.end() - B * CH_ST) &&
+                            (!dsp_get_stats(c, &s) || s.bypass_blocks > 0);
+            dsp_destroy_context(c);
+            return m;
+        };
+        bool limBypassed = false, convBypassed = false;
+        const float enterLim = enter_step(false, limBypassed), enterConv = enter_step(true, convBypassed);
+        std::cout << "[INFO] bypass entered after limiter/conv off: max step " << enterLim << " / " << enterConv
+                  << " (sine " << natural << ")\n";
+        check(enterLim < natural * 1.5f && limBypassed,
+              "entering bypass from the lookahead limiter is click-free");
+        check(enterConv < natural * 1.5f && convBypassed, "entering bypass from the convolver is click-free");
+
+        // 3) 旁路中装上卷积 IR
+        std::vector<float> ir(256, 0.0f);
+        ir[0] = 0.5f;
+        dsp_reset_stats(ctx);
+        dsp_set_conv_ir(ctx, ir.data(), ir.size(), 1, 0);
+        for (size_t k = 0; k < blocks; ++k)
+            dsp_process_block(ctx, sine.data() + k * B * CH_ST, out.data() + k * B * CH_ST, B, CH_ST);
+        float peak = 0.0f;
+        for (size_t n = out.size() / 2; n < out.size(); ++n)
+            peak = std::max(peak, std::fabs(out[n]));
+        check(peak > 0.24f && peak < 0.26f, "conv IR loaded while bypassed leaves bypass");
+        if (dsp_get_stats(ctx, &st))
+            check(st.bypass_blocks == 0, "no bypassed blocks once the conv IR is loaded");
+        dsp_destroy_context(ctx);
+
+        // 4) 8 声道：旁路 vs 整条链
+        {
+            const unsigned ch = 8;
+            const size_t frames = SR48k * 2;
+            std::vector<float> in(frames * ch);
+            for (size_t i = 0; i < in.size(); ++i)
+                in[i] = 0.3f * std::sin(0.001f * static_cast<float>(i));
+            auto time_us = [&](void *c) {
+                double best = 1e30;
+                for (int r = 0; r < 3; ++r)
+                {
+                    const auto t0 = clock_type::now();
+                    for (size_t done = 0; done < frames; done += B)
+                        dsp_process_block(c, in.data() + done * ch, in.data() + done * ch, B, ch);
+                    best = std::min(best, std::chrono::duration<double, std::micro>(clock_type::now() - t0).count());
+                }
+                return best / static_cast<double>(frames / B);
+            };
+            void *byp = make(ch);
+            void *full = make(ch);
+            dsp_set_eq_params(full, 2, 1000.f, 1.0f, 0.5f);
+            const double tb = time_us(byp), tf = time_us(full);
+            std::cout << "[INFO] 8ch identity bypass: " << tb << " us per 10 ms block vs " << tf
+                      << " us through the chain (x" << tf / tb << ")\n";
+            check(tb * 5.0 < tf, "bypass costs a small fraction of running the chain");
+            dsp_destroy_context(byp);
+            dsp_destroy_context(full);
+        }
+    }
+
+    // -------------------------
+    // 用例 AF：发布时编译处理链（增益折进 EQ 第一段、去掉 0 dB 段）
+    // 目标：1) 折进后与“输入先乘增益、增益 1 的链”一致：差别不超过舍入噪声的几倍
+    //          （舍入噪声取同一条链“先乘增益”与“后乘增益”之差，120 Hz 搁架的极点靠近 1，会放大舍入）；
+    //       2) 启用的 0 dB 段不跑，输出与不启用它逐位相同；
+    //       3) 不平滑改增益（折进的增益换值、拆出再折进）时滤波器历史跟着换算，仍与参考一致；
+    //       4) 平滑改增益：斜坡期间拆出、走完再折进，与参考一致。
+    // -------------------------
+    {
+        const uint32_t B = 480;
+        std::vector<float> in;
+        gen_log_sweep(in, SR48k, CH_ST, 1.0f, 50.0f, 18000.0f, 0.5f);
+        const size_t frames = in.size() / CH_ST, blocks = frames / B;
+        // gains 非空时第 k 块之前设增益 gains[k]（与上一块不同才设）
+        auto run = [&](void *ctx, const std::vector<float> &x, std::vector<float> &out,
+                       const std::vector<float> &gains) {
+            out.assign(x.size(), 0.0f);
+            for (size_t k = 0; k < blocks; ++k)
+            {
+                if (!gains.empty() && (k == 0 || gains[k] != gains[k - 1]))
+                    dsp_set_gain(ctx, gains[k]);
+                dsp_process_block(ctx, x.data() + k * B * CH_ST, out.data() + k * B * CH_ST, B, CH_ST);
+            }
+        };
+        auto make = [&](bool flatBand) {
+            void *ctx = make_eq_ctx(SR48k, CH_ST);
+            dsp_set_gain(ctx, 1.0f);
+            if (flatBand)
+                dsp_set_eq_enabled(ctx, 5, 1);
+            return ctx;
+        };
+        auto max_diff = [](const std::vector<float> &a, const std::vector<float> &b) {
+            float m = 0.0f;
+            for (size_t i = 0; i < a.size(); ++i)
+                m = std::max(m, std::fabs(a[i] - b[i]));
+            return m;
+        };
+        // 参考：增益 1 的链，输入先按帧乘增益
+        auto reference = [&](const std::vector<float> &g, std::vector<float> &out) {
+            std::vector<float> x(in.size());
+            for (size_t n = 0; n < frames; ++n)
+                for (unsigned c = 0; c < CH_ST; ++c)
+                    x[n * CH_ST + c] = in[n * CH_ST + c] * g[n];
+            void *ctx = make(false);
+            run(ctx, x, out, {});
+            dsp_destroy_context(ctx);
+        };
+
+        // 1) 静态增益
+        std::vector<float> gFrame(frames, 0.6f), ref, out, unity;
+        reference(gFrame, ref);
+        reference(std::vector<float>(frames, 1.0f), unity);
+        float noise = 0.0f;
+        for (size_t i = 0; i < ref.size(); ++i)
+            noise = std::max(noise, std::fabs(ref[i] - 0.6f * unity[i]));
+        void *ctx = make(true);
+        run(ctx, in, out, std::vector<float>(blocks, 0.6f));
+        const float dStatic = max_diff(out, ref);
+        DSP_STATS st;
+        if (dsp_get_stats(ctx, &st))
+            check(st.stage[DSP_STAGE_GAIN].calls == 0 && st.eq_band_runs == 3 * st.stage[DSP_STAGE_EQ].calls,
+                  "fused chain runs neither the gain stage nor the 0 dB band");
+        dsp_destroy_context(ctx);
+
+        // 2) 0 dB 段
+        std::vector<float> a, b;
+        void *ca = make(true), *cb = make(false);
+        run(ca, in, a, {});
+        run(cb, in, b, {});
+        check(a == b, "enabled 0 dB band is dropped (bit-exact with the band disabled)");
+        dsp_destroy_context(ca);
+        dsp_destroy_context(cb);
+
+        // 3) 不平滑：0.6 → 0.25 → 1（拆出）→ 0.8（再折进）
+        std::vector<float> gBlock(blocks);
+        for (size_t k = 0; k < blocks; ++k)
+            gBlock[k] = k < blocks / 4 ? 0.6f : k < blocks / 2 ? 0.25f : k < 3 * blocks / 4 ? 1.0f : 0.8f;
+        for (size_t n = 0; n < frames; ++n)
+            gFrame[n] = gBlock[std::min(n / B, blocks - 1)];
+        reference(gFrame, ref);
+        ctx = make(true);
+        dsp_set_smoothing_ms(ctx, 0.0f);
+        run(ctx, in, out, gBlock);
+        const float dHard = max_diff(out, ref);
+        dsp_destroy_context(ctx);
+
+        // 4) 平滑（默认 10 ms）：同样的增益序列，参考按斜坡逐帧乘
+        const uint32_t rampLen = SR48k / 100;
+        float g = gBlock[0];
+        for (size_t k = 0; k < blocks; ++k)
+        {
+            const float from = g, to = gBlock[k];
+            for (size_t n = 0; n < B; ++n)
+                gFrame[k * B + n] = to;
+            if (k && to != gBlock[k - 1])
+                for (uint32_t n = 0; n < rampLen && k * B + n < frames; ++n)
+                    gFrame[k * B + n] = from + (to - from) * static_cast<float>(n + 1) / static_cast<float>(rampLen);
+            g = to;
+        }
+        reference(gFrame, ref);
+        ctx = make(true);
+        run(ctx, in, out, gBlock);
+        const float dSmooth = max_diff(out, ref);
+        dsp_destroy_context(ctx);
+
+        std::cout << "[INFO] fused vs unfused max diff: static " << dStatic << ", hard gain steps " << dHard
+                  << ", smoothed gain steps " << dSmooth << " (rounding noise " << noise << ")\n";
+        check(dStatic < 4.0f * noise, "gain folded into the first biquad == pre-scaled input (rounding only)");
+        check(dHard < 4.0f * noise, "unsmoothed gain changes re-scale the folded biquad history");
+        check(dSmooth < 4.0f * noise, "smoothed gain changes unfold during the ramp and refold after it");
+    }
+
+    // -------------------------
+    // 用例 AG：处理程序（MyDspParams.opcode 字节码 → 发布时编译好的级表）
+    // 目标：1) 程序带的参数与逐个调设置函数逐位相同；
+    //       2) 不合法的程序整段拒绝，参数与顺序不变；
+    //       3) 改处理顺序生效：限幅器放到 EQ 前面时 EQ 的提升不再被限住；增益不紧挨 EQ 时不折进（单独跑），结果只差舍入；
+    //       4) 没列出的级关闭；
+    //       5) ParamsApply：opcode 变了才载入，不合法的计数并保持原程序；
+    //       6) 控制线程（同 APO 的 PipeThreadMain）反复载入程序时，实时线程每块只取到一份完整的已编译快照。
+    // -------------------------
+    {
+        const uint32_t B = 480;
+        auto f32 = [](float v) {
+            uint32_t u;
+            memcpy(&u, &v, 4);
+            return u;
+        };
+        struct Program
+        {
+            std::vector<uint8_t> bytes{'D', 'P', DSP_PROGRAM_VERSION, 0};
+            Program &Op(uint8_t op, uint8_t index, std::initializer_list<uint32_t> args = {})
+            {
+                bytes.insert(bytes.end(), {op, index, static_cast<uint8_t>(args.size()), 0});
+                for (uint32_t a : args)
+                    for (int sh = 0; sh < 32; sh += 8)
+                        bytes.push_back(static_cast<uint8_t>(a >> sh));
+                bytes[3]++;
+                return *this;
+            }
+        };
+        std::vector<float> in;
+        gen_log_sweep(in, SR48k, CH_ST, 1.0f, 50.0f, 18000.0f, 0.5f);
+        const size_t frames = in.size() / CH_ST;
+        auto run = [&](void *ctx, const std::vector<float> &x, std::vector<float> &out) {
+            out.assign(x.size(), 0.0f);
+            for (size_t done = 0; done < frames; done += B)
+            {
+                const uint32_t n = static_cast<uint32_t>(std::min<size_t>(B, frames - done));
+                dsp_process_block(ctx, x.data() + done * CH_ST, out.data() + done * CH_ST, n, CH_ST);
+            }
+        };
+
+        // 1) 程序 vs 设置函数
+        Program full;
+        full.Op(DSP_OP_EQ_BAND, 0, {DSP_EQ_LOWSHELF, f32(120.f), f32(0.707f), f32(6.f)})
+            .Op(DSP_OP_EQ_BAND, 1, {DSP_EQ_PEAK, f32(1200.f), f32(1.2f), f32(-6.f)})
+            .Op(DSP_OP_GAIN, 0, {f32(0.7f)})
+            .Op(DSP_OP_EQ, 0)
+            .Op(DSP_OP_REVERB, 0, {f32(0.25f), f32(0.6f), f32(0.3f), f32(15.f)})
+            .Op(DSP_OP_CONV, 0)
+            .Op(DSP_OP_LIMITER, 0, {DSP_LIMITER_LOOKAHEAD, f32(0.9f), f32(1.5f), f32(50.f), 0});
+        void *prog = dsp_create_context(SR48k, CH_ST);
+        void *ref = dsp_create_context(SR48k, CH_ST);
+        const int loaded = dsp_set_program(prog, full.bytes.data(), full.bytes.size());
+        dsp_set_eq_params_ex(ref, 0, 120.f, 0.707f, 6.f, DSP_EQ_LOWSHELF);
+        dsp_set_eq_enabled(ref, 0, 1);
+        dsp_set_eq_params_ex(ref, 1, 1200.f, 1.2f, -6.f, DSP_EQ_PEAK);
+        dsp_set_eq_enabled(ref, 1, 1);
+        dsp_set_gain(ref, 0.7f);
+        dsp_set_reverb_params(ref, 0.25f, 0.6f, 0.3f, 15.f);
+        dsp_set_reverb_enabled(ref, 1);
+        dsp_set_limiter_params(ref, 0.9f, 1.5f, 50.f, 0);
+        std::vector<float> a, b;
+        run(prog, in, a);
+        run(ref, in, b);
+        check(loaded && a == b, "program params == the same setters (bit-exact)");
+
+        // 2) 不合法的程序
+        std::vector<std::vector<uint8_t>> bad;
+        bad.push_back({'D', 'P'});                                              // 头不完整
+        bad.push_back(Program().Op(DSP_OP_EQ, 0).bytes);
+        bad.back()[0] = 'X';                                                    // 魔数
+        bad.push_back(Program().Op(DSP_OP_EQ, 0).bytes);
+        bad.back()[2] = DSP_PROGRAM_VERSION + 1;                                // 版本
+        bad.push_back(Program().Op(DSP_OP_EQ, 0).bytes);
+        bad.back()[3] = 2;                                                      // 条数比内容多
+        bad.push_back(Program().Op(DSP_OP_EQ, 0).bytes);
+        bad.back().push_back(0);                                                // 多出字节
+        bad.push_back(Program().Op(9, 0).bytes);                                // 未知操作码
+        bad.push_back(Program().Op(DSP_OP_GAIN, 0, {f32(1.f), f32(1.f)}).bytes); // 参数个数
+        bad.push_back(Program().Op(DSP_OP_EQ_OFF, MY_EQ_BANDS).bytes);          // 段号越界
+        bad.push_back(Program().Op(DSP_OP_GAIN, 0, {f32(std::nanf(""))}).bytes); // NaN
+        bad.push_back(Program().Op(DSP_OP_EQ, 0).Op(DSP_OP_EQ, 0).bytes);       // 同一级两次
+        bad.push_back(Program().Op(DSP_OP_LIMITER, 0, {2, f32(0.9f), f32(1.5f), f32(50.f), 0}).bytes); // 模式
+        bad.push_back(Program().Op(DSP_OP_EQ, 0).bytes);
+        bad.back()[7] = 1;                                                      // 保留字节
+        int rejected = 0;
+        for (const auto &p : bad)
+            rejected += dsp_set_program(prog, p.data(), p.size()) == 0;
+        run(prog, in, a);
+        run(ref, in, b);
+        check(rejected == static_cast<int>(bad.size()) && a == b && dsp_get_latency_frames(prog) == dsp_get_latency_frames(ref),
+              "invalid programs rejected, params and order unchanged");
+        dsp_destroy_context(prog);
+        dsp_destroy_context(ref);
+
+        // 3) 处理顺序：1 kHz 正弦 0.4，EQ 在 1 kHz +12 dB，限幅阈值 0.5
+        std::vector<float> sine(static_cast<size_t>(SR48k / 2) * CH_ST);
+        for (size_t n = 0; n < sine.size() / CH_ST; ++n)
+            for (unsigned c = 0; c < CH_ST; ++c)
+                sine[n * CH_ST + c] = 0.4f * std::sin(2.0f * 3.14159265f * 1000.0f * static_cast<float>(n) / SR48k);
+        auto peak_tail = [&](const std::vector<uint8_t> &code) {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_program(ctx, code.data(), code.size());
+            std::vector<float> o(sine.size());
+            for (size_t done = 0; done < sine.size() / CH_ST; done += B)
+                dsp_process_block(ctx, sine.data() + done * CH_ST, o.data() + done * CH_ST, B, CH_ST);
+            dsp_destroy_context(ctx);
+            float m = 0.0f;
+            for (size_t i = o.size() / 2; i < o.size(); ++i)
+                m = std::max(m, std::fabs(o[i]));
+            return m;
+        };
+        const uint32_t lim[] = {DSP_LIMITER_LOOKAHEAD, f32(0.5f), f32(1.5f), f32(50.f), 0};
+        const uint32_t boost[] = {DSP_EQ_PEAK, f32(1000.f), f32(1.0f), f32(12.f)};
+        const float limLast = peak_tail(Program()
+                                            .Op(DSP_OP_EQ_BAND, 0, {boost[0], boost[1], boost[2], boost[3]})
+                                            .Op(DSP_OP_EQ, 0)
+                                            .Op(DSP_OP_LIMITER, 0, {lim[0], lim[1], lim[2], lim[3], lim[4]})
+                                            .bytes);
+        const float limFirst = peak_tail(Program()
+                                             .Op(DSP_OP_EQ_BAND, 0, {boost[0], boost[1], boost[2], boost[3]})
+                                             .Op(DSP_OP_LIMITER, 0, {lim[0], lim[1], lim[2], lim[3], lim[4]})
+                                             .Op(DSP_OP_EQ, 0)
+                                             .bytes);
+        std::cout << "[INFO] program order: EQ -> limiter peak " << limLast << ", limiter -> EQ peak " << limFirst << "\n";
+        check(limLast <= 0.5f && limFirst > 1.4f, "program stage order takes effect");
+
+        // 增益放在 EQ 后面：不折进，单独跑增益级；与默认顺序（折进）只差舍入
+        const uint32_t mid[] = {DSP_EQ_PEAK, f32(1000.f), f32(1.0f), f32(6.f)};
+        Program gainLast, gainFirst;
+        gainLast.Op(DSP_OP_EQ_BAND, 0, {mid[0], mid[1], mid[2], mid[3]}).Op(DSP_OP_EQ, 0).Op(DSP_OP_GAIN, 0, {f32(0.5f)});
+        gainFirst.Op(DSP_OP_EQ_BAND, 0, {mid[0], mid[1], mid[2], mid[3]}).Op(DSP_OP_GAIN, 0, {f32(0.5f)}).Op(DSP_OP_EQ, 0);
+        void *gl = dsp_create_context(SR48k, CH_ST);
+        void *gf = dsp_create_context(SR48k, CH_ST);
+        dsp_set_program(gl, gainLast.bytes.data(), gainLast.bytes.size());
+        dsp_set_program(gf, gainFirst.bytes.data(), gainFirst.bytes.size());
+        run(gl, in, a);
+        run(gf, in, b);
+        float d = 0.0f;
+        for (size_t i = 0; i < a.size(); ++i)
+            d = std::max(d, std::fabs(a[i] - b[i]));
+        DSP_STATS sl, sf;
+        if (dsp_get_stats(gl, &sl) && dsp_get_stats(gf, &sf))
+            check(sl.stage[DSP_STAGE_GAIN].calls > 0 && sf.stage[DSP_STAGE_GAIN].calls == 0,
+                  "gain after EQ runs as its own stage, gain right before EQ is folded");
+        check(d < 1e-5f, "gain after EQ == gain before EQ (linear, rounding only)");
+        dsp_destroy_context(gl);
+        dsp_destroy_context(gf);
+
+        // 4) 没列出的级关闭：只有增益 0.5（限幅器默认开、EQ 开着一段都会被关掉）
+        void *only = dsp_create_context(SR48k, CH_ST);
+        dsp_set_eq_enabled(only, 0, 1);
+        dsp_set_eq_params(only, 0, 120.f, 0.707f, 6.f);
+        const std::vector<uint8_t> onlyGain = Program().Op(DSP_OP_GAIN, 0, {f32(0.5f)}).bytes;
+        dsp_set_program(only, onlyGain.data(), onlyGain.size());
+        run(only, in, a);
+        bool half = dsp_get_latency_frames(only) == 0;
+        for (size_t i = 0; i < a.size(); ++i)
+            half &= a[i] == in[i] * 0.5f;
+        check(half, "stages not listed in the program are off");
+        // 恢复默认顺序不改其余参数
+        dsp_set_program(only, nullptr, 0);
+        dsp_set_limiter_enabled(only, 1);
+        check(dsp_get_latency_frames(only) == 72, "empty program restores the default order");
+        dsp_destroy_context(only);
+
+        // 5) ParamsApply
+        {
+            MyDspParams p0{};
+            p0.gain = 1.0f;
+            p0.limiterEnabled = 1;
+            const std::vector<uint8_t> code = Program().Op(DSP_OP_GAIN, 0, {f32(0.5f)}).Op(DSP_OP_EQ, 0).bytes;
+            MyDspParams p1 = p0;
+            memcpy(p1.opcode, code.data(), code.size());
+            p1.opcodeSize = static_cast<uint32_t>(code.size());
+            MyDspParams p2 = p1;
+            p2.opcode[0] = 'X';
+            MyDspParams p3 = p2;
+            p3.opcodeSize = 0;
+            memset(p3.opcode, 0, sizeof(p3.opcode));
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            ParamsApplyCounters c{};
+            const uint32_t m0 = ParamsApply(ctx, nullptr, p0, &c);
+            const uint32_t m1 = ParamsApply(ctx, &p0, p1, &c);
+            const unsigned lat1 = dsp_get_latency_frames(ctx);
+            const uint32_t m2 = ParamsApply(ctx, &p1, p2, &c);
+            const unsigned lat2 = dsp_get_latency_frames(ctx);
+            const uint32_t m3 = ParamsApply(ctx, &p2, p2, &c);
+            const uint32_t m4 = ParamsApply(ctx, &p2, p3, &c);
+            check(!(m0 & kParamsChangedProgram) && m1 == kParamsChangedProgram && lat1 == 0 && m2 == 0 && lat2 == 0 &&
+                      m3 == 0 && m4 == kParamsChangedProgram && c.programLoads == 2 && c.programRejects == 1,
+                  "params apply loads the opcode program only when it changes, rejects bad ones");
+            dsp_destroy_context(ctx);
+        }
+
+        // 6) 控制线程交替载入两个只有增益的程序（0.5 / 0.25，不平滑），实时线程同时处理：
+        //    校验、解释、编译都在控制线程上，每块要么整块 ×0.5，要么整块 ×0.25
+        {
+            void *ctx = dsp_create_context(SR48k, CH_ST);
+            dsp_set_smoothing_ms(ctx, 0.0f);
+            MyDspParams pa{}, pb{};
+            const std::vector<uint8_t> ca = Program().Op(DSP_OP_GAIN, 0, {f32(0.5f)}).Op(DSP_OP_EQ, 0).bytes;
+            const std::vector<uint8_t> cb = Program().Op(DSP_OP_EQ, 0).Op(DSP_OP_GAIN, 0, {f32(0.25f)}).bytes;
+            pa.gain = 0.5f;
+            pb.gain = 0.25f;
+            memcpy(pa.opcode, ca.data(), ca.size());
+            memcpy(pb.opcode, cb.data(), cb.size());
+            pa.opcodeSize = static_cast<uint32_t>(ca.size());
+            pb.opcodeSize = static_cast<uint32_t>(cb.size());
+            ParamsApplyCounters c{};
+            ParamsApply(ctx, nullptr, pa, &c);
+            std::atomic<bool> done{false};
+            std::thread control([&]() {
+                for (int i = 0; i < 400; ++i)
+                {
+                    ParamsApply(ctx, i & 1 ? &pb : &pa, i & 1 ? pa : pb, &c);
+                    std::this_thread::yield();
+                }
+                done.store(true);
+            });
+            std::vector<float> o(static_cast<size_t>(B) * CH_ST);
+            bool whole = true;
+            int seen = 0;
+            for (size_t k = 0; !done.load() || k < 8; ++k)
+            {
+                const float *x = in.data() + (k * B % (frames - B)) * CH_ST;
+                dsp_process_block(ctx, x, o.data(), B, CH_ST);
+                size_t j = 0;
+                while (j + 1 < o.size() && x[j] == 0.0f)
+                    ++j;
+                const float g = o[j] == x[j] * 0.5f ? 0.5f : 0.25f;
+                for (size_t i = 0; i < o.size(); ++i)
+                    whole &= o[i] == x[i] * g;
+                seen |= g == 0.5f ? 1 : 2;
+            }
+            control.join();
+            std::cout << "[INFO] concurrent program loads: " << c.programLoads << ", gains seen mask " << seen << "\n";
+            check(whole && c.programLoads == 401 && c.programRejects == 0,
+                  "programs loaded on the control thread reach the RT thread as whole compiled snapshots");
+            dsp_destroy_context(ctx);
+        }
+    }
+
     std::cout << "\n已生成这些文件（当前工作目录）:\n"
               << "  in_float.wav, in_44100_float.wav(可选)\n"
               << "  out_null.wav, out_gain.wav, out_eq.wav, out_reverb.wav,\n"
@@ -345,5 +3611,5 @@ int main()
               << "  3) 限幅 on/off：观察波峰“圆角” vs “削顶”。\n"
               << "  4) reverb：观察尾音拉长与 ~20ms 预延迟。\n"
               << "  5) 通过上面 [TIMING] 行查看各用例的平均/最大耗时（μs/块）。\n";
-    return 0;
+    return g_failures ? 1 : 0;
 }
@@ -19,14 +19,34 @@ struct MyReverb {
     float   pre_ms;    // 0..100
 };
 
+struct MyLimiter {
+    float   threshold;     // 线性 0.01..1；<=0 表示未设置（整组用 DSP 默认值）
+    float   lookahead_ms;  // 0..10（决定 APO 报告的延迟）
+    float   release_ms;    // 1..1000
+    int32_t truePeak;      // 0/1：4 倍过采样检测样本间峰值
+    int32_t mode;          // 0=前瞻限幅 1=软限幅(tanh)
+};
+
+// 前 MY_DSP_PARAMS_BASE_BYTES 字节是最初的布局（C# ParamsPacker 等按固定偏移打包），新字段只能追加在末尾
 struct MyDspParams {
     float   gain;                // 线性
     MyEqBand eq[MY_EQ_BANDS];    // 12 段
     MyReverb reverb;
     int32_t limiterEnabled;      // 0/1
 
-    // 预留：后续下发“指令集/字节码”
+    // 处理程序字节码（格式见 dsp_wrapper.h 的 dsp_set_program）
     uint32_t opcodeSize;         // <= sizeof(opcode)
     uint8_t  opcode[512];
+
+    MyLimiter limiter;           // 追加：只发前 784 字节的老控制端这里是全 0（= DSP 默认值）
 };
 #pragma pack(pop)
+
+#define MY_DSP_PARAMS_BASE_BYTES 784 // 不含 limiter 组的旧长度
+
+#ifdef __cplusplus
+#include <stddef.h>
+static_assert(offsetof(MyDspParams, opcodeSize) == 268 && offsetof(MyDspParams, limiter) == MY_DSP_PARAMS_BASE_BYTES &&
+                  sizeof(MyDspParams) == MY_DSP_PARAMS_BASE_BYTES + sizeof(MyLimiter),
+              "MyDspParams 的二进制布局被改动了（控制端按固定偏移打包）");
+#endif
@@ -0,0 +1,132 @@
+// ParamsApply.cpp —— MyDspParams 的增量应用（说明见 ParamsApply.h）
+#include "ParamsApply.h"
+#include "dsp_wrapper.h"
+#include <math.h>
+#include <string.h>
+
+static bool SameEqShape(const MyEqBand &a, const MyEqBand &b)
+{
+    // 比较位模式即可：参数来自同一份二进制布局
+    return memcmp(&a.freq, &b.freq, sizeof(float)) == 0 && memcmp(&a.q, &b.q, sizeof(float)) == 0 &&
+           memcmp(&a.gain_db, &b.gain_db, sizeof(float)) == 0 && a.type == b.type;
+}
+
+static bool SameLimiter(const MyLimiter &a, const MyLimiter &b)
+{
+    return memcmp(&a, &b, sizeof(MyLimiter)) == 0;
+}
+
+static bool SameReverbShape(const MyReverb &a, const MyReverb &b)
+{
+    return memcmp(&a.wet, &b.wet, sizeof(float) * 4) == 0; // wet/room/damp/pre_ms 连续存放
+}
+
+bool ParamsValid(const MyDspParams &p)
+{
+    if (!isfinite(p.gain))
+        return false;
+    for (int b = 0; b < MY_EQ_BANDS; ++b)
+        if (!isfinite(p.eq[b].freq) || !isfinite(p.eq[b].q) || !isfinite(p.eq[b].gain_db))
+            return false;
+    const MyReverb &r = p.reverb;
+    const MyLimiter &l = p.limiter;
+    return isfinite(r.wet) && isfinite(r.room) && isfinite(r.damp) && isfinite(r.pre_ms) && isfinite(l.threshold) &&
+           isfinite(l.lookahead_ms) && isfinite(l.release_ms);
+}
+
+uint32_t ParamsApply(void *dspCtx, const MyDspParams *prev, const MyDspParams &next,
+                     ParamsApplyCounters *counters)
+{
+    ParamsApplyCounters dummy;
+    ParamsApplyCounters &n = counters ? *counters : dummy;
+    if (!dspCtx)
+        return 0;
+    if (!ParamsValid(next))
+    {
+        n.rejects++;
+        return kParamsRejected;
+    }
+    n.applies++;
+    if (!prev)
+        n.fullApplies++;
+
+    uint32_t changed = 0;
+    dsp_begin_update(dspCtx);
+
+    if (!prev || memcmp(&prev->gain, &next.gain, sizeof(float)) != 0)
+    {
+        dsp_set_gain(dspCtx, next.gain);
+        n.gainWrites++;
+        changed |= kParamsChangedGain;
+    }
+
+    for (int b = 0; b < MY_EQ_BANDS; ++b)
+    {
+        const MyEqBand &e = next.eq[b];
+        if (!prev || !SameEqShape(prev->eq[b], e))
+        {
+            dsp_set_eq_params_ex(dspCtx, b, e.freq, e.q, e.gain_db, (DSP_EQ_TYPE)e.type);
+            n.eqRedesigns++;
+            changed |= kParamsChangedEq;
+        }
+        if (!prev || (prev->eq[b].enabled != 0) != (e.enabled != 0))
+        {
+            dsp_set_eq_enabled(dspCtx, b, e.enabled);
+            n.eqToggles++;
+            changed |= kParamsChangedEq;
+        }
+    }
+
+    if (!prev || !SameReverbShape(prev->reverb, next.reverb))
+    {
+        dsp_set_reverb_params(dspCtx, next.reverb.wet, next.reverb.room, next.reverb.damp, next.reverb.pre_ms);
+        n.reverbUpdates++;
+        changed |= kParamsChangedReverb;
+    }
+    if (!prev || (prev->reverb.enabled != 0) != (next.reverb.enabled != 0))
+    {
+        dsp_set_reverb_enabled(dspCtx, next.reverb.enabled);
+        n.reverbToggles++;
+        changed |= kParamsChangedReverb;
+    }
+
+    if (!prev || (prev->limiterEnabled != 0) != (next.limiterEnabled != 0))
+    {
+        dsp_set_limiter_enabled(dspCtx, next.limiterEnabled);
+        n.limiterWrites++;
+        changed |= kParamsChangedLimiter;
+    }
+
+    if (!prev || !SameLimiter(prev->limiter, next.limiter))
+    {
+        const MyLimiter &l = next.limiter;
+        if (l.threshold > 0.f)
+            dsp_set_limiter_params(dspCtx, l.threshold, l.lookahead_ms, l.release_ms, l.truePeak);
+        else // 老的控制端不认识这组字段（全 0）
+            dsp_set_limiter_params(dspCtx, DSP_LIMITER_DEFAULT_THRESHOLD, DSP_LIMITER_DEFAULT_LOOKAHEAD_MS,
+                                   DSP_LIMITER_DEFAULT_RELEASE_MS, 0);
+        dsp_set_limiter_mode(dspCtx, l.mode == 1 ? DSP_LIMITER_SOFTCLIP : DSP_LIMITER_LOOKAHEAD);
+        n.limiterWrites++;
+        changed |= kParamsChangedLimiter;
+    }
+
+    const uint32_t opc = next.opcodeSize <= sizeof(next.opcode) ? next.opcodeSize : (uint32_t)sizeof(next.opcode);
+    // 没有上一份时上下文是新建的，已经是默认顺序
+    if (prev ? prev->opcodeSize != next.opcodeSize || memcmp(prev->opcode, next.opcode, opc) != 0 : opc != 0)
+    {
+        if (dsp_set_program(dspCtx, opc ? next.opcode : nullptr, opc))
+        {
+            n.programLoads++;
+            changed |= kParamsChangedProgram;
+        }
+        else
+        {
+            n.programRejects++;
+        }
+    }
+
+    dsp_commit_update(dspCtx); // 整次应用只发布一次快照
+    if (!changed)
+        n.noops++;
+    return changed;
+}
@@ -0,0 +1,45 @@
+// ParamsApply.h —— 把一份 MyDspParams 增量应用到 DSP 上下文（与上一次应用的参数逐字段比较）
+// 只重新设计变了的 EQ 段，混响字段没变就不碰混响；整次应用只发布一次 DSP 快照。
+// opcode 是 DSP 处理程序（格式见 dsp_wrapper.h 的 dsp_set_program）：变了才重新载入，在各字段之后生效。
+// 不依赖 Windows 头文件：APO 与 EfxTestHost 共用。
+#pragma once
+#include <stdint.h>
+#include "MyApoParams.h"
+
+// 累计计数：看每次下发参数实际做了多少事
+struct ParamsApplyCounters
+{
+    uint32_t applies;       // 应用次数
+    uint32_t noops;         // 与上次完全相同、什么都没做的次数
+    uint32_t fullApplies;   // 没有上一份可比（首次/重建上下文），全部写入的次数
+    uint32_t gainWrites;
+    uint32_t eqRedesigns;   // 要求重新设计系数的段数（DSP 在发布前批量算）
+    uint32_t eqToggles;     // 只改开关的段数
+    uint32_t reverbUpdates; // 混响参数重配次数
+    uint32_t reverbToggles;
+    uint32_t limiterWrites;
+    uint32_t programLoads;   // 处理程序载入次数（含 opcodeSize=0 恢复默认顺序）
+    uint32_t programRejects; // 校验没通过、保持原程序的次数
+    uint32_t rejects;        // 整份被拒（有非有限的浮点字段）、什么都没改的次数
+};
+
+// 本次应用改动了什么（位掩码，见 ParamsApplyChanged）
+enum : uint32_t
+{
+    kParamsChangedGain = 1u << 0,
+    kParamsChangedEq = 1u << 1,
+    kParamsChangedReverb = 1u << 2,
+    kParamsChangedLimiter = 1u << 3,
+    kParamsChangedProgram = 1u << 4,
+    kParamsRejected = 1u << 31, // 整份被拒，DSP 保持原样；调用方不应把 next 当作已生效
+};
+
+// prev 为 nullptr 时整份写入；返回改动位掩码，counters 可为 nullptr。
+// 参数来自共享内存/管道，任一浮点字段是 NaN/Inf 时整份拒绝（同 dsp_set_program 的 isfinite 校验）；
+// 有限但超范围的值由各 dsp_set_* 夹到合法范围
+// 非实时线程调用（APO 里在 PipeThreadMain，作为 DSP 参数的唯一写者；处理程序的校验与编译也在这里完成）
+uint32_t ParamsApply(void *dspCtx, const MyDspParams *prev, const MyDspParams &next,
+                     ParamsApplyCounters *counters);
+
+// ParamsApply 的整份校验：所有浮点字段都是有限值（opcode 里的常量由 dsp_set_program 自己校验）
+bool ParamsValid(const MyDspParams &p);
@@ -0,0 +1,291 @@
+// ParamsWire.cpp —— 参数线格式的编码/解码（格式说明见 ParamsWire.h）
+#include "ParamsWire.h"
+#include <string.h>
+
+// ---- CRC32（反射多项式 0xEDB88320），表在编译期生成 ----
+namespace
+{
+struct Crc32Table
+{
+    uint32_t v[256];
+    constexpr Crc32Table() : v()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            v[i] = c;
+        }
+    }
+};
+constexpr Crc32Table kCrc32;
+
+const uint32_t kRecordHeaderBytes = 4; // tag + index + len
+
+inline uint32_t Align4(uint32_t n) { return (n + 3u) & ~3u; }
+
+// 已知 tag 的值长度；可变长/未知返回 -1
+int FixedLength(uint8_t tag)
+{
+    switch (tag)
+    {
+    case kWireGain:
+    case kWireLimiter:
+    case kWireEqEnabled:
+    case kWireEqFreq:
+    case kWireEqQ:
+    case kWireEqGain:
+    case kWireEqType:
+    case kWireReverbEnabled:
+    case kWireReverbWet:
+        return 4;
+    case kWireEqBand:
+        return (int)sizeof(MyEqBand);
+    case kWireReverb:
+        return (int)sizeof(MyReverb);
+    case kWireLimiterParams:
+        return (int)sizeof(MyLimiter);
+    default:
+        return -1;
+    }
+}
+
+bool IsBandTag(uint8_t tag) { return tag >= kWireEqBand && tag <= kWireEqType; }
+
+bool ValidRecord(uint8_t tag, uint8_t index, uint16_t len)
+{
+    if (tag == kWireOpcode)
+        return len <= sizeof(MyDspParams::opcode);
+    const int fixed = FixedLength(tag);
+    if (fixed < 0)
+        return true; // 未知 tag：跳过
+    if (len != (uint16_t)fixed)
+        return false;
+    return !IsBandTag(tag) || index < MY_EQ_BANDS;
+}
+
+void ApplyRecord(uint8_t tag, uint8_t index, const uint8_t *v, uint16_t len, MyDspParams &p)
+{
+    switch (tag)
+    {
+    case kWireGain:          memcpy(&p.gain, v, 4); break;
+    case kWireLimiter:       memcpy(&p.limiterEnabled, v, 4); break;
+    case kWireEqBand:        memcpy(&p.eq[index], v, sizeof(MyEqBand)); break;
+    case kWireEqEnabled:     memcpy(&p.eq[index].enabled, v, 4); break;
+    case kWireEqFreq:        memcpy(&p.eq[index].freq, v, 4); break;
+    case kWireEqQ:           memcpy(&p.eq[index].q, v, 4); break;
+    case kWireEqGain:        memcpy(&p.eq[index].gain_db, v, 4); break;
+    case kWireEqType:        memcpy(&p.eq[index].type, v, 4); break;
+    case kWireReverb:        memcpy(&p.reverb, v, sizeof(MyReverb)); break;
+    case kWireReverbEnabled: memcpy(&p.reverb.enabled, v, 4); break;
+    case kWireReverbWet:     memcpy(&p.reverb.wet, v, 4); break;
+    case kWireLimiterParams: memcpy(&p.limiter, v, sizeof(MyLimiter)); break;
+    case kWireOpcode:
+        memcpy(p.opcode, v, len);
+        memset(p.opcode + len, 0, sizeof(p.opcode) - len); // 有效长度之外统一清零
+        p.opcodeSize = len;
+        break;
+    default: break;
+    }
+}
+
+inline bool Same32(const void *a, const void *b) { return memcmp(a, b, 4) == 0; }
+} // namespace
+
+uint32_t ParamsWireCrc32(const void *data, uint32_t bytes)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    uint32_t c = 0xFFFFFFFFu;
+    for (uint32_t i = 0; i < bytes; ++i)
+        c = kCrc32.v[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+// ===================== 编码 =====================
+ParamsWireWriter::ParamsWireWriter(uint8_t *buf, uint32_t capacity)
+    : m_buf(buf), m_cap(capacity), m_pos((uint32_t)sizeof(ParamsWireHeader)), m_count(0),
+      m_overflow(!buf || capacity < sizeof(ParamsWireHeader))
+{
+}
+
+bool ParamsWireWriter::Record(uint8_t tag, uint8_t index, const void *value, uint16_t len)
+{
+    const uint32_t need = kRecordHeaderBytes + Align4(len);
+    if (m_overflow || m_pos + need > m_cap || m_count == 0xFFFF)
+    {
+        m_overflow = true;
+        return false;
+    }
+    uint8_t *r = m_buf + m_pos;
+    r[0] = tag;
+    r[1] = index;
+    memcpy(r + 2, &len, 2);
+    if (len)
+        memcpy(r + kRecordHeaderBytes, value, len);
+    memset(r + kRecordHeaderBytes + len, 0, Align4(len) - len);
+    m_pos += need;
+    ++m_count;
+    return true;
+}
+
+bool ParamsWireWriter::Gain(float linear) { return Record(kWireGain, 0, &linear, 4); }
+bool ParamsWireWriter::Limiter(bool enabled)
+{
+    const int32_t v = enabled ? 1 : 0;
+    return Record(kWireLimiter, 0, &v, 4);
+}
+bool ParamsWireWriter::LimiterParams(const MyLimiter &l) { return Record(kWireLimiterParams, 0, &l, sizeof(l)); }
+bool ParamsWireWriter::EqBand(int band, const MyEqBand &e) { return Record(kWireEqBand, (uint8_t)band, &e, sizeof(e)); }
+bool ParamsWireWriter::EqEnabled(int band, bool enabled)
+{
+    const int32_t v = enabled ? 1 : 0;
+    return Record(kWireEqEnabled, (uint8_t)band, &v, 4);
+}
+bool ParamsWireWriter::EqFreq(int band, float hz) { return Record(kWireEqFreq, (uint8_t)band, &hz, 4); }
+bool ParamsWireWriter::EqQ(int band, float q) { return Record(kWireEqQ, (uint8_t)band, &q, 4); }
+bool ParamsWireWriter::EqGain(int band, float db) { return Record(kWireEqGain, (uint8_t)band, &db, 4); }
+bool ParamsWireWriter::EqType(int band, int type)
+{
+    const int32_t v = type;
+    return Record(kWireEqType, (uint8_t)band, &v, 4);
+}
+bool ParamsWireWriter::Reverb(const MyReverb &r) { return Record(kWireReverb, 0, &r, sizeof(r)); }
+bool ParamsWireWriter::ReverbEnabled(bool enabled)
+{
+    const int32_t v = enabled ? 1 : 0;
+    return Record(kWireReverbEnabled, 0, &v, 4);
+}
+bool ParamsWireWriter::ReverbWet(float wet) { return Record(kWireReverbWet, 0, &wet, 4); }
+bool ParamsWireWriter::Opcode(const uint8_t *code, uint32_t size)
+{
+    if (size > sizeof(MyDspParams::opcode))
+    {
+        m_overflow = true;
+        return false;
+    }
+    return Record(kWireOpcode, 0, code, (uint16_t)size);
+}
+
+uint32_t ParamsWireWriter::Finish()
+{
+    if (m_overflow)
+        return 0;
+    ParamsWireHeader h;
+    h.magic = PARAMS_WIRE_MAGIC;
+    h.version = (uint16_t)PARAMS_WIRE_VERSION;
+    h.count = m_count;
+    h.payloadBytes = m_pos - (uint32_t)sizeof(h);
+    h.crc32 = ParamsWireCrc32(m_buf + sizeof(h), h.payloadBytes);
+    memcpy(m_buf, &h, sizeof(h));
+    return m_pos;
+}
+
+uint32_t ParamsWireEncodeDelta(const MyDspParams *prev, const MyDspParams &next, uint8_t *buf, uint32_t capacity)
+{
+    ParamsWireWriter w(buf, capacity);
+
+    if (!prev || !Same32(&prev->gain, &next.gain))
+        w.Gain(next.gain);
+    if (!prev || prev->limiterEnabled != next.limiterEnabled)
+        w.Limiter(next.limiterEnabled != 0);
+    if (!prev || memcmp(&prev->limiter, &next.limiter, sizeof(MyLimiter)) != 0)
+        w.LimiterParams(next.limiter);
+
+    for (int b = 0; b < MY_EQ_BANDS; ++b)
+    {
+        const MyEqBand &e = next.eq[b];
+        if (!prev)
+        {
+            w.EqBand(b, e);
+            continue;
+        }
+        const MyEqBand &o = prev->eq[b];
+        const bool en = o.enabled != e.enabled, fr = !Same32(&o.freq, &e.freq), q = !Same32(&o.q, &e.q),
+                   g = !Same32(&o.gain_db, &e.gain_db), ty = o.type != e.type;
+        const int n = en + fr + q + g + ty;
+        if (n > 1)
+            w.EqBand(b, e);
+        else if (en)
+            w.Record(kWireEqEnabled, (uint8_t)b, &e.enabled, 4);
+        else if (fr)
+            w.EqFreq(b, e.freq);
+        else if (q)
+            w.EqQ(b, e.q);
+        else if (g)
+            w.EqGain(b, e.gain_db);
+        else if (ty)
+            w.EqType(b, e.type);
+    }
+
+    const MyReverb &r = next.reverb;
+    if (!prev)
+        w.Reverb(r);
+    else
+    {
+        const MyReverb &o = prev->reverb;
+        const bool en = o.enabled != r.enabled, wet = !Same32(&o.wet, &r.wet);
+        const bool rest = memcmp(&o.room, &r.room, sizeof(float) * 3) != 0; // room/damp/pre_ms
+        if (rest || (en && wet))
+            w.Reverb(r);
+        else if (en)
+            w.Record(kWireReverbEnabled, 0, &r.enabled, 4);
+        else if (wet)
+            w.ReverbWet(r.wet);
+    }
+
+    const uint32_t opc = next.opcodeSize <= sizeof(next.opcode) ? next.opcodeSize : (uint32_t)sizeof(next.opcode);
+    if (!prev || prev->opcodeSize != next.opcodeSize || memcmp(prev->opcode, next.opcode, opc) != 0)
+        w.Opcode(next.opcode, opc);
+
+    return w.Finish();
+}
+
+// ===================== 解码 =====================
+ParamsWireResult ParamsWireDecode(const void *msg, uint32_t bytes, MyDspParams &params, uint32_t *records)
+{
+    if (records)
+        *records = 0;
+    if (!msg || bytes < sizeof(ParamsWireHeader))
+        return kWireTruncated;
+    const uint8_t *m = static_cast<const uint8_t *>(msg);
+    ParamsWireHeader h;
+    memcpy(&h, m, sizeof(h));
+    if (h.magic != PARAMS_WIRE_MAGIC)
+        return kWireBadMagic;
+    if (h.version != PARAMS_WIRE_VERSION)
+        return kWireBadVersion;
+    if (h.payloadBytes > bytes - sizeof(h))
+        return kWireTruncated;
+    const uint8_t *payload = m + sizeof(h);
+    if (ParamsWireCrc32(payload, h.payloadBytes) != h.crc32)
+        return kWireBadCrc;
+
+    // 第一遍：只校验，保证要么整条生效、要么一条都不生效
+    uint32_t pos = 0;
+    for (uint16_t i = 0; i < h.count; ++i)
+    {
+        if (h.payloadBytes - pos < kRecordHeaderBytes)
+            return kWireTruncated;
+        uint16_t len;
+        memcpy(&len, payload + pos + 2, 2);
+        if (h.payloadBytes - pos - kRecordHeaderBytes < Align4(len))
+            return kWireTruncated;
+        if (!ValidRecord(payload[pos], payload[pos + 1], len))
+            return kWireBadRecord;
+        pos += kRecordHeaderBytes + Align4(len);
+    }
+
+    // 第二遍：写入
+    pos = 0;
+    for (uint16_t i = 0; i < h.count; ++i)
+    {
+        uint16_t len;
+        memcpy(&len, payload + pos + 2, 2);
+        ApplyRecord(payload[pos], payload[pos + 1], payload + pos + kRecordHeaderBytes, len, params);
+        pos += kRecordHeaderBytes + Align4(len);
+    }
+    if (records)
+        *records = h.count;
+    return kWireOk;
+}
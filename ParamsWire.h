@@ -0,0 +1,97 @@
+// ParamsWire.h —— 参数的紧凑二进制线格式（带版本、自描述 TLV、只带改动的字段、CRC32 校验）
+// 一条消息 = 16 字节头 + 若干条记录；一条消息里的所有记录是一个事务：
+// 解码时先整条校验（魔数/版本/长度/CRC/每条记录），全部通过才写入参数，否则参数保持不变。
+// 记录：tag(1) + index(1) + len(2) + len 字节的值，按 4 字节对齐；不认识的 tag 按 len 跳过（向前兼容）。
+// 数值一律小端、与 MyDspParams 里的字段同样的 32 位表示。
+// 不依赖 Windows 头文件：ApoCtl、APO（ApoShmCtl.h）与 EfxTestHost 共用。
+#pragma once
+#include <stdint.h>
+#include "MyApoParams.h"
+
+#define PARAMS_WIRE_MAGIC 0x5750594Du // 'MYPW'
+#define PARAMS_WIRE_VERSION 1u
+#define PARAMS_WIRE_MAX_BYTES 1024u   // 单条消息上限（整份参数含 512 字节 opcode 也放得下）
+
+#pragma pack(push, 1)
+struct ParamsWireHeader
+{
+    uint32_t magic;        // PARAMS_WIRE_MAGIC
+    uint16_t version;      // PARAMS_WIRE_VERSION
+    uint16_t count;        // 记录条数
+    uint32_t payloadBytes; // 头后面的字节数
+    uint32_t crc32;        // 记录区的 CRC32（IEEE 802.3）
+};
+#pragma pack(pop)
+static_assert(sizeof(ParamsWireHeader) == 16, "wire header layout");
+
+// 记录类型（值的长度固定的 tag，解码时校验 len）
+enum ParamsWireTag : uint8_t
+{
+    kWireGain = 1,          // f32
+    kWireLimiter = 2,       // i32 0/1
+    kWireEqBand = 3,        // index=段号；整段 MyEqBand（20 字节）
+    kWireEqEnabled = 4,     // index=段号；i32
+    kWireEqFreq = 5,        // index=段号；f32
+    kWireEqQ = 6,           // index=段号；f32
+    kWireEqGain = 7,        // index=段号；f32（拖一个滑块就是这一条）
+    kWireEqType = 8,        // index=段号；i32
+    kWireReverb = 9,        // 整个 MyReverb（20 字节）
+    kWireReverbEnabled = 10,// i32
+    kWireReverbWet = 11,    // f32
+    kWireOpcode = 12,       // 0..512 字节，整块替换 opcode/opcodeSize
+    kWireLimiterParams = 13,// 整个 MyLimiter（20 字节）
+};
+
+enum ParamsWireResult
+{
+    kWireOk = 0,
+    kWireTruncated,   // 长度不够（头或记录越界）
+    kWireBadMagic,
+    kWireBadVersion,
+    kWireBadCrc,
+    kWireBadRecord,   // 已知 tag 的长度/段号不合法
+};
+
+// 逐条追加记录，Finish() 补上头部。缓冲区不够时后续调用全部失败，Finish() 返回 0
+class ParamsWireWriter
+{
+public:
+    ParamsWireWriter(uint8_t *buf, uint32_t capacity);
+
+    bool Gain(float linear);
+    bool Limiter(bool enabled);
+    bool LimiterParams(const MyLimiter &l);
+    bool EqBand(int band, const MyEqBand &e);
+    bool EqEnabled(int band, bool enabled);
+    bool EqFreq(int band, float hz);
+    bool EqQ(int band, float q);
+    bool EqGain(int band, float db);
+    bool EqType(int band, int type);
+    bool Reverb(const MyReverb &r);
+    bool ReverbEnabled(bool enabled);
+    bool ReverbWet(float wet);
+    bool Opcode(const uint8_t *code, uint32_t size);
+    // 任意记录（测试未知 tag 的兼容性时用）
+    bool Record(uint8_t tag, uint8_t index, const void *value, uint16_t len);
+
+    uint16_t Count() const { return m_count; }
+    // 写入头部（含 CRC），返回整条消息的字节数；溢出或没有缓冲区时返回 0
+    uint32_t Finish();
+
+private:
+    uint8_t *m_buf;
+    uint32_t m_cap;
+    uint32_t m_pos;
+    uint16_t m_count;
+    bool m_overflow;
+};
+
+// 编码 prev → next 的改动（prev 为 nullptr 时编码整份参数）；返回字节数，缓冲区不够返回 0。
+// 一段里只改了一个字段时发单字段记录，改了多个字段时发整段记录；完全相同时只有头（count=0）
+uint32_t ParamsWireEncodeDelta(const MyDspParams *prev, const MyDspParams &next, uint8_t *buf, uint32_t capacity);
+
+// 把一条消息应用到 params 上：先整条校验再写入，失败时 params 不变。
+// 无分配、无系统调用，可以在实时线程上调用。records 可为 nullptr
+ParamsWireResult ParamsWireDecode(const void *msg, uint32_t bytes, MyDspParams &params, uint32_t *records = nullptr);
+
+uint32_t ParamsWireCrc32(const void *data, uint32_t bytes);
@@ -95,7 +95,7 @@ static class DebugLog
     }
 }
 
-// ===================== 参数模型 & 打包（784B） =====================
+// ===================== 参数模型 & 打包（804B = MyDspParams：前 784B 是旧布局，limiter 组追加在末尾） =====================
 
 public enum EqType : int { Peak = 0, LowShelf = 1, HighShelf = 2 }
 
@@ -123,6 +123,18 @@ public class ReverbModel
         $"{(Enabled ? "On" : "Off")} wet={Wet:0.00} room={Room:0.00} damp={Damp:0.00} pre={PreMs}ms";
 }
 
+[TypeConverter(typeof(ExpandableObjectConverter))]
+public class LimiterModel
+{
+    public float Threshold { get; set; } = 0.98f;  // 线性；<=0 用 DSP 默认值
+    public float LookaheadMs { get; set; } = 1.5f;
+    public float ReleaseMs { get; set; } = 50f;
+    public bool TruePeak { get; set; } = false;
+    public bool SoftClip { get; set; } = false;
+    public override string ToString() =>
+        $"thr={Threshold:0.00} look={LookaheadMs}ms rel={ReleaseMs}ms{(TruePeak ? " tp" : "")}{(SoftClip ? " softclip" : "")}";
+}
+
 [TypeConverter(typeof(ExpandableObjectConverter))]
 public class DspParamsModel
 {
@@ -160,6 +172,9 @@ public class DspParamsModel
     [Category("03 FX")]
     public bool LimiterEnabled { get; set; } = true;
 
+    [Category("03 FX")]
+    public LimiterModel Limiter { get; set; } = new LimiterModel();
+
     [Browsable(false)] public byte[] Opcode { get; set; } = Array.Empty<byte>();
 
     public IEnumerable<EqBandModel> Bands()
@@ -173,7 +188,7 @@ internal static class ParamsPacker
 {
     public static byte[] Pack(DspParamsModel m)
     {
-        byte[] buf = new byte[784];
+        byte[] buf = new byte[804];
         int off = 0;
         void W32(int v) { BitConverter.GetBytes(v).CopyTo(buf, off); off += 4; }
         void WU32(uint v) { BitConverter.GetBytes(v).CopyTo(buf, off); off += 4; }
@@ -188,6 +203,10 @@ internal static class ParamsPacker
         var op = (m.Opcode ?? Array.Empty<byte>()).Take(512).ToArray();
         WU32((uint)op.Length);
         Array.Copy(op, 0, buf, off, op.Length);
+        off += 512;
+
+        WF(m.Limiter.Threshold); WF(m.Limiter.LookaheadMs); WF(m.Limiter.ReleaseMs);
+        W32(m.Limiter.TruePeak ? 1 : 0); W32(m.Limiter.SoftClip ? 1 : 0);
 
         try { File.WriteAllBytes(DebugLog.PayloadPath, buf); } catch { }
         return buf;
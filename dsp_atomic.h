@@ -0,0 +1,90 @@
+#pragma once
+// dsp_atomic.h —— DSP 内部用的最小原子操作封装（C 代码可用，不依赖 <stdatomic.h>）
+// MSVC 走 Interlocked 内建函数（自带全屏障，x86/ARM64 语义一致），GCC/Clang 走 __atomic。
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef volatile long dsp_atomic_t;
+
+// 读（acquire）
+static inline long dsp_atomic_load(dsp_atomic_t* p) {
+#if defined(_MSC_VER)
+    return _InterlockedOr(p, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+// 写（release）
+static inline void dsp_atomic_store(dsp_atomic_t* p, long v) {
+#if defined(_MSC_VER)
+    _InterlockedExchange(p, v);
+#else
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#endif
+}
+
+// 交换，返回旧值（acq_rel）
+static inline long dsp_atomic_xchg(dsp_atomic_t* p, long v) {
+#if defined(_MSC_VER)
+    return _InterlockedExchange(p, v);
+#else
+    return __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL);
+#endif
+}
+
+// 加法，返回新值
+static inline long dsp_atomic_add(dsp_atomic_t* p, long v) {
+#if defined(_MSC_VER)
+    return _InterlockedExchangeAdd(p, v) + v;
+#else
+    return __atomic_add_fetch(p, v, __ATOMIC_ACQ_REL);
+#endif
+}
+
+// 指针（交接堆对象用，例如卷积 IR）：读（acquire）/ 交换（acq_rel）
+typedef void* volatile dsp_atomic_ptr_t;
+
+static inline void* dsp_atomic_load_ptr(dsp_atomic_ptr_t* p) {
+#if defined(_MSC_VER)
+    return _InterlockedCompareExchangePointer(p, NULL, NULL);
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void* dsp_atomic_xchg_ptr(dsp_atomic_ptr_t* p, void* v) {
+#if defined(_MSC_VER)
+    return _InterlockedExchangePointer(p, v);
+#else
+    return __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL);
+#endif
+}
+
+// 自旋时让出流水线
+static inline void dsp_cpu_relax(void) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(_MSC_VER) && (defined(_M_ARM64) || defined(_M_ARM))
+    __yield();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// 控制线程之间的写者锁（实时线程从不拿这把锁）
+static inline void dsp_spin_lock(dsp_atomic_t* p) {
+    while (dsp_atomic_xchg(p, 1)) dsp_cpu_relax();
+}
+static inline void dsp_spin_unlock(dsp_atomic_t* p) {
+    dsp_atomic_store(p, 0);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+// dsp_clock.h —— DSP 内部计时用的高精度时钟（不对外公开）
+// x86/x64：TSC（现代 CPU 上为恒定频率）；ARM64：通用计时器 CNTVCT；其他平台退回 timespec_get。
+// 只返回原始计数，换算成秒用 dsp_clock_ticks_per_second()（首次调用时校准一次，非实时线程调用）。
+#include <stdint.h>
+#include <time.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline uint64_t dsp_clock_ticks(void) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    return (uint64_t)_ReadStatusReg(0x5F02);    // ARM64_CNTVCT
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// 每秒的计数（对照系统时钟校准，结果缓存）
+double dsp_clock_ticks_per_second(void);
+
+#ifdef __cplusplus
+}
+#endif
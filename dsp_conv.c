@@ -0,0 +1,167 @@
+// dsp_conv.c —— 均匀分块 overlap-save FFT 卷积（原理见 dsp_conv.h）
+#include "dsp_conv.h"
+#include "dsp_fft.h"
+#include <string.h>
+
+struct DspConv {
+    DspFft*   fft;        // 2B 点实数 FFT，所有通道共用
+    unsigned  B, N, P;    // 分块长度、FFT 长度（2B）、分块数
+    unsigned  ch, nIr;
+    unsigned  pos;        // 当前分块已收到的帧数（0..B-1）
+    unsigned  head;       // 频域延迟线里最新一块频谱的下标
+    float*    H;          // IR 频谱 [nIr][P][N]（已含逆变换的 1/N）
+    float*    fdl;        // 频域延迟线 [ch][P][N]：最近 P 个输入块的频谱（环形）
+    float*    in;         // [ch][N]：前 B 帧是上一块输入，后 B 帧是正在收的这一块
+    float*    out;        // [ch][B]：上一分块算出的输出，本分块逐帧送出
+    float*    acc;        // [N] 频域累加结果
+    float*    y;          // [N] 逆变换结果
+    const float** xs;     // [P] 本分块按时间对齐的输入频谱指针（x[p] 对应 H[p]）
+    const float** hs;     // [nIr][P] 各 IR 的分块频谱指针
+    size_t    bytes;      // 本对象这块内存（FFT 计划另算，只有几 KB）
+};
+
+static size_t conv_take(size_t* cursor, size_t bytes) {
+    const size_t off = *cursor;
+    *cursor = (off + bytes + DSP_MEM_ALIGN - 1) & ~(size_t)(DSP_MEM_ALIGN - 1);
+    return off;
+}
+
+DspConv* dsp_conv_create(const float* ir, size_t taps, size_t stride, unsigned irCount, unsigned channels,
+                         unsigned partition) {
+    if (!ir || taps == 0 || taps > DSP_CONV_MAX_TAPS || stride < taps || irCount == 0 || channels == 0) return NULL;
+    if (partition < DSP_CONV_MIN_PARTITION || partition > DSP_CONV_MAX_PARTITION || (partition & (partition - 1)))
+        return NULL;
+    if (irCount > channels) irCount = channels;   // 多出来的 IR 用不到
+
+    const unsigned B = partition, N = 2 * partition;
+    const unsigned P = (unsigned)((taps + B - 1) / B);
+    size_t cur = 0;
+    conv_take(&cur, sizeof(DspConv));
+    const size_t offH   = conv_take(&cur, sizeof(float) * N * P * irCount);
+    const size_t offFdl = conv_take(&cur, sizeof(float) * N * P * channels);
+    const size_t offIn  = conv_take(&cur, sizeof(float) * N * channels);
+    const size_t offOut = conv_take(&cur, sizeof(float) * B * channels);
+    const size_t offAcc = conv_take(&cur, sizeof(float) * N);
+    const size_t offY   = conv_take(&cur, sizeof(float) * N);
+    const size_t offXs  = conv_take(&cur, sizeof(float*) * P);
+    const size_t offHs  = conv_take(&cur, sizeof(float*) * P * irCount);
+
+    unsigned char* base = (unsigned char*)dsp_aligned_alloc(cur, DSP_MEM_ALIGN);   // 已清零
+    if (!base) return NULL;
+    DspConv* v = (DspConv*)base;
+    v->fft = dsp_fft_create(N);
+    if (!v->fft) { dsp_aligned_free(base); return NULL; }
+    v->B = B; v->N = N; v->P = P;
+    v->ch = channels; v->nIr = irCount;
+    v->H   = (float*)(base + offH);
+    v->fdl = (float*)(base + offFdl);
+    v->in  = (float*)(base + offIn);
+    v->out = (float*)(base + offOut);
+    v->acc = (float*)(base + offAcc);
+    v->y   = (float*)(base + offY);
+    v->xs  = (const float**)(base + offXs);
+    v->hs  = (const float**)(base + offHs);
+    v->bytes = cur;
+
+    // IR 分块：前 B 个点放块内系数、后 B 个点补零，乘上 1/N 后做正变换
+    const float scale = 1.f / (float)N;
+    for (unsigned r = 0; r < irCount; ++r) {
+        const float* h = ir + (size_t)r * stride;
+        for (unsigned p = 0; p < P; ++p) {
+            const size_t t0 = (size_t)p * B;
+            const size_t n = taps - t0 < B ? taps - t0 : B;
+            memset(v->y, 0, sizeof(float) * N);
+            for (size_t i = 0; i < n; ++i) v->y[i] = h[t0 + i] * scale;
+            float* Hp = v->H + ((size_t)r * P + p) * N;
+            dsp_fft_forward(v->fft, v->y, Hp);
+            v->hs[(size_t)r * P + p] = Hp;
+        }
+    }
+    memset(v->y, 0, sizeof(float) * N);
+    return v;
+}
+
+void dsp_conv_destroy(DspConv* v) {
+    if (!v) return;
+    dsp_fft_destroy(v->fft);
+    dsp_aligned_free(v);
+}
+
+unsigned dsp_conv_partition(const DspConv* v) { return v ? v->B : 0; }
+size_t   dsp_conv_bytes(const DspConv* v)     { return v ? v->bytes : 0; }
+size_t   dsp_conv_length(const DspConv* v)    { return v ? (size_t)v->P * v->B : 0; }
+
+void dsp_conv_reset(DspConv* v) {
+    memset(v->fdl, 0, sizeof(float) * v->N * v->P * v->ch);
+    memset(v->in,  0, sizeof(float) * v->N * v->ch);
+    memset(v->out, 0, sizeof(float) * v->B * v->ch);
+    v->pos = 0;
+    v->head = 0;
+}
+
+int dsp_conv_take_history(DspConv* dst, const DspConv* src) {
+    if (dst->B != src->B || dst->ch != src->ch) return 0;
+    const unsigned N = dst->N;
+    const unsigned k = dst->P < src->P ? dst->P : src->P;   // 最多接上 k 块频谱（更早的已经用不到）
+    for (unsigned c = 0; c < dst->ch; ++c) {
+        float* d = dst->fdl + (size_t)c * dst->P * N;
+        const float* s = src->fdl + (size_t)c * src->P * N;
+        for (unsigned i = 0; i < k; ++i) {
+            const unsigned from = (src->head + src->P - i) % src->P;
+            memcpy(d + (size_t)(k - 1 - i) * N, s + (size_t)from * N, sizeof(float) * N);
+        }
+    }
+    memcpy(dst->in,  src->in,  sizeof(float) * N * dst->ch);
+    memcpy(dst->out, src->out, sizeof(float) * dst->B * dst->ch);
+    dst->pos  = src->pos;
+    dst->head = k - 1;
+    return 1;
+}
+
+// 收满一块：各通道做一次正变换、频谱乘加、逆变换
+static void conv_partition(DspConv* v, dsp_spec_mac_fn mac) {
+    const unsigned B = v->B, N = v->N, P = v->P;
+    v->head = v->head + 1 == P ? 0 : v->head + 1;
+    for (unsigned c = 0; c < v->ch; ++c) {
+        float* fdl = v->fdl + (size_t)c * P * N;
+        float* in  = v->in  + (size_t)c * N;
+        dsp_fft_forward(v->fft, in, fdl + (size_t)v->head * N);
+        for (unsigned p = 0, i = v->head; p < P; ++p, i = i ? i - 1 : P - 1) v->xs[p] = fdl + (size_t)i * N;
+        mac(v->acc, v->xs, v->hs + (size_t)(c % v->nIr) * P, P, N / 2);
+        dsp_fft_inverse(v->fft, v->acc, v->y);
+        memcpy(v->out + (size_t)c * B, v->y + B, sizeof(float) * B);   // 后半段是有效的线性卷积
+        memcpy(in, in + B, sizeof(float) * B);                          // 本块变成下一次的“上一块”
+    }
+}
+
+void dsp_conv_process(DspConv* v, dsp_spec_mac_fn mac, float* buf, size_t frames, unsigned lanes) {
+    const unsigned B = v->B, N = v->N;
+    while (frames) {
+        size_t n = B - v->pos;
+        if (n > frames) n = frames;
+        // 这 n 帧：输入进本块缓冲，同时送出上一分块算好的输出（正好晚 B 帧）
+        for (unsigned c = 0; c < v->ch; ++c) {
+            float* in = v->in + (size_t)c * N + B + v->pos;
+            const float* out = v->out + (size_t)c * B + v->pos;
+            float* x = buf + c;
+            for (size_t i = 0; i < n; ++i, x += lanes) {
+                in[i] = *x;
+                *x = out[i];
+            }
+        }
+        v->pos += (unsigned)n;
+        buf += n * lanes;
+        frames -= n;
+        if (v->pos == B) {
+            conv_partition(v, mac);
+            v->pos = 0;
+        }
+    }
+}
+
+void dsp_conv_block(DspConv* v, dsp_spec_mac_fn mac, const float* const* in, float* const* out) {
+    const unsigned B = v->B, N = v->N;
+    for (unsigned c = 0; c < v->ch; ++c) memcpy(v->in + (size_t)c * N + B, in[c], sizeof(float) * B);
+    conv_partition(v, mac);
+    for (unsigned c = 0; c < v->ch; ++c) memcpy(out[c], v->out + (size_t)c * B, sizeof(float) * B);
+}
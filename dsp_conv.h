@@ -0,0 +1,51 @@
+#pragma once
+// dsp_conv.h —— 均匀分块 overlap-save FFT 卷积（DSP 内部用，不对外公开）
+// IR 切成长度 B 的 P 块，每块补零到 2B 做 FFT 存好；运行时每攒满 B 帧：
+//   本块输入（连同上一块）做一次 FFT 推进频域延迟线 → 与 P 块 IR 频谱逐 bin 乘加 → 一次逆 FFT 取后半段。
+// 每 B 帧的代价 = 2 次 2B 点 FFT + P 次频谱乘加，与 IR 长度成线性、与宿主块大小无关；延迟正好 B 帧。
+// 一个对象 = 一份载入好的 IR 频谱 + 各通道的运行状态，整体一块内存，在非实时线程创建/释放；
+// 所有通道共用一个 FFT 计划。
+#include <stddef.h>
+#include "dsp_simd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSP_CONV_MIN_PARTITION     32
+#define DSP_CONV_MAX_PARTITION     4096
+#define DSP_CONV_DEFAULT_PARTITION 256
+#define DSP_CONV_MAX_TAPS          (1u << 20)
+
+typedef struct DspConv DspConv;
+
+// ir: 平面排布 [irCount][stride]，每条取前 taps 个点（stride >= taps；取长 IR 的一段时 stride 就是原 IR 长度）；
+// 通道 c 用第 c % irCount 条（irCount = 1 时所有通道共用一条，频谱只存一份）。
+// partition: 分块长度（2 的幂，DSP_CONV_MIN_PARTITION..DSP_CONV_MAX_PARTITION）。参数不合法或分配失败返回 NULL
+DspConv* dsp_conv_create(const float* ir, size_t taps, size_t stride, unsigned irCount, unsigned channels,
+                         unsigned partition);
+void     dsp_conv_destroy(DspConv* v);
+
+unsigned dsp_conv_partition(const DspConv* v);   // = 延迟（帧）
+size_t   dsp_conv_length(const DspConv* v);      // IR 长度（帧，向上取整到分块）
+size_t   dsp_conv_bytes(const DspConv* v);
+
+// 清空运行状态（延迟线/输入输出缓冲），IR 不变
+void dsp_conv_reset(DspConv* v);
+
+// 实时线程换 IR 时调用：把 src 的输入历史（最近的输入频谱、未满的输入块和待送出的输出）接到刚创建、
+// 还没运行过的 dst 上，dst 从下一个分块起就按完整历史输出，中间不会出现一段静音。
+// 两者分块长度或通道数不同时返回 0（dst 保持空状态）
+int  dsp_conv_take_history(DspConv* dst, const DspConv* src);
+
+// 原地处理 lane 排布的缓冲 buf[frames][lanes]（前 channels 个 lane）
+void dsp_conv_process(DspConv* v, dsp_spec_mac_fn mac, float* buf, size_t frames, unsigned lanes);
+
+// 整块接口（调用方自己攒块，例如非均匀分块里跑在后台线程上的尾部）：
+// in[c] 是通道 c 刚收满的 partition 帧输入，out[c] 收到这一块对应的卷积输出（不再额外延迟 partition 帧）。
+// 与 dsp_conv_process 不要混用在同一个对象上
+void dsp_conv_block(DspConv* v, dsp_spec_mac_fn mac, const float* const* in, float* const* out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,346 @@
+// dsp_fastmath.c —— dsp_fastmath.h 的数组版本（标量 / SSE2 / AVX2 / NEON）
+// 每个向量函数都逐条对应标量版本的运算（先乘后加、不用 FMA，除法用 IEEE 除法指令），结果逐位一致
+#include "dsp_fastmath.h"
+#include "dsp_simd.h"
+
+// 禁止把乘加收缩成 FMA（逐位一致的前提）：各编译器默认不同，GCC/Clang 在 ARM64 上默认就会收缩，
+// 必须显式关掉（等价于对本文件加 -ffp-contract=off）
+#if defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if DSP_ARCH_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif DSP_ARCH_ARM
+#include <arm_neon.h>
+#endif
+
+#if DSP_ARCH_X86 && (defined(__GNUC__) || defined(__clang__))
+#define DSP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DSP_TARGET_AVX2
+#endif
+
+//======================================================
+// 标量
+//======================================================
+static void exp2_scalar(const float* x, float* y, size_t n) {
+    for (size_t i = 0; i < n; ++i) y[i] = dsp_fast_exp2f(x[i]);
+}
+static void db_scalar(const float* x, float* y, size_t n) {
+    for (size_t i = 0; i < n; ++i) y[i] = dsp_fast_db_to_linear(x[i]);
+}
+static void tanh_scalar(const float* x, float* y, size_t n) {
+    for (size_t i = 0; i < n; ++i) y[i] = dsp_fast_tanhf(x[i]);
+}
+static void sincos_scalar(const float* x, float* s, float* c, size_t n) {
+    for (size_t i = 0; i < n; ++i) dsp_fast_sincosf(x[i], &s[i], &c[i]);
+}
+
+static const DspVecMath k_vm_scalar = { exp2_scalar, db_scalar, tanh_scalar, sincos_scalar };
+
+//======================================================
+// SSE2 / AVX2
+//======================================================
+#if DSP_ARCH_X86
+static inline __m128 exp2_ps_sse2(__m128 x) {
+    const __m128 M = _mm_set1_ps(DSP_FM_ROUND_MAGIC);
+    x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(126.f)), _mm_set1_ps(-126.f));
+    const __m128 k = _mm_sub_ps(_mm_add_ps(x, M), M);
+    const __m128 f = _mm_sub_ps(x, k);
+    __m128 p = _mm_set1_ps(0.00015403530f);
+    p = _mm_add_ps(_mm_set1_ps(0.00133335581f), _mm_mul_ps(f, p));
+    p = _mm_add_ps(_mm_set1_ps(0.00961812911f), _mm_mul_ps(f, p));
+    p = _mm_add_ps(_mm_set1_ps(0.05550410866f), _mm_mul_ps(f, p));
+    p = _mm_add_ps(_mm_set1_ps(0.24022650695f), _mm_mul_ps(f, p));
+    p = _mm_add_ps(_mm_set1_ps(0.69314718056f), _mm_mul_ps(f, p));
+    p = _mm_add_ps(_mm_set1_ps(1.f), _mm_mul_ps(f, p));
+    const __m128i e = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(k), _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(p, _mm_castsi128_ps(e));
+}
+
+static inline __m128 tanh_ps_sse2(__m128 x) {
+    const __m128 sign = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u));
+    __m128 a = _mm_andnot_ps(sign, x);
+    a = _mm_min_ps(a, _mm_set1_ps(9.f));
+    const __m128 z = _mm_mul_ps(a, a);
+    __m128 ps = _mm_set1_ps(-5.70498872745e-3f);
+    ps = _mm_add_ps(_mm_mul_ps(ps, z), _mm_set1_ps(2.06390887954e-2f));
+    ps = _mm_sub_ps(_mm_mul_ps(ps, z), _mm_set1_ps(5.37397155531e-2f));
+    ps = _mm_add_ps(_mm_mul_ps(ps, z), _mm_set1_ps(1.33314422036e-1f));
+    ps = _mm_sub_ps(_mm_mul_ps(ps, z), _mm_set1_ps(3.33332819422e-1f));
+    ps = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ps, z), a), a);
+    const __m128 e = exp2_ps_sse2(_mm_mul_ps(a, _mm_set1_ps(2.88539008178f)));
+    const __m128 pl = _mm_sub_ps(_mm_set1_ps(1.f), _mm_div_ps(_mm_set1_ps(2.f), _mm_add_ps(e, _mm_set1_ps(1.f))));
+    const __m128 small = _mm_cmplt_ps(a, _mm_set1_ps(0.625f));
+    const __m128 r = _mm_or_ps(_mm_and_ps(small, ps), _mm_andnot_ps(small, pl));
+    return _mm_or_ps(r, _mm_and_ps(sign, x));
+}
+
+static inline void sincos_ps_sse2(__m128 x, __m128* s, __m128* c) {
+    const __m128 M = _mm_set1_ps(DSP_FM_ROUND_MAGIC);
+    const __m128 q = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(0.63661977236f)), M), M);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(4.837512969970703125e-4f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(7.54978995489188216e-8f)));
+    const __m128 z = _mm_mul_ps(r, r);
+    __m128 sp = _mm_set1_ps(-1.9515295891e-4f);
+    sp = _mm_add_ps(_mm_mul_ps(sp, z), _mm_set1_ps(8.3321608736e-3f));
+    sp = _mm_sub_ps(_mm_mul_ps(sp, z), _mm_set1_ps(1.6666654611e-1f));
+    sp = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sp, z), r), r);
+    __m128 cp = _mm_set1_ps(2.443315711809948e-5f);
+    cp = _mm_sub_ps(_mm_mul_ps(cp, z), _mm_set1_ps(1.388731625493765e-3f));
+    cp = _mm_add_ps(_mm_mul_ps(cp, z), _mm_set1_ps(4.166664568298827e-2f));
+    cp = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(cp, z), z), _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_set1_ps(1.f));
+    const __m128i iq = _mm_cvttps_epi32(q);
+    const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+    const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(iq, one), one));
+    const __m128 sv = _mm_or_ps(_mm_and_ps(swap, cp), _mm_andnot_ps(swap, sp));
+    const __m128 cv = _mm_or_ps(_mm_and_ps(swap, sp), _mm_andnot_ps(swap, cp));
+    const __m128i ss = _mm_slli_epi32(_mm_and_si128(iq, two), 30);
+    const __m128i cs = _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(iq, one), two), 30);
+    *s = _mm_xor_ps(sv, _mm_castsi128_ps(ss));
+    *c = _mm_xor_ps(cv, _mm_castsi128_ps(cs));
+}
+
+static void exp2_sse2(const float* x, float* y, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(y + i, exp2_ps_sse2(_mm_loadu_ps(x + i)));
+    exp2_scalar(x + i, y + i, n - i);
+}
+static void db_sse2(const float* x, float* y, size_t n) {
+    const __m128 k = _mm_set1_ps(0.166096404744f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(y + i, exp2_ps_sse2(_mm_mul_ps(_mm_loadu_ps(x + i), k)));
+    db_scalar(x + i, y + i, n - i);
+}
+static void tanh_sse2(const float* x, float* y, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(y + i, tanh_ps_sse2(_mm_loadu_ps(x + i)));
+    tanh_scalar(x + i, y + i, n - i);
+}
+static void sincos_sse2(const float* x, float* s, float* c, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 vs, vc;
+        sincos_ps_sse2(_mm_loadu_ps(x + i), &vs, &vc);
+        _mm_storeu_ps(s + i, vs);
+        _mm_storeu_ps(c + i, vc);
+    }
+    sincos_scalar(x + i, s + i, c + i, n - i);
+}
+
+static const DspVecMath k_vm_sse2 = { exp2_sse2, db_sse2, tanh_sse2, sincos_sse2 };
+
+DSP_TARGET_AVX2
+static inline __m256 exp2_ps_avx2(__m256 x) {
+    const __m256 M = _mm256_set1_ps(DSP_FM_ROUND_MAGIC);
+    x = _mm256_max_ps(_mm256_min_ps(x, _mm256_set1_ps(126.f)), _mm256_set1_ps(-126.f));
+    const __m256 k = _mm256_sub_ps(_mm256_add_ps(x, M), M);
+    const __m256 f = _mm256_sub_ps(x, k);
+    __m256 p = _mm256_set1_ps(0.00015403530f);
+    p = _mm256_add_ps(_mm256_set1_ps(0.00133335581f), _mm256_mul_ps(f, p));
+    p = _mm256_add_ps(_mm256_set1_ps(0.00961812911f), _mm256_mul_ps(f, p));
+    p = _mm256_add_ps(_mm256_set1_ps(0.05550410866f), _mm256_mul_ps(f, p));
+    p = _mm256_add_ps(_mm256_set1_ps(0.24022650695f), _mm256_mul_ps(f, p));
+    p = _mm256_add_ps(_mm256_set1_ps(0.69314718056f), _mm256_mul_ps(f, p));
+    p = _mm256_add_ps(_mm256_set1_ps(1.f), _mm256_mul_ps(f, p));
+    const __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(k), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(e));
+}
+
+DSP_TARGET_AVX2
+static inline __m256 tanh_ps_avx2(__m256 x) {
+    const __m256 sign = _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000u));
+    __m256 a = _mm256_andnot_ps(sign, x);
+    a = _mm256_min_ps(a, _mm256_set1_ps(9.f));
+    const __m256 z = _mm256_mul_ps(a, a);
+    __m256 ps = _mm256_set1_ps(-5.70498872745e-3f);
+    ps = _mm256_add_ps(_mm256_mul_ps(ps, z), _mm256_set1_ps(2.06390887954e-2f));
+    ps = _mm256_sub_ps(_mm256_mul_ps(ps, z), _mm256_set1_ps(5.37397155531e-2f));
+    ps = _mm256_add_ps(_mm256_mul_ps(ps, z), _mm256_set1_ps(1.33314422036e-1f));
+    ps = _mm256_sub_ps(_mm256_mul_ps(ps, z), _mm256_set1_ps(3.33332819422e-1f));
+    ps = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(ps, z), a), a);
+    const __m256 e = exp2_ps_avx2(_mm256_mul_ps(a, _mm256_set1_ps(2.88539008178f)));
+    const __m256 pl = _mm256_sub_ps(_mm256_set1_ps(1.f),
+                                    _mm256_div_ps(_mm256_set1_ps(2.f), _mm256_add_ps(e, _mm256_set1_ps(1.f))));
+    const __m256 small = _mm256_cmp_ps(a, _mm256_set1_ps(0.625f), _CMP_LT_OQ);
+    const __m256 r = _mm256_blendv_ps(pl, ps, small);
+    return _mm256_or_ps(r, _mm256_and_ps(sign, x));
+}
+
+DSP_TARGET_AVX2
+static inline void sincos_ps_avx2(__m256 x, __m256* s, __m256* c) {
+    const __m256 M = _mm256_set1_ps(DSP_FM_ROUND_MAGIC);
+    const __m256 q = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(0.63661977236f)), M), M);
+    __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(q, _mm256_set1_ps(1.5703125f)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(4.837512969970703125e-4f)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(7.54978995489188216e-8f)));
+    const __m256 z = _mm256_mul_ps(r, r);
+    __m256 sp = _mm256_set1_ps(-1.9515295891e-4f);
+    sp = _mm256_add_ps(_mm256_mul_ps(sp, z), _mm256_set1_ps(8.3321608736e-3f));
+    sp = _mm256_sub_ps(_mm256_mul_ps(sp, z), _mm256_set1_ps(1.6666654611e-1f));
+    sp = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sp, z), r), r);
+    __m256 cp = _mm256_set1_ps(2.443315711809948e-5f);
+    cp = _mm256_sub_ps(_mm256_mul_ps(cp, z), _mm256_set1_ps(1.388731625493765e-3f));
+    cp = _mm256_add_ps(_mm256_mul_ps(cp, z), _mm256_set1_ps(4.166664568298827e-2f));
+    cp = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(_mm256_mul_ps(cp, z), z), _mm256_mul_ps(_mm256_set1_ps(0.5f), z)),
+                       _mm256_set1_ps(1.f));
+    const __m256i iq = _mm256_cvttps_epi32(q);
+    const __m256i one = _mm256_set1_epi32(1), two = _mm256_set1_epi32(2);
+    const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(iq, one), one));
+    const __m256 sv = _mm256_blendv_ps(sp, cp, swap);
+    const __m256 cv = _mm256_blendv_ps(cp, sp, swap);
+    const __m256i ss = _mm256_slli_epi32(_mm256_and_si256(iq, two), 30);
+    const __m256i cs = _mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(iq, one), two), 30);
+    *s = _mm256_xor_ps(sv, _mm256_castsi256_ps(ss));
+    *c = _mm256_xor_ps(cv, _mm256_castsi256_ps(cs));
+}
+
+DSP_TARGET_AVX2
+static void exp2_avx2(const float* x, float* y, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(y + i, exp2_ps_avx2(_mm256_loadu_ps(x + i)));
+    exp2_scalar(x + i, y + i, n - i);
+}
+DSP_TARGET_AVX2
+static void db_avx2(const float* x, float* y, size_t n) {
+    const __m256 k = _mm256_set1_ps(0.166096404744f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(y + i, exp2_ps_avx2(_mm256_mul_ps(_mm256_loadu_ps(x + i), k)));
+    db_scalar(x + i, y + i, n - i);
+}
+DSP_TARGET_AVX2
+static void tanh_avx2(const float* x, float* y, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(y + i, tanh_ps_avx2(_mm256_loadu_ps(x + i)));
+    tanh_scalar(x + i, y + i, n - i);
+}
+DSP_TARGET_AVX2
+static void sincos_avx2(const float* x, float* s, float* c, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 vs, vc;
+        sincos_ps_avx2(_mm256_loadu_ps(x + i), &vs, &vc);
+        _mm256_storeu_ps(s + i, vs);
+        _mm256_storeu_ps(c + i, vc);
+    }
+    sincos_scalar(x + i, s + i, c + i, n - i);
+}
+
+static const DspVecMath k_vm_avx2 = { exp2_avx2, db_avx2, tanh_avx2, sincos_avx2 };
+#endif // DSP_ARCH_X86
+
+//======================================================
+// NEON（除法只有 AArch64 有整向量指令；32 位 ARM 的 tanh 走标量）
+//======================================================
+#if DSP_ARCH_ARM
+static inline float32x4_t exp2_ps_neon(float32x4_t x) {
+    const float32x4_t M = vdupq_n_f32(DSP_FM_ROUND_MAGIC);
+    x = vmaxq_f32(vminq_f32(x, vdupq_n_f32(126.f)), vdupq_n_f32(-126.f));
+    const float32x4_t k = vsubq_f32(vaddq_f32(x, M), M);
+    const float32x4_t f = vsubq_f32(x, k);
+    float32x4_t p = vdupq_n_f32(0.00015403530f);
+    p = vaddq_f32(vdupq_n_f32(0.00133335581f), vmulq_f32(f, p));
+    p = vaddq_f32(vdupq_n_f32(0.00961812911f), vmulq_f32(f, p));
+    p = vaddq_f32(vdupq_n_f32(0.05550410866f), vmulq_f32(f, p));
+    p = vaddq_f32(vdupq_n_f32(0.24022650695f), vmulq_f32(f, p));
+    p = vaddq_f32(vdupq_n_f32(0.69314718056f), vmulq_f32(f, p));
+    p = vaddq_f32(vdupq_n_f32(1.f), vmulq_f32(f, p));
+    const int32x4_t e = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(k), vdupq_n_s32(127)), 23);
+    return vmulq_f32(p, vreinterpretq_f32_s32(e));
+}
+
+static inline void sincos_ps_neon(float32x4_t x, float32x4_t* s, float32x4_t* c) {
+    const float32x4_t M = vdupq_n_f32(DSP_FM_ROUND_MAGIC);
+    const float32x4_t q = vsubq_f32(vaddq_f32(vmulq_f32(x, vdupq_n_f32(0.63661977236f)), M), M);
+    float32x4_t r = vsubq_f32(x, vmulq_f32(q, vdupq_n_f32(1.5703125f)));
+    r = vsubq_f32(r, vmulq_f32(q, vdupq_n_f32(4.837512969970703125e-4f)));
+    r = vsubq_f32(r, vmulq_f32(q, vdupq_n_f32(7.54978995489188216e-8f)));
+    const float32x4_t z = vmulq_f32(r, r);
+    float32x4_t sp = vdupq_n_f32(-1.9515295891e-4f);
+    sp = vaddq_f32(vmulq_f32(sp, z), vdupq_n_f32(8.3321608736e-3f));
+    sp = vsubq_f32(vmulq_f32(sp, z), vdupq_n_f32(1.6666654611e-1f));
+    sp = vaddq_f32(vmulq_f32(vmulq_f32(sp, z), r), r);
+    float32x4_t cp = vdupq_n_f32(2.443315711809948e-5f);
+    cp = vsubq_f32(vmulq_f32(cp, z), vdupq_n_f32(1.388731625493765e-3f));
+    cp = vaddq_f32(vmulq_f32(cp, z), vdupq_n_f32(4.166664568298827e-2f));
+    cp = vaddq_f32(vsubq_f32(vmulq_f32(vmulq_f32(cp, z), z), vmulq_f32(vdupq_n_f32(0.5f), z)), vdupq_n_f32(1.f));
+    const int32x4_t iq = vcvtq_s32_f32(q);
+    const int32x4_t one = vdupq_n_s32(1), two = vdupq_n_s32(2);
+    const uint32x4_t swap = vceqq_s32(vandq_s32(iq, one), one);
+    const float32x4_t sv = vbslq_f32(swap, cp, sp);
+    const float32x4_t cv = vbslq_f32(swap, sp, cp);
+    const uint32x4_t ss = vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(iq, two), 30));
+    const uint32x4_t cs = vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(vaddq_s32(iq, one), two), 30));
+    *s = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(sv), ss));
+    *c = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(cv), cs));
+}
+
+static void exp2_neon(const float* x, float* y, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) vst1q_f32(y + i, exp2_ps_neon(vld1q_f32(x + i)));
+    exp2_scalar(x + i, y + i, n - i);
+}
+static void db_neon(const float* x, float* y, size_t n) {
+    const float32x4_t k = vdupq_n_f32(0.166096404744f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) vst1q_f32(y + i, exp2_ps_neon(vmulq_f32(vld1q_f32(x + i), k)));
+    db_scalar(x + i, y + i, n - i);
+}
+static void tanh_neon(const float* x, float* y, size_t n) {
+    size_t i = 0;
+#if defined(__aarch64__) || defined(_M_ARM64)
+    const uint32x4_t sign = vdupq_n_u32(0x80000000u);
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t v = vld1q_f32(x + i);
+        const float32x4_t a = vminq_f32(vabsq_f32(v), vdupq_n_f32(9.f));
+        const float32x4_t z = vmulq_f32(a, a);
+        float32x4_t ps = vdupq_n_f32(-5.70498872745e-3f);
+        ps = vaddq_f32(vmulq_f32(ps, z), vdupq_n_f32(2.06390887954e-2f));
+        ps = vsubq_f32(vmulq_f32(ps, z), vdupq_n_f32(5.37397155531e-2f));
+        ps = vaddq_f32(vmulq_f32(ps, z), vdupq_n_f32(1.33314422036e-1f));
+        ps = vsubq_f32(vmulq_f32(ps, z), vdupq_n_f32(3.33332819422e-1f));
+        ps = vaddq_f32(vmulq_f32(vmulq_f32(ps, z), a), a);
+        const float32x4_t e = exp2_ps_neon(vmulq_f32(a, vdupq_n_f32(2.88539008178f)));
+        const float32x4_t pl = vsubq_f32(vdupq_n_f32(1.f), vdivq_f32(vdupq_n_f32(2.f), vaddq_f32(e, vdupq_n_f32(1.f))));
+        const float32x4_t r = vbslq_f32(vcltq_f32(a, vdupq_n_f32(0.625f)), ps, pl);
+        const uint32x4_t sb = vandq_u32(vreinterpretq_u32_f32(v), sign);
+        vst1q_f32(y + i, vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(r), sb)));
+    }
+#endif
+    tanh_scalar(x + i, y + i, n - i);
+}
+static void sincos_neon(const float* x, float* s, float* c, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t vs, vc;
+        sincos_ps_neon(vld1q_f32(x + i), &vs, &vc);
+        vst1q_f32(s + i, vs);
+        vst1q_f32(c + i, vc);
+    }
+    sincos_scalar(x + i, s + i, c + i, n - i);
+}
+
+static const DspVecMath k_vm_neon = { exp2_neon, db_neon, tanh_neon, sincos_neon };
+#endif // DSP_ARCH_ARM
+
+const DspVecMath* dsp_fastmath_vec(DSP_SIMD_LEVEL level) {
+    if (!dsp_simd_supported(level)) return NULL;
+    switch (level) {
+    case DSP_SIMD_SCALAR: return &k_vm_scalar;
+#if DSP_ARCH_X86
+    case DSP_SIMD_SSE2:   return &k_vm_sse2;
+    case DSP_SIMD_AVX2:   return &k_vm_avx2;
+#endif
+#if DSP_ARCH_ARM
+    case DSP_SIMD_NEON:   return &k_vm_neon;
+#endif
+    default:              return NULL;
+    }
+}
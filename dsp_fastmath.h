@@ -0,0 +1,99 @@
+#pragma once
+// dsp_fastmath.h —— DSP 内部用的快速数学函数（不对外公开）
+// 标量版本是 static inline，给系数设计和标量路径直接调用；数组版本按指令集分派（dsp_fastmath.c），
+// 各指令集与这里的标量版本逐位一致（同样的运算、同样的顺序，不用 FMA），换指令集不会改变系数或输出。
+// 最大误差（相对 double 精度参考值，在 EfxTestHost 用例 X 里逐点扫描验证）：
+//   dsp_fast_exp2f          x ∈ [-126, 126]         相对误差 < 3e-7
+//   dsp_fast_db_to_linear   db ∈ [-120, 120]        相对误差 < 1.2e-6（主要来自 db*log2(10)/20 的舍入）
+//   dsp_fast_tanhf          全体实数                绝对误差 < 1.5e-7，相对误差 < 2.5e-7
+//   dsp_fast_sincosf        |x| ≤ 100               绝对误差 < 1e-7（|x| 更大时区间约简的误差随 |x| 增长）
+// NaN/Inf 不做特殊处理（参数在进入这里之前都已限幅）。
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "dsp_wrapper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSP_FM_ROUND_MAGIC 12582912.f   // 1.5 * 2^23：(x + M) - M 按“就近取偶”取整（|x| < 2^22）
+
+// 2^x：x = k + f（k 取整，|f| ≤ 0.5），2^f 用 6 次多项式，2^k 直接拼指数位
+static inline float dsp_fast_exp2f(float x) {
+    x = x < -126.f ? -126.f : (x > 126.f ? 126.f : x);
+    const float k = (x + DSP_FM_ROUND_MAGIC) - DSP_FM_ROUND_MAGIC;
+    const float f = x - k;
+    const float p = 1.f + f * (0.69314718056f + f * (0.24022650695f + f * (0.05550410866f +
+                    f * (0.00961812911f + f * (0.00133335581f + f * 0.00015403530f)))));
+    const int32_t bits = ((int32_t)k + 127) << 23;
+    float s;
+    memcpy(&s, &bits, sizeof(s));
+    return p * s;
+}
+
+// 10^(db/20)
+static inline float dsp_fast_db_to_linear(float db) {
+    return dsp_fast_exp2f(db * 0.166096404744f);   // log2(10) / 20
+}
+
+// tanh：|x| < 0.625 用奇次多项式（保住小信号的相对精度），否则 1 - 2/(e^{2|x|}+1)；|x| 限到 9（此后结果就是 ±1）
+static inline float dsp_fast_tanhf(float x) {
+    float a = x < 0.f ? -x : x;
+    a = a > 9.f ? 9.f : a;
+    float r;
+    if (a < 0.625f) {
+        const float z = a * a;
+        r = ((((-5.70498872745e-3f * z + 2.06390887954e-2f) * z - 5.37397155531e-2f) * z
+              + 1.33314422036e-1f) * z - 3.33332819422e-1f) * z * a + a;
+    } else {
+        const float e = dsp_fast_exp2f(a * 2.88539008178f);   // 2 / ln2
+        r = 1.f - 2.f / (e + 1.f);
+    }
+    // 把 x 的符号位拷回来（与 SIMD 版本的位运算一致，-0 也保持）
+    uint32_t rb, xb;
+    memcpy(&rb, &r, 4);
+    memcpy(&xb, &x, 4);
+    rb |= xb & 0x80000000u;
+    memcpy(&r, &rb, 4);
+    return r;
+}
+
+// sin/cos 一起算：按 π/2 取整约简（Cody-Waite 三段常数），[-π/4, π/4] 上各用一个多项式，再按象限交换/取反
+static inline void dsp_fast_sincosf(float x, float* s, float* c) {
+    const float q = (x * 0.63661977236f + DSP_FM_ROUND_MAGIC) - DSP_FM_ROUND_MAGIC;   // 2/π
+    const float r = ((x - q * 1.5703125f) - q * 4.837512969970703125e-4f) - q * 7.54978995489188216e-8f;
+    const float z = r * r;
+    const float sp = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+    const float cp = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z
+                     - 0.5f * z + 1.f;
+    const int32_t iq = (int32_t)q;
+    float sv = (iq & 1) ? cp : sp;
+    float cv = (iq & 1) ? sp : cp;
+    uint32_t sb, cb;
+    memcpy(&sb, &sv, 4);
+    memcpy(&cb, &cv, 4);
+    sb ^= (uint32_t)(iq & 2) << 30;
+    cb ^= (uint32_t)((iq + 1) & 2) << 30;
+    memcpy(s, &sb, 4);
+    memcpy(c, &cb, 4);
+}
+
+// ================== 数组版本（按指令集分派） ==================
+// y 可以与 x 是同一块内存；n 任意（尾巴按标量处理）
+typedef void (*dsp_vmath_fn)(const float* x, float* y, size_t n);
+typedef void (*dsp_vsincos_fn)(const float* x, float* s, float* c, size_t n);
+
+typedef struct {
+    dsp_vmath_fn   exp2;
+    dsp_vmath_fn   db_to_linear;
+    dsp_vmath_fn   tanh;
+    dsp_vsincos_fn sincos;
+} DspVecMath;
+
+// 取指定指令集的一组数组函数；当前 CPU 不支持时返回 NULL
+const DspVecMath* dsp_fastmath_vec(DSP_SIMD_LEVEL level);
+
+#ifdef __cplusplus
+}
+#endif
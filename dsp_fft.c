@@ -0,0 +1,220 @@
+// dsp_fft.c —— 实数 FFT（格式说明见 dsp_fft.h）
+// 正变换：偶/奇样本拼成 m 点复数 z[k] = x[2k] + i·x[2k+1]，位反转装入后逐级蝶形，最后拆分成 n 点实数频谱；
+// 逆变换反过来：先合成 z 的频谱，交换实虚部后走同一套正向蝶形（swap(FFT(swap(Z))) = m·IFFT(Z)），
+// 最后再交换回来按偶/奇样本写出。
+#include "dsp_fft.h"
+#include "dsp_simd.h"
+#include <math.h>
+#include <string.h>
+
+// 禁止把乘加收缩成 FMA（逐位一致的前提）：各编译器默认不同，GCC/Clang 在 ARM64 上默认就会收缩，
+// 必须显式关掉（等价于对本文件加 -ffp-contract=off）
+#if defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+// 蝶形内层循环按 4 个一组用编译目标的基线向量指令（x64 的 SSE2 / ARM 的 NEON），不做运行时分派：
+// 与标量写法是同样的乘、加、减，结果与所选 DSP_SIMD_LEVEL 无关
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DSP_FFT_SSE2 1
+#elif DSP_ARCH_ARM
+#include <arm_neon.h>
+#define DSP_FFT_NEON 1
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+struct DspFft {
+    unsigned  n, m;       // 实数长度 n，复数 FFT 长度 m = n/2
+    float*    tw_re;      // [m]：半长为 h 的那一级用 [h, 2h)，值为 e^{-2πi·j/(2h)}
+    float*    tw_im;
+    float*    rw_re;      // [m/2+1]：实数拆分用 e^{-2πi·k/n}
+    float*    rw_im;
+    unsigned* rev;        // [m]：位反转下标
+};
+
+static size_t fft_align(size_t bytes) {
+    return (bytes + DSP_MEM_ALIGN - 1) & ~(size_t)(DSP_MEM_ALIGN - 1);
+}
+
+DspFft* dsp_fft_create(unsigned n) {
+    if (n < DSP_FFT_MIN_SIZE || n > DSP_FFT_MAX_SIZE || (n & (n - 1))) return NULL;
+    const unsigned m = n / 2;
+    const size_t hdr = fft_align(sizeof(DspFft));
+    const size_t tw  = fft_align(sizeof(float) * m);
+    const size_t rw  = fft_align(sizeof(float) * (m / 2 + 1));
+    const size_t rv  = fft_align(sizeof(unsigned) * m);
+    unsigned char* p = (unsigned char*)dsp_aligned_alloc(hdr + 2 * tw + 2 * rw + rv, DSP_MEM_ALIGN);
+    if (!p) return NULL;
+
+    DspFft* f = (DspFft*)p;
+    p += hdr;
+    f->n = n;
+    f->m = m;
+    f->tw_re = (float*)p;    p += tw;
+    f->tw_im = (float*)p;    p += tw;
+    f->rw_re = (float*)p;    p += rw;
+    f->rw_im = (float*)p;    p += rw;
+    f->rev   = (unsigned*)p;
+
+    // 旋转因子用 double 算再取整到 float
+    for (unsigned h = 1; h < m; h <<= 1)
+        for (unsigned j = 0; j < h; ++j) {
+            const double a = -M_PI * (double)j / (double)h;
+            f->tw_re[h + j] = (float)cos(a);
+            f->tw_im[h + j] = (float)sin(a);
+        }
+    for (unsigned k = 0; k <= m / 2; ++k) {
+        const double a = -2.0 * M_PI * (double)k / (double)n;
+        f->rw_re[k] = (float)cos(a);
+        f->rw_im[k] = (float)sin(a);
+    }
+    unsigned bits = 0;
+    while ((1u << bits) < m) bits++;
+    for (unsigned k = 0; k < m; ++k) {
+        unsigned r = 0;
+        for (unsigned b = 0; b < bits; ++b) r |= ((k >> b) & 1u) << (bits - 1 - b);
+        f->rev[k] = r;
+    }
+    return f;
+}
+
+void dsp_fft_destroy(DspFft* f) {
+    dsp_aligned_free(f);
+}
+
+unsigned dsp_fft_size(const DspFft* f) {
+    return f ? f->n : 0;
+}
+
+// 一组 4 个蝶形：a' = a + w·b，b' = a - w·b
+static inline void fft_bfly4(float* ar, float* ai, float* br, float* bi, const float* wr, const float* wi) {
+#if DSP_FFT_SSE2
+    const __m128 xr = _mm_loadu_ps(ar), xi = _mm_loadu_ps(ai), yr = _mm_loadu_ps(br), yi = _mm_loadu_ps(bi);
+    const __m128 cr = _mm_loadu_ps(wr), ci = _mm_loadu_ps(wi);
+    const __m128 tr = _mm_sub_ps(_mm_mul_ps(cr, yr), _mm_mul_ps(ci, yi));
+    const __m128 ti = _mm_add_ps(_mm_mul_ps(cr, yi), _mm_mul_ps(ci, yr));
+    _mm_storeu_ps(ar, _mm_add_ps(xr, tr)); _mm_storeu_ps(ai, _mm_add_ps(xi, ti));
+    _mm_storeu_ps(br, _mm_sub_ps(xr, tr)); _mm_storeu_ps(bi, _mm_sub_ps(xi, ti));
+#elif DSP_FFT_NEON
+    const float32x4_t xr = vld1q_f32(ar), xi = vld1q_f32(ai), yr = vld1q_f32(br), yi = vld1q_f32(bi);
+    const float32x4_t cr = vld1q_f32(wr), ci = vld1q_f32(wi);
+    const float32x4_t tr = vsubq_f32(vmulq_f32(cr, yr), vmulq_f32(ci, yi));
+    const float32x4_t ti = vaddq_f32(vmulq_f32(cr, yi), vmulq_f32(ci, yr));
+    vst1q_f32(ar, vaddq_f32(xr, tr)); vst1q_f32(ai, vaddq_f32(xi, ti));
+    vst1q_f32(br, vsubq_f32(xr, tr)); vst1q_f32(bi, vsubq_f32(xi, ti));
+#else
+    for (int j = 0; j < 4; ++j) {
+        const float xr = ar[j], xi = ai[j], yr = br[j], yi = bi[j];
+        const float tr = wr[j] * yr - wi[j] * yi;
+        const float ti = wr[j] * yi + wi[j] * yr;
+        ar[j] = xr + tr; ai[j] = xi + ti;
+        br[j] = xr - tr; bi[j] = xi - ti;
+    }
+#endif
+}
+
+// m 点复数 FFT 的蝶形部分（输入已按位反转排好），原地
+static void fft_stages(const DspFft* f, float* re, float* im) {
+    const unsigned m = f->m;
+    // 前两级合成一个基 4 步：旋转因子只有 1 和 -i，不用乘法
+    for (unsigned s = 0; s < m; s += 4) {
+        const float r0 = re[s] + re[s + 1], i0 = im[s] + im[s + 1];
+        const float r1 = re[s] - re[s + 1], i1 = im[s] - im[s + 1];
+        const float r2 = re[s + 2] + re[s + 3], i2 = im[s + 2] + im[s + 3];
+        const float r3 = re[s + 2] - re[s + 3], i3 = im[s + 2] - im[s + 3];
+        re[s]     = r0 + r2; im[s]     = i0 + i2;
+        re[s + 2] = r0 - r2; im[s + 2] = i0 - i2;
+        re[s + 1] = r1 + i3; im[s + 1] = i1 - r3;   // (r1,i1) + (-i)·(r3,i3)
+        re[s + 3] = r1 - i3; im[s + 3] = i1 + r3;
+    }
+    // 其余各级：每组蝶形在连续内存上，4 个一组
+    for (unsigned h = 4; h < m; h <<= 1) {
+        const float* wr = f->tw_re + h;
+        const float* wi = f->tw_im + h;
+        for (unsigned s = 0; s < m; s += 2 * h)
+            for (unsigned j = 0; j < h; j += 4)
+                fft_bfly4(re + s + j, im + s + j, re + s + h + j, im + s + h + j, wr + j, wi + j);
+    }
+}
+
+void dsp_fft_forward(const DspFft* f, const float* x, float* X) {
+    const unsigned m = f->m;
+    float* re = X;
+    float* im = X + m;
+    for (unsigned k = 0; k < m; ++k) {
+        const unsigned j = f->rev[k];
+        re[k] = x[2 * j];
+        im[k] = x[2 * j + 1];
+    }
+    fft_stages(f, re, im);
+
+    // 拆分：E = (Z[k] + conj Z[m-k]) / 2（偶样本的谱），O = (Z[k] - conj Z[m-k]) / 2i（奇样本的谱）
+    // X[k] = E + W^k·O，X[m-k] = conj(E - W^k·O)
+    const float r0 = re[0], i0 = im[0];
+    re[0] = r0 + i0;     // 直流
+    im[0] = r0 - i0;     // Nyquist
+    for (unsigned k = 1; k < m / 2; ++k) {
+        const unsigned j = m - k;
+        const float ar = re[k], ai = im[k], br = re[j], bi = im[j];
+        const float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);
+        const float orr = 0.5f * (ai + bi), oi = -0.5f * (ar - br);
+        const float wr = f->rw_re[k], wi = f->rw_im[k];
+        const float tr = wr * orr - wi * oi, ti = wr * oi + wi * orr;
+        re[k] = er + tr;   im[k] = ei + ti;
+        re[j] = er - tr;   im[j] = ti - ei;
+    }
+    im[m / 2] = -im[m / 2];   // k = m/2：W = -i，X = conj(Z)
+}
+
+void dsp_fft_inverse(const DspFft* f, float* X, float* x) {
+    const unsigned m = f->m;
+    float* re = X;
+    float* im = X + m;
+
+    // 合成 2·Z：E2 = X[k] + conj X[m-k]，O2 = conj(W^k)·(X[k] - conj X[m-k])，Z2 = E2 + i·O2；
+    // Z2[m-k] = conj(E2) + i·conj(O2)。写回时直接交换实虚部（为下面的正向蝶形做准备）
+    {
+        const float d = re[0], q = im[0];
+        re[0] = d - q;    // swap：实部位置放虚部
+        im[0] = d + q;
+    }
+    for (unsigned k = 1; k < m / 2; ++k) {
+        const unsigned j = m - k;
+        const float xr = re[k], xi = im[k], yr = re[j], yi = im[j];
+        const float er = xr + yr, ei = xi - yi;
+        const float dr = xr - yr, di = xi + yi;
+        const float wr = f->rw_re[k], wi = f->rw_im[k];
+        const float orr = wr * dr + wi * di, oi = wr * di - wi * dr;
+        re[k] = ei + orr;  im[k] = er - oi;    // swap(Z2[k])
+        re[j] = orr - ei;  im[j] = er + oi;    // swap(Z2[m-k])
+    }
+    {
+        const float xr = re[m / 2], xi = im[m / 2];
+        re[m / 2] = -2.f * xi;                 // swap(2·conj X)
+        im[m / 2] = 2.f * xr;
+    }
+
+    // 位反转（对合置换，成对交换）
+    for (unsigned k = 0; k < m; ++k) {
+        const unsigned j = f->rev[k];
+        if (j > k) {
+            float t = re[k]; re[k] = re[j]; re[j] = t;
+            t = im[k]; im[k] = im[j]; im[j] = t;
+        }
+    }
+    fft_stages(f, re, im);
+
+    // 再交换回来：z = 实部取 im、虚部取 re；偶样本是 z 的实部，奇样本是虚部
+    for (unsigned k = 0; k < m; ++k) {
+        x[2 * k]     = im[k];
+        x[2 * k + 1] = re[k];
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+// dsp_fft.h —— DSP 内部用的实数 FFT（不对外公开）
+// 长度 n 为 2 的幂：内部是 n/2 点复数 FFT（基 2、按时间抽取、每级旋转因子连续存放）再做实数拆分。
+// 计划（旋转因子 + 位反转表）创建后只读，可以被任意多个通道/线程同时使用；变换本身不分配内存。
+// 只有一份可移植 C 实现，所有 SIMD 档位下结果相同。
+//
+// 频谱排布（拆分复数，共 n 个 float）：X[0..m) 为实部，X[m..2m) 为虚部，m = n/2；
+// bin 0 的实部是直流，bin 0 的“虚部”位置放 Nyquist（两者都是实数），其余 bin k 为正常复数。
+// 不归一化：dsp_fft_inverse(dsp_fft_forward(x)) = n·x。
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSP_FFT_MIN_SIZE 32
+#define DSP_FFT_MAX_SIZE 65536
+
+typedef struct DspFft DspFft;
+
+// n 不是 [DSP_FFT_MIN_SIZE, DSP_FFT_MAX_SIZE] 内的 2 的幂或分配失败时返回 NULL（非实时线程调用）
+DspFft*  dsp_fft_create(unsigned n);
+void     dsp_fft_destroy(DspFft* f);
+unsigned dsp_fft_size(const DspFft* f);
+
+// x: n 个实数 → X: 频谱（排布见上）；x 与 X 不能重叠
+void dsp_fft_forward(const DspFft* f, const float* x, float* X);
+// X: 频谱（会被改写，当作工作区）→ x: n 个实数；x 与 X 不能重叠
+void dsp_fft_inverse(const DspFft* f, float* X, float* x);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,367 @@
+// dsp_nuconv.c —— 非均匀分块卷积（分段方式见 dsp_nuconv.h）
+// 尾部的交接：输入/输出各两份缓冲，实时线程用 [flip]、后台线程用 [flip ^ 1]。
+// 每到 T 帧边界，实时线程先确认上一块已经算完（done == job），翻转 flip —— 刚收满的输入交给后台线程，
+// 后台线程刚写好的输出换到实时线程这边在接下来的 T 帧里送出 —— 再 job + 1 并唤醒后台线程。
+// 缓冲内容与 flip/内核指针都靠 job/done 这对原子变量的 release/acquire 交接，不加锁。
+#include "dsp_nuconv.h"
+#include "dsp_conv.h"
+#include "dsp_atomic.h"
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <errno.h>
+#endif
+
+#define NU_H DSP_NUCONV_HEAD
+#define NU_T DSP_NUCONV_TAIL
+
+//======================================================
+// 后台线程与唤醒信号（Win32 / POSIX）
+//======================================================
+#if defined(_WIN32)
+typedef HANDLE NuThread;
+typedef HANDLE NuSignal;   // 自动复位事件
+#else
+typedef pthread_t NuThread;
+typedef sem_t     NuSignal;
+#endif
+
+struct DspNuConv {
+    unsigned  ch, nIr;
+    size_t    taps;
+    unsigned  pos;        // 中段当前块已收到的帧数（0..H-1）
+    unsigned  tpos;       // 尾部当前块已收到的帧数（0..T-1；没有尾部时也照常计数，换 IR 时用来对齐）
+    float*    g;          // 头部系数 [nIr][H]（倒序存放，点积时与输入历史同向）
+    float*    hx;         // [ch][2H]：前 H 帧是上一块输入，后 H 帧是正在收的这一块
+    float*    mout;       // [ch][H]：中段上一块算出的输出，本块逐帧送出
+    const float** mIn;    // [ch] → hx 的后半段
+    float**   mOut;       // [ch] → mout
+    DspConv*  mid;        // NULL：IR 不超过 H
+
+    // 尾部（tail == NULL 时以下都不用）
+    DspConv*  tail;
+    float*    tbuf[2];    // 输入 [ch][T]
+    float*    obuf[2];    // 输出 [ch][T]
+    const float** tIn;    // [2][ch]
+    float**   tOut;       // [2][ch]
+    unsigned  flip;
+    long      seq;        // 已交出的块数（实时线程私有）
+    dsp_spec_mac_fn job_mac;
+    dsp_atomic_t job;     // 实时线程写：交出的块数
+    dsp_atomic_t done;    // 后台线程写：算完的块数
+    dsp_atomic_t quit;
+    NuSignal  wake;
+    NuThread  thread;
+    int       has_wake, has_thread;
+
+    size_t    bytes;
+};
+
+static int nu_signal_init(NuSignal* s) {
+#if defined(_WIN32)
+    *s = CreateEventW(NULL, FALSE, FALSE, NULL);
+    return *s != NULL;
+#else
+    return sem_init(s, 0, 0) == 0;
+#endif
+}
+
+static void nu_signal_free(NuSignal* s) {
+#if defined(_WIN32)
+    CloseHandle(*s);
+#else
+    sem_destroy(s);
+#endif
+}
+
+// 实时线程调用：不阻塞
+static void nu_signal_post(NuSignal* s) {
+#if defined(_WIN32)
+    SetEvent(*s);
+#else
+    sem_post(s);
+#endif
+}
+
+static void nu_signal_wait(NuSignal* s) {
+#if defined(_WIN32)
+    WaitForSingleObject(*s, INFINITE);
+#else
+    while (sem_wait(s) != 0 && errno == EINTR) {}
+#endif
+}
+
+static void nu_yield(void) {
+#if defined(_WIN32)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+static void nu_worker_loop(DspNuConv* v) {
+    dsp_fpu_flush_denormals();   // 自己的线程，不用还原；尾部衰减到很小时不掉进非规格化数
+    for (;;) {
+        nu_signal_wait(&v->wake);
+        if (dsp_atomic_load(&v->quit)) break;
+        const long j = dsp_atomic_load(&v->job);
+        if (j == dsp_atomic_load(&v->done)) continue;
+        const unsigned f = v->flip ^ 1u;
+        dsp_conv_block(v->tail, v->job_mac, v->tIn + (size_t)f * v->ch, v->tOut + (size_t)f * v->ch);
+        dsp_atomic_store(&v->done, j);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI nu_worker_main(LPVOID arg) {
+    nu_worker_loop((DspNuConv*)arg);
+    return 0;
+}
+#else
+static void* nu_worker_main(void* arg) {
+    nu_worker_loop((DspNuConv*)arg);
+    return NULL;
+}
+#endif
+
+static int nu_thread_start(DspNuConv* v) {
+#if defined(_WIN32)
+    v->thread = CreateThread(NULL, 0, nu_worker_main, v, 0, NULL);
+    if (!v->thread) return 0;
+    SetThreadPriority(v->thread, THREAD_PRIORITY_HIGHEST);   // 要赶在下一个 T 帧边界之前算完
+    return 1;
+#else
+    return pthread_create(&v->thread, NULL, nu_worker_main, v) == 0;
+#endif
+}
+
+static void nu_thread_join(DspNuConv* v) {
+#if defined(_WIN32)
+    WaitForSingleObject(v->thread, INFINITE);
+    CloseHandle(v->thread);
+#else
+    pthread_join(v->thread, NULL);
+#endif
+}
+
+// 实时线程：等后台线程手上的块算完；返回是否真的等了
+static unsigned nu_wait_idle(DspNuConv* v) {
+    if (!v->tail || dsp_atomic_load(&v->done) == v->seq) return 0;
+    for (unsigned spin = 0; dsp_atomic_load(&v->done) != v->seq; ++spin) {
+        if (spin < 256) dsp_cpu_relax();
+        else nu_yield();
+    }
+    return 1;
+}
+
+//======================================================
+// 创建/销毁
+//======================================================
+static size_t nu_take(size_t* cursor, size_t bytes) {
+    const size_t off = *cursor;
+    *cursor = (off + bytes + DSP_MEM_ALIGN - 1) & ~(size_t)(DSP_MEM_ALIGN - 1);
+    return off;
+}
+
+DspNuConv* dsp_nuconv_create(const float* ir, size_t taps, unsigned irCount, unsigned channels) {
+    if (!ir || taps == 0 || taps > DSP_CONV_MAX_TAPS || irCount == 0 || channels == 0) return NULL;
+    if (irCount > channels) irCount = channels;
+    const int hasTail = taps > 2 * (size_t)NU_T;
+
+    size_t cur = 0;
+    nu_take(&cur, sizeof(DspNuConv));
+    const size_t offG    = nu_take(&cur, sizeof(float) * NU_H * irCount);
+    const size_t offHx   = nu_take(&cur, sizeof(float) * 2 * NU_H * channels);
+    const size_t offMout = nu_take(&cur, sizeof(float) * NU_H * channels);
+    const size_t offMIn  = nu_take(&cur, sizeof(float*) * channels);
+    const size_t offMOut = nu_take(&cur, sizeof(float*) * channels);
+    size_t offT[2] = { 0, 0 }, offO[2] = { 0, 0 }, offTIn = 0, offTOut = 0;
+    if (hasTail) {
+        for (int i = 0; i < 2; ++i) {
+            offT[i] = nu_take(&cur, sizeof(float) * NU_T * channels);
+            offO[i] = nu_take(&cur, sizeof(float) * NU_T * channels);
+        }
+        offTIn  = nu_take(&cur, sizeof(float*) * 2 * channels);
+        offTOut = nu_take(&cur, sizeof(float*) * 2 * channels);
+    }
+
+    unsigned char* base = (unsigned char*)dsp_aligned_alloc(cur, DSP_MEM_ALIGN);   // 已清零
+    if (!base) return NULL;
+    DspNuConv* v = (DspNuConv*)base;
+    v->ch = channels; v->nIr = irCount; v->taps = taps;
+    v->g    = (float*)(base + offG);
+    v->hx   = (float*)(base + offHx);
+    v->mout = (float*)(base + offMout);
+    v->mIn  = (const float**)(base + offMIn);
+    v->mOut = (float**)(base + offMOut);
+    for (unsigned c = 0; c < channels; ++c) {
+        v->mIn[c]  = v->hx + (size_t)c * 2 * NU_H + NU_H;
+        v->mOut[c] = v->mout + (size_t)c * NU_H;
+    }
+    for (unsigned r = 0; r < irCount; ++r)
+        for (unsigned j = 0; j < NU_H && j < taps; ++j) v->g[(size_t)r * NU_H + (NU_H - 1 - j)] = ir[(size_t)r * taps + j];
+    v->bytes = cur;
+
+    if (taps > NU_H) {
+        const size_t end = taps < 2 * (size_t)NU_T ? taps : 2 * (size_t)NU_T;
+        v->mid = dsp_conv_create(ir + NU_H, end - NU_H, taps, irCount, channels, NU_H);
+        if (!v->mid) { dsp_nuconv_destroy(v); return NULL; }
+        v->bytes += dsp_conv_bytes(v->mid);
+    }
+    if (hasTail) {
+        for (int i = 0; i < 2; ++i) {
+            v->tbuf[i] = (float*)(base + offT[i]);
+            v->obuf[i] = (float*)(base + offO[i]);
+        }
+        v->tIn  = (const float**)(base + offTIn);
+        v->tOut = (float**)(base + offTOut);
+        for (unsigned f = 0; f < 2; ++f)
+            for (unsigned c = 0; c < channels; ++c) {
+                v->tIn[f * channels + c]  = v->tbuf[f] + (size_t)c * NU_T;
+                v->tOut[f * channels + c] = v->obuf[f] + (size_t)c * NU_T;
+            }
+        v->tail = dsp_conv_create(ir + 2 * NU_T, taps - 2 * NU_T, taps, irCount, channels, NU_T);
+        if (!v->tail) { dsp_nuconv_destroy(v); return NULL; }
+        v->bytes += dsp_conv_bytes(v->tail);
+        v->has_wake = nu_signal_init(&v->wake);
+        v->has_thread = v->has_wake && nu_thread_start(v);
+        if (!v->has_thread) { dsp_nuconv_destroy(v); return NULL; }
+    }
+    return v;
+}
+
+void dsp_nuconv_destroy(DspNuConv* v) {
+    if (!v) return;
+    if (v->has_thread) {
+        dsp_atomic_store(&v->quit, 1);
+        nu_signal_post(&v->wake);
+        nu_thread_join(v);
+    }
+    if (v->has_wake) nu_signal_free(&v->wake);
+    dsp_conv_destroy(v->tail);
+    dsp_conv_destroy(v->mid);
+    dsp_aligned_free(v);
+}
+
+size_t dsp_nuconv_bytes(const DspNuConv* v) {
+    return v ? v->bytes : 0;
+}
+
+size_t dsp_nuconv_taps(const DspNuConv* v) {
+    return v ? v->taps : 0;
+}
+
+void dsp_nuconv_reset(DspNuConv* v) {
+    nu_wait_idle(v);
+    memset(v->hx,   0, sizeof(float) * 2 * NU_H * v->ch);
+    memset(v->mout, 0, sizeof(float) * NU_H * v->ch);
+    if (v->mid) dsp_conv_reset(v->mid);
+    if (v->tail) {
+        dsp_conv_reset(v->tail);   // 后台线程空闲，可以直接动它的状态
+        for (int i = 0; i < 2; ++i) {
+            memset(v->tbuf[i], 0, sizeof(float) * NU_T * v->ch);
+            memset(v->obuf[i], 0, sizeof(float) * NU_T * v->ch);
+        }
+    }
+    v->pos = 0;
+    v->tpos = 0;
+    v->flip = 0;
+}
+
+void dsp_nuconv_take_history(DspNuConv* dst, DspNuConv* src) {
+    nu_wait_idle(src);
+    const unsigned ch = dst->ch < src->ch ? dst->ch : src->ch;
+    memcpy(dst->hx,   src->hx,   sizeof(float) * 2 * NU_H * ch);
+    memcpy(dst->mout, src->mout, sizeof(float) * NU_H * ch);
+    if (dst->mid && src->mid) dsp_conv_take_history(dst->mid, src->mid);
+    dst->pos  = src->pos;
+    dst->tpos = src->tpos;
+    if (dst->tail && src->tail) {
+        // dst 的后台线程还没接过活，它的状态可以在这里直接写
+        dsp_conv_take_history(dst->tail, src->tail);
+        for (int i = 0; i < 2; ++i) {
+            memcpy(dst->tbuf[i], src->tbuf[i], sizeof(float) * NU_T * ch);
+            memcpy(dst->obuf[i], src->obuf[i], sizeof(float) * NU_T * ch);
+        }
+        dst->flip = src->flip;
+    }
+}
+
+//======================================================
+// 实时处理
+//======================================================
+// 头部直接型 FIR：y = Σ g[j]·x[j]（4 路累加）
+static inline float nu_dot(const float* g, const float* x) {
+    float a0 = 0.f, a1 = 0.f, a2 = 0.f, a3 = 0.f;
+    for (unsigned j = 0; j < NU_H; j += 4) {
+        a0 += g[j] * x[j];
+        a1 += g[j + 1] * x[j + 1];
+        a2 += g[j + 2] * x[j + 2];
+        a3 += g[j + 3] * x[j + 3];
+    }
+    return (a0 + a1) + (a2 + a3);
+}
+
+// 尾部到了 T 帧边界：收回上一块的结果，交出这一块
+static unsigned nu_tail_swap(DspNuConv* v, dsp_spec_mac_fn mac) {
+    const unsigned waited = nu_wait_idle(v);
+    v->flip ^= 1u;
+    v->job_mac = mac;
+    dsp_atomic_store(&v->job, ++v->seq);
+    nu_signal_post(&v->wake);
+    return waited;
+}
+
+unsigned dsp_nuconv_process(DspNuConv* v, dsp_spec_mac_fn mac, const float* in, float* out,
+                            size_t frames, unsigned lanes) {
+    unsigned waits = 0;
+    while (frames) {
+        // T 是 H 的整数倍，两级的块边界对齐：只按 H 切
+        size_t n = NU_H - v->pos;
+        if (n > frames) n = frames;
+        for (unsigned c = 0; c < v->ch; ++c) {
+            const float* g  = v->g + (size_t)(c % v->nIr) * NU_H;
+            float*       hx = v->hx + (size_t)c * 2 * NU_H;
+            const float* mo = v->mout + (size_t)c * NU_H + v->pos;
+            const float* x = in + c;
+            float*       y = out + c;
+            if (v->tail) {
+                float*       ti = v->tbuf[v->flip] + (size_t)c * NU_T + v->tpos;
+                const float* to = v->obuf[v->flip] + (size_t)c * NU_T + v->tpos;
+                for (size_t i = 0; i < n; ++i, x += lanes, y += lanes) {
+                    hx[NU_H + v->pos + i] = *x;
+                    ti[i] = *x;
+                    *y = nu_dot(g, hx + v->pos + i + 1) + mo[i] + to[i];
+                }
+            } else {
+                for (size_t i = 0; i < n; ++i, x += lanes, y += lanes) {
+                    hx[NU_H + v->pos + i] = *x;
+                    *y = nu_dot(g, hx + v->pos + i + 1) + mo[i];
+                }
+            }
+        }
+        v->pos  += (unsigned)n;
+        v->tpos += (unsigned)n;
+        in  += n * lanes;
+        out += n * lanes;
+        frames -= n;
+        if (v->pos == NU_H) {
+            if (v->mid) dsp_conv_block(v->mid, mac, v->mIn, v->mOut);
+            for (unsigned c = 0; c < v->ch; ++c) {
+                float* hx = v->hx + (size_t)c * 2 * NU_H;
+                memcpy(hx, hx + NU_H, sizeof(float) * NU_H);
+            }
+            v->pos = 0;
+            if (v->tpos == NU_T) {
+                if (v->tail) waits += nu_tail_swap(v, mac);
+                v->tpos = 0;
+            }
+        }
+    }
+    return waits;
+}
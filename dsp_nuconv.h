@@ -0,0 +1,48 @@
+#pragma once
+// dsp_nuconv.h —— 非均匀分块卷积（IR 混响用，DSP 内部用，不对外公开）
+// 长 IR（几秒）按位置切成三段，越靠后的段分块越大：
+//   头部 [0, H)       ：直接型 FIR，逐样本算，没有延迟；
+//   中段 [H, 2T)      ：H 帧均匀分块（dsp_conv），在实时线程上每 H 帧算一次，分块延迟 H 正好被段起点抵消；
+//   尾部 [2T, taps)   ：T 帧均匀分块，交给后台线程：实时线程每攒满 T 帧把这一块交出去，
+//                       结果要到再下一个 T 帧才用到（段起点 2T = 分块延迟 T + 给后台线程留的 T），
+//                       所以后台线程有整整 T 帧的时间算完。
+// 合起来输出与整条 IR 的直接卷积一致、零延迟；实时线程每次回调的代价只取决于 H 和中段长度，与 IR 总长无关。
+// 后台线程没按时算完时（只会在比实时快地离线处理或机器过载时出现）实时线程原地等它，并计数。
+// 一个对象 = 载入好的 IR + 各通道运行状态 + 一个后台线程，在非实时线程创建/释放。
+#include <stddef.h>
+#include "dsp_simd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSP_NUCONV_HEAD 64      // H：直接型头部长度 = 中段分块长度
+#define DSP_NUCONV_TAIL 1024    // T：尾部分块长度（尾部从 2T 开始）
+
+typedef struct DspNuConv DspNuConv;
+
+// ir: 平面排布 [irCount][taps]，通道 c 用第 c % irCount 条；taps 上限同 DSP_CONV_MAX_TAPS。
+// IR 长于 2T 时会起一个后台线程。参数不合法、分配或建线程失败返回 NULL
+DspNuConv* dsp_nuconv_create(const float* ir, size_t taps, unsigned irCount, unsigned channels);
+// 通知后台线程退出并等它结束后释放
+void       dsp_nuconv_destroy(DspNuConv* v);
+
+size_t     dsp_nuconv_bytes(const DspNuConv* v);
+// IR 长度（帧）：输入静音这么久之后输出恒为 0
+size_t     dsp_nuconv_taps(const DspNuConv* v);
+
+// 以下在实时线程调用（会先等后台线程手上的那一块算完）
+// 清空运行状态，IR 不变
+void       dsp_nuconv_reset(DspNuConv* v);
+// 换 IR：把 src 的输入历史接到刚创建、还没运行过的 dst 上（两者分块长度相同，总能接上；
+// 已经算好还没送出的尾部输出按旧 IR 送完）
+void       dsp_nuconv_take_history(DspNuConv* dst, DspNuConv* src);
+
+// in/out: lane 排布 [frames][lanes]（前 channels 个 lane），out 只收卷积结果，不能与 in 重叠。
+// 返回本次调用里等后台线程的次数（正常实时运行时为 0）
+unsigned   dsp_nuconv_process(DspNuConv* v, dsp_spec_mac_fn mac, const float* in, float* out,
+                              size_t frames, unsigned lanes);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,1051 @@
+// dsp_simd.c —— SIMD biquad 内核（标量 / SSE2 / AVX2 / NEON）与运行时分派
+// 所有内核按同一顺序做“先乘后加”，不使用 FMA，因此各指令集输出与标量回退逐位一致。
+#include "dsp_simd.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+// 禁止把乘加收缩成 FMA（逐位一致的前提）：各编译器默认不同，GCC/Clang 在 ARM64 上默认就会收缩，
+// 必须显式关掉（等价于对本文件加 -ffp-contract=off）
+#if defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if DSP_ARCH_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif DSP_ARCH_ARM
+#include <arm_neon.h>
+#if defined(_MSC_VER)
+#include <float.h>       // _controlfp_s
+#endif
+#endif
+
+// GCC/Clang 需要对单个函数开启 AVX2；MSVC 直接可用内建函数
+#if DSP_ARCH_X86 && (defined(__GNUC__) || defined(__clang__))
+#define DSP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DSP_TARGET_AVX2
+#endif
+
+//======================================================
+// 对齐分配
+//======================================================
+void* dsp_aligned_alloc(size_t bytes, size_t align) {
+    void* p = NULL;
+    if (bytes == 0) bytes = align;
+#if defined(_MSC_VER) || defined(__MINGW32__)
+    p = _aligned_malloc(bytes, align);
+#else
+    if (posix_memalign(&p, align, bytes) != 0) p = NULL;
+#endif
+    if (p) memset(p, 0, bytes);
+    return p;
+}
+
+void dsp_aligned_free(void* p) {
+    if (!p) return;
+#if defined(_MSC_VER) || defined(__MINGW32__)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+//======================================================
+// 标量回退（也是各 SIMD 版本的参考实现）
+//======================================================
+static void bq_band_scalar(const BqCoef* k, float* state, float* buf, size_t frames, unsigned lanes) {
+    float* X1 = state;
+    float* X2 = state + lanes;
+    float* Y1 = state + 2 * lanes;
+    float* Y2 = state + 3 * lanes;
+    const float b0 = k->b0, b1 = k->b1, b2 = k->b2, a1 = k->a1, a2 = k->a2;
+
+    for (unsigned l = 0; l < lanes; ++l) {
+        float x1 = X1[l], x2 = X2[l], y1 = Y1[l], y2 = Y2[l];
+        float* p = buf + l;
+        for (size_t n = 0; n < frames; ++n, p += lanes) {
+            float x = *p;
+            float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+            x2 = x1; x1 = x;
+            y2 = y1; y1 = y;
+            *p = y;
+        }
+        X1[l] = x1; X2[l] = x2; Y1[l] = y1; Y2[l] = y2;
+    }
+}
+
+#if DSP_ARCH_X86
+//======================================================
+// SSE2：4 通道一组
+//======================================================
+static void bq_band_sse2(const BqCoef* k, float* state, float* buf, size_t frames, unsigned lanes) {
+    const __m128 b0 = _mm_set1_ps(k->b0), b1 = _mm_set1_ps(k->b1), b2 = _mm_set1_ps(k->b2);
+    const __m128 a1 = _mm_set1_ps(k->a1), a2 = _mm_set1_ps(k->a2);
+
+    for (unsigned l = 0; l < lanes; l += 4) {
+        __m128 x1 = _mm_load_ps(state + l);
+        __m128 x2 = _mm_load_ps(state + lanes + l);
+        __m128 y1 = _mm_load_ps(state + 2 * lanes + l);
+        __m128 y2 = _mm_load_ps(state + 3 * lanes + l);
+        float* p = buf + l;
+        for (size_t n = 0; n < frames; ++n, p += lanes) {
+            __m128 x = _mm_load_ps(p);
+            __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), _mm_mul_ps(b1, x1));
+            y = _mm_add_ps(y, _mm_mul_ps(b2, x2));
+            y = _mm_sub_ps(y, _mm_mul_ps(a1, y1));
+            y = _mm_sub_ps(y, _mm_mul_ps(a2, y2));
+            x2 = x1; x1 = x;
+            y2 = y1; y1 = y;
+            _mm_store_ps(p, y);
+        }
+        _mm_store_ps(state + l, x1);
+        _mm_store_ps(state + lanes + l, x2);
+        _mm_store_ps(state + 2 * lanes + l, y1);
+        _mm_store_ps(state + 3 * lanes + l, y2);
+    }
+}
+
+//======================================================
+// AVX2：8 通道一组，剩余 4 通道走 SSE2
+//======================================================
+DSP_TARGET_AVX2
+static void bq_band_avx2(const BqCoef* k, float* state, float* buf, size_t frames, unsigned lanes) {
+    const __m256 b0 = _mm256_set1_ps(k->b0), b1 = _mm256_set1_ps(k->b1), b2 = _mm256_set1_ps(k->b2);
+    const __m256 a1 = _mm256_set1_ps(k->a1), a2 = _mm256_set1_ps(k->a2);
+
+    unsigned l = 0;
+    for (; l + 8 <= lanes; l += 8) {
+        // lanes 只保证是 4 的倍数，这里用非对齐读写
+        __m256 x1 = _mm256_loadu_ps(state + l);
+        __m256 x2 = _mm256_loadu_ps(state + lanes + l);
+        __m256 y1 = _mm256_loadu_ps(state + 2 * lanes + l);
+        __m256 y2 = _mm256_loadu_ps(state + 3 * lanes + l);
+        float* p = buf + l;
+        for (size_t n = 0; n < frames; ++n, p += lanes) {
+            __m256 x = _mm256_loadu_ps(p);
+            __m256 y = _mm256_add_ps(_mm256_mul_ps(b0, x), _mm256_mul_ps(b1, x1));
+            y = _mm256_add_ps(y, _mm256_mul_ps(b2, x2));
+            y = _mm256_sub_ps(y, _mm256_mul_ps(a1, y1));
+            y = _mm256_sub_ps(y, _mm256_mul_ps(a2, y2));
+            x2 = x1; x1 = x;
+            y2 = y1; y1 = y;
+            _mm256_storeu_ps(p, y);
+        }
+        _mm256_storeu_ps(state + l, x1);
+        _mm256_storeu_ps(state + lanes + l, x2);
+        _mm256_storeu_ps(state + 2 * lanes + l, y1);
+        _mm256_storeu_ps(state + 3 * lanes + l, y2);
+    }
+    if (l < lanes) {
+        // 尾部 4 个 lane：把它当成一个 lanes 跨距不变的子缓冲交给 SSE2 路径
+        const __m128 s0 = _mm_set1_ps(k->b0), s1 = _mm_set1_ps(k->b1), s2 = _mm_set1_ps(k->b2);
+        const __m128 t1 = _mm_set1_ps(k->a1), t2 = _mm_set1_ps(k->a2);
+        __m128 x1 = _mm_load_ps(state + l);
+        __m128 x2 = _mm_load_ps(state + lanes + l);
+        __m128 y1 = _mm_load_ps(state + 2 * lanes + l);
+        __m128 y2 = _mm_load_ps(state + 3 * lanes + l);
+        float* p = buf + l;
+        for (size_t n = 0; n < frames; ++n, p += lanes) {
+            __m128 x = _mm_load_ps(p);
+            __m128 y = _mm_add_ps(_mm_mul_ps(s0, x), _mm_mul_ps(s1, x1));
+            y = _mm_add_ps(y, _mm_mul_ps(s2, x2));
+            y = _mm_sub_ps(y, _mm_mul_ps(t1, y1));
+            y = _mm_sub_ps(y, _mm_mul_ps(t2, y2));
+            x2 = x1; x1 = x;
+            y2 = y1; y1 = y;
+            _mm_store_ps(p, y);
+        }
+        _mm_store_ps(state + l, x1);
+        _mm_store_ps(state + lanes + l, x2);
+        _mm_store_ps(state + 2 * lanes + l, y1);
+        _mm_store_ps(state + 3 * lanes + l, y2);
+    }
+}
+#endif // DSP_ARCH_X86
+
+#if DSP_ARCH_ARM
+//======================================================
+// NEON：4 通道一组（显式 mul + add，避免 vmla/vfma 融合）
+//======================================================
+static void bq_band_neon(const BqCoef* k, float* state, float* buf, size_t frames, unsigned lanes) {
+    const float32x4_t b0 = vdupq_n_f32(k->b0), b1 = vdupq_n_f32(k->b1), b2 = vdupq_n_f32(k->b2);
+    const float32x4_t a1 = vdupq_n_f32(k->a1), a2 = vdupq_n_f32(k->a2);
+
+    for (unsigned l = 0; l < lanes; l += 4) {
+        float32x4_t x1 = vld1q_f32(state + l);
+        float32x4_t x2 = vld1q_f32(state + lanes + l);
+        float32x4_t y1 = vld1q_f32(state + 2 * lanes + l);
+        float32x4_t y2 = vld1q_f32(state + 3 * lanes + l);
+        float* p = buf + l;
+        for (size_t n = 0; n < frames; ++n, p += lanes) {
+            float32x4_t x = vld1q_f32(p);
+            float32x4_t y = vaddq_f32(vmulq_f32(b0, x), vmulq_f32(b1, x1));
+            y = vaddq_f32(y, vmulq_f32(b2, x2));
+            y = vsubq_f32(y, vmulq_f32(a1, y1));
+            y = vsubq_f32(y, vmulq_f32(a2, y2));
+            x2 = x1; x1 = x;
+            y2 = y1; y1 = y;
+            vst1q_f32(p, y);
+        }
+        vst1q_f32(state + l, x1);
+        vst1q_f32(state + lanes + l, x2);
+        vst1q_f32(state + 2 * lanes + l, y1);
+        vst1q_f32(state + 3 * lanes + l, y2);
+    }
+}
+#endif // DSP_ARCH_ARM
+
+//======================================================
+// 级联：按 active 表逐段调用单段内核；被禁用的段不出现在表里，零开销
+//======================================================
+static inline BqCoef bq_coef_at(const BqCoefSoA* k, unsigned b) {
+    BqCoef c;
+    c.b0 = k->b0[b]; c.b1 = k->b1[b]; c.b2 = k->b2[b]; c.a1 = k->a1[b]; c.a2 = k->a2[b];
+    return c;
+}
+
+#define DSP_DEFINE_CASCADE(name, band_fn, attr)                                                   \
+    attr static void name(const BqCoefSoA* k, const unsigned char* active, unsigned nActive,      \
+                          float* state, float* buf, size_t frames, unsigned lanes) {              \
+        for (unsigned i = 0; i < nActive; ++i) {                                                  \
+            const unsigned b = active[i];                                                         \
+            const BqCoef c = bq_coef_at(k, b);                                                    \
+            band_fn(&c, state + (size_t)b * DSP_BQ_STATE_FLOATS(lanes), buf, frames, lanes);      \
+        }                                                                                         \
+    }
+
+DSP_DEFINE_CASCADE(bq_cascade_scalar, bq_band_scalar, )
+#if DSP_ARCH_X86
+DSP_DEFINE_CASCADE(bq_cascade_sse2, bq_band_sse2, )
+DSP_DEFINE_CASCADE(bq_cascade_avx2, bq_band_avx2, DSP_TARGET_AVX2)
+#endif
+#if DSP_ARCH_ARM
+DSP_DEFINE_CASCADE(bq_cascade_neon, bq_band_neon, )
+#endif
+
+//======================================================
+// 参数斜坡：生成逐帧的线性斜坡，逐帧乘到全部 lane 上
+// 斜坡值按下标直接算（v0 + step*k，先乘后加），各指令集逐位一致
+//======================================================
+static void ramp_fill_scalar(float* dst, size_t frames, float v0, float step) {
+    for (size_t n = 0; n < frames; ++n) dst[n] = v0 + step * (float)(n + 1);
+}
+
+static void ramp_mul_scalar(float* buf, const float* g, size_t frames, unsigned lanes) {
+    for (size_t n = 0; n < frames; ++n, buf += lanes) {
+        const float G = g[n];
+        for (unsigned l = 0; l < lanes; ++l) buf[l] *= G;
+    }
+}
+
+#if DSP_ARCH_X86
+static void ramp_fill_sse2(float* dst, size_t frames, float v0, float step) {
+    const __m128 vv0 = _mm_set1_ps(v0), vst = _mm_set1_ps(step), four = _mm_set1_ps(4.f);
+    __m128 k = _mm_setr_ps(1.f, 2.f, 3.f, 4.f);   // 整数下标，加法精确
+    size_t n = 0;
+    for (; n + 4 <= frames; n += 4) {
+        _mm_storeu_ps(dst + n, _mm_add_ps(vv0, _mm_mul_ps(vst, k)));
+        k = _mm_add_ps(k, four);
+    }
+    for (; n < frames; ++n) dst[n] = v0 + step * (float)(n + 1);
+}
+
+static void ramp_mul_sse2(float* buf, const float* g, size_t frames, unsigned lanes) {
+    for (size_t n = 0; n < frames; ++n, buf += lanes) {
+        const __m128 G = _mm_set1_ps(g[n]);
+        for (unsigned l = 0; l < lanes; l += 4) _mm_store_ps(buf + l, _mm_mul_ps(_mm_load_ps(buf + l), G));
+    }
+}
+
+DSP_TARGET_AVX2
+static void ramp_fill_avx2(float* dst, size_t frames, float v0, float step) {
+    const __m256 vv0 = _mm256_set1_ps(v0), vst = _mm256_set1_ps(step), eight = _mm256_set1_ps(8.f);
+    __m256 k = _mm256_setr_ps(1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f);
+    size_t n = 0;
+    for (; n + 8 <= frames; n += 8) {
+        _mm256_storeu_ps(dst + n, _mm256_add_ps(vv0, _mm256_mul_ps(vst, k)));
+        k = _mm256_add_ps(k, eight);
+    }
+    for (; n < frames; ++n) dst[n] = v0 + step * (float)(n + 1);
+}
+
+DSP_TARGET_AVX2
+static void ramp_mul_avx2(float* buf, const float* g, size_t frames, unsigned lanes) {
+    for (size_t n = 0; n < frames; ++n, buf += lanes) {
+        const __m256 G = _mm256_set1_ps(g[n]);
+        unsigned l = 0;
+        for (; l + 8 <= lanes; l += 8) _mm256_storeu_ps(buf + l, _mm256_mul_ps(_mm256_loadu_ps(buf + l), G));
+        if (l < lanes) _mm_store_ps(buf + l, _mm_mul_ps(_mm_load_ps(buf + l), _mm256_castps256_ps128(G)));
+    }
+}
+#endif // DSP_ARCH_X86
+
+#if DSP_ARCH_ARM
+static void ramp_fill_neon(float* dst, size_t frames, float v0, float step) {
+    const float32x4_t vv0 = vdupq_n_f32(v0), vst = vdupq_n_f32(step), four = vdupq_n_f32(4.f);
+    static const float k0[4] = { 1.f, 2.f, 3.f, 4.f };
+    float32x4_t k = vld1q_f32(k0);
+    size_t n = 0;
+    for (; n + 4 <= frames; n += 4) {
+        vst1q_f32(dst + n, vaddq_f32(vv0, vmulq_f32(vst, k)));
+        k = vaddq_f32(k, four);
+    }
+    for (; n < frames; ++n) dst[n] = v0 + step * (float)(n + 1);
+}
+
+static void ramp_mul_neon(float* buf, const float* g, size_t frames, unsigned lanes) {
+    for (size_t n = 0; n < frames; ++n, buf += lanes) {
+        const float32x4_t G = vdupq_n_f32(g[n]);
+        for (unsigned l = 0; l < lanes; l += 4) vst1q_f32(buf + l, vmulq_f32(vld1q_f32(buf + l), G));
+    }
+}
+#endif // DSP_ARCH_ARM
+
+//======================================================
+// 频域乘加（分块卷积的热循环）：y = Σ_p x[p]·h[p]
+// 逐分块、逐 bin 累加，每个 bin 的累加顺序在各指令集下相同（先乘后加，不用 FMA），结果逐位一致。
+// bin 0 的直流/Nyquist 是两个实数：向量循环按普通复数算错的那一格，先用标量算好、循环后再写回
+//======================================================
+static void spec_mac_scalar(float* y, const float* const* x, const float* const* h, unsigned parts, size_t m) {
+    float* yr = y;
+    float* yi = y + m;
+    memset(y, 0, sizeof(float) * 2 * m);
+    for (unsigned p = 0; p < parts; ++p) {
+        const float* xr = x[p];
+        const float* xi = x[p] + m;
+        const float* hr = h[p];
+        const float* hi = h[p] + m;
+        const float dc = yr[0] + xr[0] * hr[0], ny = yi[0] + xi[0] * hi[0];
+        for (size_t k = 0; k < m; ++k) {
+            const float r = yr[k] + (xr[k] * hr[k] - xi[k] * hi[k]);
+            const float i = yi[k] + (xr[k] * hi[k] + xi[k] * hr[k]);
+            yr[k] = r;
+            yi[k] = i;
+        }
+        yr[0] = dc;
+        yi[0] = ny;
+    }
+}
+
+#if DSP_ARCH_X86
+static void spec_mac_sse2(float* y, const float* const* x, const float* const* h, unsigned parts, size_t m) {
+    float* yr = y;
+    float* yi = y + m;
+    memset(y, 0, sizeof(float) * 2 * m);
+    for (unsigned p = 0; p < parts; ++p) {
+        const float* xr = x[p];
+        const float* xi = x[p] + m;
+        const float* hr = h[p];
+        const float* hi = h[p] + m;
+        const float dc = yr[0] + xr[0] * hr[0], ny = yi[0] + xi[0] * hi[0];
+        for (size_t k = 0; k < m; k += 4) {
+            const __m128 a = _mm_load_ps(xr + k), b = _mm_load_ps(xi + k);
+            const __m128 c = _mm_load_ps(hr + k), d = _mm_load_ps(hi + k);
+            _mm_store_ps(yr + k, _mm_add_ps(_mm_load_ps(yr + k), _mm_sub_ps(_mm_mul_ps(a, c), _mm_mul_ps(b, d))));
+            _mm_store_ps(yi + k, _mm_add_ps(_mm_load_ps(yi + k), _mm_add_ps(_mm_mul_ps(a, d), _mm_mul_ps(b, c))));
+        }
+        yr[0] = dc;
+        yi[0] = ny;
+    }
+}
+
+DSP_TARGET_AVX2
+static void spec_mac_avx2(float* y, const float* const* x, const float* const* h, unsigned parts, size_t m) {
+    float* yr = y;
+    float* yi = y + m;
+    memset(y, 0, sizeof(float) * 2 * m);
+    for (unsigned p = 0; p < parts; ++p) {
+        const float* xr = x[p];
+        const float* xi = x[p] + m;
+        const float* hr = h[p];
+        const float* hi = h[p] + m;
+        const float dc = yr[0] + xr[0] * hr[0], ny = yi[0] + xi[0] * hi[0];
+        for (size_t k = 0; k < m; k += 8) {
+            const __m256 a = _mm256_load_ps(xr + k), b = _mm256_load_ps(xi + k);
+            const __m256 c = _mm256_load_ps(hr + k), d = _mm256_load_ps(hi + k);
+            _mm256_store_ps(yr + k, _mm256_add_ps(_mm256_load_ps(yr + k), _mm256_sub_ps(_mm256_mul_ps(a, c), _mm256_mul_ps(b, d))));
+            _mm256_store_ps(yi + k, _mm256_add_ps(_mm256_load_ps(yi + k), _mm256_add_ps(_mm256_mul_ps(a, d), _mm256_mul_ps(b, c))));
+        }
+        yr[0] = dc;
+        yi[0] = ny;
+    }
+}
+#endif // DSP_ARCH_X86
+
+#if DSP_ARCH_ARM
+static void spec_mac_neon(float* y, const float* const* x, const float* const* h, unsigned parts, size_t m) {
+    float* yr = y;
+    float* yi = y + m;
+    memset(y, 0, sizeof(float) * 2 * m);
+    for (unsigned p = 0; p < parts; ++p) {
+        const float* xr = x[p];
+        const float* xi = x[p] + m;
+        const float* hr = h[p];
+        const float* hi = h[p] + m;
+        const float dc = yr[0] + xr[0] * hr[0], ny = yi[0] + xi[0] * hi[0];
+        for (size_t k = 0; k < m; k += 4) {
+            const float32x4_t a = vld1q_f32(xr + k), b = vld1q_f32(xi + k);
+            const float32x4_t c = vld1q_f32(hr + k), d = vld1q_f32(hi + k);
+            vst1q_f32(yr + k, vaddq_f32(vld1q_f32(yr + k), vsubq_f32(vmulq_f32(a, c), vmulq_f32(b, d))));
+            vst1q_f32(yi + k, vaddq_f32(vld1q_f32(yi + k), vaddq_f32(vmulq_f32(a, d), vmulq_f32(b, c))));
+        }
+        yr[0] = dc;
+        yi[0] = ny;
+    }
+}
+#endif // DSP_ARCH_ARM
+
+//======================================================
+// FDN（8 线反馈延迟网络）：各线同一行一次向量读，阻尼/增益/Hadamard/加输入都是 8 路向量运算，
+// 只有按各线延迟写回是 8 次标量写；两路共用一个 FDN，这 8 次写与整个反馈网络都摊到两路上。
+// Hadamard 每级写成 h = s·sign + swap(s)（乘 ±1 精确，a + (-b) 与 a - b 相同），
+// 每路输出求和固定为 ((p0+p4)+(p2+p6)) + ((p1+p5)+(p3+p7))，输入项固定为 ig0·x0 + ig1·x1，各指令集逐位一致
+//======================================================
+static const float k_fdn_sign1[8] = { 1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f };
+static const float k_fdn_sign2[8] = { 1.f, 1.f, -1.f, -1.f, 1.f, 1.f, -1.f, -1.f };
+static const float k_fdn_sign3[8] = { 1.f, 1.f, 1.f, 1.f, -1.f, -1.f, -1.f, -1.f };
+
+static inline void fdn_write(DspFdn* f, unsigned pos, const float* y) {
+    for (unsigned i = 0; i < DSP_FDN_LINES; ++i)
+        f->ring[(size_t)((pos + f->delay[i]) & f->mask) * DSP_FDN_LINES + i] = y[i];
+}
+
+static inline float fdn_tap_sum(const float* v, const float* og) {
+    float p[DSP_FDN_LINES];
+    for (unsigned i = 0; i < DSP_FDN_LINES; ++i) p[i] = v[i] * og[i];
+    return ((p[0] + p[4]) + (p[2] + p[6])) + ((p[1] + p[5]) + (p[3] + p[7]));
+}
+
+static void fdn_scalar(DspFdn* f, const float* in, float* out, size_t frames, unsigned stride, unsigned nio) {
+    float lp[DSP_FDN_LINES];
+    memcpy(lp, f->lp, sizeof(lp));
+    const float a = f->damp, b = 1.f - a;
+    unsigned pos = f->pos;
+    for (size_t n = 0; n < frames; ++n, in += stride, out += stride) {
+        const float x0 = in[0], x1 = nio > 1 ? in[1] : 0.f;
+        const float* v = f->ring + (size_t)pos * DSP_FDN_LINES;
+        float s[DSP_FDN_LINES], h[DSP_FDN_LINES];
+        const float y0 = fdn_tap_sum(v, f->out_gain[0]), y1 = fdn_tap_sum(v, f->out_gain[1]);
+        for (unsigned i = 0; i < DSP_FDN_LINES; ++i) {
+            lp[i] = v[i] * b + lp[i] * a;
+            s[i] = lp[i] * f->g[i];
+        }
+        for (unsigned i = 0; i < DSP_FDN_LINES; ++i) h[i] = s[i] * k_fdn_sign1[i] + s[i ^ 1];
+        for (unsigned i = 0; i < DSP_FDN_LINES; ++i) s[i] = h[i] * k_fdn_sign2[i] + h[i ^ 2];
+        for (unsigned i = 0; i < DSP_FDN_LINES; ++i) h[i] = s[i] * k_fdn_sign3[i] + s[i ^ 4];
+        for (unsigned i = 0; i < DSP_FDN_LINES; ++i) h[i] = h[i] + (f->in_gain[0][i] * x0 + f->in_gain[1][i] * x1);
+        fdn_write(f, pos, h);
+        pos = (pos + 1) & f->mask;
+        out[0] = y0;
+        if (nio > 1) out[1] = y1;
+    }
+    memcpy(f->lp, lp, sizeof(lp));
+    f->pos = pos;
+}
+
+#if DSP_ARCH_X86
+// 两路抽头和 t0/t1（各 4 个部分和，第 j 个 = p_j + p_(j+4)）的水平求和：结果的 0/1 两个元素是两路输出
+static inline __m128 fdn_hsum2_sse(__m128 t0, __m128 t1) {
+    const __m128 u = _mm_add_ps(_mm_unpacklo_ps(t0, t1), _mm_unpackhi_ps(t0, t1));   // t0/t1 的 (0+2, 0+2, 1+3, 1+3)
+    return _mm_add_ps(u, _mm_movehl_ps(u, u));
+}
+
+static void fdn_sse2(DspFdn* f, const float* in, float* out, size_t frames, unsigned stride, unsigned nio) {
+    __m128 lp0 = _mm_loadu_ps(f->lp), lp1 = _mm_loadu_ps(f->lp + 4);
+    const __m128 A = _mm_set1_ps(f->damp), Bc = _mm_set1_ps(1.f - f->damp);
+    const __m128 g0 = _mm_loadu_ps(f->g), g1 = _mm_loadu_ps(f->g + 4);
+    const __m128 ia0 = _mm_loadu_ps(f->in_gain[0]), ia1 = _mm_loadu_ps(f->in_gain[0] + 4);
+    const __m128 ib0 = _mm_loadu_ps(f->in_gain[1]), ib1 = _mm_loadu_ps(f->in_gain[1] + 4);
+    const __m128 oa0 = _mm_loadu_ps(f->out_gain[0]), oa1 = _mm_loadu_ps(f->out_gain[0] + 4);
+    const __m128 ob0 = _mm_loadu_ps(f->out_gain[1]), ob1 = _mm_loadu_ps(f->out_gain[1] + 4);
+    const __m128 s1 = _mm_loadu_ps(k_fdn_sign1), s2 = _mm_loadu_ps(k_fdn_sign2);
+    float y[DSP_FDN_LINES];
+    unsigned pos = f->pos;
+    for (size_t n = 0; n < frames; ++n, in += stride, out += stride) {
+        const __m128 x0 = _mm_set1_ps(in[0]), x1 = _mm_set1_ps(nio > 1 ? in[1] : 0.f);
+        const float* v = f->ring + (size_t)pos * DSP_FDN_LINES;
+        const __m128 v0 = _mm_load_ps(v), v1 = _mm_load_ps(v + 4);
+        const __m128 o = fdn_hsum2_sse(_mm_add_ps(_mm_mul_ps(v0, oa0), _mm_mul_ps(v1, oa1)),
+                                       _mm_add_ps(_mm_mul_ps(v0, ob0), _mm_mul_ps(v1, ob1)));
+        lp0 = _mm_add_ps(_mm_mul_ps(v0, Bc), _mm_mul_ps(lp0, A));
+        lp1 = _mm_add_ps(_mm_mul_ps(v1, Bc), _mm_mul_ps(lp1, A));
+        __m128 a = _mm_mul_ps(lp0, g0), b = _mm_mul_ps(lp1, g1);
+        a = _mm_add_ps(_mm_mul_ps(a, s1), _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)));
+        b = _mm_add_ps(_mm_mul_ps(b, s1), _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)));
+        a = _mm_add_ps(_mm_mul_ps(a, s2), _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 0, 3, 2)));
+        b = _mm_add_ps(_mm_mul_ps(b, s2), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2)));
+        _mm_storeu_ps(y,     _mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(_mm_mul_ps(ia0, x0), _mm_mul_ps(ib0, x1))));
+        _mm_storeu_ps(y + 4, _mm_add_ps(_mm_sub_ps(a, b), _mm_add_ps(_mm_mul_ps(ia1, x0), _mm_mul_ps(ib1, x1))));
+        fdn_write(f, pos, y);
+        pos = (pos + 1) & f->mask;
+        if (nio > 1) _mm_storel_pi((__m64*)out, o);
+        else _mm_store_ss(out, o);
+    }
+    _mm_storeu_ps(f->lp, lp0);
+    _mm_storeu_ps(f->lp + 4, lp1);
+    f->pos = pos;
+}
+
+DSP_TARGET_AVX2
+static void fdn_avx2(DspFdn* f, const float* in, float* out, size_t frames, unsigned stride, unsigned nio) {
+    __m256 lp = _mm256_loadu_ps(f->lp);
+    const __m256 A = _mm256_set1_ps(f->damp), Bc = _mm256_set1_ps(1.f - f->damp);
+    const __m256 g = _mm256_loadu_ps(f->g);
+    const __m256 ia = _mm256_loadu_ps(f->in_gain[0]), ib = _mm256_loadu_ps(f->in_gain[1]);
+    const __m256 oa = _mm256_loadu_ps(f->out_gain[0]), ob = _mm256_loadu_ps(f->out_gain[1]);
+    const __m256 s1 = _mm256_loadu_ps(k_fdn_sign1), s2 = _mm256_loadu_ps(k_fdn_sign2), s3 = _mm256_loadu_ps(k_fdn_sign3);
+    float y[DSP_FDN_LINES];
+    unsigned pos = f->pos;
+    for (size_t n = 0; n < frames; ++n, in += stride, out += stride) {
+        const __m256 x0 = _mm256_set1_ps(in[0]), x1 = _mm256_set1_ps(nio > 1 ? in[1] : 0.f);
+        const __m256 v = _mm256_load_ps(f->ring + (size_t)pos * DSP_FDN_LINES);
+        const __m256 pa = _mm256_mul_ps(v, oa), pb = _mm256_mul_ps(v, ob);
+        const __m128 o = fdn_hsum2_sse(_mm_add_ps(_mm256_castps256_ps128(pa), _mm256_extractf128_ps(pa, 1)),
+                                       _mm_add_ps(_mm256_castps256_ps128(pb), _mm256_extractf128_ps(pb, 1)));
+        lp = _mm256_add_ps(_mm256_mul_ps(v, Bc), _mm256_mul_ps(lp, A));
+        __m256 s = _mm256_mul_ps(lp, g);
+        s = _mm256_add_ps(_mm256_mul_ps(s, s1), _mm256_permute_ps(s, _MM_SHUFFLE(2, 3, 0, 1)));
+        s = _mm256_add_ps(_mm256_mul_ps(s, s2), _mm256_permute_ps(s, _MM_SHUFFLE(1, 0, 3, 2)));
+        s = _mm256_add_ps(_mm256_mul_ps(s, s3), _mm256_permute2f128_ps(s, s, 1));
+        _mm256_storeu_ps(y, _mm256_add_ps(s, _mm256_add_ps(_mm256_mul_ps(ia, x0), _mm256_mul_ps(ib, x1))));
+        fdn_write(f, pos, y);
+        pos = (pos + 1) & f->mask;
+        if (nio > 1) _mm_storel_pi((__m64*)out, o);
+        else _mm_store_ss(out, o);
+    }
+    _mm256_storeu_ps(f->lp, lp);
+    f->pos = pos;
+}
+#endif // DSP_ARCH_X86
+
+#if DSP_ARCH_ARM
+static void fdn_neon(DspFdn* f, const float* in, float* out, size_t frames, unsigned stride, unsigned nio) {
+    float32x4_t lp0 = vld1q_f32(f->lp), lp1 = vld1q_f32(f->lp + 4);
+    const float32x4_t A = vdupq_n_f32(f->damp), Bc = vdupq_n_f32(1.f - f->damp);
+    const float32x4_t g0 = vld1q_f32(f->g), g1 = vld1q_f32(f->g + 4);
+    const float32x4_t ia0 = vld1q_f32(f->in_gain[0]), ia1 = vld1q_f32(f->in_gain[0] + 4);
+    const float32x4_t ib0 = vld1q_f32(f->in_gain[1]), ib1 = vld1q_f32(f->in_gain[1] + 4);
+    const float32x4_t oa0 = vld1q_f32(f->out_gain[0]), oa1 = vld1q_f32(f->out_gain[0] + 4);
+    const float32x4_t ob0 = vld1q_f32(f->out_gain[1]), ob1 = vld1q_f32(f->out_gain[1] + 4);
+    const float32x4_t s1 = vld1q_f32(k_fdn_sign1), s2 = vld1q_f32(k_fdn_sign2);
+    float y[DSP_FDN_LINES];
+    unsigned pos = f->pos;
+    for (size_t n = 0; n < frames; ++n, in += stride, out += stride) {
+        const float32x4_t x0 = vdupq_n_f32(in[0]), x1 = vdupq_n_f32(nio > 1 ? in[1] : 0.f);
+        const float* v = f->ring + (size_t)pos * DSP_FDN_LINES;
+        const float32x4_t v0 = vld1q_f32(v), v1 = vld1q_f32(v + 4);
+        const float32x4_t ta = vaddq_f32(vmulq_f32(v0, oa0), vmulq_f32(v1, oa1));
+        const float32x4_t tb = vaddq_f32(vmulq_f32(v0, ob0), vmulq_f32(v1, ob1));
+        const float32x2_t o = vpadd_f32(vadd_f32(vget_low_f32(ta), vget_high_f32(ta)),
+                                        vadd_f32(vget_low_f32(tb), vget_high_f32(tb)));
+        lp0 = vaddq_f32(vmulq_f32(v0, Bc), vmulq_f32(lp0, A));
+        lp1 = vaddq_f32(vmulq_f32(v1, Bc), vmulq_f32(lp1, A));
+        float32x4_t a = vmulq_f32(lp0, g0), b = vmulq_f32(lp1, g1);
+        a = vaddq_f32(vmulq_f32(a, s1), vrev64q_f32(a));
+        b = vaddq_f32(vmulq_f32(b, s1), vrev64q_f32(b));
+        a = vaddq_f32(vmulq_f32(a, s2), vextq_f32(a, a, 2));
+        b = vaddq_f32(vmulq_f32(b, s2), vextq_f32(b, b, 2));
+        vst1q_f32(y,     vaddq_f32(vaddq_f32(a, b), vaddq_f32(vmulq_f32(ia0, x0), vmulq_f32(ib0, x1))));
+        vst1q_f32(y + 4, vaddq_f32(vsubq_f32(a, b), vaddq_f32(vmulq_f32(ia1, x0), vmulq_f32(ib1, x1))));
+        fdn_write(f, pos, y);
+        pos = (pos + 1) & f->mask;
+        if (nio > 1) vst1_f32(out, o);
+        else vst1_lane_f32(out, o, 0);
+    }
+    vst1q_f32(f->lp, lp0);
+    vst1q_f32(f->lp + 4, lp1);
+    f->pos = pos;
+}
+#endif // DSP_ARCH_ARM
+
+//======================================================
+// Schroeder 混响：按最多 SCHROEDER_CHUNK 帧一段，先把输入按 stride 收进连续的 x[]，
+// 再依次跑 4 个梳状、两个全通，最后按 stride 写出。
+//   梳状：4 条梳状延迟线首尾相接放在同一块对齐内存里，每条线长度就是它的延迟，读写在同一位置
+//         （先读出 len 个样本以前写进的值，再写入新值）。按离绕回最近的那条线切出一段（段长 <= 线长），
+//         段内各样本互不依赖，沿时间方向 4 个（AVX2 8 个）样本一组，4 条线依次读、阻尼、反馈、加输入、
+//         写回，输出在寄存器里按 ((((0+y0)+y1)+y2)+y3)·0.25 的原顺序求和。
+//   全通：两个全通前后串联，同一样本内没法并行；单个全通在不绕回的一段里同样沿时间方向向量化。
+// 每个样本的运算和次序与逐样本标量写法完全一样，各指令集逐位一致。
+//======================================================
+#define SCHROEDER_CHUNK 256
+
+// 一条延迟线（base 起、长 len、当前位置 *idx）不绕回的一段：返回段长并给出起点
+static inline size_t schroeder_line_run(float* base, unsigned len, unsigned idx, size_t frames, float** d) {
+    const size_t n = len - idx;
+    *d = base + idx;
+    return n < frames ? n : frames;
+}
+
+static inline void schroeder_line_advance(unsigned len, unsigned* idx, size_t run) {
+    *idx += (unsigned)run;
+    if (*idx == len) *idx = 0;
+}
+
+// 4 条梳状共同不绕回的一段：返回段长并给出各线起点
+static inline size_t schroeder_comb_run(DspSchroeder* r, size_t frames, float** d) {
+    float* base = r->comb;
+    size_t n = frames;
+    for (int i = 0; i < 4; ++i) {
+        d[i] = base + r->idx[i];
+        if (r->len[i] - r->idx[i] < n) n = r->len[i] - r->idx[i];
+        base += r->len[i];
+    }
+    return n;
+}
+
+// 一个样本过 4 条梳状，返回求和输出
+static inline float schroeder_comb_sample(float* const* d, size_t n, float x, float omd, float dz, const float* fb) {
+    float s = 0.f;
+    for (int i = 0; i < 4; ++i) {
+        const float y = d[i][n];
+        const float z = omd * y + dz;
+        d[i][n] = x + z * fb[i];
+        s += y;
+    }
+    return s * 0.25f;
+}
+
+static inline void schroeder_ap_sample(float* d, float* x, float fb) {
+    const float y = *d;
+    const float v = *x + (-fb) * y;
+    *d = v;
+    *x = y + fb * v;
+}
+
+// 不绕回的一段：梳状 comb_seg(d, x, t, run, omd, dz, fb)（4 条线一起），全通 ap_seg(d, x, run, fb)
+static inline void schroeder_comb_seg_scalar(float* const* d, const float* x, float* t, size_t run, float omd, float dz, const float* fb) {
+    for (size_t n = 0; n < run; ++n) t[n] = schroeder_comb_sample(d, n, x[n], omd, dz, fb);
+}
+
+static inline void schroeder_ap_seg_scalar(float* d, float* x, size_t run, float fb) {
+    for (size_t n = 0; n < run; ++n) schroeder_ap_sample(d + n, x + n, fb);
+}
+
+#if DSP_ARCH_X86
+static inline void schroeder_comb_seg_sse2(float* const* d, const float* x, float* t, size_t run, float omd, float dz, const float* fb) {
+    const __m128 O = _mm_set1_ps(omd), DZ = _mm_set1_ps(dz), Q = _mm_set1_ps(0.25f);
+    const __m128 F[4] = { _mm_set1_ps(fb[0]), _mm_set1_ps(fb[1]), _mm_set1_ps(fb[2]), _mm_set1_ps(fb[3]) };
+    size_t n = 0;
+    for (; n + 4 <= run; n += 4) {
+        const __m128 x4 = _mm_loadu_ps(x + n);
+        __m128 s = _mm_setzero_ps();
+        for (int i = 0; i < 4; ++i) {
+            const __m128 y = _mm_loadu_ps(d[i] + n);
+            const __m128 z = _mm_add_ps(_mm_mul_ps(O, y), DZ);
+            _mm_storeu_ps(d[i] + n, _mm_add_ps(x4, _mm_mul_ps(z, F[i])));
+            s = _mm_add_ps(s, y);
+        }
+        _mm_storeu_ps(t + n, _mm_mul_ps(s, Q));
+    }
+    for (; n < run; ++n) t[n] = schroeder_comb_sample(d, n, x[n], omd, dz, fb);
+}
+
+static inline void schroeder_ap_seg_sse2(float* d, float* x, size_t run, float fb) {
+    const __m128 F = _mm_set1_ps(fb), NF = _mm_set1_ps(-fb);
+    size_t n = 0;
+    for (; n + 4 <= run; n += 4) {
+        const __m128 y = _mm_loadu_ps(d + n);
+        const __m128 v = _mm_add_ps(_mm_loadu_ps(x + n), _mm_mul_ps(NF, y));
+        _mm_storeu_ps(d + n, v);
+        _mm_storeu_ps(x + n, _mm_add_ps(y, _mm_mul_ps(F, v)));
+    }
+    for (; n < run; ++n) schroeder_ap_sample(d + n, x + n, fb);
+}
+
+// AVX2：同 SSE2，一组 8 个样本
+DSP_TARGET_AVX2
+static inline void schroeder_comb_seg_avx2(float* const* d, const float* x, float* t, size_t run, float omd, float dz, const float* fb) {
+    const __m256 O = _mm256_set1_ps(omd), DZ = _mm256_set1_ps(dz), Q = _mm256_set1_ps(0.25f);
+    const __m256 F[4] = { _mm256_set1_ps(fb[0]), _mm256_set1_ps(fb[1]), _mm256_set1_ps(fb[2]), _mm256_set1_ps(fb[3]) };
+    size_t n = 0;
+    for (; n + 8 <= run; n += 8) {
+        const __m256 x8 = _mm256_loadu_ps(x + n);
+        __m256 s = _mm256_setzero_ps();
+        for (int i = 0; i < 4; ++i) {
+            const __m256 y = _mm256_loadu_ps(d[i] + n);
+            const __m256 z = _mm256_add_ps(_mm256_mul_ps(O, y), DZ);
+            _mm256_storeu_ps(d[i] + n, _mm256_add_ps(x8, _mm256_mul_ps(z, F[i])));
+            s = _mm256_add_ps(s, y);
+        }
+        _mm256_storeu_ps(t + n, _mm256_mul_ps(s, Q));
+    }
+    for (; n < run; ++n) t[n] = schroeder_comb_sample(d, n, x[n], omd, dz, fb);
+}
+
+DSP_TARGET_AVX2
+static inline void schroeder_ap_seg_avx2(float* d, float* x, size_t run, float fb) {
+    const __m256 F = _mm256_set1_ps(fb), NF = _mm256_set1_ps(-fb);
+    size_t n = 0;
+    for (; n + 8 <= run; n += 8) {
+        const __m256 y = _mm256_loadu_ps(d + n);
+        const __m256 v = _mm256_add_ps(_mm256_loadu_ps(x + n), _mm256_mul_ps(NF, y));
+        _mm256_storeu_ps(d + n, v);
+        _mm256_storeu_ps(x + n, _mm256_add_ps(y, _mm256_mul_ps(F, v)));
+    }
+    for (; n < run; ++n) schroeder_ap_sample(d + n, x + n, fb);
+}
+#endif // DSP_ARCH_X86
+
+#if DSP_ARCH_ARM
+static inline void schroeder_comb_seg_neon(float* const* d, const float* x, float* t, size_t run, float omd, float dz, const float* fb) {
+    const float32x4_t O = vdupq_n_f32(omd), DZ = vdupq_n_f32(dz), Q = vdupq_n_f32(0.25f);
+    const float32x4_t F[4] = { vdupq_n_f32(fb[0]), vdupq_n_f32(fb[1]), vdupq_n_f32(fb[2]), vdupq_n_f32(fb[3]) };
+    size_t n = 0;
+    for (; n + 4 <= run; n += 4) {
+        const float32x4_t x4 = vld1q_f32(x + n);
+        float32x4_t s = vdupq_n_f32(0.f);
+        for (int i = 0; i < 4; ++i) {
+            const float32x4_t y = vld1q_f32(d[i] + n);
+            const float32x4_t z = vaddq_f32(vmulq_f32(O, y), DZ);
+            vst1q_f32(d[i] + n, vaddq_f32(x4, vmulq_f32(z, F[i])));
+            s = vaddq_f32(s, y);
+        }
+        vst1q_f32(t + n, vmulq_f32(s, Q));
+    }
+    for (; n < run; ++n) t[n] = schroeder_comb_sample(d, n, x[n], omd, dz, fb);
+}
+
+static inline void schroeder_ap_seg_neon(float* d, float* x, size_t run, float fb) {
+    const float32x4_t F = vdupq_n_f32(fb), NF = vdupq_n_f32(-fb);
+    size_t n = 0;
+    for (; n + 4 <= run; n += 4) {
+        const float32x4_t y = vld1q_f32(d + n);
+        const float32x4_t v = vaddq_f32(vld1q_f32(x + n), vmulq_f32(NF, y));
+        vst1q_f32(d + n, v);
+        vst1q_f32(x + n, vaddq_f32(y, vmulq_f32(F, v)));
+    }
+    for (; n < run; ++n) schroeder_ap_sample(d + n, x + n, fb);
+}
+#endif // DSP_ARCH_ARM
+
+// 完整内核：每段收输入 → 梳状组 → 逐个全通 → 写出
+// （in 与 out 可以是同一块内存：一段的输入先全部读完）
+#define DSP_DEFINE_SCHROEDER(name, comb_seg, ap_seg, attr)                                        \
+    attr static void name(DspSchroeder* r, const float* in, float* out, size_t frames, unsigned stride) { \
+        float x[SCHROEDER_CHUNK], t[SCHROEDER_CHUNK];                                             \
+        const float omd = 1.f - r->damp, dz = r->damp * 0.f;                                      \
+        while (frames) {                                                                          \
+            const size_t n = frames < SCHROEDER_CHUNK ? frames : SCHROEDER_CHUNK;                 \
+            for (size_t j = 0; j < n; ++j, in += stride) x[j] = *in;                              \
+            for (size_t j = 0, run; j < n; j += run) {                                            \
+                float* d[4];                                                                      \
+                run = schroeder_comb_run(r, n - j, d);                                            \
+                comb_seg(d, x + j, t + j, run, omd, dz, r->fb);                                   \
+                for (int i = 0; i < 4; ++i) schroeder_line_advance(r->len[i], &r->idx[i], run);   \
+            }                                                                                     \
+            for (int k = 0; k < 2; ++k) {                                                         \
+                float* ab = r->ap + (k ? r->ap_len[0] : 0);                                       \
+                for (size_t j = 0, run; j < n; j += run) {                                        \
+                    float* d;                                                                     \
+                    run = schroeder_line_run(ab, r->ap_len[k], r->ap_idx[k], n - j, &d);          \
+                    ap_seg(d, t + j, run, r->ap_fb[k]);                                           \
+                    schroeder_line_advance(r->ap_len[k], &r->ap_idx[k], run);                     \
+                }                                                                                 \
+            }                                                                                     \
+            for (size_t j = 0; j < n; ++j, out += stride) *out = t[j];                            \
+            frames -= n;                                                                          \
+        }                                                                                         \
+    }
+
+DSP_DEFINE_SCHROEDER(schroeder_scalar, schroeder_comb_seg_scalar, schroeder_ap_seg_scalar, )
+#if DSP_ARCH_X86
+DSP_DEFINE_SCHROEDER(schroeder_sse2, schroeder_comb_seg_sse2, schroeder_ap_seg_sse2, )
+DSP_DEFINE_SCHROEDER(schroeder_avx2, schroeder_comb_seg_avx2, schroeder_ap_seg_avx2, DSP_TARGET_AVX2)
+#endif
+#if DSP_ARCH_ARM
+DSP_DEFINE_SCHROEDER(schroeder_neon, schroeder_comb_seg_neon, schroeder_ap_seg_neon, )
+#endif
+
+//======================================================
+// 静音检测：|x[i]| <= level 对所有 i 成立？（NaN 不算静音）
+// 每 64 个样本看一次结果，有声音的块第一组就返回；只读不写，与排布无关
+//======================================================
+#define QUIET_GROUP 64
+
+static int is_quiet_scalar(const float* x, size_t n, float level) {
+    for (size_t i = 0; i < n; ++i)
+        if (!(fabsf(x[i]) <= level)) return 0;
+    return 1;
+}
+
+#if DSP_ARCH_X86
+static int is_quiet_sse2(const float* x, size_t n, float level) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 lv = _mm_set1_ps(level);
+    size_t i = 0;
+    while (i + 4 <= n) {
+        const size_t e = (n - i >= QUIET_GROUP) ? i + QUIET_GROUP : i + ((n - i) & ~(size_t)3);
+        __m128 loud = _mm_setzero_ps();
+        for (; i < e; i += 4)   // !(|x| <= level)：NaN 也置位
+            loud = _mm_or_ps(loud, _mm_cmpnle_ps(_mm_and_ps(_mm_loadu_ps(x + i), absMask), lv));
+        if (_mm_movemask_ps(loud)) return 0;
+    }
+    return is_quiet_scalar(x + i, n - i, level);
+}
+
+DSP_TARGET_AVX2
+static int is_quiet_avx2(const float* x, size_t n, float level) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 lv = _mm256_set1_ps(level);
+    size_t i = 0;
+    while (i + 8 <= n) {
+        const size_t e = (n - i >= QUIET_GROUP) ? i + QUIET_GROUP : i + ((n - i) & ~(size_t)7);
+        __m256 loud = _mm256_setzero_ps();
+        for (; i < e; i += 8)
+            loud = _mm256_or_ps(loud, _mm256_cmp_ps(_mm256_and_ps(_mm256_loadu_ps(x + i), absMask), lv, _CMP_NLE_UQ));
+        if (_mm256_movemask_ps(loud)) return 0;
+    }
+    return is_quiet_scalar(x + i, n - i, level);
+}
+#endif // DSP_ARCH_X86
+
+#if DSP_ARCH_ARM
+static int is_quiet_neon(const float* x, size_t n, float level) {
+    const float32x4_t lv = vdupq_n_f32(level);
+    size_t i = 0;
+    while (i + 4 <= n) {
+        const size_t e = (n - i >= QUIET_GROUP) ? i + QUIET_GROUP : i + ((n - i) & ~(size_t)3);
+        uint32x4_t ok = vdupq_n_u32(0xffffffffu);
+        for (; i < e; i += 4)   // |x| <= level 对 NaN 为假
+            ok = vandq_u32(ok, vcleq_f32(vabsq_f32(vld1q_f32(x + i)), lv));
+        const uint32x2_t m = vand_u32(vget_low_u32(ok), vget_high_u32(ok));
+        if ((vget_lane_u32(m, 0) & vget_lane_u32(m, 1)) != 0xffffffffu) return 0;
+    }
+    return is_quiet_scalar(x + i, n - i, level);
+}
+#endif // DSP_ARCH_ARM
+
+//======================================================
+// 指令集检测与分派
+//======================================================
+#if DSP_ARCH_X86
+static int cpu_has_sse2(void) {
+#if defined(_M_X64) || defined(__x86_64__)
+    return 1; // x64 基线
+#elif defined(_MSC_VER)
+    int r[4]; __cpuid(r, 1);
+    return (r[3] >> 26) & 1;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static int cpu_has_avx2(void) {
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7) return 0;
+    __cpuid(r, 1);
+    const int osxsave = (r[2] >> 27) & 1;
+    const int avx     = (r[2] >> 28) & 1;
+    if (!osxsave || !avx) return 0;
+    // 操作系统必须保存 YMM 状态（XCR0 的 bit1/bit2）
+    if ((_xgetbv(0) & 0x6) != 0x6) return 0;
+    __cpuidex(r, 7, 0);
+    return (r[1] >> 5) & 1;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+int dsp_simd_supported(DSP_SIMD_LEVEL level) {
+    switch (level) {
+    case DSP_SIMD_SCALAR: return 1;
+#if DSP_ARCH_X86
+    case DSP_SIMD_SSE2:   return cpu_has_sse2();
+    case DSP_SIMD_AVX2:   return cpu_has_sse2() && cpu_has_avx2();
+#endif
+#if DSP_ARCH_ARM
+    case DSP_SIMD_NEON:   return 1; // ARM64 / Windows on ARM 均保证 NEON
+#endif
+    default:              return 0;
+    }
+}
+
+DSP_SIMD_LEVEL dsp_simd_best(void) {
+    static const DSP_SIMD_LEVEL order[] = { DSP_SIMD_AVX2, DSP_SIMD_NEON, DSP_SIMD_SSE2 };
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); ++i)
+        if (dsp_simd_supported(order[i])) return order[i];
+    return DSP_SIMD_SCALAR;
+}
+
+dsp_bq_cascade_fn dsp_simd_bq_cascade(DSP_SIMD_LEVEL level) {
+    if (!dsp_simd_supported(level)) return NULL;
+    switch (level) {
+    case DSP_SIMD_SCALAR: return bq_cascade_scalar;
+#if DSP_ARCH_X86
+    case DSP_SIMD_SSE2:   return bq_cascade_sse2;
+    case DSP_SIMD_AVX2:   return bq_cascade_avx2;
+#endif
+#if DSP_ARCH_ARM
+    case DSP_SIMD_NEON:   return bq_cascade_neon;
+#endif
+    default:              return NULL;
+    }
+}
+
+dsp_ramp_fill_fn dsp_simd_ramp_fill(DSP_SIMD_LEVEL level) {
+    if (!dsp_simd_supported(level)) return NULL;
+    switch (level) {
+    case DSP_SIMD_SCALAR: return ramp_fill_scalar;
+#if DSP_ARCH_X86
+    case DSP_SIMD_SSE2:   return ramp_fill_sse2;
+    case DSP_SIMD_AVX2:   return ramp_fill_avx2;
+#endif
+#if DSP_ARCH_ARM
+    case DSP_SIMD_NEON:   return ramp_fill_neon;
+#endif
+    default:              return NULL;
+    }
+}
+
+dsp_ramp_mul_fn dsp_simd_ramp_mul(DSP_SIMD_LEVEL level) {
+    if (!dsp_simd_supported(level)) return NULL;
+    switch (level) {
+    case DSP_SIMD_SCALAR: return ramp_mul_scalar;
+#if DSP_ARCH_X86
+    case DSP_SIMD_SSE2:   return ramp_mul_sse2;
+    case DSP_SIMD_AVX2:   return ramp_mul_avx2;
+#endif
+#if DSP_ARCH_ARM
+    case DSP_SIMD_NEON:   return ramp_mul_neon;
+#endif
+    default:              return NULL;
+    }
+}
+
+dsp_spec_mac_fn dsp_simd_spec_mac(DSP_SIMD_LEVEL level) {
+    if (!dsp_simd_supported(level)) return NULL;
+    switch (level) {
+    case DSP_SIMD_SCALAR: return spec_mac_scalar;
+#if DSP_ARCH_X86
+    case DSP_SIMD_SSE2:   return spec_mac_sse2;
+    case DSP_SIMD_AVX2:   return spec_mac_avx2;
+#endif
+#if DSP_ARCH_ARM
+    case DSP_SIMD_NEON:   return spec_mac_neon;
+#endif
+    default:              return NULL;
+    }
+}
+
+dsp_fdn_fn dsp_simd_fdn(DSP_SIMD_LEVEL level) {
+    if (!dsp_simd_supported(level)) return NULL;
+    switch (level) {
+    case DSP_SIMD_SCALAR: return fdn_scalar;
+#if DSP_ARCH_X86
+    case DSP_SIMD_SSE2:   return fdn_sse2;
+    case DSP_SIMD_AVX2:   return fdn_avx2;
+#endif
+#if DSP_ARCH_ARM
+    case DSP_SIMD_NEON:   return fdn_neon;
+#endif
+    default:              return NULL;
+    }
+}
+
+dsp_schroeder_fn dsp_simd_schroeder(DSP_SIMD_LEVEL level) {
+    if (!dsp_simd_supported(level)) return NULL;
+    switch (level) {
+    case DSP_SIMD_SCALAR: return schroeder_scalar;
+#if DSP_ARCH_X86
+    case DSP_SIMD_SSE2:   return schroeder_sse2;
+    case DSP_SIMD_AVX2:   return schroeder_avx2;
+#endif
+#if DSP_ARCH_ARM
+    case DSP_SIMD_NEON:   return schroeder_neon;
+#endif
+    default:              return NULL;
+    }
+}
+
+dsp_is_quiet_fn dsp_simd_is_quiet(DSP_SIMD_LEVEL level) {
+    if (!dsp_simd_supported(level)) return NULL;
+    switch (level) {
+    case DSP_SIMD_SCALAR: return is_quiet_scalar;
+#if DSP_ARCH_X86
+    case DSP_SIMD_SSE2:   return is_quiet_sse2;
+    case DSP_SIMD_AVX2:   return is_quiet_avx2;
+#endif
+#if DSP_ARCH_ARM
+    case DSP_SIMD_NEON:   return is_quiet_neon;
+#endif
+    default:              return NULL;
+    }
+}
+
+//======================================================
+// 非规格化数：处理期间按“冲零”运行（x86 MXCSR 的 FTZ|DAZ，ARM 的 FZ）
+//======================================================
+#if DSP_ARCH_X86
+#define DSP_MXCSR_FLUSH 0x8040u   // FTZ (bit 15) | DAZ (bit 6)
+#elif DSP_ARCH_ARM && !defined(_MSC_VER)
+#define DSP_FPCR_FZ (1ull << 24)
+#endif
+
+dsp_fpu_state dsp_fpu_flush_denormals(void) {
+#if DSP_ARCH_X86
+#if defined(_M_X64) || defined(__x86_64__)
+    const unsigned old = _mm_getcsr();
+#else
+    static int s_sse2 = -1;   // 32 位：没有 SSE 的 CPU 上不能碰 MXCSR
+    if (s_sse2 < 0) s_sse2 = cpu_has_sse2();
+    if (!s_sse2) return 0;
+    const unsigned old = _mm_getcsr();
+#endif
+    if ((old & DSP_MXCSR_FLUSH) != DSP_MXCSR_FLUSH) _mm_setcsr(old | DSP_MXCSR_FLUSH);
+    return old;
+#elif DSP_ARCH_ARM && defined(_MSC_VER)
+    unsigned old = 0;
+    _controlfp_s(&old, 0, 0);
+    unsigned cur;
+    if ((old & _MCW_DN) != _DN_FLUSH) _controlfp_s(&cur, _DN_FLUSH, _MCW_DN);
+    return old;
+#elif DSP_ARCH_ARM && defined(__aarch64__)
+    unsigned long long old;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(old));
+    if (!(old & DSP_FPCR_FZ)) __asm__ __volatile__("msr fpcr, %0" : : "r"(old | DSP_FPCR_FZ));
+    return old;
+#elif DSP_ARCH_ARM
+    unsigned old;
+    __asm__ __volatile__("vmrs %0, fpscr" : "=r"(old));
+    if (!(old & DSP_FPCR_FZ)) __asm__ __volatile__("vmsr fpscr, %0" : : "r"(old | (unsigned)DSP_FPCR_FZ));
+    return old;
+#else
+    return 0;
+#endif
+}
+
+void dsp_fpu_restore(dsp_fpu_state s) {
+#if DSP_ARCH_X86
+#if !defined(_M_X64) && !defined(__x86_64__)
+    if (!s) return;   // 没有 SSE：flush 时什么也没做
+#endif
+    if (_mm_getcsr() != (unsigned)s) _mm_setcsr((unsigned)s);
+#elif DSP_ARCH_ARM && defined(_MSC_VER)
+    unsigned cur;
+    _controlfp_s(&cur, (unsigned)s & _MCW_DN, _MCW_DN);
+#elif DSP_ARCH_ARM && defined(__aarch64__)
+    __asm__ __volatile__("msr fpcr, %0" : : "r"((unsigned long long)s));
+#elif DSP_ARCH_ARM
+    __asm__ __volatile__("vmsr fpscr, %0" : : "r"((unsigned)s));
+#else
+    (void)s;
+#endif
+}
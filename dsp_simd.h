@@ -0,0 +1,142 @@
+#pragma once
+// dsp_simd.h —— DSP 内部使用的 SIMD 内核与指令集分派（不对外公开）
+// 约定：多通道数据在工作区内按“帧 × lane”排布（buf[n*lanes + ch]），
+//      lanes = 通道数向上取整到 4 的倍数，多出的 lane 恒为 0，
+//      这样每个通道占一个 SIMD lane，整块逐段处理时滤波器状态常驻寄存器。
+#include <stddef.h>
+#include "dsp_wrapper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ================== 平台/指令集宏 ==================
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define DSP_ARCH_X86 1
+#elif defined(_M_ARM64) || defined(_M_ARM) || defined(__aarch64__) || defined(__ARM_NEON)
+#define DSP_ARCH_ARM 1
+#endif
+
+#define DSP_LANE_ALIGN   4      // lanes 的取整粒度（SSE2/NEON 宽度；AVX2 按 8 处理 + 4 尾巴）
+#define DSP_MEM_ALIGN    64     // 工作区/状态对齐（缓存行）
+#define DSP_SUBBLOCK     256    // 工作区帧数：lanes<=8 时约 8KB，留在 L1 内
+
+static inline unsigned dsp_round_lanes(unsigned ch) {
+    return (ch + (DSP_LANE_ALIGN - 1)) & ~(unsigned)(DSP_LANE_ALIGN - 1);
+}
+
+// ================== 对齐分配 ==================
+void* dsp_aligned_alloc(size_t bytes, size_t align);   // 内容已清零
+void  dsp_aligned_free(void* p);
+
+// ================== Biquad 级联内核 ==================
+// 一段 biquad 的系数（所有通道共享）
+typedef struct {
+    float b0, b1, b2, a1, a2;
+} BqCoef;
+
+// MY_EQ_BANDS 段系数的 SoA 排布（同名系数连续存放）
+typedef struct {
+    float b0[MY_EQ_BANDS];
+    float b1[MY_EQ_BANDS];
+    float b2[MY_EQ_BANDS];
+    float a1[MY_EQ_BANDS];
+    float a2[MY_EQ_BANDS];
+} BqCoefSoA;
+
+// 单段状态占 4*lanes 个 float：x1, x2, y1, y2（DF1）
+#define DSP_BQ_STATE_FLOATS(lanes) (4u * (lanes))
+
+// 对一个 lane 化缓冲区原地跑 biquad 级联，只处理 active[0..nActive) 列出的段
+// state: [MY_EQ_BANDS][4][lanes]；buf: [frames][lanes]
+// 逐段整块处理与逐样本穿过各段的结果相同（每段只依赖前一段的过去输出）
+typedef void (*dsp_bq_cascade_fn)(const BqCoefSoA* k, const unsigned char* active, unsigned nActive,
+                                  float* state, float* buf, size_t frames, unsigned lanes);
+
+// ================== 参数斜坡内核 ==================
+// 线性斜坡：dst[n] = v0 + step * (n + 1)，n = 0..frames-1（按下标直接算，不累加，没有误差积累）
+typedef void (*dsp_ramp_fill_fn)(float* dst, size_t frames, float v0, float step);
+// 逐帧增益：buf[n*lanes + l] *= g[n]（每帧一个值广播到全部 lane）
+typedef void (*dsp_ramp_mul_fn)(float* buf, const float* g, size_t frames, unsigned lanes);
+
+// ================== 频域乘加内核（分块卷积） ==================
+// 频谱按 dsp_fft.h 的拆分排布（m 个实部后接 m 个虚部，bin 0 的虚部位置放 Nyquist）；m 为 8 的倍数
+// y = Σ x[p]·h[p]（逐 bin 复数乘，p = 0..parts-1 依次累加；直流与 Nyquist 各按实数乘）
+typedef void (*dsp_spec_mac_fn)(float* y, const float* const* x, const float* const* h, unsigned parts, size_t m);
+
+// ================== 8 线反馈延迟网络（FDN 混响）内核 ==================
+#define DSP_FDN_LINES 8
+
+// 一个 FDN 的状态与系数。8 条延迟线交织存放在同一个环里：第 r 行是各线同一时刻的 8 个样本（32 字节，对齐），
+// 每个样本所有线一起读当前行（一次向量读）；延迟体现在写位置上：第 i 线的新值写到 pos + delay[i] 行。
+// 一个 FDN 供两路（相邻两个通道）共用：两路输入各按一组系数分配到各线，两组输出抽头各出一路
+typedef struct {
+    float    lp[DSP_FDN_LINES];           // 阻尼低通状态
+    float    g[DSP_FDN_LINES];            // 反馈增益（按 RT60 与线长算，已含 Hadamard 归一化的 1/√8）
+    float    in_gain[2][DSP_FDN_LINES];   // 两路输入分配到各线
+    float    out_gain[2][DSP_FDN_LINES];  // 两路输出各自的抽头
+    float    damp;                     // 一阶低通：lp = (1-damp)·v + damp·lp
+    float*   ring;                     // [mask+1][DSP_FDN_LINES]
+    unsigned mask;                     // 环长 - 1（环长为 2 的幂，大于最长延迟）
+    unsigned pos;                      // 当前读行
+    unsigned delay[DSP_FDN_LINES];     // 各线延迟（样本）
+} DspFdn;
+
+// 逐样本：读当前行 → 两组输出抽头求和 → 阻尼低通 → 反馈增益 → 8 点 Hadamard（3 级蝶形）→ 加两路输入 → 按各线延迟写回。
+// in/out 是 lane 排布里相邻的两个通道（in[0]、in[1]），相邻样本间隔 stride 个 float，可以是同一块内存；
+// nio = 1 时只有一路（第二路输入按 0 算、不写第二路输出）
+typedef void (*dsp_fdn_fn)(DspFdn* f, const float* in, float* out, size_t frames, unsigned stride, unsigned nio);
+
+// ================== Schroeder 混响内核（4 梳状 + 2 全通） ==================
+// 4 条梳状延迟线首尾相接放在同一块对齐内存里，每条线长就是它的延迟，读写在同一位置；
+// 两个全通也首尾相接放在一段内存里。线与线之间（梳状）或同一条线不绕回的一段之内没有依赖，
+// 内核逐条线沿时间方向做向量运算；两个全通前后串联，依次各跑一遍
+typedef struct {
+    float*   comb;         // [len[0] + len[1] + len[2] + len[3]]
+    unsigned len[4];       // 各梳状长度（样本）
+    unsigned idx[4];       // 各梳状当前读写位置
+    float    fb[4];        // 各梳状反馈
+    float    damp;
+    float*   ap;           // [ap_len[0] + ap_len[1]]
+    unsigned ap_len[2];
+    unsigned ap_idx[2];
+    float    ap_fb[2];
+} DspSchroeder;
+
+// 逐样本：各梳状读出 y → z = (1-damp)·y + damp·0 → 写回 x + z·fb → 输出 ((((0+y0)+y1)+y2)+y3)·0.25
+// → 两个全通。in/out 相邻样本间隔 stride 个 float，可以是同一块内存
+typedef void (*dsp_schroeder_fn)(DspSchroeder* r, const float* in, float* out, size_t frames, unsigned stride);
+
+// ================== 静音检测 ==================
+// x[0..n) 全部满足 |x| <= level 时返回 1（NaN 不算静音）；分组比较，有声音时第一组就返回
+typedef int (*dsp_is_quiet_fn)(const float* x, size_t n, float level);
+
+// ================== 非规格化数 ==================
+// 衰减中的混响/IIR 状态会落进非规格化数，x86 上每次运算慢 10~100 倍。
+// 处理开头调 dsp_fpu_flush_denormals 置上冲零（x86：MXCSR 的 FTZ|DAZ；ARM：FPCR/FPSCR 的 FZ），
+// 结束时用它的返回值调 dsp_fpu_restore 还原调用线程原来的设置。已经是冲零时不写寄存器
+typedef unsigned long long dsp_fpu_state;
+dsp_fpu_state dsp_fpu_flush_denormals(void);
+void          dsp_fpu_restore(dsp_fpu_state s);
+
+// 当前机器是否支持某指令集（DSP_SIMD_SCALAR 恒支持）
+int dsp_simd_supported(DSP_SIMD_LEVEL level);
+// 机器支持的最宽指令集
+DSP_SIMD_LEVEL dsp_simd_best(void);
+// 取指定指令集的 biquad 级联内核；不支持时返回 NULL
+dsp_bq_cascade_fn dsp_simd_bq_cascade(DSP_SIMD_LEVEL level);
+// 斜坡内核（与 biquad 内核同一套分派；不支持时返回 NULL）
+dsp_ramp_fill_fn dsp_simd_ramp_fill(DSP_SIMD_LEVEL level);
+dsp_ramp_mul_fn  dsp_simd_ramp_mul(DSP_SIMD_LEVEL level);
+// 频域乘加内核（不支持时返回 NULL）
+dsp_spec_mac_fn  dsp_simd_spec_mac(DSP_SIMD_LEVEL level);
+// FDN 内核（不支持时返回 NULL）
+dsp_fdn_fn       dsp_simd_fdn(DSP_SIMD_LEVEL level);
+// Schroeder 混响内核（不支持时返回 NULL；SSE2/NEON 一组 4 个样本，AVX2 一组 8 个）
+dsp_schroeder_fn dsp_simd_schroeder(DSP_SIMD_LEVEL level);
+// 静音检测内核（不支持时返回 NULL）
+dsp_is_quiet_fn  dsp_simd_is_quiet(DSP_SIMD_LEVEL level);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,4 +1,10 @@
 #include "dsp_wrapper.h"
+#include "dsp_simd.h"
+#include "dsp_atomic.h"
+#include "dsp_clock.h"
+#include "dsp_fastmath.h"
+#include "dsp_conv.h"
+#include "dsp_nuconv.h"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -10,61 +16,33 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-static inline float dB_to_linear(float db) {
-    return (float)pow(10.0, db / 20.0);
-}
-
+// NaN 比较总是假，写成这样 NaN 落到 lo（而不是原样穿过去）
 static inline float clampf(float x, float lo, float hi) {
-    return x < lo ? lo : (x > hi ? hi : x);
-}
-
-static inline float softclip(float x) {
-    // 简单软限幅：tanh 风格
-    const float k = 1.5f;
-    return tanhf(k * x);
+    return x >= lo ? (x <= hi ? x : hi) : lo;
 }
 
 //======================================================
 // Biquad（双二阶）滤波器：低搁架 / 峰值 / 高搁架
-// 每个通道各自一套状态
+// MY_EQ_BANDS 段串联；系数所有通道共享并按 SoA 存放，
+// 状态 [band][4][lanes] 连续对齐存放（每通道一个 SIMD lane），由 dsp_simd.c 的级联内核整块处理
 //======================================================
 typedef struct {
-    // 系数
-    float b0, b1, b2, a1, a2;
-    // 状态（Direct Form I 或 II 均可，这里用 DF1）
-    float x1, x2, y1, y2;
-    // 目标系数（参数更新时写入这组，处理时原子切换）
-    volatile float t_b0, t_b1, t_b2, t_a1, t_a2;
-    volatile int   update_pending;
-    int enabled;
-} Biquad;
+    // 状态 [MY_EQ_BANDS][4][lanes]（系数不在这里：随参数快照一起发布）
+    float* state;
+} EqCascade;
 
-static void biquad_reset(Biquad* s) {
-    s->x1 = s->x2 = s->y1 = s->y2 = 0.0f;
+static size_t eq_state_bytes(unsigned lanes) {
+    return sizeof(float) * DSP_BQ_STATE_FLOATS(lanes) * MY_EQ_BANDS;
 }
 
-static float biquad_process(Biquad* s, float x) {
-    if (s->update_pending) {
-        // 无锁切换（尽量保持简单、近似原子）
-        s->b0 = s->t_b0; s->b1 = s->t_b1; s->b2 = s->t_b2; s->a1 = s->t_a1; s->a2 = s->t_a2;
-        s->update_pending = 0;
-        // 不重置状态，以防参数步进造成突变；若需要可插入系数光滑
-    }
-    if (!s->enabled) return x;
-
-    float y = s->b0 * x + s->b1 * s->x1 + s->b2 * s->x2
-                        - s->a1 * s->y1 - s->a2 * s->y2;
-    s->x2 = s->x1; s->x1 = x;
-    s->y2 = s->y1; s->y1 = y;
-    return y;
+static void eq_reset(EqCascade* e, unsigned lanes) {
+    if (e->state) memset(e->state, 0, eq_state_bytes(lanes));
 }
 
 // 设计函数：低搁架 / 峰值 / 高搁架（Audio EQ Cookbook）
-static void biquad_design_lowshelf(Biquad* s, float fs, float f0, float gain_db, float Q) {
-    float A  = dB_to_linear(gain_db);
-    float w0 = 2.f * (float)M_PI * (f0 / fs);
-    float alpha = sinf(w0) / (2.f * Q);
-    float cosw0 = cosf(w0);
+// A = 10^(gain_db/20) 与 sin/cos(w0) 由调用方批量算好（见 eq_design_bands）
+static void biquad_design_lowshelf(BqCoef* s, float A, float sinw0, float cosw0, float Q) {
+    float alpha = sinw0 / (2.f * Q);
 
     float sqrtA = sqrtf(A);
     float b0 =     A*( (A+1) - (A-1)*cosw0 + 2*sqrtA*alpha );
@@ -74,16 +52,12 @@ static void biquad_design_lowshelf(Biquad* s, float fs, float f0, float gain_db,
     float a1 =   -2*( (A-1) + (A+1)*cosw0 );
     float a2 =         (A+1) + (A-1)*cosw0 - 2*sqrtA*alpha;
 
-    s->t_b0 = b0/a0; s->t_b1 = b1/a0; s->t_b2 = b2/a0;
-    s->t_a1 = a1/a0; s->t_a2 = a2/a0;
-    s->update_pending = 1;
+    s->b0 = b0/a0; s->b1 = b1/a0; s->b2 = b2/a0;
+    s->a1 = a1/a0; s->a2 = a2/a0;
 }
 
-static void biquad_design_peaking(Biquad* s, float fs, float f0, float gain_db, float Q) {
-    float A  = dB_to_linear(gain_db);
-    float w0 = 2.f * (float)M_PI * (f0 / fs);
-    float alpha = sinf(w0) / (2.f * Q);
-    float cosw0 = cosf(w0);
+static void biquad_design_peaking(BqCoef* s, float A, float sinw0, float cosw0, float Q) {
+    float alpha = sinw0 / (2.f * Q);
 
     float b0 = 1 + alpha*A;
     float b1 = -2*cosw0;
@@ -92,16 +66,12 @@ static void biquad_design_peaking(Biquad* s, float fs, float f0, float gain_db,
     float a1 = -2*cosw0;
     float a2 = 1 - alpha/A;
 
-    s->t_b0 = b0/a0; s->t_b1 = b1/a0; s->t_b2 = b2/a0;
-    s->t_a1 = a1/a0; s->t_a2 = a2/a0;
-    s->update_pending = 1;
+    s->b0 = b0/a0; s->b1 = b1/a0; s->b2 = b2/a0;
+    s->a1 = a1/a0; s->a2 = a2/a0;
 }
 
-static void biquad_design_highshelf(Biquad* s, float fs, float f0, float gain_db, float Q) {
-    float A  = dB_to_linear(gain_db);
-    float w0 = 2.f * (float)M_PI * (f0 / fs);
-    float alpha = sinf(w0) / (2.f * Q);
-    float cosw0 = cosf(w0);
+static void biquad_design_highshelf(BqCoef* s, float A, float sinw0, float cosw0, float Q) {
+    float alpha = sinw0 / (2.f * Q);
 
     float sqrtA = sqrtf(A);
     float b0 =     A*( (A+1) + (A-1)*cosw0 + 2*sqrtA*alpha );
@@ -111,43 +81,44 @@ static void biquad_design_highshelf(Biquad* s, float fs, float f0, float gain_db
     float a1 =    2*( (A-1) - (A+1)*cosw0 );
     float a2 =         (A+1) - (A-1)*cosw0 - 2*sqrtA*alpha;
 
-    s->t_b0 = b0/a0; s->t_b1 = b1/a0; s->t_b2 = b2/a0;
-    s->t_a1 = a1/a0; s->t_a2 = a2/a0;
-    s->update_pending = 1;
+    s->b0 = b0/a0; s->b1 = b1/a0; s->b2 = b2/a0;
+    s->a1 = a1/a0; s->a2 = a2/a0;
+}
+
+// 按类型设计一段，写入 SoA 系数表的第 band 列
+static void eq_design_band(BqCoefSoA* e, int band, DSP_EQ_TYPE type, float A, float sinw0, float cosw0, float Q) {
+    BqCoef k;
+    switch (type) {
+        case DSP_EQ_LOWSHELF:  biquad_design_lowshelf (&k, A, sinw0, cosw0, Q); break;
+        case DSP_EQ_HIGHSHELF: biquad_design_highshelf(&k, A, sinw0, cosw0, Q); break;
+        default:               biquad_design_peaking  (&k, A, sinw0, cosw0, Q); break;
+    }
+    e->b0[band] = k.b0; e->b1[band] = k.b1; e->b2[band] = k.b2;
+    e->a1[band] = k.a1; e->a2[band] = k.a2;
 }
 
 //======================================================
 // 混响：简化 Schroeder（每声道：4 梳状 + 2 全通），带 pre-delay
-// 为简洁与实时安全，使用 malloc 于 create 阶段，process 不分配
+// 延迟线在 create 时按最坏情况从上下文内存块里切好（预延迟按本实例采样率的 100ms）；
+// 改参数只更新长度/反馈，复位只清零，参数路径上没有任何堆操作。
+// 4 条梳状、两个全通各自首尾相接放在对齐的内存里，整段交给 SIMD 内核（见 dsp_simd.h 的 DspSchroeder）
 //======================================================
-typedef struct {
-    float* buf;
-    int    len;
-    int    idx;
-    float  feedback;
-} Comb;
+#define REVERB_MAX_PREDELAY_MS 100.f
 
 typedef struct {
-    float* buf;
-    int    len;
-    int    idx;
-    float  feedback;
-} Allpass;
-
-typedef struct {
-    // 预延迟
+    // 预延迟（pd_cap 为分配容量，pd_len 为当前长度）
     float* predelay;
+    int    pd_cap;
     int    pd_len;
-    int    pd_w, pd_r;
+    int    pd_pos;    // 读写位置（同一个：先读出 pd_len 个样本以前写进的值，再写入新值）
 
     // 梳状 & 全通
-    Comb   comb[4];
-    Allpass ap[2];
+    DspSchroeder k;
+
+    float  room_size; // 0.2..0.95（决定梳状反馈）；阻尼 0..0.7 直接放在 k.damp
 
-    float  wet;       // 0..1
-    float  room_size; // 0.2..0.9
-    float  damp;      // 0..0.7
-    int    enabled;
+    float* mem;       // 以上所有延迟线共用的一段内存（属于上下文内存块，梳状线在最前面）
+    size_t mem_floats;
 } ReverbChan;
 
 // 便于不同采样率缩放（基于 48k 的典型取值）
@@ -157,311 +128,2143 @@ static int ms_to_samples(float ms, unsigned sr) {
     return n;
 }
 
-static void comb_init(Comb* c, int len, float fb) {
-    c->buf = (float*)calloc((size_t)len, sizeof(float));
-    c->len = len;
-    c->idx = 0;
-    c->feedback = fb;
+static const float k_comb_fb[4] = { 0.77f, 0.80f, 0.84f, 0.88f };
+
+// comb 与 allpass 的长度（基于 48k，做采样率缩放）
+// 典型值（ms）：comb: 29.7, 37.1, 41.1, 43.7; allpass: 5.0, 1.7
+// 长度与房间大小无关，只有反馈随房间变，所以这里就是最终长度
+static void reverb_lengths(ReverbChan* r, unsigned sr) {
+    static const float comb_ms[4] = { 29.7f, 37.1f, 41.1f, 43.7f };
+    static const float ap_ms[2]   = { 5.0f, 1.7f };
+    r->pd_cap = ms_to_samples(REVERB_MAX_PREDELAY_MS, sr);
+    for (int i=0;i<4;i++) r->k.len[i] = (unsigned)ms_to_samples(comb_ms[i] * 48000.f / (float)sr, sr);
+    for (int i=0;i<2;i++) r->k.ap_len[i] = (unsigned)ms_to_samples(ap_ms[i] * 48000.f / (float)sr, sr);
 }
 
-static void allpass_init(Allpass* a, int len, float fb) {
-    a->buf = (float*)calloc((size_t)len, sizeof(float));
-    a->len = len;
-    a->idx = 0;
-    a->feedback = fb;
+// 每通道延迟线总长度（float 个数，取整到缓存行，各通道的梳状线都从缓存行开始）
+static size_t reverb_mem_floats(unsigned sr) {
+    ReverbChan t;
+    reverb_lengths(&t, sr);
+    size_t total = (size_t)t.k.len[0] + t.k.len[1] + t.k.len[2] + t.k.len[3] + (size_t)t.pd_cap + t.k.ap_len[0] + t.k.ap_len[1];
+    const size_t line = DSP_MEM_ALIGN / sizeof(float);
+    return (total + line - 1) / line * line;
 }
 
-static inline float comb_process(Comb* c, float x, float damp) {
-    // simple damp via one-pole lowpass on the feedback
-    float y = c->buf[c->idx];
-    float z = (1.f - damp) * y + damp * 0.f; // 可扩展为对 y 的低通，这里简化
-    float v = x + z * c->feedback;
-    c->buf[c->idx] = v;
-    if (++c->idx >= c->len) c->idx = 0;
-    return y;
+// 只在 create 时调用：把 mem（已清零，reverb_mem_floats 个 float，按缓存行对齐）切给各条延迟线
+static void reverb_carve(ReverbChan* r, unsigned sr, float* mem) {
+    memset(r, 0, sizeof(*r));
+    reverb_lengths(r, sr);
+    r->mem = mem;
+    r->mem_floats = reverb_mem_floats(sr);
+
+    float* p = r->mem;
+    r->k.comb = p;   p += (size_t)r->k.len[0] + r->k.len[1] + r->k.len[2] + r->k.len[3];
+    r->predelay = p; p += r->pd_cap;
+    r->k.ap = p;
+    r->k.ap_fb[0] = r->k.ap_fb[1] = 0.5f;
+    r->pd_len = 1;
 }
 
-static inline float allpass_process(Allpass* a, float x) {
-    float y = a->buf[a->idx];
-    float v = x + (-a->feedback) * y;
-    a->buf[a->idx] = v;
-    float out = y + a->feedback * v;
-    if (++a->idx >= a->len) a->idx = 0;
-    return out;
+// 复位：只清零延迟线与读写位置
+static void reverb_clear(ReverbChan* r) {
+    if (!r->mem) return;
+    memset(r->mem, 0, sizeof(float) * r->mem_floats);
+    r->pd_pos = 0;
+    for (int i=0;i<4;i++) r->k.idx[i] = 0;
+    r->k.ap_idx[0] = r->k.ap_idx[1] = 0;
 }
 
-static void reverb_free(ReverbChan* r) {
-    if (!r) return;
-    free(r->predelay);
-    for (int i=0;i<4;i++) free(r->comb[i].buf);
-    for (int i=0;i<2;i++) free(r->ap[i].buf);
-    memset(r, 0, sizeof(*r));
+// 实时线程在块开头调用：把快照里的混响参数同步到本通道（只改长度/反馈，不碰内存）
+static inline void reverb_apply(ReverbChan* r, float room_size, float damp, int pd_len) {
+    if (r->room_size != room_size) {
+        r->room_size = room_size;
+        for (int i=0;i<4;i++) r->k.fb[i] = k_comb_fb[i] * room_size;
+    }
+    r->k.damp = damp;
+    if (pd_len > r->pd_cap) pd_len = r->pd_cap;
+    if (r->pd_len != pd_len) {
+        // 缩短时绕回即可；缓冲里残留的旧样本就当作延迟线内容继续输出
+        r->pd_len = pd_len;
+        if (r->pd_pos >= pd_len) r->pd_pos = 0;
+    }
 }
 
-static void reverb_init(ReverbChan* r, unsigned sr, float wet, float room_size, float damp, float pre_delay_ms) {
-    memset(r, 0, sizeof(*r));
-    r->wet = clampf(wet, 0.f, 1.f);
-    r->room_size = clampf(room_size, 0.2f, 0.95f);
-    r->damp = clampf(damp, 0.f, 0.7f);
-    r->enabled = 0;
+// 预延迟（Schroeder 与 FDN 共用）：x 的 frames 个样本送进去，延迟后的写到 d（步长都是 lanes）。
+// 按不绕回的段逐样本交换，段内不判断绕回
+static void reverb_predelay(ReverbChan* r, const float* x, float* d, size_t frames, unsigned lanes) {
+    while (frames) {
+        size_t run = (size_t)(r->pd_len - r->pd_pos);
+        if (run > frames) run = frames;
+        float* p = r->predelay + r->pd_pos;
+        for (size_t n=0; n<run; ++n, x += lanes, d += lanes) {
+            const float y = p[n];
+            p[n] = *x;
+            *d = y;
+        }
+        r->pd_pos += (int)run;
+        if (r->pd_pos >= r->pd_len) r->pd_pos = 0;
+        frames -= run;
+    }
+}
 
-    // 预延迟
-    r->pd_len = ms_to_samples(pre_delay_ms, sr);
-    if (r->pd_len < 1) r->pd_len = 1;
-    r->predelay = (float*)calloc((size_t)r->pd_len, sizeof(float));
-    r->pd_w = r->pd_r = 0;
+//======================================================
+// FDN 混响（8 线反馈延迟网络，相邻两个通道共用一个，预延迟仍用各自通道 ReverbChan 的那条）
+//   两路输入按两组互不相同的符号分配到各线，两路输出用两组正交的抽头符号（声道间去相关）；
+//   线长两两不同、取奇数，按通道对略微错开；反馈增益 g = 10^(-3·d / (sr·T60))，
+//   T60 由 room_size 映射（0.2 → 约 0.3s，0.95 → 约 2.7s）；damp 是各线反馈路径上一阶低通的系数，
+//   每绕一圈都过一次低通，高频比低频衰减得快。内核见 dsp_simd.c（dsp_fdn_fn）。
+//   环在 create 时按本实例采样率切好，改参数只重算增益，复位只清零。
+//======================================================
+static const float k_fdn_ms[DSP_FDN_LINES] = { 23.1f, 26.9f, 30.7f, 34.3f, 38.9f, 43.1f, 47.3f, 53.9f };
+#define FDN_CH_SPREAD 8   // 通道对错开的周期：第 k 对的线长乘 1 + 0.019·(k % 8)
 
-    // comb 与 allpass 的长度（基于 48k，做采样率缩放）
-    // 典型值（ms）：comb: 29.7, 37.1, 41.1, 43.7; allpass: 5.0, 1.7
-    int c0 = ms_to_samples(29.7f * 48000.f / (float)sr, sr);
-    int c1 = ms_to_samples(37.1f * 48000.f / (float)sr, sr);
-    int c2 = ms_to_samples(41.1f * 48000.f / (float)sr, sr);
-    int c3 = ms_to_samples(43.7f * 48000.f / (float)sr, sr);
-    int a0 = ms_to_samples(5.0f  * 48000.f / (float)sr, sr);
-    int a1 = ms_to_samples(1.7f  * 48000.f / (float)sr, sr);
+typedef struct {
+    DspFdn k;
+    float  room;   // 当前增益对应的 room_size（< 0：还没算过）
+} FdnChan;
+
+// n 路混响要几个 FDN（通道 2k、2k+1 共用第 k 个）
+static inline unsigned fdn_pairs(unsigned n) { return (n + 1) / 2; }
+
+static void fdn_delays(unsigned sr, unsigned pair, unsigned* d) {
+    const float spread = 1.f + 0.019f * (float)(pair % FDN_CH_SPREAD);
+    for (int i=0;i<DSP_FDN_LINES;i++) {
+        unsigned n = (unsigned)ms_to_samples(k_fdn_ms[i] * spread, sr) | 1u;
+        if (i && n <= d[i-1]) n = d[i-1] + 2;
+        d[i] = n;
+    }
+}
 
-    comb_init(&r->comb[0], c0, 0.77f * r->room_size);
-    comb_init(&r->comb[1], c1, 0.80f * r->room_size);
-    comb_init(&r->comb[2], c2, 0.84f * r->room_size);
-    comb_init(&r->comb[3], c3, 0.88f * r->room_size);
+// 环的行数：2 的幂，大于所有通道对里最长的线
+static unsigned fdn_rows(unsigned sr) {
+    unsigned d[DSP_FDN_LINES];
+    fdn_delays(sr, FDN_CH_SPREAD - 1, d);
+    unsigned rows = 1;
+    while (rows <= d[DSP_FDN_LINES - 1]) rows <<= 1;
+    return rows;
+}
 
-    allpass_init(&r->ap[0], a0, 0.5f);
-    allpass_init(&r->ap[1], a1, 0.5f);
+static size_t fdn_mem_floats(unsigned sr) {
+    return (size_t)fdn_rows(sr) * DSP_FDN_LINES;
 }
 
-static inline float reverb_process_sample(ReverbChan* r, float x) {
-    // 预延迟
-    float pd_out = r->predelay[r->pd_r];
-    r->predelay[r->pd_w] = x;
-    if (++r->pd_w >= r->pd_len) r->pd_w = 0;
-    if (++r->pd_r >= r->pd_len) r->pd_r = 0;
+// 只在 create 时调用：mem 已清零，fdn_mem_floats 个 float，按缓存行对齐
+static void fdn_carve(FdnChan* f, unsigned sr, unsigned pair, float* mem) {
+    memset(f, 0, sizeof(*f));
+    f->k.ring = mem;
+    f->k.mask = fdn_rows(sr) - 1;
+    fdn_delays(sr, pair, f->k.delay);
+    for (int i=0;i<DSP_FDN_LINES;i++) {
+        f->k.in_gain[0][i]  = (i & 1) ? -0.35355339f : 0.35355339f;                  // ±1/√8
+        f->k.in_gain[1][i]  = (i & 4) ? -0.35355339f : 0.35355339f;
+        f->k.out_gain[0][i] = (i & 2) ? -0.35355339f : 0.35355339f;                  // 两路的符号序列正交
+        f->k.out_gain[1][i] = (((unsigned)i + 1) & 2) ? -0.35355339f : 0.35355339f;
+    }
+    f->room = -1.f;
+}
 
-    // 四个梳状求和
-    float s = 0.f;
-    for (int i=0;i<4;i++) s += comb_process(&r->comb[i], pd_out, r->damp);
-    s *= 0.25f;
+static void fdn_clear(FdnChan* f) {
+    memset(f->k.ring, 0, sizeof(float) * ((size_t)f->k.mask + 1) * DSP_FDN_LINES);
+    memset(f->k.lp, 0, sizeof(f->k.lp));
+    f->k.pos = 0;
+}
 
-    // 两个全通
-    s = allpass_process(&r->ap[0], s);
-    s = allpass_process(&r->ap[1], s);
-    return s;
+// 实时线程在块开头调用：room_size 变了才重算 8 个增益
+static inline void fdn_apply(FdnChan* f, float room_size, float damp, unsigned sr) {
+    f->k.damp = damp;
+    if (f->room == room_size) return;
+    f->room = room_size;
+    const float t60 = 0.2f + 2.8f * room_size * room_size;
+    const float k = -3.f * 3.32192809f / ((float)sr * t60);   // log2(10^-3) / (sr·T60)
+    for (int i=0;i<DSP_FDN_LINES;i++)
+        f->k.g[i] = dsp_fast_exp2f(k * (float)f->k.delay[i]) * 0.35355339f;   // Hadamard 的 1/√8 一起乘进去
 }
 
 //======================================================
-// 总上下文
+// 前瞻限幅器（砖墙，所有通道联动同一个增益）
+//   检测：每帧取各通道 |x| 的最大值；开真峰值时再用 4 倍过采样插值器估计样本之间的峰值
+//   需求增益：r = min(1, thr / 窗口峰值)，窗口 = 前瞻 L 帧 + 当前帧，单调队列求滑动最大值（每样本均摊 O(1)）
+//   释放：需求更低时立即跟上，回升走一阶指数
+//   平滑：对释放后的增益再做 L+1 点滑动平均 —— 峰值前 L 帧开始下压，到峰值那一帧正好压到 r
+//   音频延迟 L 帧（真峰值再加插值器的 DSP_TP_DELAY 帧）后乘增益；低于阈值的信号原样输出，只是延迟
+// 延迟线/队列/平均环按本实例采样率的最大前瞻在 create 时切好，改前瞻或重新启用时只清零
 //======================================================
+#define DSP_LIMITER_MAX_LOOKAHEAD_MS 10.f
+#define DSP_TP_TAPS   8                    // 插值器每相抽头数
+#define DSP_TP_DELAY  (DSP_TP_TAPS / 2)    // 插值器引入的检测延迟（帧）
+
 typedef struct {
+    float*    delay;        // 音频延迟线 [cap][lanes]
+    unsigned  cap;          // 延迟线容量（帧）= 最大前瞻 + DSP_TP_DELAY + 1
+    unsigned  wpos;
+    float*    dq_val;       // 单调队列（环形，容量 win_cap）：窗口内的峰值，从头到尾严格递减
+    uint32_t* dq_t;         // 对应的检测帧序号
+    unsigned  win_cap;      // 最大窗口长度 = 最大前瞻 + 1
+    unsigned  dq_head, dq_n;
+    float*    box;          // 滑动平均环 [win_cap]
+    unsigned  box_pos;
+    double    box_sum;
+    float     env;          // 释放后的增益
+    uint32_t  t;            // 检测帧序号
+    float*    tp_hist;      // 真峰值插值器历史 [ch][2*DSP_TP_TAPS]（双写，窗口总是连续的）
+    unsigned  tp_pos;
+    float     tp_prev;      // 上一个样本区间里的插值峰值
+    float     tp_k[3][DSP_TP_TAPS];
+    int       L;            // 当前前瞻（帧）
+    int       tp;           // 当前是否检测真峰值
+    int       live;         // 0：下一次运行前先清状态（刚启用 / dsp_reset / 前瞻变了）
+} DspLimiter;
+
+// 4 倍过采样插值器的 1/4、2/4、3/4 相（Blackman 窗 sinc，每相归一化到直流增益 1）
+static void tp_design(float k[3][DSP_TP_TAPS]) {
+    for (int p=1;p<=3;p++) {
+        double h[DSP_TP_TAPS], sum = 0.0;
+        for (int j=0;j<DSP_TP_TAPS;j++) {
+            // 抽头 j 对应样本 x[n0-3+j]，插值点在 n0+p/4
+            const double t = (double)(j - (DSP_TP_DELAY - 1)) - (double)p * 0.25;
+            const double s = sin(M_PI * t) / (M_PI * t);   // t 不会是整数
+            const double u = t / (double)DSP_TP_DELAY;      // -1..1
+            h[j] = s * (0.42 + 0.5 * cos(M_PI * u) + 0.08 * cos(2.0 * M_PI * u));
+            sum += h[j];
+        }
+        for (int j=0;j<DSP_TP_TAPS;j++) k[p-1][j] = (float)(h[j] / sum);
+    }
+}
+
+static unsigned limiter_max_lookahead(unsigned sr) {
+    return (unsigned)ms_to_samples(DSP_LIMITER_MAX_LOOKAHEAD_MS, sr);
+}
+
+// 每实例需要的 float 个数（延迟线 + 平均环 + 插值历史）与队列序号个数
+static size_t limiter_floats(unsigned sr, unsigned ch, unsigned lanes) {
+    const size_t maxL = limiter_max_lookahead(sr);
+    return (maxL + DSP_TP_DELAY + 1) * lanes + 2 * (maxL + 1) + (size_t)ch * 2 * DSP_TP_TAPS;
+}
+
+static void limiter_carve(DspLimiter* m, unsigned sr, unsigned ch, unsigned lanes, float* mem, uint32_t* idx) {
+    memset(m, 0, sizeof(*m));
+    const unsigned maxL = limiter_max_lookahead(sr);
+    m->cap     = maxL + DSP_TP_DELAY + 1;
+    m->win_cap = maxL + 1;
+    m->delay   = mem;  mem += (size_t)m->cap * lanes;
+    m->dq_val  = mem;  mem += m->win_cap;
+    m->box     = mem;  mem += m->win_cap;
+    m->tp_hist = mem;  (void)ch;
+    m->dq_t    = idx;
+    tp_design(m->tp_k);
+}
+
+// 清状态并换到新的前瞻：延迟线清零，增益从 1 开始
+static void limiter_reset(DspLimiter* m, unsigned ch, unsigned lanes, int L, int tp) {
+    memset(m->delay, 0, sizeof(float) * m->cap * lanes);
+    memset(m->tp_hist, 0, sizeof(float) * ch * 2 * DSP_TP_TAPS);
+    m->wpos = 0;
+    m->dq_head = m->dq_n = 0;
+    for (int i=0;i<=L;i++) m->box[i] = 1.f;
+    m->box_pos = 0;
+    m->box_sum = (double)(L + 1);
+    m->env = 1.f;
+    m->t = 0;
+    m->tp_pos = 0;
+    m->tp_prev = 0.f;
+    m->L = L;
+    m->tp = tp;
+    m->live = 1;
+}
+
+// 真峰值检测：写入一帧，返回 DSP_TP_DELAY 帧之前那个样本与它两侧区间插值点的峰值（各通道取最大）
+static inline float limiter_tp_detect(DspLimiter* m, const float* x, unsigned ch) {
+    const unsigned pos = m->tp_pos;
+    float smp = 0.f, inter = 0.f;
+    for (unsigned cc=0; cc<ch; ++cc) {
+        float* h = m->tp_hist + (size_t)cc * 2 * DSP_TP_TAPS;
+        h[pos] = h[pos + DSP_TP_TAPS] = x[cc];
+        const float* v = h + pos + 1;    // 最旧 → 最新：v[DSP_TP_TAPS-1] 是刚写入的样本
+        const float a = fabsf(v[DSP_TP_DELAY - 1]);
+        if (a > smp) smp = a;
+        for (int p=0;p<3;p++) {
+            float s = 0.f;
+            for (int j=0;j<DSP_TP_TAPS;j++) s += m->tp_k[p][j] * v[j];
+            s = fabsf(s);
+            if (s > inter) inter = s;
+        }
+    }
+    m->tp_pos = (pos + 1) % DSP_TP_TAPS;
+    float pk = smp > inter ? smp : inter;
+    if (m->tp_prev > pk) pk = m->tp_prev;    // 样本前面那个区间也算在这个样本上
+    m->tp_prev = inter;
+    return pk;
+}
+
+//======================================================
+// 级表：发布时按处理顺序编译好（见 prog_compile），实时线程每块只按运行条件挑出要跑的项
+//======================================================
+struct DSP_CTX;
+struct DspParamSet;
+typedef void (*dsp_stage_fn)(struct DSP_CTX* c, const struct DspParamSet* p, float* buf, size_t frames);
+
+#define DSP_MAX_STAGES DSP_STAGE_COUNT
+
+// 运行条件（位）：一项要求的条件本块都满足才跑；0 = 总是跑
+#define DSP_NEED_GAIN_RAMP 1u   // 增益斜坡在跑（目标增益为 1 时）
+#define DSP_NEED_UNFOLDED  2u   // 增益没有折进 EQ（增益或 EQ 斜坡在跑）
+#define DSP_NEED_EQ_RAMP   4u   // EQ 斜坡在跑（没有要跑的段时）
+#define DSP_NEED_WET_RAMP  8u   // 湿度斜坡在跑（混响关闭时淡出）
+#define DSP_NEED_CONV      16u  // 实时线程手上有卷积 IR
+#define DSP_NEED_RVIR      32u  // 实时线程手上有混响 IR
+
+#define DSP_DRAIN_CONV     1u   // 进入旁路时放完卷积的延迟
+#define DSP_DRAIN_LIMITER  2u   // 进入旁路时放完前瞻限幅器的延迟
+
+typedef struct {
+    dsp_stage_fn  fn;     // 已按参数选好的实现（混响路由/算法、限幅模式）；状态在上下文内存块里的固定位置
+    unsigned char id;     // DSP_STAGE_*
+    unsigned char need;   // DSP_NEED_*
+} DspOp;
+
+//======================================================
+// 参数快照：三缓冲（控制线程发布，实时线程每块取一次）
+// 写者独占 back 槽、读者独占 front 槽，中间槽的下标和“有新数据”标志放在同一个原子变量里，
+// 双方只靠一次原子交换换槽，因此实时线程拿到的永远是某一次发布的完整参数，不会半新半旧。
+//======================================================
+typedef struct DspParamSet {
+    BqCoefSoA     eqk;                    // EQ 系数（SoA，所有通道共享）
+    BqCoefSoA     eqf;                    // 同 eqk，但第一个要跑的段的 b0/b1/b2 乘上了 gain（gain_fold 时用）
+    unsigned char eqActive[MY_EQ_BANDS];  // 要跑的段（按串联顺序）：启用且不是恒等的段
+    unsigned      nEq;
+    float gain;
+    int   gain_fold;                      // 有要跑的 EQ 段且 gain != 1：增益折进第一段，静态时不单独跑增益级
+    int   reverb_enabled;
+    float reverb_wet;
+    float reverb_room;
+    float reverb_damp;
+    int   reverb_pd_len;                  // 预延迟样本数（已按容量限制）
+    int   reverb_type;                    // DSP_REVERB_TYPE（IR 本身不在快照里，见 DSP_CTX::rvir）
+    int   reverb_bus;                     // DSP_REVERB_ROUTING
+    float rv_send[DSP_REVERB_MAX_SENDS];  // 每通道发送 / 返回电平
+    float rv_return[DSP_REVERB_MAX_SENDS];
+    int   limiter_enabled;
+    int   limiter_mode;                   // DSP_LIMITER_MODE
+    float lim_threshold;                  // 线性
+    int   lim_lookahead;                  // 前瞻帧数（已按容量限制）
+    int   lim_true_peak;
+    float lim_release;                    // 释放的一阶系数（每样本）
+    int   conv_enabled;                   // 卷积级开关（IR 本身不在快照里，见 DSP_CTX::conv）
+    int   ramp_len;                       // 参数平滑时长（样本数，0 = 直接跳变）
+    int   identity;                       // 发布时判定：整条链在数学上是恒等（卷积另在实时线程看有没有 IR）
+    DspOp    prog[DSP_MAX_STAGES];        // 按处理顺序编译好的级表（只有启用的级）
+    unsigned nProg;
+} DspParamSet;
+
+#define DSP_TB_DIRTY 4
+
+// 每个快照槽按缓存行取整：写者填 back 槽时不会碰到读者正在用的 front 槽所在的行
+#define DSP_SLOT_STRIDE ((sizeof(DspParamSet) + DSP_MEM_ALIGN - 1) & ~(size_t)(DSP_MEM_ALIGN - 1))
+#define DSP_SLOT_EVENT  3   // 第 4 个槽：实时线程私有，存放最近一次生效的定时事件参数
+
+//======================================================
+// 定时参数事件：单生产者（设置线程，持 ctl_lock）/ 单消费者（实时线程）环形队列
+// 每个事件带一份完整参数快照（EQ 系数已在控制线程算好），按流位置（帧）升序排队；
+// 实时线程在事件所在帧把块切开，从那一帧起换用事件里的参数。
+//======================================================
+#define DSP_EVENT_QUEUE 16   // 2 的幂
+
+typedef struct {
+    uint64_t    frame;   // 生效的流位置（帧，自创建以来）
+    DspParamSet set;
+} DspEvent;
+
+#define DSP_EVENT_STRIDE ((sizeof(DspEvent) + DSP_MEM_ALIGN - 1) & ~(size_t)(DSP_MEM_ALIGN - 1))
+
+//======================================================
+// 控制侧状态（仅设置函数读写，ctl_lock 串行化多个设置线程）
+// 单独占缓存行，设置线程写这里不会让实时线程的热数据失效
+//======================================================
+typedef struct {
+    dsp_atomic_t ctl_lock;
+    int          back;                // 三缓冲写者槽
+    int          batch;               // dsp_begin_update 嵌套深度：>0 时设置函数只改副本不发布
+    unsigned long ev_wr;              // 事件队列写位置（控制侧私有副本）
+    uint64_t     ev_last;             // 最后一个排队事件的帧位置（保证队列按时间升序）
+    DspParamSet  ctl;                 // 下一次要发布的完整参数
+
+    // 12 段 EQ（每通道串联；默认 0=低搁架 / 1=峰值 / 2=高搁架 / 3..11=峰值）
+    float eq_freq[MY_EQ_BANDS];
+    float eq_q[MY_EQ_BANDS];
+    float eq_gain_db[MY_EQ_BANDS];
+    int   eq_type[MY_EQ_BANDS];
+    int   eq_enabled[MY_EQ_BANDS];
+
+    unsigned char order[DSP_STAGE_COUNT]; // 处理顺序（DSP_STAGE_* 的一个排列，见 dsp_set_program）
+
+    float reverb_pre_ms;
+    unsigned conv_partition;          // 最近一次载入的 IR 的分块长度（= 卷积级延迟；0 = 没有 IR）
+    unsigned eq_dirty;                // 参数改过、发布前要重新设计系数的段（位掩码）
+} DspControl;
+
+//======================================================
+// 运行统计（实时线程独写；dsp_get_stats 在别的线程只读）
+//======================================================
+typedef struct {
+    uint64_t blocks;
+    uint64_t frames;
+    DSP_STAGE_STATS stage[DSP_STAGE_COUNT];
+    uint64_t eq_band_runs;
+    uint64_t block_ticks;
+    uint64_t block_max_ticks;
+    uint64_t block_hist[DSP_STATS_HIST_BUCKETS];
+    uint64_t reverb_tail_waits;
+    uint64_t tail_blocks;
+    uint64_t idle_blocks;
+    uint64_t bypass_blocks;
+} DspStatsAcc;
+
+//======================================================
+// 参数平滑（实时线程私有）：立即发布的参数不再跳变，而是在 ramp_len 个样本内过渡
+//   增益 / 混响湿度：线性斜坡，每个子块用 SIMD 内核生成一整段斜坡向量再乘上去；
+//   EQ：控制率插值，每 DSP_COEF_STEP 个样本在新旧系数之间线性插值一次
+//       （二阶段稳定区域 |a2|<1, |a1|<1+a2 是凸集，两组稳定系数之间的插值仍然稳定）；
+//   没有斜坡在跑时各级走原来的常量路径，只多一次比较。
+// 首块之前 / dsp_reset 之后 / 定时事件（帧精确）不平滑，直接跳到目标。
+//======================================================
+#define DSP_DEFAULT_SMOOTH_MS 10.f
+#define DSP_MAX_SMOOTH_MS     100.f
+#define DSP_COEF_STEP         32     // EQ 系数插值间隔（样本）
+#define DSP_MAX_GAIN          16.f   // 线性增益上限（+24 dB）
+
+typedef struct {
+    float start, step, target;
+    int   pos, len;                 // pos >= len：不在斜坡中，值就是 target
+} DspRamp;
+
+typedef struct {
+    BqCoefSoA cur;                  // 正在使用的系数（斜坡中为插值结果）
+    BqCoefSoA from, to;             // 斜坡两端；不在对应启用集合里的段为直通系数
+    unsigned  mask;                 // 正在发声的段（斜坡中为新旧并集）
+    unsigned  target_mask;          // 斜坡结束后的启用段
+    unsigned char active[MY_EQ_BANDS];
+    unsigned  nActive;
+    int       pos, len;
+} DspEqRamp;
+
+static inline int ramp_active(const DspRamp* r) { return r->pos < r->len; }
+
+// 最近一个输出样本的值
+static inline float ramp_value(const DspRamp* r) {
+    return ramp_active(r) ? r->start + r->step * (float)r->pos : r->target;
+}
+
+static void ramp_to(DspRamp* r, float target, int len, int snap) {
+    if (snap || len <= 0) {
+        r->start = r->target = target;
+        r->step = 0.f;
+        r->pos = r->len = 0;
+        return;
+    }
+    if (target == r->target) return;   // 已经在去往（或停在）这个值的路上
+    const float cur = ramp_value(r);
+    r->start  = cur;
+    r->target = target;
+    r->step   = (target - cur) / (float)len;
+    r->pos = 0;
+    r->len = len;
+}
+
+//======================================================
+// 总上下文（实时线程的热数据；整个实例只有一块对齐内存，见下面的布局）
+//======================================================
+typedef struct DSP_CTX {
     unsigned sr;
     unsigned ch;
 
-    // 参数（非实时写，实时读需要近似无锁）
-    volatile float gain;
-
-    // 3 段 EQ（每通道串联：低搁架 / 峰值 / 高搁架）
-    Biquad* eqBands[3];   // [band] 指向长度为 ch 的数组
-    volatile float eq_freq[3];
-    volatile float eq_q[3];
-    volatile float eq_gain_db[3];
-    volatile int   eq_enabled[3];
+    // 工作区 lane 数（通道数向上取整到 4）与 lane 化工作缓冲 [DSP_SUBBLOCK][lanes]
+    unsigned lanes;
+    float*   work;
+
+    // SIMD 内核（创建时按 CPU 选择）
+    DSP_SIMD_LEVEL   simd;
+    dsp_bq_cascade_fn bq_cascade;
+    dsp_ramp_fill_fn  ramp_fill;
+    dsp_ramp_mul_fn   ramp_mul;
+    dsp_spec_mac_fn   spec_mac;
+    dsp_fdn_fn        fdn_run;
+    dsp_schroeder_fn  schroeder;
+    dsp_is_quiet_fn   is_quiet;
+    const DspVecMath* vmath;        // 数组版快速数学函数（softclip 与控制线程的批量系数设计共用）
+
+    // 参数平滑（实时线程私有）
+    float*    ramp;         // [DSP_SUBBLOCK] 斜坡向量
+    DspRamp   gain_r;
+    DspRamp   wet_r;        // 目标 = 启用 ? reverb_wet : 0（开关混响也是淡入淡出）
+    DspEqRamp eq_r;
+    int       snap;         // 下一次换参数直接跳到目标（首块之前 / dsp_reset 之后）
+
+    // 12 段 EQ 的滤波器状态（系数在参数快照里）
+    EqCascade eq;
+    int       fold;         // 本段级表里增益折进了 EQ：fold_band 的输入历史（x1/x2）是未乘增益的输入
+    int       fold_band;
+    float     fold_g;
 
     // 混响
-    ReverbChan* reverb; // 每通道一个
-    volatile int   reverb_enabled;
-    volatile float reverb_wet;
-    volatile float reverb_room;
-    volatile float reverb_damp;
-    volatile float reverb_pre_ms;
+    ReverbChan* reverb; // 每通道一个（只有总线时 nrev 个）
+    FdnChan*    fdn;    // 相邻两个通道一个，共 ⌈nrev/2⌉ 个（FDN 模式）
+    unsigned    nrev;   // 分配了几路混响状态：ch，或 DSP_CREATE_REVERB_BUS_ONLY 时的总线路数
+    int         rv_bus; // 最近一块走的是否发送总线（刚切到总线时清掉闲下来的各路状态）
+    float*      rvin;   // [DSP_SUBBLOCK][lanes] 总线输入（只用前 1~2 个 lane，其余始终为 0）
+
+    // IR 混响（非均匀分块卷积）：交接方式同下面的卷积级
+    DspNuConv*        rvir;         // 实时线程正在用的（NULL = 没有 IR）
+    int               rvir_live;    // 0：下一次运行前先清状态（刚启用 / 刚切到 IR 模式 / dsp_reset）
+    dsp_atomic_ptr_t* rvir_pending;
+    dsp_atomic_ptr_t* rvir_retired;
+    float*            rvbuf;        // [DSP_SUBBLOCK][lanes] IR 混响的湿声
+
+    // 前瞻限幅器
+    DspLimiter lim;
+
+    // 卷积（房间校正 FIR）：IR 对象在控制线程建好后经 conv_pending 交给实时线程，
+    // 换下来的旧对象经 conv_retired 交回控制线程释放（实时线程上没有分配/释放）
+    DspConv*          conv;         // 实时线程正在用的（NULL = 没有 IR）
+    int               conv_live;    // 0：下一次运行前先清状态（刚启用 / dsp_reset）
+    dsp_atomic_ptr_t* conv_pending; // 控制线程写入新对象（DSP_CONV_NONE = 卸载），实时线程取走
+    dsp_atomic_ptr_t* conv_retired; // 实时线程放回换下来的对象，控制线程取走释放
+
+    // 参数快照（实时线程只从这里读参数）
+    unsigned char* slots;   // 3 个三缓冲槽 + 1 个事件槽，间距 DSP_SLOT_STRIDE
+    dsp_atomic_t*  tb_mid;  // 中间槽下标 | DSP_TB_DIRTY（与 stats_reset、事件队列下标同占一行，两边都会写）
+    int            front;   // 三缓冲读者槽
+    const DspParamSet* params;   // 当前生效的参数：front 槽或事件槽
+
+    // 定时事件
+    unsigned char* events;       // DSP_EVENT_QUEUE 个事件，间距 DSP_EVENT_STRIDE
+    dsp_atomic_t*  ev_write;     // 控制线程写
+    dsp_atomic_t*  ev_read;      // 实时线程写
+    unsigned long  ev_rd;        // 读位置（实时线程私有副本）
+    volatile uint64_t frame_pos; // 流位置：已处理的帧数（仅实时线程写）
+
+    // 静音跳过（实时线程私有）
+    uint64_t quiet_in;      // 输入连续静音的帧数
+    uint64_t quiet_out;     // 输入静音以来输出连续安静的帧数
+    int      idle;          // 1：尾音已放完、各级状态已清空，静音块直接输出 0
+
+    // 恒等旁路（实时线程私有）
+    int      bypass;        // 1：整块直通（就地时什么也不做），各级状态已清空
+    float    byp_dry;       // 旁路淡化中干声的权重（退出 1 → 0，进入 0 → 1）
+    float    byp_step;      // 每帧的变化（退出 <0，进入 >0），0 = 不在淡化
+    unsigned byp_hold;      // 淡化前先等处理链填满/放完延迟（帧），这期间干声权重不变
+    unsigned byp_drain;     // 进入旁路的淡化中接着跑的级（DSP_DRAIN_*），0 = 不在进入
+
+    DspStatsAcc*   stats;
+    dsp_atomic_t*  stats_reset;   // 控制线程置 1，实时线程在块开头清零统计
+
+    DspControl*    ctrl;    // 控制侧状态
+    size_t         arena_bytes;
+} DSP_CTX;
 
-    // 软限幅器
-    volatile int   limiter_enabled;
+//======================================================
+// 内存布局：一次分配，按缓存行对齐切成各区
+//   [DSP_CTX 热数据][tb_mid + stats_reset + 事件下标][DspControl][统计][快照槽 ×4][事件 ×16][工作区][斜坡向量]
+//   [EQ 状态][ReverbChan ×nrev][混响延迟线 ×nrev][FdnChan ×⌈nrev/2⌉][FDN 环 ×⌈nrev/2⌉][混响湿声][总线输入][限幅器延迟线/平均环][限幅器队列序号]
+// nrev = 通道数；DSP_CREATE_REVERB_BUS_ONLY 时只有总线的 1~2 路
+// 卷积 IR / 混响 IR 的大小取决于载入的 IR，不在这块内存里（见 dsp_set_conv_ir / dsp_set_reverb_ir）
+//======================================================
+typedef struct {
+    size_t off_mid, off_ctrl, off_stats, off_slots, off_events, off_work, off_ramp, off_eq, off_rev, off_revmem, off_rvbuf, off_rvin;
+    size_t off_fdn, off_fdnmem;
+    size_t off_lim, off_limidx;
+    size_t revmem_floats;   // 每通道
+    size_t fdnmem_floats;   // 每个通道对（行数为 2 的幂，每个起点都在缓存行上）
+    size_t total;
+} DspLayout;
+
+static size_t layout_take(size_t* cursor, size_t bytes) {
+    size_t off = *cursor;
+    *cursor = (off + bytes + DSP_MEM_ALIGN - 1) & ~(size_t)(DSP_MEM_ALIGN - 1);
+    return off;
+}
 
-} DSP_CTX;
+static void dsp_layout(unsigned sr, unsigned ch, unsigned nrev, DspLayout* L) {
+    const unsigned lanes = dsp_round_lanes(ch);
+    size_t cur = 0;
+    layout_take(&cur, sizeof(DSP_CTX));
+    L->off_mid    = layout_take(&cur, sizeof(dsp_atomic_t) * 4 + sizeof(dsp_atomic_ptr_t) * 4);
+    L->off_ctrl   = layout_take(&cur, sizeof(DspControl));
+    L->off_stats  = layout_take(&cur, sizeof(DspStatsAcc));
+    L->off_slots  = layout_take(&cur, DSP_SLOT_STRIDE * 4);
+    L->off_events = layout_take(&cur, DSP_EVENT_STRIDE * DSP_EVENT_QUEUE);
+    L->off_work   = layout_take(&cur, sizeof(float) * DSP_SUBBLOCK * lanes);
+    L->off_ramp   = layout_take(&cur, sizeof(float) * DSP_SUBBLOCK);
+    L->off_eq     = layout_take(&cur, eq_state_bytes(lanes));
+    L->off_rev    = layout_take(&cur, sizeof(ReverbChan) * nrev);
+    L->revmem_floats = reverb_mem_floats(sr);
+    L->off_revmem = layout_take(&cur, sizeof(float) * L->revmem_floats * nrev);
+    L->off_fdn    = layout_take(&cur, sizeof(FdnChan) * fdn_pairs(nrev));
+    L->fdnmem_floats = fdn_mem_floats(sr);
+    L->off_fdnmem = layout_take(&cur, sizeof(float) * L->fdnmem_floats * fdn_pairs(nrev));
+    L->off_rvbuf  = layout_take(&cur, sizeof(float) * DSP_SUBBLOCK * lanes);
+    L->off_rvin   = layout_take(&cur, sizeof(float) * DSP_SUBBLOCK * lanes);
+    L->off_lim    = layout_take(&cur, sizeof(float) * limiter_floats(sr, ch, lanes));
+    L->off_limidx = layout_take(&cur, sizeof(uint32_t) * (limiter_max_lookahead(sr) + 1));
+    L->total = cur;
+}
+
+static DspParamSet* tb_slot(DSP_CTX* c, int i) {
+    return (DspParamSet*)(c->slots + (size_t)i * DSP_SLOT_STRIDE);
+}
+
+// 写者：填好 back 槽后与中间槽交换，并打上“有新数据”标志
+static void tb_publish(DSP_CTX* c, const DspParamSet* p) {
+    DspControl* k = c->ctrl;
+    *tb_slot(c, k->back) = *p;
+    long old = dsp_atomic_xchg(c->tb_mid, k->back | DSP_TB_DIRTY);
+    k->back = (int)(old & 3);
+}
+
+// 读者：有新数据时与中间槽交换并换用新参数；否则继续用当前参数（可能是上一个定时事件的）
+static const DspParamSet* tb_acquire(DSP_CTX* c) {
+    if (dsp_atomic_load(c->tb_mid) & DSP_TB_DIRTY) {
+        long old = dsp_atomic_xchg(c->tb_mid, c->front);
+        c->front = (int)(old & 3);
+        c->params = tb_slot(c, c->front);
+    }
+    return c->params;
+}
+
+static void smooth_retarget(DSP_CTX* c, const DspParamSet* P, int snap);
+
+static DspEvent* ev_slot(DSP_CTX* c, unsigned long i) {
+    return (DspEvent*)(c->events + (size_t)(i & (DSP_EVENT_QUEUE - 1)) * DSP_EVENT_STRIDE);
+}
+
+// 写者（持 ctl_lock）：把控制侧副本排到 frame 处；队列满返回 0
+static int ev_push(DSP_CTX* c, uint64_t frame) {
+    DspControl* k = c->ctrl;
+    const unsigned long r = (unsigned long)dsp_atomic_load(c->ev_read);
+    if (k->ev_wr - r >= DSP_EVENT_QUEUE) return 0;
+    if (frame < k->ev_last) frame = k->ev_last;   // 比已排队的更早：跟在最后一个后面
+    DspEvent* e = ev_slot(c, k->ev_wr);
+    e->frame = frame;
+    e->set   = k->ctl;
+    k->ev_wr++;
+    k->ev_last = frame;
+    dsp_atomic_store(c->ev_write, (long)k->ev_wr);
+    return 1;
+}
+
+// 读者：应用所有 frame <= pos 的事件，返回下一个未到时事件的帧位置（没有则 UINT64_MAX）
+static uint64_t ev_apply_due(DSP_CTX* c, uint64_t pos) {
+    const unsigned long w = (unsigned long)dsp_atomic_load(c->ev_write);
+    while (c->ev_rd != w) {
+        const DspEvent* e = ev_slot(c, c->ev_rd);
+        if (e->frame > pos) return e->frame;
+        DspParamSet* cur = tb_slot(c, DSP_SLOT_EVENT);
+        *cur = e->set;        // 拷出来再归还槽位，写者随后可以复用
+        c->params = cur;
+        smooth_retarget(c, cur, 1);   // 定时事件要求帧精确：不平滑
+        c->ev_rd++;
+        dsp_atomic_store(c->ev_read, (long)c->ev_rd);
+    }
+    return UINT64_MAX;
+}
+
+//======================================================
+// 参数平滑：换参数时设定各斜坡的目标
+//======================================================
+static unsigned eq_mask_of(const DspParamSet* P) {
+    unsigned m = 0;
+    for (unsigned i=0;i<P->nEq;i++) m |= 1u << P->eqActive[i];
+    return m;
+}
+
+static void eq_set_identity(BqCoefSoA* k, int b) {
+    k->b0[b] = 1.f; k->b1[b] = 0.f; k->b2[b] = 0.f; k->a1[b] = 0.f; k->a2[b] = 0.f;
+}
+
+static int eq_band_equal(const BqCoefSoA* x, const BqCoefSoA* y, int b) {
+    return x->b0[b] == y->b0[b] && x->b1[b] == y->b1[b] && x->b2[b] == y->b2[b] &&
+           x->a1[b] == y->a1[b] && x->a2[b] == y->a2[b];
+}
+
+static void eq_ramp_to(DSP_CTX* c, const DspParamSet* P, int snap) {
+    DspEqRamp* r = &c->eq_r;
+    const unsigned newMask = eq_mask_of(P);
+    const int len = P->ramp_len;
+    if (snap || len <= 0) {
+        r->cur = P->eqk;
+        r->mask = r->target_mask = newMask;
+        r->pos = r->len = 0;
+        return;
+    }
+    if (r->pos >= r->len && newMask == r->mask) {
+        int same = 1;
+        for (int b=0;b<MY_EQ_BANDS && same;b++) if ((newMask >> b) & 1) same = eq_band_equal(&r->cur, &P->eqk, b);
+        if (same) { r->cur = P->eqk; return; }   // EQ 没变（只改了别的参数）
+    }
+    // 从当前实际在用的系数出发；新加入的段从直通开始，退出的段过渡到直通
+    const unsigned uni = r->mask | newMask;
+    r->from = r->cur;
+    r->to   = P->eqk;
+    r->nActive = 0;
+    for (int b=0;b<MY_EQ_BANDS;b++) {
+        if (!((r->mask >> b) & 1)) {
+            eq_set_identity(&r->from, b);
+            eq_set_identity(&r->cur, b);
+            if ((newMask >> b) & 1) memset(c->eq.state + (size_t)b * DSP_BQ_STATE_FLOATS(c->lanes), 0,
+                                           sizeof(float) * DSP_BQ_STATE_FLOATS(c->lanes));   // 历史状态已过时
+        }
+        if (!((newMask >> b) & 1)) eq_set_identity(&r->to, b);
+        if ((uni >> b) & 1) r->active[r->nActive++] = (unsigned char)b;
+    }
+    r->mask = uni;
+    r->target_mask = newMask;
+    r->pos = 0;
+    r->len = len;
+}
+
+// 换参数：snap=1 时直接跳到目标
+static void smooth_retarget(DSP_CTX* c, const DspParamSet* P, int snap) {
+    ramp_to(&c->gain_r, P->gain, P->ramp_len, snap);
+    ramp_to(&c->wet_r, P->reverb_enabled ? P->reverb_wet : 0.f, P->ramp_len, snap);
+    eq_ramp_to(c, P, snap);
+}
+
+// 设置函数统一用法：ctl_begin → 改 k->ctl / 控制侧字段 → ctl_commit（发布一次完整快照）
+static DspControl* ctl_begin(DSP_CTX* c) {
+    dsp_spin_lock(&c->ctrl->ctl_lock);
+    return c->ctrl;
+}
+
+// 批量设计 mask 里的各段：sin/cos(w0) 与 10^(dB/20) 用数组函数一次算完，再逐段套公式
+static void eq_design_bands(DSP_CTX* c, unsigned mask) {
+    DspControl* k = c->ctrl;
+    float w0[MY_EQ_BANDS], g[MY_EQ_BANDS], sn[MY_EQ_BANDS], cs[MY_EQ_BANDS], A[MY_EQ_BANDS];
+    int band[MY_EQ_BANDS];
+    size_t n = 0;
+    for (int b=0;b<MY_EQ_BANDS;b++) {
+        if (!((mask >> b) & 1)) continue;
+        band[n] = b;
+        w0[n] = 2.f * (float)M_PI * (k->eq_freq[b] / (float)c->sr);
+        g[n]  = k->eq_gain_db[b];
+        n++;
+    }
+    if (!n) return;
+    c->vmath->sincos(w0, sn, cs, n);
+    c->vmath->db_to_linear(g, A, n);
+    for (size_t i=0;i<n;i++)
+        eq_design_band(&k->ctl.eqk, band[i], (DSP_EQ_TYPE)k->eq_type[band[i]], A[i], sn[i], cs[i], k->eq_q[band[i]]);
+}
+
+static void prog_compile(DSP_CTX* c, DspParamSet* P);
+
+// 默认处理顺序（没有载入处理程序时）
+static const unsigned char dsp_default_order[DSP_STAGE_COUNT] = {
+    DSP_STAGE_GAIN, DSP_STAGE_EQ, DSP_STAGE_REVERB, DSP_STAGE_CONV, DSP_STAGE_LIMITER
+};
+
+// 段的传递函数恒为 1：0 dB（三种类型 A = 1 时都是），或系数上零极点正好抵消
+static int eq_band_flat(const DspControl* k, int b) {
+    const BqCoefSoA* e = &k->ctl.eqk;
+    return k->eq_gain_db[b] == 0.f || (e->b0[b] == 1.f && e->b1[b] == e->a1[b] && e->b2[b] == e->a2[b]);
+}
+
+// 发布前的收尾：重新设计改过的段（一次批量），把参数编译成要跑的最短处理链 ——
+// 段表只留启用且不是恒等的段（实时线程不再逐段判断开关），按处理顺序生成级表，增益折进第一段的 b 系数
+static void ctl_prepare(DSP_CTX* c) {
+    DspControl* k = c->ctrl;
+    DspParamSet* P = &k->ctl;
+    if (k->eq_dirty) {
+        eq_design_bands(c, k->eq_dirty);
+        k->eq_dirty = 0;
+    }
+    P->nEq = 0;
+    for (int b=0;b<MY_EQ_BANDS;b++) if (k->eq_enabled[b] && !eq_band_flat(k, b)) P->eqActive[P->nEq++] = (unsigned char)b;
+    prog_compile(c, P);
+    if (P->gain_fold) {
+        const int b = P->eqActive[0];
+        P->eqf = P->eqk;
+        P->eqf.b0[b] *= P->gain;
+        P->eqf.b1[b] *= P->gain;
+        P->eqf.b2[b] *= P->gain;
+    }
+    // 恒等：增益 1、没有要跑的 EQ 段、混响没有湿声、限幅器关闭
+    P->identity = !P->nEq && P->gain == 1.f && !(P->reverb_enabled && P->reverb_wet > 0.f) && !P->limiter_enabled;
+}
+
+static void ctl_commit(DSP_CTX* c) {
+    DspControl* k = c->ctrl;
+    if (!k->batch) {
+        ctl_prepare(c);
+        tb_publish(c, &k->ctl);
+    }
+    dsp_spin_unlock(&k->ctl_lock);
+}
+
+// 限幅参数换算成快照里的帧数/系数（前瞻按本实例的延迟线容量限制）
+static void limiter_configure(DSP_CTX* c, DspParamSet* P, float threshold, float lookahead_ms, float release_ms, int true_peak) {
+    lookahead_ms = clampf(lookahead_ms, 0.f, DSP_LIMITER_MAX_LOOKAHEAD_MS);
+    release_ms   = clampf(release_ms, 1.f, 1000.f);
+    int L = (int)(lookahead_ms * 0.001f * (float)c->sr + 0.5f);
+    if (L > (int)limiter_max_lookahead(c->sr)) L = (int)limiter_max_lookahead(c->sr);
+    P->lim_threshold = clampf(threshold, 0.01f, 1.f);
+    P->lim_lookahead = L;
+    P->lim_true_peak = true_peak ? 1 : 0;
+    P->lim_release   = 1.f - expf(-1000.f / (release_ms * (float)c->sr));
+}
 
 //======================================================
 // 创建/销毁/复位
 //======================================================
 void* dsp_create_context(unsigned sampleRate, unsigned channels) {
+    return dsp_create_context_ex(sampleRate, channels, 0);
+}
+
+void* dsp_create_context_ex(unsigned sampleRate, unsigned channels, unsigned flags) {
     if (channels < 1) channels = 1;
-    DSP_CTX* c = (DSP_CTX*)calloc(1, sizeof(DSP_CTX));
-    if (!c) return NULL;
+    const unsigned nrev = (flags & DSP_CREATE_REVERB_BUS_ONLY) ? (channels > 1 ? 2u : 1u) : channels;
+    DspLayout L;
+    dsp_layout(sampleRate, channels, nrev, &L);
+    unsigned char* base = (unsigned char*)dsp_aligned_alloc(L.total, DSP_MEM_ALIGN);   // 已清零
+    if (!base) return NULL;
+
+    DSP_CTX* c = (DSP_CTX*)base;
+    c->arena_bytes = L.total;
     c->sr = sampleRate;
     c->ch = channels;
-
-    c->gain = 1.0f;
+    c->lanes = dsp_round_lanes(channels);
+    c->nrev = nrev;
+
+    c->simd = dsp_simd_best();
+    c->bq_cascade = dsp_simd_bq_cascade(c->simd);
+    c->ramp_fill  = dsp_simd_ramp_fill(c->simd);
+    c->ramp_mul   = dsp_simd_ramp_mul(c->simd);
+    c->spec_mac   = dsp_simd_spec_mac(c->simd);
+    c->fdn_run    = dsp_simd_fdn(c->simd);
+    c->schroeder  = dsp_simd_schroeder(c->simd);
+    c->is_quiet   = dsp_simd_is_quiet(c->simd);
+    c->vmath      = dsp_fastmath_vec(c->simd);
+
+    c->tb_mid    = (dsp_atomic_t*)(base + L.off_mid);
+    c->stats_reset = c->tb_mid + 1;
+    c->ev_write  = c->tb_mid + 2;
+    c->ev_read   = c->tb_mid + 3;
+    c->conv_pending = (dsp_atomic_ptr_t*)(base + L.off_mid + sizeof(dsp_atomic_t) * 4);
+    c->conv_retired = c->conv_pending + 1;
+    c->rvir_pending = c->conv_pending + 2;
+    c->rvir_retired = c->conv_pending + 3;
+    c->events    = base + L.off_events;
+    c->stats     = (DspStatsAcc*)(base + L.off_stats);
+    c->ctrl      = (DspControl*)(base + L.off_ctrl);
+    c->slots     = base + L.off_slots;
+    c->work      = (float*)(base + L.off_work);
+    c->ramp      = (float*)(base + L.off_ramp);
+    c->eq.state  = (float*)(base + L.off_eq);
+    c->reverb    = (ReverbChan*)(base + L.off_rev);
+    c->fdn       = (FdnChan*)(base + L.off_fdn);
+    c->rvbuf     = (float*)(base + L.off_rvbuf);
+    c->rvin      = (float*)(base + L.off_rvin);
+
+    DspControl* k = c->ctrl;
+    k->ctl.gain = 1.0f;
 
     // 默认 EQ 参数（可调）：低搁架 100Hz +3dB, 峰值 1kHz +0dB, 高搁架 8kHz +0dB, Q=0.707
-    c->eq_freq[0] = 100.f;  c->eq_gain_db[0] = 0.f;   c->eq_q[0] = 0.707f; c->eq_enabled[0] = 0;
-    c->eq_freq[1] = 1000.f; c->eq_gain_db[1] = 0.f;   c->eq_q[1] = 1.0f;   c->eq_enabled[1] = 0;
-    c->eq_freq[2] = 8000.f; c->eq_gain_db[2] = 0.f;   c->eq_q[2] = 0.707f; c->eq_enabled[2] = 0;
-
-    for (int b=0;b<3;b++) {
-        c->eqBands[b] = (Biquad*)calloc(channels, sizeof(Biquad));
-        if (!c->eqBands[b]) { dsp_destroy_context(c); return NULL; }
-        for (unsigned ch=0; ch<channels; ++ch) {
-            biquad_reset(&c->eqBands[b][ch]);
-            c->eqBands[b][ch].enabled = 0;
-        }
-    }
-    // 初次设计（虽然默认禁用）
-    biquad_design_lowshelf (&c->eqBands[0][0], (float)c->sr, c->eq_freq[0], c->eq_gain_db[0], c->eq_q[0]);
-    biquad_design_peaking  (&c->eqBands[1][0], (float)c->sr, c->eq_freq[1], c->eq_gain_db[1], c->eq_q[1]);
-    biquad_design_highshelf(&c->eqBands[2][0], (float)c->sr, c->eq_freq[2], c->eq_gain_db[2], c->eq_q[2]);
-    // 把 band[0] 的系数复制到每个通道（避免重复计算；参数一变会统一更新）
-    for (int b=0;b<3;b++) {
-        for (unsigned ch=1; ch<channels; ++ch) {
-            c->eqBands[b][ch] = c->eqBands[b][0];
-            biquad_reset(&c->eqBands[b][ch]); // 状态独立
-        }
+    k->eq_freq[0] = 100.f;  k->eq_gain_db[0] = 0.f;   k->eq_q[0] = 0.707f; k->eq_type[0] = DSP_EQ_LOWSHELF;
+    k->eq_freq[1] = 1000.f; k->eq_gain_db[1] = 0.f;   k->eq_q[1] = 1.0f;   k->eq_type[1] = DSP_EQ_PEAK;
+    k->eq_freq[2] = 8000.f; k->eq_gain_db[2] = 0.f;   k->eq_q[2] = 0.707f; k->eq_type[2] = DSP_EQ_HIGHSHELF;
+    // 3..11：峰值 1kHz 0dB Q=1
+    for (int b=3;b<MY_EQ_BANDS;b++) {
+        k->eq_freq[b] = 1000.f; k->eq_gain_db[b] = 0.f; k->eq_q[b] = 1.0f; k->eq_type[b] = DSP_EQ_PEAK;
     }
 
+    // 初次设计（虽然默认禁用）：系数所有通道共享，12 段一次批量算完
+    for (int b=0;b<MY_EQ_BANDS;b++) k->eq_enabled[b] = 0;
+    eq_design_bands(c, (1u << MY_EQ_BANDS) - 1);
+
     // 混响（默认禁用）
-    c->reverb_enabled = 0;
-    c->reverb_wet  = 0.2f;
-    c->reverb_room = 0.7f;
-    c->reverb_damp = 0.3f;
-    c->reverb_pre_ms = 20.f;
-    c->reverb = (ReverbChan*)calloc(channels, sizeof(ReverbChan));
-    if (!c->reverb) { dsp_destroy_context(c); return NULL; }
-    for (unsigned chn=0; chn<channels; ++chn) {
-        reverb_init(&c->reverb[chn], c->sr, c->reverb_wet, c->reverb_room, c->reverb_damp, c->reverb_pre_ms);
-    }
-
-    c->limiter_enabled = 1; // 默认开启软限幅，防止测试时爆音
+    k->ctl.reverb_enabled = 0;
+    k->ctl.reverb_wet  = 0.2f;
+    k->ctl.reverb_room = 0.7f;
+    k->ctl.reverb_damp = 0.3f;
+    k->reverb_pre_ms = 20.f;
+    k->ctl.reverb_pd_len = ms_to_samples(k->reverb_pre_ms, c->sr);
+    k->ctl.reverb_type = DSP_REVERB_SCHROEDER;
+    k->ctl.reverb_bus  = DSP_REVERB_PER_CHANNEL;
+    for (int i=0;i<DSP_REVERB_MAX_SENDS;i++) k->ctl.rv_send[i] = k->ctl.rv_return[i] = 1.f;
+    float* revmem = (float*)(base + L.off_revmem);
+    for (unsigned chn=0; chn<nrev; ++chn) {
+        reverb_carve(&c->reverb[chn], c->sr, revmem + L.revmem_floats * chn);
+        reverb_apply(&c->reverb[chn], k->ctl.reverb_room, k->ctl.reverb_damp, k->ctl.reverb_pd_len);
+    }
+    for (unsigned pr=0; pr<fdn_pairs(nrev); ++pr)
+        fdn_carve(&c->fdn[pr], c->sr, pr, (float*)(base + L.off_fdnmem) + L.fdnmem_floats * pr);
+
+    limiter_carve(&c->lim, c->sr, channels, c->lanes, (float*)(base + L.off_lim), (uint32_t*)(base + L.off_limidx));
+    k->ctl.limiter_enabled = 1; // 默认开启限幅，防止测试时爆音
+    k->ctl.limiter_mode = DSP_LIMITER_LOOKAHEAD;
+    limiter_configure(c, &k->ctl, DSP_LIMITER_DEFAULT_THRESHOLD, DSP_LIMITER_DEFAULT_LOOKAHEAD_MS,
+                      DSP_LIMITER_DEFAULT_RELEASE_MS, 0);
+    k->ctl.ramp_len = ms_to_samples(DSP_DEFAULT_SMOOTH_MS, c->sr);
+    k->ctl.conv_enabled = 1;   // 没有载入 IR 时卷积级不运行
+    memcpy(k->order, dsp_default_order, sizeof(k->order));
+
+    // 三个槽都放初始参数：front=0 / mid=1 / back=2
+    ctl_prepare(c);
+    for (int i=0;i<3;i++) *tb_slot(c, i) = k->ctl;
+    c->front  = 0;
+    c->params = tb_slot(c, 0);
+    smooth_retarget(c, c->params, 1);
+    c->snap = 1;
+    *c->tb_mid = 1;
+    k->back   = 2;
     return c;
 }
 
 void dsp_reset(void* ctx) {
     if (!ctx) return;
     DSP_CTX* c = (DSP_CTX*)ctx;
-    for (int b=0;b<3;b++) {
-        for (unsigned ch=0; ch<c->ch; ++ch) biquad_reset(&c->eqBands[b][ch]);
-    }
-    for (unsigned ch=0; ch<c->ch; ++ch) {
-        reverb_free(&c->reverb[ch]);
-        reverb_init(&c->reverb[ch], c->sr, c->reverb_wet, c->reverb_room, c->reverb_damp, c->reverb_pre_ms);
+    eq_reset(&c->eq, c->lanes);
+    for (unsigned r=0; r<c->nrev; ++r) reverb_clear(&c->reverb[r]);
+    for (unsigned r=0; r<fdn_pairs(c->nrev); ++r) fdn_clear(&c->fdn[r]);
+    c->lim.live = 0;                    // 延迟线下一次运行前清零
+    c->conv_live = 0;
+    c->rvir_live = 0;
+    if (c->byp_drain) {                 // 延迟线已清空，没有要放的声音：下一块直接进入旁路
+        c->byp_drain = 0;
+        c->byp_step = 0.f;
+        c->byp_hold = 0;
     }
+    smooth_retarget(c, c->params, 1);   // 状态清零后没有可衔接的声音：下一次换参数也直接跳
+    c->snap = 1;
 }
 
+static char s_conv_none;
+#define DSP_CONV_NONE ((void*)&s_conv_none)   // conv_pending / rvir_pending 里的“卸载 IR”
+
 void dsp_destroy_context(void* ctx) {
     if (!ctx) return;
     DSP_CTX* c = (DSP_CTX*)ctx;
-    if (c->reverb) {
-        for (unsigned ch=0; ch<c->ch; ++ch) reverb_free(&c->reverb[ch]);
-        free(c->reverb);
-    }
-    for (int b=0;b<3;b++) free(c->eqBands[b]);
-    free(c);
+    // 除卷积 IR / 混响 IR 外所有状态都在同一块内存里
+    void* p = dsp_atomic_xchg_ptr(c->conv_pending, NULL);
+    if (p != DSP_CONV_NONE) dsp_conv_destroy((DspConv*)p);
+    dsp_conv_destroy((DspConv*)dsp_atomic_xchg_ptr(c->conv_retired, NULL));
+    dsp_conv_destroy(c->conv);
+    p = dsp_atomic_xchg_ptr(c->rvir_pending, NULL);
+    if (p != DSP_CONV_NONE) dsp_nuconv_destroy((DspNuConv*)p);
+    dsp_nuconv_destroy((DspNuConv*)dsp_atomic_xchg_ptr(c->rvir_retired, NULL));
+    dsp_nuconv_destroy(c->rvir);   // 会等各自的后台线程退出
+    dsp_aligned_free(ctx);
+}
+
+size_t dsp_get_memory_footprint(void* ctx) {
+    if (!ctx) return 0;
+    return ((DSP_CTX*)ctx)->arena_bytes;
 }
 
 //======================================================
-// 参数设置（非实时线程调用）
+// 参数设置（非实时线程调用）：改控制侧副本，然后整体发布一次快照
 //======================================================
 void dsp_set_gain(void* ctx, float linear_gain) {
     if (!ctx) return;
     DSP_CTX* c = (DSP_CTX*)ctx;
-    c->gain = linear_gain;
+    if (!isfinite(linear_gain)) return;
+    DspControl* k = ctl_begin(c);
+    k->ctl.gain = clampf(linear_gain, -DSP_MAX_GAIN, DSP_MAX_GAIN);
+    ctl_commit(c);
 }
 
 void dsp_set_eq_enabled(void* ctx, int band, int enabled) {
     if (!ctx) return;
-    if (band < 0 || band > 2) return;
+    if (band < 0 || band >= MY_EQ_BANDS) return;
     DSP_CTX* c = (DSP_CTX*)ctx;
-    c->eq_enabled[band] = enabled ? 1 : 0;
-    for (unsigned ch=0; ch<c->ch; ++ch) c->eqBands[band][ch].enabled = c->eq_enabled[band];
+    DspControl* k = ctl_begin(c);
+    k->eq_enabled[band] = enabled ? 1 : 0;
+    ctl_commit(c);
+}
+
+static DSP_EQ_TYPE eq_type_sanitize(DSP_EQ_TYPE type) {
+    return (type == DSP_EQ_LOWSHELF || type == DSP_EQ_HIGHSHELF) ? type : DSP_EQ_PEAK;
+}
+
+// 写入一段参数（已限幅），只有真的变了才标记重新设计；系数在发布前批量算（批量更新时多段只算一次）
+static void eq_update_band(DspControl* k, int band, int type, float f, float q, float g) {
+    if (k->eq_type[band] == type && k->eq_freq[band] == f && k->eq_q[band] == q && k->eq_gain_db[band] == g) return;
+    k->eq_type[band] = type;
+    k->eq_freq[band] = f;
+    k->eq_q[band]    = q;
+    k->eq_gain_db[band] = g;
+    k->eq_dirty |= 1u << band;
 }
 
 void dsp_set_eq_params(void* ctx, int band, float freq_hz, float q, float gain_db) {
     if (!ctx) return;
-    if (band < 0 || band > 2) return;
+    if (band < 0 || band >= MY_EQ_BANDS) return;
     DSP_CTX* c = (DSP_CTX*)ctx;
-    c->eq_freq[band] = clampf(freq_hz, 20.f, 20000.f);
-    c->eq_q[band]    = clampf(q, 0.3f, 8.f);
-    c->eq_gain_db[band] = clampf(gain_db, -24.f, 24.f);
-
-    // 重新设计一组系数（拷给每通道的 t_*），实时线程会自动切换
-    for (unsigned ch=0; ch<c->ch; ++ch) {
-        switch (band) {
-            case 0: biquad_design_lowshelf (&c->eqBands[0][ch], (float)c->sr, c->eq_freq[0], c->eq_gain_db[0], c->eq_q[0]); break;
-            case 1: biquad_design_peaking  (&c->eqBands[1][ch], (float)c->sr, c->eq_freq[1], c->eq_gain_db[1], c->eq_q[1]); break;
-            case 2: biquad_design_highshelf(&c->eqBands[2][ch], (float)c->sr, c->eq_freq[2], c->eq_gain_db[2], c->eq_q[2]); break;
-        }
+    DspControl* k = ctl_begin(c);
+    eq_update_band(k, band, k->eq_type[band],
+                   clampf(freq_hz, 20.f, 20000.f), clampf(q, 0.3f, 8.f), clampf(gain_db, -24.f, 24.f));
+    ctl_commit(c);
+}
+
+void dsp_set_eq_type(void* ctx, int band, DSP_EQ_TYPE type) {
+    if (!ctx) return;
+    if (band < 0 || band >= MY_EQ_BANDS) return;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspControl* k = ctl_begin(c);
+    eq_update_band(k, band, eq_type_sanitize(type), k->eq_freq[band], k->eq_q[band], k->eq_gain_db[band]);
+    ctl_commit(c);
+}
+
+void dsp_set_eq_params_ex(void* ctx, int band, float freq_hz, float q, float gain_db, DSP_EQ_TYPE type) {
+    if (!ctx) return;
+    if (band < 0 || band >= MY_EQ_BANDS) return;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspControl* k = ctl_begin(c);
+    eq_update_band(k, band, eq_type_sanitize(type),
+                   clampf(freq_hz, 20.f, 20000.f), clampf(q, 0.3f, 8.f), clampf(gain_db, -24.f, 24.f));
+    ctl_commit(c);
+}
+
+void dsp_begin_update(void* ctx) {
+    if (!ctx) return;
+    DspControl* k = ctl_begin((DSP_CTX*)ctx);
+    k->batch++;
+    dsp_spin_unlock(&k->ctl_lock);
+}
+
+void dsp_commit_update(void* ctx) {
+    if (!ctx) return;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspControl* k = ctl_begin(c);
+    if (k->batch > 0) k->batch--;
+    ctl_commit(c);   // 最外层 commit 时发布一次
+}
+
+int dsp_commit_update_at(void* ctx, uint64_t frame) {
+    if (!ctx) return 0;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspControl* k = ctl_begin(c);
+    if (k->batch > 0) k->batch--;
+    int ok = 1;
+    if (!k->batch) {
+        ctl_prepare(c);
+        ok = ev_push(c, frame);
+        if (!ok) tb_publish(c, &k->ctl);   // 队列满：退化为立即发布
     }
+    dsp_spin_unlock(&k->ctl_lock);
+    return ok;
+}
+
+uint64_t dsp_get_stream_position(void* ctx) {
+    if (!ctx) return 0;
+    return ((DSP_CTX*)ctx)->frame_pos;
 }
 
 void dsp_set_reverb_enabled(void* ctx, int enabled) {
     if (!ctx) return;
     DSP_CTX* c = (DSP_CTX*)ctx;
-    c->reverb_enabled = enabled ? 1 : 0;
+    DspControl* k = ctl_begin(c);
+    k->ctl.reverb_enabled = enabled ? 1 : 0;
+    ctl_commit(c);
 }
 
 void dsp_set_reverb_params(void* ctx, float wet, float room_size, float damp, float pre_delay_ms) {
     if (!ctx) return;
     DSP_CTX* c = (DSP_CTX*)ctx;
-    c->reverb_wet   = clampf(wet, 0.f, 1.f);
-    c->reverb_room  = clampf(room_size, 0.2f, 0.95f);
-    c->reverb_damp  = clampf(damp, 0.f, 0.7f);
-    c->reverb_pre_ms= clampf(pre_delay_ms, 0.f, 100.f);
+    DspControl* k = ctl_begin(c);
+    k->ctl.reverb_wet  = clampf(wet, 0.f, 1.f);
+    k->ctl.reverb_room = clampf(room_size, 0.2f, 0.95f);
+    k->ctl.reverb_damp = clampf(damp, 0.f, 0.7f);
+    k->reverb_pre_ms   = clampf(pre_delay_ms, 0.f, REVERB_MAX_PREDELAY_MS);
+    // 只换算长度，延迟线由实时线程在下一块开头按新长度继续使用
+    k->ctl.reverb_pd_len = ms_to_samples(k->reverb_pre_ms, c->sr);
+    ctl_commit(c);
+}
 
-    // 重新初始化混响通道（非实时调用）
-    for (unsigned ch=0; ch<c->ch; ++ch) {
-        reverb_free(&c->reverb[ch]);
-        reverb_init(&c->reverb[ch], c->sr, c->reverb_wet, c->reverb_room, c->reverb_damp, c->reverb_pre_ms);
-        c->reverb[ch].enabled = c->reverb_enabled;
+void dsp_set_reverb_type(void* ctx, DSP_REVERB_TYPE type) {
+    if (!ctx) return;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspControl* k = ctl_begin(c);
+    k->ctl.reverb_type = (type == DSP_REVERB_IR || type == DSP_REVERB_FDN) ? type : DSP_REVERB_SCHROEDER;
+    ctl_commit(c);
+}
+
+void dsp_set_reverb_routing(void* ctx, DSP_REVERB_ROUTING routing) {
+    if (!ctx) return;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspControl* k = ctl_begin(c);
+    k->ctl.reverb_bus = routing == DSP_REVERB_SEND_BUS ? 1 : 0;
+    ctl_commit(c);
+}
+
+int dsp_set_reverb_send(void* ctx, unsigned channel, float send, float ret) {
+    if (!ctx || channel >= DSP_REVERB_MAX_SENDS) return 0;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspControl* k = ctl_begin(c);
+    k->ctl.rv_send[channel]   = clampf(send, 0.f, 1.f);
+    k->ctl.rv_return[channel] = clampf(ret, 0.f, 1.f);
+    ctl_commit(c);
+    return 1;
+}
+
+// IR 混响：分段、分块做 FFT 并起后台线程（在调用线程上完成），交给实时线程在下一块开头换上
+int dsp_set_reverb_ir(void* ctx, const float* ir, size_t taps, unsigned irChannels) {
+    if (!ctx) return 0;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspNuConv* v = NULL;
+    if (ir && taps) {
+        v = dsp_nuconv_create(ir, taps, irChannels, c->nrev);   // 不持锁；只有总线时只有 1~2 路
+        if (!v) return 0;
     }
+    // 锁内只交换指针；销毁（要等后台线程退出、释放大块内存）放到锁外，其他设置函数不用陪着空转
+    DspControl* k = ctl_begin(c);
+    DspNuConv* retired = (DspNuConv*)dsp_atomic_xchg_ptr(c->rvir_retired, NULL);
+    void* prev = dsp_atomic_xchg_ptr(c->rvir_pending, v ? (void*)v : DSP_CONV_NONE);
+    dsp_spin_unlock(&k->ctl_lock);
+    dsp_nuconv_destroy(retired);
+    if (prev && prev != DSP_CONV_NONE) dsp_nuconv_destroy((DspNuConv*)prev);
+    return 1;
+}
+
+void dsp_set_smoothing_ms(void* ctx, float ms) {
+    if (!ctx) return;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspControl* k = ctl_begin(c);
+    ms = clampf(ms, 0.f, DSP_MAX_SMOOTH_MS);
+    k->ctl.ramp_len = ms > 0.f ? ms_to_samples(ms, c->sr) : 0;
+    ctl_commit(c);
 }
 
 void dsp_set_limiter_enabled(void* ctx, int enabled) {
     if (!ctx) return;
     DSP_CTX* c = (DSP_CTX*)ctx;
-    c->limiter_enabled = enabled ? 1 : 0;
+    DspControl* k = ctl_begin(c);
+    k->ctl.limiter_enabled = enabled ? 1 : 0;
+    ctl_commit(c);
+}
+
+void dsp_set_limiter_mode(void* ctx, DSP_LIMITER_MODE mode) {
+    if (!ctx) return;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspControl* k = ctl_begin(c);
+    k->ctl.limiter_mode = mode == DSP_LIMITER_SOFTCLIP ? DSP_LIMITER_SOFTCLIP : DSP_LIMITER_LOOKAHEAD;
+    ctl_commit(c);
+}
+
+void dsp_set_limiter_params(void* ctx, float threshold, float lookahead_ms, float release_ms, int true_peak) {
+    if (!ctx) return;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspControl* k = ctl_begin(c);
+    limiter_configure(c, &k->ctl, threshold, lookahead_ms, release_ms, true_peak);
+    ctl_commit(c);
+}
+
+// 卷积：载入 IR（耗时与 IR 长度成正比，在调用线程上完成），交给实时线程在下一块开头换上
+int dsp_set_conv_ir(void* ctx, const float* ir, size_t taps, unsigned irChannels, unsigned partition) {
+    if (!ctx) return 0;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    if (partition == 0) partition = DSP_CONV_DEFAULT_PARTITION;
+    DspConv* v = NULL;
+    if (ir && taps) {
+        v = dsp_conv_create(ir, taps, taps, irChannels, c->ch, partition);   // 不持锁
+        if (!v) return 0;
+    }
+    // 锁内只交换指针，释放放到锁外（其他设置函数与 dsp_get_latency_frames 不用陪着空转）
+    DspControl* k = ctl_begin(c);
+    // 实时线程上次换下来的对象现在可以释放了
+    DspConv* retired = (DspConv*)dsp_atomic_xchg_ptr(c->conv_retired, NULL);
+    // 上一次载入的对象如果实时线程还没取走，它从没被用过，直接释放
+    void* prev = dsp_atomic_xchg_ptr(c->conv_pending, v ? (void*)v : DSP_CONV_NONE);
+    k->conv_partition = v ? partition : 0;
+    dsp_spin_unlock(&k->ctl_lock);
+    dsp_conv_destroy(retired);
+    if (prev && prev != DSP_CONV_NONE) dsp_conv_destroy((DspConv*)prev);
+    return 1;
+}
+
+void dsp_set_conv_enabled(void* ctx, int enabled) {
+    if (!ctx) return;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspControl* k = ctl_begin(c);
+    k->ctl.conv_enabled = enabled ? 1 : 0;
+    ctl_commit(c);
+}
+
+unsigned dsp_get_latency_frames(void* ctx) {
+    if (!ctx) return 0;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    DspControl* k = ctl_begin(c);
+    const DspParamSet* P = &k->ctl;
+    unsigned n = 0;
+    if (P->conv_enabled)
+        n += k->conv_partition;
+    if (P->limiter_enabled && P->limiter_mode == DSP_LIMITER_LOOKAHEAD)
+        n += (unsigned)P->lim_lookahead + (P->lim_true_peak ? DSP_TP_DELAY : 0u);
+    dsp_spin_unlock(&k->ctl_lock);
+    return n;
 }
 
 //======================================================
-// 实时处理
-// 流程：PreGain → EQ(LS→Peak→HS) → Reverb(湿干混合) → Limiter → 输出
+// 处理程序（格式见 dsp_wrapper.h）：先整段校验，通过后在一次批量更新里按指令调各设置函数、换上新的处理顺序。
+// 校验、解释与编译（prog_compile）都在调用线程上（非实时；APO 里是 PipeThreadMain 经 ParamsApply 调用），
+// 实时线程每块只取一次发布好的快照，按里面编译好的级表依次调用
 //======================================================
-void dsp_process_block(void* ctx, const float* in, float* out, size_t frames, unsigned channels) {
+#define DSP_PROG_MAX_ARGS 5
+
+typedef struct {
+    unsigned char op, index, nargs;
+    union { float f; int32_t i; } a[DSP_PROG_MAX_ARGS];
+} DspInsn;
+
+static uint32_t rd_le32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// 取一条指令并校验；*p 前进到下一条。stage 返回它是哪一级（不是级指令时为 -1）
+static int prog_next(const unsigned char** p, const unsigned char* end, DspInsn* in, int* stage) {
+    if (end - *p < 4) return 0;
+    const unsigned char* q = *p;
+    in->op = q[0]; in->index = q[1]; in->nargs = q[2];
+    if (q[3] || in->nargs > DSP_PROG_MAX_ARGS || (size_t)(end - q - 4) < 4u * in->nargs) return 0;
+    for (unsigned i=0; i<in->nargs; ++i) {
+        const uint32_t v = rd_le32(q + 4 + 4*i);
+        memcpy(&in->a[i], &v, 4);
+    }
+    *p = q + 4 + 4u * in->nargs;
+
+    // 各操作码允许的参数个数（两种时另一种是 0）、index 的范围、哪几个参数是整数
+    int argc = 0, alt = -1, maxIndex = 0;
+    unsigned ints = 0;   // 位 i = 第 i 个参数是 i32
+    *stage = -1;
+    switch (in->op) {
+        case DSP_OP_GAIN:         *stage = DSP_STAGE_GAIN;    argc = 1; alt = 0; break;
+        case DSP_OP_EQ:           *stage = DSP_STAGE_EQ;      break;
+        case DSP_OP_REVERB:       *stage = DSP_STAGE_REVERB;  argc = 4; alt = 0; break;
+        case DSP_OP_CONV:         *stage = DSP_STAGE_CONV;    break;
+        case DSP_OP_LIMITER:      *stage = DSP_STAGE_LIMITER; argc = 5; alt = 0; ints = 1u | 16u; break;
+        case DSP_OP_EQ_BAND:      argc = 4; ints = 1u; maxIndex = MY_EQ_BANDS - 1; break;
+        case DSP_OP_EQ_OFF:       maxIndex = MY_EQ_BANDS - 1; break;
+        case DSP_OP_REVERB_TYPE:
+        case DSP_OP_REVERB_ROUTE: argc = 1; ints = 1u; break;
+        case DSP_OP_REVERB_SEND:  argc = 2; maxIndex = DSP_REVERB_MAX_SENDS - 1; break;
+        default: return 0;
+    }
+    if ((int)in->nargs != argc && (int)in->nargs != alt) return 0;
+    if (in->index > maxIndex) return 0;
+    for (unsigned i=0; i<in->nargs; ++i)
+        if (!((ints >> i) & 1) && !isfinite(in->a[i].f)) return 0;
+    // 整数参数的取值
+    switch (in->op) {
+        case DSP_OP_LIMITER:      if (in->nargs && ((uint32_t)in->a[0].i > 1u || (uint32_t)in->a[4].i > 1u)) return 0; break;
+        case DSP_OP_EQ_BAND:      if ((uint32_t)in->a[0].i > DSP_EQ_HIGHSHELF) return 0; break;
+        case DSP_OP_REVERB_TYPE:  if ((uint32_t)in->a[0].i > DSP_REVERB_FDN) return 0; break;
+        case DSP_OP_REVERB_ROUTE: if ((uint32_t)in->a[0].i > DSP_REVERB_SEND_BUS) return 0; break;
+        default: break;
+    }
+    return 1;
+}
+
+// 整段校验；通过时 order/nOrder 是程序列出的级（按顺序）
+static int prog_validate(const unsigned char* code, size_t bytes, unsigned char* order, unsigned* nOrder) {
+    if (bytes < 4 || code[0] != 'D' || code[1] != 'P' || code[2] != DSP_PROGRAM_VERSION) return 0;
+    const unsigned char* p = code + 4;
+    const unsigned char* end = code + bytes;
+    unsigned seen = 0;
+    *nOrder = 0;
+    for (unsigned i=0; i<code[3]; ++i) {
+        DspInsn in;
+        int stage;
+        if (!prog_next(&p, end, &in, &stage)) return 0;
+        if (stage < 0) continue;
+        if ((seen >> stage) & 1) return 0;   // 同一级出现两次
+        seen |= 1u << stage;
+        order[(*nOrder)++] = (unsigned char)stage;
+    }
+    return p == end;   // 多出来的字节也算不合法
+}
+
+int dsp_set_program(void* ctx, const void* code, size_t bytes) {
+    if (!ctx) return 0;
     DSP_CTX* c = (DSP_CTX*)ctx;
-    if (!c || channels != c->ch || frames == 0) {
-        // 兜底：直通
-        if (in != out) memcpy(out, in, sizeof(float)*frames*channels);
-        return;
+    unsigned char order[DSP_STAGE_COUNT];
+    unsigned nOrder = 0;
+    const int reset = !code || !bytes;
+    if (!reset && !prog_validate((const unsigned char*)code, bytes, order, &nOrder)) return 0;
+
+    dsp_begin_update(ctx);
+    if (reset) {
+        memcpy(order, dsp_default_order, sizeof(order));
+        nOrder = DSP_STAGE_COUNT;
+    } else {
+        const unsigned char* p = (const unsigned char*)code + 4;
+        const unsigned char* end = (const unsigned char*)code + bytes;
+        unsigned listed = 0;
+        for (unsigned i=0; i<((const unsigned char*)code)[3]; ++i) {
+            DspInsn in;
+            int stage;
+            prog_next(&p, end, &in, &stage);
+            if (stage >= 0) listed |= 1u << stage;
+            switch (in.op) {
+                case DSP_OP_GAIN:
+                    if (in.nargs) dsp_set_gain(ctx, in.a[0].f);
+                    break;
+                case DSP_OP_REVERB:
+                    if (in.nargs) {
+                        dsp_set_reverb_params(ctx, in.a[0].f, in.a[1].f, in.a[2].f, in.a[3].f);
+                        dsp_set_reverb_enabled(ctx, 1);
+                    }
+                    break;
+                case DSP_OP_LIMITER:
+                    if (in.nargs) {
+                        dsp_set_limiter_mode(ctx, (DSP_LIMITER_MODE)in.a[0].i);
+                        dsp_set_limiter_params(ctx, in.a[1].f, in.a[2].f, in.a[3].f, in.a[4].i);
+                        dsp_set_limiter_enabled(ctx, 1);
+                    }
+                    break;
+                case DSP_OP_EQ_BAND:
+                    dsp_set_eq_params_ex(ctx, in.index, in.a[1].f, in.a[2].f, in.a[3].f, (DSP_EQ_TYPE)in.a[0].i);
+                    dsp_set_eq_enabled(ctx, in.index, 1);
+                    break;
+                case DSP_OP_EQ_OFF:       dsp_set_eq_enabled(ctx, in.index, 0); break;
+                case DSP_OP_REVERB_TYPE:  dsp_set_reverb_type(ctx, (DSP_REVERB_TYPE)in.a[0].i); break;
+                case DSP_OP_REVERB_ROUTE: dsp_set_reverb_routing(ctx, (DSP_REVERB_ROUTING)in.a[0].i); break;
+                case DSP_OP_REVERB_SEND:  dsp_set_reverb_send(ctx, in.index, in.a[0].f, in.a[1].f); break;
+                default: break;
+            }
+        }
+        // 没列出的级关掉
+        if (!((listed >> DSP_STAGE_GAIN) & 1)) dsp_set_gain(ctx, 1.f);
+        if (!((listed >> DSP_STAGE_EQ) & 1))
+            for (int b=0; b<MY_EQ_BANDS; ++b) dsp_set_eq_enabled(ctx, b, 0);
+        if (!((listed >> DSP_STAGE_REVERB) & 1)) dsp_set_reverb_enabled(ctx, 0);
+        if (!((listed >> DSP_STAGE_CONV) & 1)) dsp_set_conv_enabled(ctx, 0);
+        if (!((listed >> DSP_STAGE_LIMITER) & 1)) dsp_set_limiter_enabled(ctx, 0);
+        // 顺序补成完整的排列（没列出的级已关闭，放在哪里都不会跑，之后单独打开时按默认的相对顺序排在后面）
+        for (int i=0; i<DSP_STAGE_COUNT; ++i)
+            if (!((listed >> dsp_default_order[i]) & 1)) order[nOrder++] = dsp_default_order[i];
     }
+    DspControl* k = ctl_begin(c);
+    memcpy(k->order, order, sizeof(k->order));
+    ctl_commit(c);
+    dsp_commit_update(ctx);
+    return 1;
+}
 
-    const unsigned ch = c->ch;
-    const float G = c->gain;
-    const int eqEn0 = c->eq_enabled[0];
-    const int eqEn1 = c->eq_enabled[1];
-    const int eqEn2 = c->eq_enabled[2];
-    const int rvEn  = c->reverb_enabled;
-    const float wet = c->reverb_wet;
-    const int limitEn = c->limiter_enabled;
-
-    // 逐帧逐通道处理（保持简单，可后续矢量化）
+//======================================================
+// 运行统计
+//======================================================
+double dsp_clock_ticks_per_second(void) {
+    // 对照系统时钟跑约 20ms 校准一次；多线程同时首调只会多校准几次，结果相同
+    static volatile double s_tps = 0.0;
+    if (s_tps > 0.0) return s_tps;
+    struct timespec a, b;
+    timespec_get(&a, TIME_UTC);
+    const uint64_t t0 = dsp_clock_ticks();
+    double el;
+    do {
+        timespec_get(&b, TIME_UTC);
+        el = (double)(b.tv_sec - a.tv_sec) + (double)(b.tv_nsec - a.tv_nsec) * 1e-9;
+    } while (el < 0.02);
+    const uint64_t t1 = dsp_clock_ticks();
+    s_tps = (double)(t1 - t0) / el;
+    return s_tps;
+}
+
+#if DSP_ENABLE_STATS
+static inline void stat_add(DSP_STAGE_STATS* s, uint64_t dt) {
+    s->calls++;
+    s->ticks += dt;
+    if (dt > s->max_ticks) s->max_ticks = dt;
+}
+
+static inline unsigned stat_bucket(uint64_t dt) {
+    unsigned b = 0;
+    while (dt > 1 && b < DSP_STATS_HIST_BUCKETS - 1) { dt >>= 1; b++; }
+    return b;
+}
+
+// 直方图第 q 分位：返回所在桶的上沿（ticks）
+static double stat_percentile(const uint64_t* hist, uint64_t total, double q) {
+    if (!total) return 0.0;
+    uint64_t need = (uint64_t)(q * (double)total);
+    if (need < 1) need = 1;
+    uint64_t acc = 0;
+    for (unsigned i=0;i<DSP_STATS_HIST_BUCKETS;i++) {
+        acc += hist[i];
+        if (acc >= need) return (double)((uint64_t)2 << i);
+    }
+    return (double)((uint64_t)2 << (DSP_STATS_HIST_BUCKETS - 1));
+}
+#endif
+
+int dsp_get_stats(void* ctx, DSP_STATS* out) {
+    if (!out) return 0;
+    memset(out, 0, sizeof(*out));
+#if DSP_ENABLE_STATS
+    if (!ctx) return 0;
+    const DspStatsAcc* a = ((DSP_CTX*)ctx)->stats;
+    const double tps = dsp_clock_ticks_per_second();
+    const double us = 1e6 / tps;
+    out->ticks_per_second = tps;
+    out->blocks = a->blocks;
+    out->frames = a->frames;
+    memcpy(out->stage, a->stage, sizeof(out->stage));
+    out->eq_band_runs = a->eq_band_runs;
+    out->block_max_ticks = a->block_max_ticks;
+    memcpy(out->block_hist, a->block_hist, sizeof(out->block_hist));
+    out->reverb_tail_waits = a->reverb_tail_waits;
+    out->tail_blocks = a->tail_blocks;
+    out->idle_blocks = a->idle_blocks;
+    out->bypass_blocks = a->bypass_blocks;
+
+    uint64_t total = 0;
+    for (unsigned i=0;i<DSP_STATS_HIST_BUCKETS;i++) total += out->block_hist[i];
+    out->block_avg_us  = out->blocks ? (double)a->block_ticks * us / (double)out->blocks : 0.0;
+    out->block_p50_us  = stat_percentile(out->block_hist, total, 0.50)  * us;
+    out->block_p99_us  = stat_percentile(out->block_hist, total, 0.99)  * us;
+    out->block_p999_us = stat_percentile(out->block_hist, total, 0.999) * us;
+    return 1;
+#else
+    (void)ctx;
+    return 0;
+#endif
+}
+
+void dsp_reset_stats(void* ctx) {
+    if (!ctx) return;
+    dsp_atomic_store(((DSP_CTX*)ctx)->stats_reset, 1);
+}
+
+DSP_SIMD_LEVEL dsp_get_simd_level(void* ctx) {
+    if (!ctx) return DSP_SIMD_SCALAR;
+    return ((DSP_CTX*)ctx)->simd;
+}
+
+int dsp_set_simd_level(void* ctx, DSP_SIMD_LEVEL level) {
+    if (!ctx) return 0;
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    dsp_bq_cascade_fn k = dsp_simd_bq_cascade(level);
+    if (!k) return 0;
+    c->bq_cascade = k;
+    c->ramp_fill  = dsp_simd_ramp_fill(level);
+    c->ramp_mul   = dsp_simd_ramp_mul(level);
+    c->spec_mac   = dsp_simd_spec_mac(level);
+    c->fdn_run    = dsp_simd_fdn(level);
+    c->schroeder  = dsp_simd_schroeder(level);
+    c->is_quiet   = dsp_simd_is_quiet(level);
+    c->vmath      = dsp_fastmath_vec(level);
+    c->simd = level;
+    return 1;
+}
+
+//======================================================
+// 实时处理：分级流水线
+// 默认流程：PreGain → EQ(12 段串联) → Reverb(湿干混合) → Conv(房间校正 FIR) → Limiter(前瞻限幅或软限幅) → 输出
+// （顺序可由 dsp_set_program 改）。每块开头取一次参数快照，从发布时编译好的级表里挑出本块要跑的级；每一级在整个子块（DSP_SUBBLOCK 帧）上跑完
+// 再交给下一级，内层循环里没有开关判断，滤波器状态留在寄存器里，各级耗时也可以单独测。
+// 工作区按“帧 × lane”排布（而非逐通道平面），这样 EQ 的 SIMD 内核可以一次处理全部通道。
+//======================================================
+static void stage_gain(DSP_CTX* c, const DspParamSet* p, float* buf, size_t frames) {
+    DspRamp* r = &c->gain_r;
+    if (ramp_active(r)) {
+        const size_t k = ((size_t)(r->len - r->pos) < frames) ? (size_t)(r->len - r->pos) : frames;
+        c->ramp_fill(c->ramp, k, r->start + r->step * (float)r->pos, r->step);
+        if (r->pos + (int)k == r->len) c->ramp[k - 1] = r->target;   // 终点精确落在目标上
+        c->ramp_mul(buf, c->ramp, k, c->lanes);
+        r->pos += (int)k;
+        buf += k * c->lanes;
+        frames -= k;
+    }
+    const size_t n = frames * c->lanes;
+    const float G = p->gain;
+    for (size_t i=0; i<n; ++i) buf[i] *= G;
+}
+
+// EQ 斜坡：每 DSP_COEF_STEP 个样本重算一次插值系数，返回处理掉的帧数
+static size_t stage_eq_ramp(DSP_CTX* c, float* buf, size_t frames) {
+    DspEqRamp* r = &c->eq_r;
+    size_t done = 0;
+    while (done < frames && r->pos < r->len) {
+        const int phase = r->pos % DSP_COEF_STEP;
+        if (phase == 0) {
+            float t = (float)(r->pos + DSP_COEF_STEP) / (float)r->len;
+            if (t > 1.f) t = 1.f;
+            for (int b=0;b<MY_EQ_BANDS;b++) {
+                r->cur.b0[b] = r->from.b0[b] + (r->to.b0[b] - r->from.b0[b]) * t;
+                r->cur.b1[b] = r->from.b1[b] + (r->to.b1[b] - r->from.b1[b]) * t;
+                r->cur.b2[b] = r->from.b2[b] + (r->to.b2[b] - r->from.b2[b]) * t;
+                r->cur.a1[b] = r->from.a1[b] + (r->to.a1[b] - r->from.a1[b]) * t;
+                r->cur.a2[b] = r->from.a2[b] + (r->to.a2[b] - r->from.a2[b]) * t;
+            }
+        }
+        size_t n = (size_t)(DSP_COEF_STEP - phase);
+        if (n > (size_t)(r->len - r->pos)) n = (size_t)(r->len - r->pos);
+        if (n > frames - done) n = frames - done;
+        c->bq_cascade(&r->cur, r->active, r->nActive, c->eq.state, buf + done * c->lanes, n, c->lanes);
+        r->pos += (int)n;
+        done += n;
+    }
+    if (r->pos >= r->len) {
+        // 斜坡结束：退出的段已经过渡到直通，从并集里去掉
+        r->cur = r->to;
+        r->mask = r->target_mask;
+    }
+    return done;
+}
+
+static void stage_eq(DSP_CTX* c, const DspParamSet* p, float* buf, size_t frames) {
+    if (c->eq_r.pos < c->eq_r.len) {
+        const size_t done = stage_eq_ramp(c, buf, frames);
+        buf += done * c->lanes;
+        frames -= done;
+        if (!frames) return;
+    }
+    // 逐段整块处理，每个通道占一个 SIMD lane；整张段表一次交给内核（统计只计整级，见 dsp_run）
+    const BqCoefSoA* k = c->fold ? &p->eqf : &p->eqk;
+    c->bq_cascade(k, p->eqActive, p->nEq, c->eq.state, buf, frames, c->lanes);
+#if DSP_ENABLE_STATS
+    c->stats->eq_band_runs += p->nEq;
+#endif
+}
+
+// 增益折进/拆出第一个 EQ 段时换算该段的输入历史：折进后 x1/x2 存未乘增益的输入，拆出后存乘过增益的，
+// 这样换表前后滤波器接着走，不会在两个样本里按错的增益算（增益为 0 时历史用不到，不换算）
+static void eq_fold_state(DSP_CTX* c, const DspParamSet* P, int fold) {
+    if (fold == c->fold && (!fold || (c->fold_band == P->eqActive[0] && c->fold_g == P->gain))) return;
+    const unsigned lanes = c->lanes;
+    if (c->fold) {
+        float* x = c->eq.state + (size_t)c->fold_band * DSP_BQ_STATE_FLOATS(lanes);
+        for (unsigned i=0; i<2*lanes; ++i) x[i] *= c->fold_g;
+    }
+    if (fold && P->gain != 0.f) {
+        float* x = c->eq.state + (size_t)P->eqActive[0] * DSP_BQ_STATE_FLOATS(lanes);
+        const float inv = 1.f / P->gain;
+        for (unsigned i=0; i<2*lanes; ++i) x[i] *= inv;
+    }
+    c->fold = fold;
+    c->fold_band = fold ? P->eqActive[0] : 0;
+    c->fold_g = fold ? P->gain : 1.f;
+}
+
+// 湿度斜坡在跑时：生成本子块的整段湿度向量（斜坡结束后的部分填目标值）并推进斜坡；否则返回 NULL
+static const float* reverb_wet_ramp(DSP_CTX* c, size_t frames) {
+    DspRamp* wr = &c->wet_r;
+    if (!ramp_active(wr)) return NULL;
+    const size_t k = ((size_t)(wr->len - wr->pos) < frames) ? (size_t)(wr->len - wr->pos) : frames;
+    c->ramp_fill(c->ramp, k, wr->start + wr->step * (float)wr->pos, wr->step);
+    if (wr->pos + (int)k == wr->len) c->ramp[k - 1] = wr->target;
+    for (size_t n=k; n<frames; ++n) c->ramp[n] = wr->target;
+    wr->pos += (int)k;
+    return c->ramp;
+}
+
+// 第 cc 个通道的发送/返回电平（超出可设置范围的通道固定为 1）
+static inline float rv_level(const float* a, unsigned cc) {
+    return cc < DSP_REVERB_MAX_SENDS ? a[cc] : 1.f;
+}
+
+// 干湿混合：湿声在 rvbuf（lane 排布），湿度斜坡与开关沿用 Schroeder 的同一套。
+// bus = 0：通道 cc 取 lane cc，湿度乘发送×返回电平；bus = 1：取总线 lane（奇偶），湿度只乘返回电平
+static void reverb_mix(DSP_CTX* c, const DspParamSet* p, float* buf, size_t frames, int bus) {
+    const unsigned lanes = c->lanes;
+    const unsigned m = bus ? (c->ch > 1 ? 1u : 0u) : ~0u;
+    const float* wv = reverb_wet_ramp(c, frames);
+    for (unsigned cc=0; cc<c->ch; ++cc) {
+        const float g = bus ? rv_level(p->rv_return, cc) : rv_level(p->rv_send, cc) * rv_level(p->rv_return, cc);
+        const float* rv = c->rvbuf + (cc & m);
+        float* x = buf + cc;
+        if (wv) {
+            for (size_t n=0; n<frames; ++n, x += lanes, rv += lanes) {
+                const float wet = wv[n] * g;
+                *x = (1.0f - wet) * *x + wet * *rv;
+            }
+        } else {
+            const float wet = c->wet_r.target * g, dry = 1.0f - wet;
+            for (size_t n=0; n<frames; ++n, x += lanes, rv += lanes) *x = dry * *x + wet * *rv;
+        }
+    }
+}
+
+// 第 r 路 Schroeder：x 先过预延迟，再整段交给梳状/全通内核，湿声写到 d（步长都是 lanes）
+static void reverb_schroeder_run(DSP_CTX* c, const DspParamSet* p, unsigned r, const float* x, float* d, size_t frames) {
+    const unsigned lanes = c->lanes;
+    ReverbChan* rc = &c->reverb[r];
+    reverb_apply(rc, p->reverb_room, p->reverb_damp, p->reverb_pd_len);
+    reverb_predelay(rc, x, d, frames, lanes);
+    c->schroeder(&rc->k, d, d, frames, lanes);
+}
+
+// Schroeder 混响：每通道一路，湿声放在 rvbuf
+static void stage_reverb(DSP_CTX* c, const DspParamSet* p, float* buf, size_t frames) {
+    for (unsigned cc=0; cc<c->ch; ++cc) reverb_schroeder_run(c, p, cc, buf + cc, c->rvbuf + cc, frames);
+    reverb_mix(c, p, buf, frames, 0);
+}
+
+// IR 混响：非均匀分块卷积算出整个子块的湿声（in 与 rvbuf 同为 lane 排布）
+static void reverb_ir_run(DSP_CTX* c, const float* in, size_t frames) {
+    if (!c->rvir_live) {
+        dsp_nuconv_reset(c->rvir);
+        c->rvir_live = 1;
+    }
+    const unsigned waits = dsp_nuconv_process(c->rvir, c->spec_mac, in, c->rvbuf, frames, c->lanes);
+#if DSP_ENABLE_STATS
+    c->stats->reverb_tail_waits += waits;
+#else
+    (void)waits;
+#endif
+}
+
+// IR 混响：先算湿声，再与干声混合
+static void stage_reverb_ir(DSP_CTX* c, const DspParamSet* p, float* buf, size_t frames) {
+    reverb_ir_run(c, buf, frames);
+    reverb_mix(c, p, buf, frames, 0);
+}
+
+// 第 pr 个 FDN，带 nio（1~2）路：x[k] 先过第 2·pr + k 路 ReverbChan 的预延迟，再整段交给 FDN 内核，
+// 湿声写到 d[k]（x、d 的 nio 路在 lane 里相邻，步长都是 lanes）
+static void reverb_fdn_run(DSP_CTX* c, const DspParamSet* p, unsigned pr, unsigned nio,
+                           const float* x, float* d, size_t frames) {
+    const unsigned lanes = c->lanes;
+    FdnChan* f = &c->fdn[pr];
+    for (unsigned k=0; k<nio; ++k) {
+        ReverbChan* rc = &c->reverb[2 * pr + k];
+        reverb_apply(rc, p->reverb_room, p->reverb_damp, p->reverb_pd_len);
+        reverb_predelay(rc, x + k, d + k, frames, lanes);
+    }
+    fdn_apply(f, p->reverb_room, p->reverb_damp, c->sr);
+    c->fdn_run(&f->k, d, d, frames, lanes, nio);
+}
+
+// FDN 混响：相邻两个通道一个 FDN，湿声放在 rvbuf
+static void stage_reverb_fdn(DSP_CTX* c, const DspParamSet* p, float* buf, size_t frames) {
+    for (unsigned cc=0; cc<c->ch; cc += 2)
+        reverb_fdn_run(c, p, cc / 2, c->ch - cc > 1 ? 2u : 1u, buf + cc, c->rvbuf + cc, frames);
+    reverb_mix(c, p, buf, frames, 0);
+}
+
+// 发送总线：偶数通道加成 lane 0、奇数通道加成 lane 1（单声道只有 lane 0），各乘发送电平；
+// 只跑这 1~2 路混响（第 b 路用 reverb[b] / IR 的第 b 路，FDN 两路共用 fdn[0]），再按奇偶分回各通道
+static void stage_reverb_bus(DSP_CTX* c, const DspParamSet* p, float* buf, size_t frames) {
+    const unsigned ch = c->ch, lanes = c->lanes, nb = ch > 1 ? 2u : 1u;
+    const float* x = buf;
+    float* d = c->rvin;
+    for (size_t n=0; n<frames; ++n, x += lanes, d += lanes) {
+        for (unsigned b=0; b<nb; ++b) {
+            float s = x[b] * rv_level(p->rv_send, b);   // 从本组第一个通道起加，立体声时就是 x·send 本身
+            for (unsigned cc=b+2; cc<ch; cc += 2) s += x[cc] * rv_level(p->rv_send, cc);
+            d[b] = s;
+        }
+    }
+    if (p->reverb_type == DSP_REVERB_IR) reverb_ir_run(c, c->rvin, frames);
+    else if (p->reverb_type == DSP_REVERB_FDN) reverb_fdn_run(c, p, 0, nb, c->rvin, c->rvbuf, frames);
+    else
+        for (unsigned b=0; b<nb; ++b) reverb_schroeder_run(c, p, b, c->rvin + b, c->rvbuf + b, frames);
+    reverb_mix(c, p, buf, frames, 1);
+}
+
+static void stage_conv(DSP_CTX* c, const DspParamSet* p, float* buf, size_t frames) {
+    (void)p;
+    if (!c->conv_live) {
+        dsp_conv_reset(c->conv);
+        c->conv_live = 1;
+    }
+    dsp_conv_process(c->conv, c->spec_mac, buf, frames, c->lanes);
+}
+
+static void stage_softclip(DSP_CTX* c, const DspParamSet* p, float* buf, size_t frames) {
+    (void)p;
+    // tanh(1.5x)；补齐的 lane 为 0，tanh(0)=0，直接整片处理
+    const size_t n = frames * c->lanes;
+    for (size_t i=0; i<n; ++i) buf[i] *= 1.5f;
+    c->vmath->tanh(buf, buf, n);
+}
+
+static void stage_limiter(DSP_CTX* c, const DspParamSet* p, float* buf, size_t frames) {
+    DspLimiter* m = &c->lim;
+    const unsigned ch = c->ch, lanes = c->lanes;
+    if (!m->live || m->L != p->lim_lookahead || m->tp != p->lim_true_peak)
+        limiter_reset(m, ch, lanes, p->lim_lookahead, p->lim_true_peak);
+
+    const unsigned W = (unsigned)m->L + 1;                       // 窗口 = 平均长度
+    const unsigned D = (unsigned)m->L + (m->tp ? DSP_TP_DELAY : 0u);
+    const float thr = p->lim_threshold, rel = p->lim_release;
+    float* x = buf;
+    for (size_t n=0; n<frames; ++n, x += lanes) {
+        // 检测（通道联动）
+        float pk;
+        if (m->tp) pk = limiter_tp_detect(m, x, ch);
+        else {
+            pk = 0.f;
+            for (unsigned cc=0; cc<ch; ++cc) { const float a = fabsf(x[cc]); if (a > pk) pk = a; }
+        }
+
+        // 单调队列：新值从尾部进，挤掉不比它大的；头部过期（离开窗口）就出队
+        const uint32_t t = m->t++;
+        while (m->dq_n) {
+            const unsigned back = (m->dq_head + m->dq_n - 1) % m->win_cap;
+            if (m->dq_val[back] > pk) break;
+            m->dq_n--;
+        }
+        {
+            const unsigned tail = (m->dq_head + m->dq_n) % m->win_cap;
+            m->dq_val[tail] = pk;
+            m->dq_t[tail] = t;
+            m->dq_n++;
+        }
+        if (t - m->dq_t[m->dq_head] >= W) { m->dq_head = (m->dq_head + 1) % m->win_cap; m->dq_n--; }
+        const float peak = m->dq_val[m->dq_head];
+
+        // 需求增益 → 释放 → 滑动平均
+        const float r = peak > thr ? thr / peak : 1.f;
+        m->env = r < m->env ? r : m->env + (r - m->env) * rel;
+        m->box_sum += (double)m->env - (double)m->box[m->box_pos];
+        m->box[m->box_pos] = m->env;
+        if (++m->box_pos == W) m->box_pos = 0;
+        const float g = (float)(m->box_sum / (double)W);
+
+        // 延迟 D 帧后乘增益（先写后读，D=0 时就是当前帧）
+        float* dw = m->delay + (size_t)m->wpos * lanes;
+        for (unsigned l=0; l<lanes; ++l) dw[l] = x[l];
+        const unsigned rp = m->wpos >= D ? m->wpos - D : m->wpos + m->cap - D;
+        const float* dr = m->delay + (size_t)rp * lanes;
+        for (unsigned l=0; l<lanes; ++l) x[l] = dr[l] * g;
+        if (++m->wpos == m->cap) m->wpos = 0;
+    }
+}
+
+// 发布时（持 ctl_lock）按 k->order 编译级表：不启用的级根本不出现，各级的实现在这里选好；
+// 只在斜坡走完前、或实时线程手上有 IR 时才跑的级带上运行条件。
+// 增益紧挨在 EQ 前面时可以折进 EQ 第一段（中间没有别的级，换算第一段的输入历史就能无缝折进/拆出）
+static void prog_compile(DSP_CTX* c, DspParamSet* P) {
+    const DspControl* k = c->ctrl;
+    const int bus = P->reverb_bus || c->nrev < c->ch;
+    int gainAt = -1, eqAt = -1;
+    P->nProg = 0;
+    for (int i=0; i<DSP_STAGE_COUNT; ++i) {
+        DspOp op = { NULL, k->order[i], 0 };
+        switch (k->order[i]) {
+            case DSP_STAGE_GAIN:
+                op.fn = stage_gain;
+                gainAt = (int)P->nProg;
+                break;
+            case DSP_STAGE_EQ:
+                op.fn = stage_eq;
+                op.need = P->nEq ? 0 : DSP_NEED_EQ_RAMP;
+                eqAt = (int)P->nProg;
+                break;
+            case DSP_STAGE_REVERB:
+                if (P->reverb_type == DSP_REVERB_IR) op.fn = bus ? stage_reverb_bus : stage_reverb_ir;
+                else if (bus) op.fn = stage_reverb_bus;
+                else op.fn = P->reverb_type == DSP_REVERB_FDN ? stage_reverb_fdn : stage_reverb;
+                op.need = (P->reverb_enabled ? 0 : DSP_NEED_WET_RAMP) | (P->reverb_type == DSP_REVERB_IR ? DSP_NEED_RVIR : 0);
+                break;
+            case DSP_STAGE_CONV:
+                if (!P->conv_enabled) continue;
+                op.fn = stage_conv;
+                op.need = DSP_NEED_CONV;
+                break;
+            case DSP_STAGE_LIMITER:
+                if (!P->limiter_enabled) continue;
+                op.fn = P->limiter_mode == DSP_LIMITER_SOFTCLIP ? stage_softclip : stage_limiter;
+                break;
+            default: continue;
+        }
+        P->prog[P->nProg++] = op;
+    }
+    P->gain_fold = P->nEq && P->gain != 1.f && eqAt == gainAt + 1;
+    // 增益为 1 时只在斜坡中跑，折进 EQ 时只在没折（斜坡中）时跑
+    P->prog[gainAt].need = (unsigned char)(P->gain_fold ? DSP_NEED_UNFOLDED : P->gain != 1.f ? 0 : DSP_NEED_GAIN_RAMP);
+}
+
+// 本块的级表：按发布时编译好的顺序，挑出运行条件满足的项
+static int build_stages(DSP_CTX* c, const DspParamSet* P, dsp_stage_fn* stages, unsigned char* stageId) {
+    // 增益与 EQ 都不在斜坡中时增益已折进 EQ 第一段（斜坡按未折的系数和逐帧增益走）
+    const int fold = P->gain_fold && !ramp_active(&c->gain_r) && c->eq_r.pos >= c->eq_r.len;
+    eq_fold_state(c, P, fold);
+    // 斜坡还在跑的级即使目标是“关闭/恒等”也要留在表里，直到斜坡走完
+    const unsigned have = (ramp_active(&c->gain_r) ? DSP_NEED_GAIN_RAMP : 0u) | (fold ? 0u : DSP_NEED_UNFOLDED) |
+                          (c->eq_r.pos < c->eq_r.len ? DSP_NEED_EQ_RAMP : 0u) |
+                          (ramp_active(&c->wet_r) ? DSP_NEED_WET_RAMP : 0u) |
+                          (c->conv ? DSP_NEED_CONV : 0u) | (c->rvir ? DSP_NEED_RVIR : 0u);
+    int n = 0, irRev = 0;
+    for (unsigned i=0; i<P->nProg; ++i) {
+        const DspOp* op = &P->prog[i];
+        if ((op->need & have) != op->need) continue;
+        stages[n] = op->fn;
+        stageId[n] = op->id;
+        n++;
+        irRev |= op->id == DSP_STAGE_REVERB && P->reverb_type == DSP_REVERB_IR;
+    }
+    // 只分配了总线状态的实例总是走总线；刚切到总线时，闲下来的各路清零（切回来时不会放出旧的尾音），
+    // IR 两种路由的输入不同，切换时也从空状态开始
+    const int bus = P->reverb_bus || c->nrev < c->ch;
+    if (bus != c->rv_bus) {
+        if (bus) {
+            for (unsigned r = c->ch > 1 ? 2u : 1u; r < c->nrev; ++r) reverb_clear(&c->reverb[r]);
+            for (unsigned r = 1; r < fdn_pairs(c->nrev); ++r) fdn_clear(&c->fdn[r]);
+        }
+        c->rv_bus = bus;
+        c->rvir_live = 0;
+    }
+    // 进入旁路的淡化中（见 bypass_enter）：刚停掉的卷积/前瞻限幅器接着跑，放完延迟线里的声音
+    if ((c->byp_drain & DSP_DRAIN_CONV) && c->conv) {
+        stages[n] = stage_conv;
+        stageId[n++] = DSP_STAGE_CONV;
+    }
+    if (c->byp_drain & DSP_DRAIN_LIMITER) {
+        stages[n] = stage_limiter;
+        stageId[n++] = DSP_STAGE_LIMITER;
+    }
+    if (!(c->byp_drain & DSP_DRAIN_LIMITER) && (!P->limiter_enabled || P->limiter_mode != DSP_LIMITER_LOOKAHEAD))
+        c->lim.live = 0;   // 再启用时从空延迟线开始
+    if (!(c->byp_drain & DSP_DRAIN_CONV) && !P->conv_enabled) c->conv_live = 0;
+    if (!irRev) c->rvir_live = 0;   // 下次再跑时不能接着放停下之前的历史
+    return n;
+}
+
+// 块开头：控制线程载入了新 IR 就换上。分块长度相同时把输入历史接过去，输出不断档；
+// 旧对象放进 conv_retired 等控制线程释放（上一个还没被取走时推迟到下一块再换）
+static void conv_acquire(DSP_CTX* c) {
+    if (!dsp_atomic_load_ptr(c->conv_pending)) return;   // 常态：一次原子读
+    if (dsp_atomic_load_ptr(c->conv_retired)) return;
+    void* p = dsp_atomic_xchg_ptr(c->conv_pending, NULL);
+    DspConv* next = p == DSP_CONV_NONE ? NULL : (DspConv*)p;
+    DspConv* old = c->conv;
+    if (next && old && c->conv_live) dsp_conv_take_history(next, old);
+    c->conv = next;
+    c->conv_live = 1;   // 新对象要么接上了历史，要么还是创建时的空状态
+    if (old) dsp_atomic_xchg_ptr(c->conv_retired, old);
+}
+
+// 同上，换 IR 混响（非均匀分块长度固定，总能接上输入历史）
+static void rvir_acquire(DSP_CTX* c) {
+    if (!dsp_atomic_load_ptr(c->rvir_pending)) return;
+    if (dsp_atomic_load_ptr(c->rvir_retired)) return;
+    void* p = dsp_atomic_xchg_ptr(c->rvir_pending, NULL);
+    DspNuConv* next = p == DSP_CONV_NONE ? NULL : (DspNuConv*)p;
+    DspNuConv* old = c->rvir;
+    if (next && old && c->rvir_live) dsp_nuconv_take_history(next, old);
+    c->rvir = next;
+    c->rvir_live = 1;
+    if (old) dsp_atomic_xchg_ptr(c->rvir_retired, old);
+}
+
+//======================================================
+// 静音跳过：输入静音后跑完尾音，再清空各级状态进入空闲，静音块不再跑任何一级
+//======================================================
+#define DSP_TAIL_MIN_MS 50.f   // EQ 等没有延迟线的级：输出至少连续安静这么久（约 20Hz 一个周期）
+
+// 按当前级表，输入静音之后链上还可能放出声音的最长时间（帧）：各级串联，尾音相加
+static uint64_t tail_frames(const DSP_CTX* c, const DspParamSet* P, const unsigned char* stageId, int nStages) {
+    uint64_t n = (uint64_t)ms_to_samples(DSP_TAIL_MIN_MS, c->sr);
+    for (int i=0; i<nStages; ++i) {
+        switch (stageId[i]) {
+        case DSP_STAGE_REVERB:
+            if (P->reverb_type == DSP_REVERB_IR) n += dsp_nuconv_taps(c->rvir);
+            else {
+                // 延迟线里的内容一个环长之内都会经过输出；输出连续安静这么久说明环里也只剩安静的内容
+                // （Schroeder 取最长的梳状 len[3]，再加一个样本的余量）
+                const ReverbChan* r = &c->reverb[0];
+                n += (uint64_t)r->pd_cap + (P->reverb_type == DSP_REVERB_FDN
+                        ? (uint64_t)c->fdn[0].k.mask + 1
+                        : (uint64_t)r->k.len[3] + 1 + r->k.ap_len[0] + r->k.ap_len[1]);
+            }
+            break;
+        case DSP_STAGE_CONV:
+            n += dsp_conv_length(c->conv) + dsp_conv_partition(c->conv);
+            break;
+        case DSP_STAGE_LIMITER:
+            if (P->limiter_mode == DSP_LIMITER_LOOKAHEAD)
+                n += (uint64_t)P->lim_lookahead + (P->lim_true_peak ? DSP_TP_DELAY : 0u);
+            break;
+        default:
+            break;
+        }
+    }
+    return n;
+}
+
+// 清空刚才在跑的各级状态，之后再运行时与 dsp_reset 之后一样从空状态开始
+// （只清跑过的那种混响、用到的那几路，8 通道的全部延迟线有 1MB 多）
+static void clear_stages(DSP_CTX* c, const DspParamSet* P, const unsigned char* stageId, int nStages) {
+    for (int i=0; i<nStages; ++i) {
+        if (stageId[i] == DSP_STAGE_EQ) eq_reset(&c->eq, c->lanes);
+        if (stageId[i] == DSP_STAGE_REVERB && P->reverb_type != DSP_REVERB_IR) {
+            const unsigned nr = c->rv_bus ? (c->ch > 1 ? 2u : 1u) : c->nrev;
+            for (unsigned r=0; r<nr; ++r) reverb_clear(&c->reverb[r]);
+            if (P->reverb_type == DSP_REVERB_FDN)
+                for (unsigned r=0; r<fdn_pairs(nr); ++r) fdn_clear(&c->fdn[r]);
+        }
+    }
+    c->lim.live = 0;
+    c->conv_live = 0;
+    c->rvir_live = 0;
+}
+
+//======================================================
+// 恒等旁路：发布时判定参数整体是恒等（见 ctl_prepare），实时线程在块开头确认没有斜坡/块内事件/卷积 IR 后
+// 整块直通：就地什么也不做，非就地一次 memcpy，进入时清空各级状态。
+// 进入时增益/湿度/EQ 要等各自的斜坡走完，这几级本身已是恒等；但刚关掉的前瞻限幅器或卷积的延迟线里
+// 还有没放出来的声音，直接切到干声会丢掉这几百帧、在接缝处跳变。这时与退出对称：两级接着跑，
+// 先放完各自的延迟，再按平滑时长交叉淡化到干声，淡化走完才清状态、真正进入旁路。
+// 退出时增益/湿度/EQ 的斜坡都从恒等值出发，同样不用淡化；只有新的处理链有延迟或非线性（限幅器、卷积）时，
+// 先输出干声直到处理链填满自己的延迟，再按平滑时长线性交叉淡化到处理链输出。块内有定时事件时按帧精确直接切换
+//======================================================
+static int bypass_wanted(const DSP_CTX* c, const DspParamSet* P, int eventInBlock) {
+    return P->identity && !eventInBlock && !(P->conv_enabled && c->conv) &&
+           !ramp_active(&c->gain_r) && !ramp_active(&c->wet_r) && c->eq_r.pos >= c->eq_r.len;
+}
+
+// 当前参数下处理链的延迟（帧），同 dsp_get_latency_frames，但卷积看实时线程手上的 IR
+static unsigned chain_latency(const DSP_CTX* c, const DspParamSet* P) {
+    unsigned n = 0;
+    if (P->conv_enabled && c->conv) n += dsp_conv_partition(c->conv);
+    if (P->limiter_enabled && P->limiter_mode == DSP_LIMITER_LOOKAHEAD)
+        n += (unsigned)P->lim_lookahead + (P->lim_true_peak ? DSP_TP_DELAY : 0u);
+    return n;
+}
+
+// 退出旁路（各级状态进入时已清空）；hard = 块内有定时事件
+static void bypass_leave(DSP_CTX* c, const DspParamSet* P, int hard) {
+    c->bypass = 0;
+    if (hard || !(P->limiter_enabled || (P->conv_enabled && c->conv))) return;
+    c->byp_dry = 1.f;
+    c->byp_step = -1.f / (float)(P->ramp_len > 0 ? P->ramp_len : 1);
+    c->byp_hold = chain_latency(c, P);
+}
+
+// 进入旁路（上一块还在跑处理链）：前瞻限幅器/卷积上一块还在跑时开始淡化到干声，返回 1；
+// 没有要放的延迟时返回 0，调用方直接进入。淡化中途从退出淡化转过来时从当前权重接着走，不再等延迟
+static int bypass_enter(DSP_CTX* c, const DspParamSet* P) {
+    unsigned drain = 0, hold = 0;
+    if (c->conv_live && c->conv) {
+        drain |= DSP_DRAIN_CONV;
+        hold += dsp_conv_partition(c->conv);
+    }
+    // 前瞻一起改了时接着跑会先清空延迟线，放出来的是静音，不如直接切
+    if (c->lim.live && c->lim.L == P->lim_lookahead && c->lim.tp == P->lim_true_peak) {
+        drain |= DSP_DRAIN_LIMITER;
+        hold += (unsigned)c->lim.L + (c->lim.tp ? DSP_TP_DELAY : 0u);
+    }
+    if (!drain) return 0;
+    if (c->byp_step == 0.f) {
+        c->byp_dry = 0.f;
+        c->byp_hold = hold;
+    } else {
+        c->byp_hold = 0;
+    }
+    c->byp_step = 1.f / (float)(P->ramp_len > 0 ? P->ramp_len : 1);
+    c->byp_drain = drain;
+    return 1;
+}
+
+// 淡化中的写回：dst = (1-d)·处理链 + d·干声，先保持 d 不变共 byp_hold 帧，再逐帧走到 0（退出）或 1（进入）
+// （src 与 dst 可以是同一块内存：同一位置先读后写）
+static void bypass_mix(DSP_CTX* c, const float* src, float* dst, const float* w, size_t frames) {
+    const unsigned ch = c->ch, lanes = c->lanes;
     for (size_t n=0; n<frames; ++n) {
+        float d = c->byp_dry;
+        if (c->byp_hold) c->byp_hold--;
+        else {
+            d = clampf(c->byp_dry + c->byp_step, 0.f, 1.f);
+            c->byp_dry = d;
+        }
         for (unsigned cc=0; cc<ch; ++cc) {
-            float x = in[n*ch + cc];
+            const float x = src ? src[n*ch + cc] : 0.f;
+            dst[n*ch + cc] = (1.f - d) * w[n*lanes + cc] + d * x;
+        }
+    }
+    if (c->byp_step < 0.f ? c->byp_dry <= 0.f : c->byp_dry >= 1.f) c->byp_step = 0.f;
+}
+
+#if DSP_ENABLE_STATS
+static void stat_block(DSP_CTX* c, uint64_t tBlock, size_t frames) {
+    DspStatsAcc* a = c->stats;
+    const uint64_t dt = dsp_clock_ticks() - tBlock;
+    a->blocks++;
+    a->frames += frames;
+    a->block_ticks += dt;
+    if (dt > a->block_max_ticks) a->block_max_ticks = dt;
+    a->block_hist[stat_bucket(dt)]++;
+}
+#endif
+
+// 记录本块输入是否静音：有声音的块清零计数并退出空闲
+static int note_silence(DSP_CTX* c, const float* in, size_t frames) {
+    const int silent = !in || c->is_quiet(in, frames * c->ch, DSP_SILENCE_LEVEL);
+    if (silent) {
+        c->quiet_in += frames;
+    } else {
+        c->quiet_in = c->quiet_out = 0;
+        c->idle = 0;
+    }
+    return silent;
+}
 
-            // PreGain
-            x *= G;
+// dsp_process_block / dsp_process_silence 的共同实现；in = NULL 表示整块静音。
+// 返回 0：链空闲，这一块没有跑任何一级（in != NULL 时 out 已清零，否则 out 没动）；
+// 旁路中 in = NULL 也返回 0（输出就是静音的输入）
+static int dsp_run(DSP_CTX* c, const float* in, float* out, size_t frames) {
+#if DSP_ENABLE_STATS
+    const uint64_t tBlock = dsp_clock_ticks();
+    if (dsp_atomic_load(c->stats_reset)) {
+        memset(c->stats, 0, sizeof(*c->stats));
+        dsp_atomic_store(c->stats_reset, 0);
+    }
+#endif
 
-            // EQ 串联
-            if (eqEn0) x = biquad_process(&c->eqBands[0][cc], x);
-            if (eqEn1) x = biquad_process(&c->eqBands[1][cc], x);
-            if (eqEn2) x = biquad_process(&c->eqBands[2][cc], x);
+    const unsigned ch = c->ch;
+    const unsigned lanes = c->lanes;
+    float* const w = c->work;
+
+    // 有声音的块一来就退出空闲（状态进入空闲时已清空）；旁路中不看输入
+    int silent = 0;
+    if (!c->bypass) silent = note_silence(c, in, frames);
+
+    // 参数快照每块只取一次（一次原子读；有新发布时再加一次原子交换）；
+    // 之后再看一眼事件队列（空队列也只是一次原子读）
+    const uint64_t pos = c->frame_pos;
+    const DspParamSet* prev = c->params;
+    tb_acquire(c);
+    // 新发布的参数：设定斜坡（空闲时没有声音可平滑；旁路中换成另一组恒等参数也不用平滑）
+    if (c->params != prev) smooth_retarget(c, c->params, c->snap || c->idle || (c->bypass && c->params->identity));
+
+    if (c->idle) {
+        // 空闲：只推进流位置，块内到时的事件一并应用，新 IR 照常换上（进入空闲时 live 已清零，换上的是空状态）
+        ev_apply_due(c, pos + frames - 1);
+        conv_acquire(c);
+        rvir_acquire(c);
+        if (in) memset(out, 0, sizeof(float) * frames * ch);
+        c->frame_pos = pos + frames;
+#if DSP_ENABLE_STATS
+        c->stats->idle_blocks++;
+        stat_block(c, tBlock, frames);
+#endif
+        return 0;
+    }
 
-            float y = x;
+    uint64_t nextEv = ev_apply_due(c, pos);
+    const DspParamSet* P = c->params;
+    conv_acquire(c);
+    rvir_acquire(c);
+
+    dsp_stage_fn  stages[DSP_MAX_STAGES];
+    unsigned char stageId[DSP_MAX_STAGES];
+    const int eventInBlock = nextEv - pos < frames;
+    const int wanted = bypass_wanted(c, P, eventInBlock);
+    if (wanted && (c->bypass || (!c->byp_drain && !bypass_enter(c, P)))) {
+        if (!c->bypass) {
+            clear_stages(c, P, stageId, build_stages(c, P, stages, stageId));
+            c->bypass = 1;
+            c->byp_step = 0.f;
+            c->byp_hold = 0;
+        }
+        if (in && in != out) memcpy(out, in, sizeof(float) * frames * ch);
+        c->frame_pos = pos + frames;
+        c->snap = 0;
+#if DSP_ENABLE_STATS
+        c->stats->bypass_blocks++;
+        stat_block(c, tBlock, frames);
+#endif
+        return in != NULL;
+    }
+    if (c->bypass) {
+        silent = note_silence(c, in, frames);
+        bypass_leave(c, P, eventInBlock);
+    } else if (c->byp_drain && !wanted) {
+        // 淡化到干声的途中又有要跑的级：从当前权重淡回处理链，刚才接着跑的两级按新参数决定去留
+        c->byp_drain = 0;
+        c->byp_step = -1.f / (float)(P->ramp_len > 0 ? P->ramp_len : 1);
+        c->byp_hold = 0;
+    }
 
-            // Reverb（湿干）
-            if (rvEn && c->reverb && c->reverb[cc].enabled) {
-                float rv = reverb_process_sample(&c->reverb[cc], x);
-                y = (1.0f - wet) * x + wet * rv;
+    const dsp_fpu_state fpu = dsp_fpu_flush_denormals();
+    int nStages = build_stages(c, P, stages, stageId);
+    const int mixing = c->byp_step != 0.f;
+
+    // 按 DSP_SUBBLOCK 分段，遇到事件所在帧再切一刀：先把整段读进工作区，再写回，因此 in==out 也安全
+    for (size_t base=0; base<frames; ) {
+        size_t nf = (frames - base < DSP_SUBBLOCK) ? (frames - base) : DSP_SUBBLOCK;
+        if (nextEv - (pos + base) < nf) nf = (size_t)(nextEv - (pos + base));   // nextEv > pos+base
+        const float* src = in ? in + base*ch : NULL;
+        float* dst = out + base*ch;
+
+        // 交织 → lane 排布（补齐的 lane 始终为 0）
+        if (src) {
+            for (size_t n=0; n<nf; ++n) {
+                for (unsigned cc=0; cc<ch; ++cc) w[n*lanes + cc] = src[n*ch + cc];
             }
+        } else {
+            memset(w, 0, sizeof(float) * nf * lanes);
+        }
 
-            // 软限幅（防止爆音）
-            if (limitEn) y = softclip(y);
+        for (int i=0; i<nStages; ++i) {
+#if DSP_ENABLE_STATS
+            const uint64_t t0 = dsp_clock_ticks();
+            stages[i](c, P, w, nf);
+            stat_add(&c->stats->stage[stageId[i]], dsp_clock_ticks() - t0);
+#else
+            stages[i](c, P, w, nf);
+#endif
+        }
 
-            out[n*ch + cc] = y;
+        // lane 排布 → 交织（退出旁路的淡化中与干声混合）
+        if (mixing) {
+            bypass_mix(c, src, dst, w, nf);
+        } else {
+            for (size_t n=0; n<nf; ++n) {
+                for (unsigned cc=0; cc<ch; ++cc) dst[n*ch + cc] = w[n*lanes + cc];
+            }
+        }
+
+        base += nf;
+        if (base < frames && pos + base >= nextEv) {
+            // 到了事件所在帧：换参数、重建级表（滤波器/混响状态连续，不清零）
+            nextEv = ev_apply_due(c, pos + base);
+            P = c->params;
+            nStages = build_stages(c, P, stages, stageId);
+        }
+    }
+    c->frame_pos = pos + frames;
+    c->snap = 0;
+
+    if (c->byp_drain && c->byp_step == 0.f) {
+        // 淡化到干声走完：清掉接着跑的两级，下一块起整块直通
+        clear_stages(c, P, stageId, nStages);
+        c->byp_drain = 0;
+        c->bypass = 1;
+    } else if (silent) {
+        // 输入静音：看输出是否也安静；安静得足够久（超过各级最长尾音）且没有斜坡/淡化在跑就进入空闲
+        if (c->is_quiet(out, frames * ch, DSP_SILENCE_LEVEL)) c->quiet_out += frames;
+        else c->quiet_out = 0;
+        if (c->quiet_out && c->byp_step == 0.f && !ramp_active(&c->gain_r) && !ramp_active(&c->wet_r) &&
+            c->eq_r.pos >= c->eq_r.len) {
+            const uint64_t hold = tail_frames(c, P, stageId, nStages);
+            if (c->quiet_in >= hold && c->quiet_out >= hold) {
+                clear_stages(c, P, stageId, nStages);
+                c->idle = 1;
+            }
         }
     }
+    dsp_fpu_restore(fpu);
+
+#if DSP_ENABLE_STATS
+    if (silent) c->stats->tail_blocks++;
+    stat_block(c, tBlock, frames);
+#endif
+    return 1;
+}
+
+void dsp_process_block(void* ctx, const float* in, float* out, size_t frames, unsigned channels) {
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    if (!c || !in || channels != c->ch || frames == 0) {
+        // 兜底：直通
+        if (in && in != out) memcpy(out, in, sizeof(float)*frames*channels);
+        return;
+    }
+    dsp_run(c, in, out, frames);
+}
+
+int dsp_process_silence(void* ctx, float* out, size_t frames, unsigned channels) {
+    DSP_CTX* c = (DSP_CTX*)ctx;
+    if (!c || !out || channels != c->ch || frames == 0) return 0;
+    return dsp_run(c, NULL, out, frames);
 }
@@ -18,19 +18,55 @@ typedef enum { DSP_EQ_PEAK = 0, DSP_EQ_LOWSHELF = 1, DSP_EQ_HIGHSHELF = 2 } DSP_
 
 // 创建/销毁（在非实时线程调用）
 void* dsp_create_context(unsigned sampleRate, unsigned channels);
+// 带选项创建（flags 为下面的 DSP_CREATE_* 按位或；dsp_create_context 即 flags = 0）
+//   DSP_CREATE_REVERB_BUS_ONLY：混响固定走发送总线，只分配总线用的最多 2 路混响状态，
+//   混响内存与通道数无关（dsp_set_reverb_routing 不起作用）
+#define DSP_CREATE_REVERB_BUS_ONLY 0x1u
+void* dsp_create_context_ex(unsigned sampleRate, unsigned channels, unsigned flags);
 void  dsp_destroy_context(void* ctx);
 void  dsp_reset(void* ctx);
 
+// 单个实例占用的内存字节数（创建时按采样率/通道数一次分配，之后不再变化）
+size_t dsp_get_memory_footprint(void* ctx);
+
 // 处理（实时线程调用）
 // in/out: interleaved float32, frames = 每声道样本数, channels = 实际通道数（与创建时一致）
+// 恒等旁路：参数整体是恒等时（增益 1、启用的 EQ 段全是 0 dB、混响关闭或湿度 0、限幅器关闭、卷积没有 IR 或关闭）
+// 整块直通，in == out 时什么也不做，否则一次 memcpy。判定在发布参数时做，斜坡走完才进入旁路；
+// 退出时若新的处理链有延迟或非线性（限幅器、卷积），先等它填满延迟，再按平滑时长（dsp_set_smoothing_ms）
+// 从干声交叉淡化过去；块内有定时事件时按帧精确直接切换
 void  dsp_process_block(void* ctx, const float* in, float* out, size_t frames, unsigned channels);
 
-// -------- 参数设置（非实时线程调用，内部做无锁更新） --------
+// 静音：整块输入都不超过 DSP_SILENCE_LEVEL（约 -160 dBFS）算静音。输入静音后各级照常运行放完尾音，
+// 直到输出连续安静的时间超过当前各级最长的尾音（混响延迟线与预延迟、IR 混响/卷积的 IR 长度、限幅器前瞻），
+// 这时清空各级状态进入空闲：之后的静音块不跑任何一级，直接输出 0（只推进流位置、照常应用参数与定时事件）。
+// 来了有声音的块立即恢复，从空状态开始（同 dsp_reset 之后）。处理期间浮点按“冲零”运行（x86 FTZ/DAZ，ARM FZ），
+// 衰减中的状态不会掉进非规格化数；调用线程原来的设置在返回前还原
+#define DSP_SILENCE_LEVEL 1e-8f
+// 宿主已知整块静音（例如 APO 收到 BUFFER_SILENT）时调用，等同输入全 0 的 dsp_process_block，但不用准备输入。
+// 返回 1：尾音还没放完，out 写了 frames 帧；返回 0：链已空闲，out 没有动过（输出就是静音）
+int   dsp_process_silence(void* ctx, float* out, size_t frames, unsigned channels);
+
+// -------- 参数设置（非实时线程调用；每次调用发布一份完整参数快照，实时线程在下一块开头整体切换） --------
+
+// 批量设置：begin/commit 之间的设置函数只改控制侧副本，最外层 commit 时统一发布一次快照（可嵌套）
+void  dsp_begin_update(void* ctx);
+void  dsp_commit_update(void* ctx);
+
+// 定时提交：把 begin 以来的改动排到流位置 frame（自创建以来已处理的帧数）处生效，帧精确：
+// dsp_process_block 会在该帧把块切开。frame 早于当前位置时在下一块开头生效；
+// 早于已排队的事件时跟在它后面（队列按时间升序）。最多排 16 个，队列满返回 0 并退化为立即发布。
+// 注意：控制侧副本始终是最新的，之后的立即设置会把尚未到时的改动一并带出去
+int   dsp_commit_update_at(void* ctx, uint64_t frame);
 
-// 增益（线性倍数，例如 1.0 原音量，1.5 约 +3.52 dB）
+// 当前流位置（帧）；其他线程读到的是最近一块结束时的值
+uint64_t dsp_get_stream_position(void* ctx);
+
+// 增益（线性倍数，例如 1.0 原音量，1.5 约 +3.52 dB）；夹在 ±16（+24 dB）以内，非有限值忽略
+// 有 EQ 段要跑时增益在发布时折进第一段的系数，不单独计时（stage[DSP_STAGE_GAIN] 只在增益斜坡中或没有 EQ 时有数）
 void  dsp_set_gain(void* ctx, float linear_gain);
 
-// 3 段 EQ（单位：Hz / dB / 无量纲 Q）
+// EQ（单位：Hz / dB / 无量纲 Q），MY_EQ_BANDS 段串联，禁用的段与 0 dB 的段不参与运算
 // 兼容保留：band=0 低搁架、band=1 峰值、band=2 高搁架；
 // 扩展后：band 可以取 0..11，3..11 默认按“峰值”处理（如需指定类型看下面增强函数）
 void  dsp_set_eq_enabled(void* ctx, int band, int enabled);
@@ -49,8 +85,153 @@ void  dsp_set_eq_params_ex(void* ctx, int band, float freq_hz, float q, float ga
 void  dsp_set_reverb_enabled(void* ctx, int enabled);
 void  dsp_set_reverb_params(void* ctx, float wet, float room_size, float damp, float pre_delay_ms);
 
-// 软限幅器（防爆音，可选）
+// 混响算法（开关/湿度沿用上面两个函数，运行中可切换）：
+//   SCHROEDER：每通道 4 梳状 + 2 全通（默认）；
+//   IR：用 dsp_set_reverb_ir 载入的脉冲响应做卷积，room_size/damp/pre_delay 不起作用（IR 自带房间特性与预延迟）；
+//   FDN：每通道一个 8 线反馈延迟网络（Hadamard 混合），room_size 决定混响时间（约 0.3~2.7 秒），
+//        damp 是反馈路径上的高频阻尼，pre_delay 同 Schroeder
+typedef enum { DSP_REVERB_SCHROEDER = 0, DSP_REVERB_IR = 1, DSP_REVERB_FDN = 2 } DSP_REVERB_TYPE;
+void  dsp_set_reverb_type(void* ctx, DSP_REVERB_TYPE type);
+
+// IR 混响的脉冲响应：非均匀分块卷积 —— 头部 64 点直接型、之后到 2048 点用 64 帧小分块（实时线程），
+// 再往后用 1024 帧大分块交给后台线程算，零延迟；几秒长的 IR 每次回调的代价也是固定的。
+// ir: 平面排布 [irChannels][taps]，通道 c 用第 c % irChannels 条；taps 最多 2^20。
+// IR 在调用线程上做 FFT，实时线程在下一块开头换上（接上输入历史，不会断音）。ir=NULL 或 taps=0 卸载
+// （IR 模式下没有 IR 时混响级不运行）。IR 内存另外分配，不计入 dsp_get_memory_footprint。
+// 返回 0 表示参数不合法、内存不足或建不了后台线程（原 IR 保持不变）
+int   dsp_set_reverb_ir(void* ctx, const float* ir, size_t taps, unsigned irChannels);
+
+// 混响路由（默认 PER_CHANNEL，运行中可切换）：
+//   PER_CHANNEL：每个通道跑自己的一路混响，代价随通道数线性增长；
+//   SEND_BUS：偶数通道（FL/C/BL/SL…）乘发送电平后加成总线左路、奇数通道加成右路（单声道只有一路），
+//             只跑这 1~2 路混响（FDN 两路线长/输出符号错开，互不相关），再按同样的奇偶分回各通道。
+//             代价与通道数无关；立体声时与 PER_CHANNEL 结果相同。IR 模式要省下 CPU 需配合 DSP_CREATE_REVERB_BUS_ONLY
+typedef enum { DSP_REVERB_PER_CHANNEL = 0, DSP_REVERB_SEND_BUS = 1 } DSP_REVERB_ROUTING;
+void  dsp_set_reverb_routing(void* ctx, DSP_REVERB_ROUTING routing);
+
+// 每通道的发送/返回电平（0~1，默认都是 1）：send 决定该通道送进混响多少，ret 决定混响湿声回到该通道多少
+// （该通道实际湿度 = wet·ret，例如 LFE 设 0/0 就完全不参与混响）。PER_CHANNEL 下两者相乘作用在本通道湿声上。
+// 只能设置前 DSP_REVERB_MAX_SENDS 个通道（更多的通道固定为 1），channel 超出范围返回 0
+#define DSP_REVERB_MAX_SENDS 32
+int   dsp_set_reverb_send(void* ctx, unsigned channel, float send, float ret);
+
+// 限幅器（防爆音，默认开启）：默认是前瞻砖墙限幅，所有通道共用一个增益，输出不超过阈值；
+// 低于阈值的信号原样通过，只是延迟前瞻那么多帧（见 dsp_get_latency_frames）。
+// 软限幅（tanh，无延迟，但对所有电平都有失真）作为另一种模式保留
+typedef enum { DSP_LIMITER_LOOKAHEAD = 0, DSP_LIMITER_SOFTCLIP = 1 } DSP_LIMITER_MODE;
+
+#define DSP_LIMITER_DEFAULT_THRESHOLD    0.98f   // 线性（约 -0.18 dBFS）
+#define DSP_LIMITER_DEFAULT_LOOKAHEAD_MS 1.5f
+#define DSP_LIMITER_DEFAULT_RELEASE_MS   50.f
+
 void  dsp_set_limiter_enabled(void* ctx, int enabled);
+void  dsp_set_limiter_mode(void* ctx, DSP_LIMITER_MODE mode);
+// threshold: 线性 0.01~1；lookahead_ms: 0~10；release_ms: 1~1000；
+// true_peak: 1 = 用 4 倍过采样估计样本之间的峰值（多 4 帧延迟）。改前瞻或真峰值开关时延迟线清零
+void  dsp_set_limiter_params(void* ctx, float threshold, float lookahead_ms, float release_ms, int true_peak);
+
+// 卷积（房间校正 FIR，默认位于混响之后、限幅器之前）：均匀分块 overlap-save FFT 卷积，
+// 每 partition 帧做一次 FFT 乘加，代价与 IR 长度成线性、与宿主块大小无关，延迟 = partition 帧。
+// ir: 平面排布 [irChannels][taps]，通道 c 用第 c % irChannels 条（传 1 条即所有通道共用）；
+// partition: 2 的幂 32~4096，0 = 默认 256。IR 在调用线程上分块做 FFT，实时线程在下一块开头换上
+// （分块长度不变时接上输入历史，不会断音）。ir=NULL 或 taps=0 卸载 IR。
+// IR 内存按需另外分配，不计入 dsp_get_memory_footprint。返回 0 表示参数不合法或内存不足（原 IR 保持不变）
+int   dsp_set_conv_ir(void* ctx, const float* ir, size_t taps, unsigned irChannels, unsigned partition);
+// 默认开启：载入 IR 即生效；关闭后再开启从空状态开始
+void  dsp_set_conv_enabled(void* ctx, int enabled);
+
+// 当前参数下整条链的延迟（帧）：卷积级（分块长度）与前瞻限幅器会引入延迟，其余各级为 0
+unsigned dsp_get_latency_frames(void* ctx);
+
+// 参数平滑时长（毫秒，0~100，默认 10；0 = 直接跳变）
+// 立即发布的增益/混响湿度（含开关）按线性斜坡过渡，EQ 系数每 32 个样本插值一次；
+// 首块之前、dsp_reset 之后和 dsp_commit_update_at 的定时事件不平滑（帧精确）
+void  dsp_set_smoothing_ms(void* ctx, float ms);
+
+// ========== 处理程序（字节码）：处理顺序 + 路由 + 各级参数 ==========
+// 小端，4 字节对齐。头 4 字节：'D' 'P' DSP_PROGRAM_VERSION 指令条数；
+// 每条指令：op(1) index(1) nargs(1) 0(1)，后接 nargs 个 32 位参数（f32，或标注 i32 的整数）。
+// 级指令每种至多出现一次，出现的先后就是处理顺序；没列出的级在载入时关闭（增益置 1、EQ 各段关闭）：
+//   DSP_OP_GAIN     [] | [gain]                                        带参数时设增益
+//   DSP_OP_EQ       []                                                 段参数用 DSP_OP_EQ_BAND
+//   DSP_OP_REVERB   [] | [wet, room, damp, pre_ms]                     带参数时同时启用
+//   DSP_OP_CONV     []                                                 IR 仍用 dsp_set_conv_ir 载入
+//   DSP_OP_LIMITER  [] | [mode(i32), threshold, lookahead_ms, release_ms, true_peak(i32)]  带参数时同时启用
+// 参数指令（位置不限，按出现顺序生效）：
+//   DSP_OP_EQ_BAND      index=段号 [type(i32), freq, q, gain_db]       设置并启用该段
+//   DSP_OP_EQ_OFF       index=段号 []                                   关闭该段
+//   DSP_OP_REVERB_TYPE  [type(i32)]    DSP_OP_REVERB_ROUTE [routing(i32)]
+//   DSP_OP_REVERB_SEND  index=通道 [send, ret]
+#define DSP_PROGRAM_VERSION 1
+typedef enum {
+    DSP_OP_GAIN = 1, DSP_OP_EQ = 2, DSP_OP_REVERB = 3, DSP_OP_CONV = 4, DSP_OP_LIMITER = 5,
+    DSP_OP_EQ_BAND = 16, DSP_OP_EQ_OFF = 17, DSP_OP_REVERB_TYPE = 18, DSP_OP_REVERB_ROUTE = 19, DSP_OP_REVERB_SEND = 20
+} DSP_OP;
+
+// 非实时线程调用。先整段校验（头、长度、操作码、参数个数/范围、非有限浮点数、重复的级），
+// 通过后作为一次批量更新生效：发布时编译成按顺序排好的级表，实时线程每块只是依次调用。
+// code=NULL 或 bytes=0 恢复默认顺序（其余参数不动）。返回 0 表示程序不合法（参数与顺序都保持不变）
+int   dsp_set_program(void* ctx, const void* code, size_t bytes);
+
+// ========== SIMD 指令集（创建时自动选择 CPU 支持的最宽指令集） ==========
+// 各指令集与标量回退输出逐位一致；强制切换主要用于 EfxTestHost 做 A/B 对比
+typedef enum {
+    DSP_SIMD_SCALAR = 0,
+    DSP_SIMD_SSE2   = 1,
+    DSP_SIMD_AVX2   = 2,
+    DSP_SIMD_NEON   = 3
+} DSP_SIMD_LEVEL;
+
+DSP_SIMD_LEVEL dsp_get_simd_level(void* ctx);
+// 非实时线程调用；返回 0 表示当前 CPU 不支持该指令集（保持原设置）
+int   dsp_set_simd_level(void* ctx, DSP_SIMD_LEVEL level);
+
+// ========== 运行统计（各级耗时 + 块耗时直方图） ==========
+// 开销：每个子块每级读两次时钟，每块再读两次、记一次直方图；EQ 整张段表仍一次跑完，只计整级的时间。
+// 默认不编译（DSP_ENABLE_STATS=0，dsp_get_stats 返回 0）；APO 与 EfxTestHost 的工程里都定义了 DSP_ENABLE_STATS=1
+#ifndef DSP_ENABLE_STATS
+#define DSP_ENABLE_STATS 0
+#endif
+
+#define DSP_STATS_HIST_BUCKETS 32   // 第 i 桶：块耗时计数落在 [2^i, 2^(i+1))
+
+typedef enum {
+    DSP_STAGE_GAIN    = 0,
+    DSP_STAGE_EQ      = 1,
+    DSP_STAGE_REVERB  = 2,
+    DSP_STAGE_LIMITER = 3,
+    DSP_STAGE_CONV    = 4,
+    DSP_STAGE_COUNT
+} DSP_STAGE;
+
+typedef struct {
+    uint64_t calls;       // 运行次数（按子块计，一块最多 DSP_SUBBLOCK 帧）
+    uint64_t ticks;       // 累计耗时（时钟计数）
+    uint64_t max_ticks;   // 单次最大耗时
+} DSP_STAGE_STATS;
+
+typedef struct {
+    double   ticks_per_second;            // 时钟频率，用于把 ticks 换算成时间
+    uint64_t blocks;                      // dsp_process_block 调用次数
+    uint64_t frames;                      // 累计帧数
+    DSP_STAGE_STATS stage[DSP_STAGE_COUNT];
+    uint64_t eq_band_runs;                // EQ 级静态时跑过的段数之和（每子块加一次段表长度；0 dB 的段发布时就去掉，不计）
+    uint64_t block_max_ticks;
+    uint64_t block_hist[DSP_STATS_HIST_BUCKETS];
+    uint64_t reverb_tail_waits;           // IR 混响：实时线程等后台线程算尾部的次数（按实时节奏运行时应为 0）
+    uint64_t tail_blocks;                 // 输入静音、还在放尾音的块数（各级照常运行）
+    uint64_t idle_blocks;                 // 输入静音、链已空闲直接输出静音的块数（计入 blocks 与直方图）
+    uint64_t bypass_blocks;               // 参数为恒等、整块直通的块数（同上）
+    double   block_avg_us;
+    double   block_p50_us;                // 由直方图估算，取所在桶的上沿（偏保守）
+    double   block_p99_us;
+    double   block_p999_us;
+} DSP_STATS;
+
+// 非实时线程调用；实时线程同时在写，读到的是近似一致的快照。返回 0 表示统计未编译
+int   dsp_get_stats(void* ctx, DSP_STATS* out);
+// 请求清零：实时线程在下一块开头执行
+void  dsp_reset_stats(void* ctx);
 
 #ifdef __cplusplus
 }